@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+// The brackets_bench target of cefclient.gyp. To build it by hand on Linux,
+// from src/, with all of common/ but the Windows, async and V8 files:
+//
+//   g++ -O2 -I . bench/brackets_bench*.cpp $(ls common/*.cpp |
+//       grep -v "_win\|async\|v8_util") -lpthread -o brackets_bench
+//
+// Run it with the names, or the beginnings of the names, of the benchmarks
+// to run, or none to run them all:
+//
+//   brackets_bench fs/read json_escape > results.json
+
+#include "bench/brackets_bench.h"
+#include "common/brackets_fs.h"
+#include "common/brackets_json.h"
+#include "common/brackets_metrics.h"
+#include "common/brackets_threading.h"
+
+#include <stdio.h>
+#include <vector>
+
+namespace Brackets {
+namespace Bench {
+
+namespace {
+
+std::vector<std::string> g_filters;
+bool g_failed = false;
+
+void PrintResult(const std::string& name, unsigned long long elapsed, const Metrics::Histogram& times,
+                 unsigned long long bytes)
+{
+    std::string line = "{\"name\":";
+    JSON::AppendString(line, name);
+
+    char buffer[256];
+    sprintf(buffer, ",\"iterations\":%llu,\"ns_per_op\":%.0f,\"p50_ns\":%llu,\"p99_ns\":%llu",
+            times.GetCount(), (double)elapsed / times.GetCount(), times.GetPercentile(50),
+            times.GetPercentile(99));
+    line += buffer;
+    if (bytes) {
+        sprintf(buffer, ",\"mb_per_s\":%.1f", (double)bytes * times.GetCount() / 1e6 / (elapsed / 1e9));
+        line += buffer;
+    }
+    line += "}";
+
+    printf("%s\n", line.c_str());
+    fflush(stdout);
+}
+
+} // namespace
+
+bool IsSelected(const std::string& name)
+{
+    if (g_filters.empty())
+        return true;
+    for (size_t i = 0; i < g_filters.size(); i++) {
+        if (name.compare(0, g_filters[i].length(), g_filters[i]) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool IsGroupSelected(const std::string& prefix)
+{
+    if (IsSelected(prefix))
+        return true;
+    for (size_t i = 0; i < g_filters.size(); i++) {
+        if (g_filters[i].compare(0, prefix.length(), prefix) == 0)
+            return true;
+    }
+    return false;
+}
+
+void ReportError(const std::string& name, int error)
+{
+    std::string line = "{\"name\":";
+    JSON::AppendString(line, name);
+    printf("%s,\"error\":%d}\n", line.c_str(), error);
+    fflush(stdout);
+    g_failed = true;
+}
+
+void Measure(const std::string& name, Benchmark& benchmark, unsigned long long bytes)
+{
+    if (!IsSelected(name))
+        return;
+
+    // Once to warm up the caches, and to find out if it works at all
+    int error = benchmark.Run();
+    if (error != NO_ERROR) {
+        ReportError(name, error);
+        return;
+    }
+
+    Metrics::Histogram times;
+    unsigned long long start = GetMonotonicTime();
+    unsigned long long now = start;
+    while (now - start < kRunNanoseconds) {
+        unsigned long long runStart = now;
+        error = benchmark.Run();
+        now = GetMonotonicTime();
+        if (error != NO_ERROR) {
+            ReportError(name, error);
+            return;
+        }
+        times.Record(now - runStart);
+    }
+
+    PrintResult(name, now - start, times, bytes);
+}
+
+} // namespace Bench
+} // namespace Brackets
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+        Brackets::Bench::g_filters.push_back(argv[i]);
+
+    Brackets::Bench::RunJSONBenchmarks();
+    Brackets::Bench::RunFileSystemBenchmarks();
+#if defined(BRACKETS_BENCH_CEF)
+    Brackets::Bench::RunCefWrapperBenchmarks();
+#endif
+
+    return Brackets::Bench::g_failed ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_BENCH_H
+#define _BRACKETS_BENCH_H
+
+#include <string>
+
+/**
+ * brackets_bench times the native code that doesn't need a browser: the
+ * file system core, the JSON escaping and, where libcef is there to link
+ * with, the wrapper utilities. Each benchmark prints one JSON object per
+ * line, so the results can be kept and compared between builds:
+ *
+ *   {"name":"fs/read_file/1mb","iterations":2917,"ns_per_op":68541,
+ *    "p50_ns":65535,"p99_ns":98303,"mb_per_s":15298.4}
+ *
+ * p50_ns and p99_ns are within the precision of Metrics::Histogram, and
+ * mb_per_s is only there for benchmarks that process a known number of
+ * bytes. A benchmark that fails prints its name and the error instead.
+ */
+namespace Brackets {
+namespace Bench {
+
+// How long each benchmark runs, roughly
+const unsigned long long kRunNanoseconds = 200000000ULL;
+
+// An operation to time. Run() returns NO_ERROR, or the error that makes the
+// benchmark stop.
+class Benchmark {
+public:
+    virtual ~Benchmark() {}
+    virtual int Run() = 0;
+};
+
+// Returns true if the benchmark called name was asked for on the command
+// line, by its name or the beginning of it
+bool IsSelected(const std::string& name);
+
+// Returns true if any of the benchmarks whose names start with prefix may
+// be selected, so groups of benchmarks that aren't can skip their setup
+bool IsGroupSelected(const std::string& prefix);
+
+// Runs benchmark over and over for about kRunNanoseconds, if it is
+// selected, and prints its results. bytes is the amount of data each run
+// processes, or 0.
+void Measure(const std::string& name, Benchmark& benchmark, unsigned long long bytes);
+
+// Prints that the benchmark, or group of benchmarks, called name failed with
+// error, for failures outside of Benchmark::Run(). brackets_bench exits with
+// 1 if any did.
+void ReportError(const std::string& name, int error);
+
+void RunJSONBenchmarks();
+void RunFileSystemBenchmarks();
+
+#if defined(BRACKETS_BENCH_CEF)
+// CefZipArchive, CefXmlObject and CefByteReadHandler. They need libcef.
+void RunCefWrapperBenchmarks();
+#endif
+
+} // namespace Bench
+} // namespace Brackets
+
+#endif // _BRACKETS_BENCH_H
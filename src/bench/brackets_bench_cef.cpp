@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+// The stream and archive utilities of libcef_dll_wrapper. CefZipArchive and
+// CefXmlObject read through CefZipReader and CefXmlReader, which are in
+// libcef, so these are only built where it is linked in (BRACKETS_BENCH_CEF).
+// They don't need CefInitialize().
+
+#if defined(BRACKETS_BENCH_CEF)
+
+#include "bench/brackets_bench.h"
+#include "common/brackets_fs.h"
+#include "include/cef.h"
+#include "include/cef_wrapper.h"
+
+#include <stdio.h>
+#include <string>
+
+namespace Brackets {
+namespace Bench {
+
+namespace {
+
+const int kArchiveFileCount = 200;
+const size_t kArchiveFileSize = 4 * 1024;
+const int kXmlElementCount = 2000;
+const size_t kStreamSize = 1024 * 1024;
+const size_t kReadSize = 4 * 1024;
+
+unsigned int g_crcTable[256];
+
+unsigned int GetCRC32(const std::string& data)
+{
+    if (!g_crcTable[1]) {
+        for (unsigned int i = 0; i < 256; i++) {
+            unsigned int crc = i;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 1) ? (0xEDB88320U ^ (crc >> 1)) : (crc >> 1);
+            g_crcTable[i] = crc;
+        }
+    }
+
+    unsigned int crc = 0xFFFFFFFFU;
+    for (size_t i = 0; i < data.length(); i++)
+        crc = g_crcTable[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFU;
+}
+
+void AppendUInt16(std::string& out, unsigned int value)
+{
+    out += (char)(value & 0xFF);
+    out += (char)((value >> 8) & 0xFF);
+}
+
+void AppendUInt32(std::string& out, unsigned int value)
+{
+    AppendUInt16(out, value & 0xFFFF);
+    AppendUInt16(out, value >> 16);
+}
+
+// A zip archive of source files, stored without compression so the time is
+// spent in the archive code rather than in inflating
+std::string MakeArchive()
+{
+    std::string contents;
+    while (contents.length() + 32 <= kArchiveFileSize)
+        contents += "    var value = load(path, 42);\n";
+    contents.append(kArchiveFileSize - contents.length(), '\n');
+    unsigned int crc = GetCRC32(contents);
+
+    std::string archive;
+    std::string directory;
+    for (int i = 0; i < kArchiveFileCount; i++) {
+        char name[32];
+        int nameLength = sprintf(name, "src/file%03d.js", i);
+        unsigned int offset = (unsigned int)archive.length();
+
+        AppendUInt32(archive, 0x04034B50);      // local file header
+        AppendUInt16(archive, 20);              // version needed
+        AppendUInt16(archive, 0);               // flags
+        AppendUInt16(archive, 0);               // stored
+        AppendUInt16(archive, 0);               // time
+        AppendUInt16(archive, 0x21);            // date, 1980-01-01
+        AppendUInt32(archive, crc);
+        AppendUInt32(archive, (unsigned int)contents.length());
+        AppendUInt32(archive, (unsigned int)contents.length());
+        AppendUInt16(archive, nameLength);
+        AppendUInt16(archive, 0);               // extra field length
+        archive.append(name, nameLength);
+        archive += contents;
+
+        AppendUInt32(directory, 0x02014B50);    // central directory header
+        AppendUInt16(directory, 20);            // version made by
+        AppendUInt16(directory, 20);            // version needed
+        AppendUInt16(directory, 0);             // flags
+        AppendUInt16(directory, 0);             // stored
+        AppendUInt16(directory, 0);             // time
+        AppendUInt16(directory, 0x21);          // date
+        AppendUInt32(directory, crc);
+        AppendUInt32(directory, (unsigned int)contents.length());
+        AppendUInt32(directory, (unsigned int)contents.length());
+        AppendUInt16(directory, nameLength);
+        AppendUInt16(directory, 0);             // extra field length
+        AppendUInt16(directory, 0);             // comment length
+        AppendUInt16(directory, 0);             // disk number
+        AppendUInt16(directory, 0);             // internal attributes
+        AppendUInt32(directory, 0);             // external attributes
+        AppendUInt32(directory, offset);
+        directory.append(name, nameLength);
+    }
+
+    unsigned int directoryOffset = (unsigned int)archive.length();
+    archive += directory;
+    AppendUInt32(archive, 0x06054B50);          // end of central directory
+    AppendUInt16(archive, 0);                   // disk number
+    AppendUInt16(archive, 0);                   // disk with the directory
+    AppendUInt16(archive, kArchiveFileCount);
+    AppendUInt16(archive, kArchiveFileCount);
+    AppendUInt32(archive, (unsigned int)directory.length());
+    AppendUInt32(archive, directoryOffset);
+    AppendUInt16(archive, 0);                   // comment length
+    return archive;
+}
+
+// A project description, with attributes, text and entities
+std::string MakeXml()
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<project name=\"brackets\">\n";
+    for (int i = 0; i < kXmlElementCount; i++) {
+        char element[256];
+        sprintf(element, "  <file path=\"src/dir%d/file%04d.js\" size=\"%d\" modified=\"2012-03-01T12:00:00Z\">\n"
+                         "    <description>Loads &amp; saves the r\xC3\xA9sum\xC3\xA9 &lt;%d&gt;</description>\n"
+                         "  </file>\n", i % 100, i, i * 37, i);
+        xml += element;
+    }
+    xml += "</project>\n";
+    return xml;
+}
+
+class ZipArchiveBenchmark : public Benchmark {
+public:
+    ZipArchiveBenchmark() : m_archive(MakeArchive()) {}
+
+    size_t GetSize() const { return m_archive.length(); }
+
+    virtual int Run()
+    {
+        CefRefPtr<CefZipArchive> archive(new CefZipArchive());
+        CefRefPtr<CefStreamReader> stream(CefStreamReader::CreateForData(&m_archive[0], m_archive.length()));
+        if (!stream.get() || archive->Load(stream, true) != (size_t)kArchiveFileCount)
+            return ERR_UNKNOWN;
+        return NO_ERROR;
+    }
+
+private:
+    std::string m_archive;
+};
+
+class XmlObjectBenchmark : public Benchmark {
+public:
+    XmlObjectBenchmark() : m_xml(MakeXml()) {}
+
+    size_t GetSize() const { return m_xml.length(); }
+
+    virtual int Run()
+    {
+        CefRefPtr<CefXmlObject> object(new CefXmlObject("project"));
+        CefRefPtr<CefStreamReader> stream(CefStreamReader::CreateForData(&m_xml[0], m_xml.length()));
+        if (!stream.get() || !object->Load(stream, XML_ENCODING_NONE, "", NULL) ||
+                object->GetChildCount() != kXmlElementCount)
+            return ERR_UNKNOWN;
+        return NO_ERROR;
+    }
+
+private:
+    std::string m_xml;
+};
+
+// Reads all of the bytes kReadSize at a time, from the handler itself or
+// through a CefStreamReader, the way CefZipArchive and CefXmlObject read
+class ByteReadHandlerBenchmark : public Benchmark {
+public:
+    explicit ByteReadHandlerBenchmark(bool throughStream)
+        : m_bytes(kStreamSize, 'x')
+        , m_buffer(kReadSize, 0)
+        , m_throughStream(throughStream)
+    {
+    }
+
+    virtual int Run()
+    {
+        CefRefPtr<CefByteReadHandler> handler(
+            new CefByteReadHandler(reinterpret_cast<const unsigned char*>(m_bytes.data()), m_bytes.length(), NULL));
+        CefRefPtr<CefStreamReader> stream;
+        if (m_throughStream) {
+            stream = CefStreamReader::CreateForHandler(handler.get());
+            if (!stream.get())
+                return ERR_UNKNOWN;
+        }
+
+        size_t total = 0;
+        for (;;) {
+            size_t read = m_throughStream ? stream->Read(&m_buffer[0], 1, kReadSize)
+                                          : handler->Read(&m_buffer[0], 1, kReadSize);
+            if (!read)
+                break;
+            total += read;
+        }
+        return (total == m_bytes.length()) ? NO_ERROR : ERR_CANT_READ;
+    }
+
+private:
+    std::string m_bytes;
+    std::string m_buffer;
+    bool m_throughStream;
+};
+
+} // namespace
+
+void RunCefWrapperBenchmarks()
+{
+    if (!IsGroupSelected("cef/"))
+        return;
+
+    if (IsSelected("cef/zip_archive_load/200_files")) {
+        ZipArchiveBenchmark zipArchive;
+        Measure("cef/zip_archive_load/200_files", zipArchive, zipArchive.GetSize());
+    }
+    if (IsSelected("cef/xml_object_load/2000_elements")) {
+        XmlObjectBenchmark xmlObject;
+        Measure("cef/xml_object_load/2000_elements", xmlObject, xmlObject.GetSize());
+    }
+
+    ByteReadHandlerBenchmark byteReadHandler(false);
+    Measure("cef/byte_read_handler/1mb", byteReadHandler, kStreamSize);
+    ByteReadHandlerBenchmark streamReader(true);
+    Measure("cef/byte_read_handler/1mb/stream_reader", streamReader, kStreamSize);
+}
+
+} // namespace Bench
+} // namespace Brackets
+
+#endif // BRACKETS_BENCH_CEF
@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+// Directory listing, stat, read and write, through the FileSystem functions
+// the native methods call. The files are made in a new directory in the
+// temporary directory, and deleted afterwards.
+//
+// Unless the name says cached, the caches of brackets_fs.cpp are cleared or
+// turned off for each run, so the disk (or rather the OS cache) is read every
+// time.
+
+#include "bench/brackets_bench.h"
+#include "common/brackets_encoding.h"
+#include "common/brackets_fs.h"
+#include "common/brackets_fs_content_cache.h"
+#include "common/brackets_fs_metadata_cache.h"
+#include "common/brackets_threading.h"
+#include "common/brackets_worker_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace Brackets {
+namespace Bench {
+
+namespace {
+
+const int kFileCount = 1000;
+const size_t kSmallFileSize = 4 * 1024;
+const size_t kLargeFileSize = 1024 * 1024;
+
+// The caches don't keep files and directories modified in the last two
+// seconds, which may change again without their modification time changing.
+// They go by time(), so it can take almost three.
+const unsigned long long kCacheDelay = 3500000000ULL;
+
+// The files a benchmark run made, deleted when it is done
+class Fixture {
+public:
+    Fixture() : m_error(NO_ERROR) {}
+    ~Fixture() { Delete(); }
+
+    int Create()
+    {
+        const char* tempDir = getenv("TMPDIR");
+        if (!tempDir || !*tempDir)
+            tempDir = getenv("TEMP");
+        if (!tempDir || !*tempDir)
+            tempDir = "/tmp";
+
+        char name[64];
+        sprintf(name, "/brackets_bench_%llu", GetMonotonicTime());
+        m_root = tempDir;
+        for (size_t i = 0; i < m_root.length(); i++) {
+            if (m_root[i] == '\\')
+                m_root[i] = '/';
+        }
+        if (!m_root.empty() && m_root[m_root.length() - 1] == '/')
+            m_root.erase(m_root.length() - 1);
+        m_root += name;
+
+        m_error = FileSystem::MakeDir(m_root, 0777);
+        if (m_error == NO_ERROR)
+            m_directories.push_back(m_root);
+        return m_error;
+    }
+
+    const std::string& GetRoot() const { return m_root; }
+
+    int AddDirectory(const std::string& path)
+    {
+        if (m_error == NO_ERROR) {
+            m_error = FileSystem::MakeDir(path, 0777);
+            if (m_error == NO_ERROR)
+                m_directories.push_back(path);
+        }
+        return m_error;
+    }
+
+    int AddFile(const std::string& path, const std::string& contents)
+    {
+        if (m_error == NO_ERROR) {
+            m_error = FileSystem::WriteFile(path, contents, "utf8");
+            if (m_error == NO_ERROR)
+                m_files.push_back(path);
+        }
+        return m_error;
+    }
+
+    const std::vector<std::string>& GetFiles() const { return m_files; }
+
+    void Delete()
+    {
+        for (size_t i = 0; i < m_files.size(); i++)
+            FileSystem::DeleteFileOrDirectory(m_files[i]);
+        m_files.clear();
+        while (!m_directories.empty()) {
+            FileSystem::DeleteEmptyDirectory(m_directories.back());
+            m_directories.pop_back();
+        }
+    }
+
+private:
+    std::string m_root;
+    std::vector<std::string> m_directories;     // parents first
+    std::vector<std::string> m_files;
+    int m_error;
+
+    // Not copyable
+    Fixture(const Fixture&);
+    Fixture& operator=(const Fixture&);
+};
+
+class ReadDirBenchmark : public Benchmark {
+public:
+    ReadDirBenchmark(const std::string& path, bool withInfo, bool cached)
+        : m_path(path)
+        , m_withInfo(withInfo)
+        , m_cached(cached)
+    {
+    }
+
+    virtual int Run()
+    {
+        if (!m_cached)
+            FileSystem::MetadataCache::Invalidate(m_path, false);
+        return FileSystem::ReadDir(m_path, m_entries, m_withInfo);
+    }
+
+private:
+    std::string m_path;
+    bool m_withInfo;
+    bool m_cached;
+    FileSystem::DirEntryList m_entries;
+};
+
+class StatManyBenchmark : public Benchmark {
+public:
+    StatManyBenchmark(const std::string& directory, const std::vector<std::string>& paths)
+        : m_directory(directory)
+        , m_paths(paths)
+    {
+    }
+
+    virtual int Run()
+    {
+        FileSystem::MetadataCache::Invalidate(m_directory, true);
+        FileSystem::StatMany(m_paths, m_results);
+        for (size_t i = 0; i < m_results.size(); i++) {
+            if (m_results[i].error != NO_ERROR)
+                return m_results[i].error;
+        }
+        return NO_ERROR;
+    }
+
+private:
+    std::string m_directory;
+    const std::vector<std::string>& m_paths;
+    FileSystem::StatResultList m_results;
+};
+
+// Runs FileSystem::StatMany() on a WorkerPool thread and signals done
+class StatManyWorkerTask : public WorkerTask {
+public:
+    StatManyWorkerTask(const std::vector<std::string>& paths, FileSystem::StatResultList& results,
+                       WaitGroup& done)
+        : m_paths(paths)
+        , m_results(results)
+        , m_done(done)
+    {
+    }
+
+    virtual void Run()
+    {
+        FileSystem::StatMany(m_paths, m_results);
+        m_done.Done();
+    }
+
+private:
+    const std::vector<std::string>& m_paths;
+    FileSystem::StatResultList& m_results;
+    WaitGroup& m_done;
+};
+
+// StatMany() the way brackets.fs.statMany runs it: StatManyAsync() queues a
+// request that calls it on a WorkerPool thread. The callback, which needs
+// CEF, is left out.
+class StatManyAsyncBenchmark : public Benchmark {
+public:
+    StatManyAsyncBenchmark(const std::string& directory, const std::vector<std::string>& paths)
+        : m_directory(directory)
+        , m_paths(paths)
+    {
+    }
+
+    virtual int Run()
+    {
+        WorkerPool* pool = WorkerPool::GetInstance();
+        if (!pool)
+            return ERR_UNKNOWN;
+
+        FileSystem::MetadataCache::Invalidate(m_directory, true);
+        WaitGroup done;
+        done.Add(1);
+        pool->PostTask(new StatManyWorkerTask(m_paths, m_results, done));
+        done.Wait();
+        for (size_t i = 0; i < m_results.size(); i++) {
+            if (m_results[i].error != NO_ERROR)
+                return m_results[i].error;
+        }
+        return NO_ERROR;
+    }
+
+private:
+    std::string m_directory;
+    const std::vector<std::string>& m_paths;
+    FileSystem::StatResultList m_results;
+};
+
+class ReadFileBenchmark : public Benchmark {
+public:
+    ReadFileBenchmark(const std::string& path, bool utf16)
+        : m_path(path)
+        , m_utf16(utf16)
+    {
+    }
+
+    virtual int Run()
+    {
+        if (m_utf16)
+            return FileSystem::ReadFileUTF16(m_path, "utf8", m_contentsUTF16, m_usedEncoding);
+        return FileSystem::ReadFile(m_path, "utf8", m_contents);
+    }
+
+private:
+    std::string m_path;
+    bool m_utf16;
+    std::string m_contents;
+    Encoding::UTF16Buffer m_contentsUTF16;
+    std::string m_usedEncoding;
+};
+
+// Changes the contents every run, or WriteFile() would see that they are
+// the same and skip writing them
+class WriteFileBenchmark : public Benchmark {
+public:
+    WriteFileBenchmark(const std::string& path, const std::string& contents)
+        : m_path(path)
+        , m_contents(contents)
+        , m_run(0)
+    {
+    }
+
+    virtual int Run()
+    {
+        char stamp[32];
+        int length = sprintf(stamp, "// %u\n", m_run++);
+        m_contents.replace(0, length, stamp, length);
+        return FileSystem::WriteFile(m_path, m_contents, "utf8");
+    }
+
+private:
+    std::string m_path;
+    std::string m_contents;
+    unsigned int m_run;
+};
+
+// Source code, so ReadFile() has UTF-8 to validate
+std::string MakeSourceText(size_t size)
+{
+    std::string line = "    var name = \"r\xC3\xA9sum\xC3\xA9\", path = \"/Users/dev/projects/brackets\";\n";
+    std::string text;
+    while (text.length() + line.length() <= size)
+        text += line;
+    text.append(size - text.length(), '\n');
+    return text;
+}
+
+// What the benchmarks work on
+struct Files {
+    std::string listingDirectory;
+    std::vector<std::string> listingPaths;
+    std::string readPath;
+    std::string writePath;
+};
+
+int CreateFiles(Fixture& fixture, Files& files)
+{
+    files.listingDirectory = fixture.GetRoot() + "/listing";
+    int error = fixture.AddDirectory(files.listingDirectory);
+    for (int i = 0; i < kFileCount && error == NO_ERROR; i++) {
+        char name[32];
+        sprintf(name, "/file%04d.js", i);
+        files.listingPaths.push_back(files.listingDirectory + name);
+        error = fixture.AddFile(files.listingPaths.back(), "var a;\n");
+    }
+
+    files.readPath = fixture.GetRoot() + "/read.js";
+    if (error == NO_ERROR)
+        error = fixture.AddFile(files.readPath, MakeSourceText(kLargeFileSize));
+    files.writePath = fixture.GetRoot() + "/write.js";
+    if (error == NO_ERROR)
+        error = fixture.AddFile(files.writePath, MakeSourceText(kSmallFileSize));
+    return error;
+}
+
+void RunUncachedBenchmarks(const Files& files)
+{
+    ReadDirBenchmark readDir(files.listingDirectory, false, false);
+    Measure("fs/read_dir/1000_entries", readDir, 0);
+    ReadDirBenchmark readDirWithInfo(files.listingDirectory, true, false);
+    Measure("fs/read_dir/1000_entries/with_info", readDirWithInfo, 0);
+    StatManyBenchmark statMany(files.listingDirectory, files.listingPaths);
+    Measure("fs/stat_many/1000_files", statMany, 0);
+    StatManyAsyncBenchmark statManyAsync(files.listingDirectory, files.listingPaths);
+    Measure("fs/stat_many/1000_files/async", statManyAsync, 0);
+
+    FileSystem::ContentCache::SetBudget(0);
+    ReadFileBenchmark readFile(files.readPath, false);
+    Measure("fs/read_file/1mb", readFile, kLargeFileSize);
+    ReadFileBenchmark readFileUTF16(files.readPath, true);
+    Measure("fs/read_file_utf16/1mb", readFileUTF16, kLargeFileSize);
+    FileSystem::ContentCache::SetBudget(FileSystem::ContentCache::kDefaultBudget);
+
+    FileSystem::SetSyncPolicy(FileSystem::SYNC_NONE);
+    WriteFileBenchmark writeSmall(files.writePath, MakeSourceText(kSmallFileSize));
+    Measure("fs/write_file/4kb", writeSmall, kSmallFileSize);
+    WriteFileBenchmark writeLarge(files.writePath, MakeSourceText(kLargeFileSize));
+    Measure("fs/write_file/1mb", writeLarge, kLargeFileSize);
+
+    // The default, which makes each write wait for the disk
+    FileSystem::SetSyncPolicy(FileSystem::SYNC_DATA);
+    WriteFileBenchmark writeSmallSynced(files.writePath, MakeSourceText(kSmallFileSize));
+    Measure("fs/write_file/4kb/sync_data", writeSmallSynced, kSmallFileSize);
+}
+
+void RunCachedBenchmarks(const Files& files)
+{
+    // Listings with info are only cached for watched directories
+    ReadDirBenchmark readDir(files.listingDirectory, false, true);
+    Measure("fs/read_dir/1000_entries/cached", readDir, 0);
+    ReadFileBenchmark readFile(files.readPath, false);
+    Measure("fs/read_file/1mb/cached", readFile, kLargeFileSize);
+}
+
+void WaitUntil(unsigned long long time)
+{
+    Lock lock;
+    ConditionVariable condition(lock);
+    AutoLock autoLock(lock);
+    for (unsigned long long now = GetMonotonicTime(); now < time; now = GetMonotonicTime())
+        condition.TimedWait((int)((time - now) / 1000000) + 1);
+}
+
+} // namespace
+
+void RunFileSystemBenchmarks()
+{
+    if (!IsGroupSelected("fs/"))
+        return;
+
+    Fixture fixture;
+    int error = fixture.Create();
+    if (error != NO_ERROR) {
+        ReportError("fs/", error);
+        return;
+    }
+
+    Files files;
+    error = CreateFiles(fixture, files);
+    if (error != NO_ERROR) {
+        ReportError("fs/", error);
+        return;
+    }
+    unsigned long long created = GetMonotonicTime();
+
+    RunUncachedBenchmarks(files);
+    if (IsSelected("fs/read_dir/1000_entries/cached") || IsSelected("fs/read_file/1mb/cached")) {
+        WaitUntil(created + kCacheDelay);
+        RunCachedBenchmarks(files);
+    }
+}
+
+} // namespace Bench
+} // namespace Brackets
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+// Compares JSON::AppendString() with the EscapeJSONString() that ReadDir and
+// ShowOpenDialog used before their results were built as V8 arrays.
+
+#include "bench/brackets_bench.h"
+#include "common/brackets_fs.h"
+#include "common/brackets_json.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace Brackets {
+namespace Bench {
+
+namespace {
+
+// The old escaper, as it was in mac/cefclient/brackets_extensions.mm
+void EscapeJSONString(const std::string& str, std::string& result) {
+    result = "";
+    
+    for(size_t pos = 0; pos != str.size(); ++pos) {
+            switch(str[pos]) {
+                case '\a':  result.append("\\a");   break;
+                case '\b':  result.append("\\b");   break;
+                case '\f':  result.append("\\f");   break;
+                case '\n':  result.append("\\n");   break;
+                case '\r':  result.append("\\r");   break;
+                case '\t':  result.append("\\t");   break;
+                case '\v':  result.append("\\v");   break;
+                // Note: single quotes are OK for JSON
+                case '\"':  result.append("\\\"");  break; // double quote
+                case '\\':  result.append("\\\\");  break; // backslash
+                    
+                    
+            default:   result.append( 1, str[pos]); break;
+                    
+        }
+    }
+}
+
+// The way the callers put the escaped strings together
+void OldStringArray(const std::vector<std::string>& strings, std::string& result)
+{
+    result = "[";
+    for (size_t i = 0; i < strings.size(); i++) {
+        std::string escaped;
+        EscapeJSONString(strings[i], escaped);
+        if (i > 0)
+            result += ",";
+        result += "\"" + escaped + "\"";
+    }
+    result += "]";
+}
+
+void NewStringArray(const std::vector<std::string>& strings, std::string& result)
+{
+    result.clear();
+    JSON::AppendStringArray(result, strings);
+}
+
+typedef void (*ArrayFunction)(const std::vector<std::string>&, std::string&);
+
+// A directory listing of a large project
+void MakeFileNames(std::vector<std::string>& strings)
+{
+    const char* names[] = { "index.html", "main.js", "README.md", "package.json", "jquery-1.7.min.js",
+                            "brackets_extensions.cpp", "test \"quoted\".txt", "r\xC3\xA9sum\xC3\xA9.doc" };
+    for (int i = 0; i < 10000; i++) {
+        char prefix[64];
+        sprintf(prefix, "/Users/dev/projects/brackets/src/dir%d/", i % 100);
+        strings.push_back(std::string(prefix) + names[i % (sizeof(names) / sizeof(names[0]))]);
+    }
+}
+
+// Source code, with plenty of quotes, backslashes and line breaks
+void MakeSourceText(std::vector<std::string>& strings)
+{
+    std::string text;
+    while (text.length() < 1024 * 1024)
+        text += "    var path = \"C:\\\\Program Files\\\\Brackets\";\n\tif (path) {\r\n        load(path);\n    }\n";
+    strings.push_back(text);
+}
+
+class EscapeBenchmark : public Benchmark {
+public:
+    EscapeBenchmark(ArrayFunction function, const std::vector<std::string>& strings)
+        : m_function(function)
+        , m_strings(strings)
+    {
+    }
+
+    virtual int Run()
+    {
+        m_function(m_strings, m_result);
+        return NO_ERROR;
+    }
+
+private:
+    ArrayFunction m_function;
+    const std::vector<std::string>& m_strings;
+    std::string m_result;
+};
+
+void MeasureEscaping(const char* name, const std::vector<std::string>& strings)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < strings.size(); i++)
+        bytes += strings[i].length();
+
+    EscapeBenchmark oldBenchmark(OldStringArray, strings);
+    Measure(std::string("json_escape/") + name + "/old", oldBenchmark, bytes);
+    EscapeBenchmark newBenchmark(NewStringArray, strings);
+    Measure(std::string("json_escape/") + name + "/new", newBenchmark, bytes);
+}
+
+} // namespace
+
+void RunJSONBenchmarks()
+{
+    if (!IsGroupSelected("json_escape/"))
+        return;
+
+    std::vector<std::string> fileNames;
+    MakeFileNames(fileNames);
+    std::vector<std::string> sourceText;
+    MakeSourceText(sourceText);
+
+    MeasureEscaping("file_names", fileNames);
+    MeasureEscaping("source_text", sourceText);
+}
+
+} // namespace Bench
+} // namespace Brackets
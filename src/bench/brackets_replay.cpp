@@ -0,0 +1,634 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+// The brackets_replay target of cefclient.gyp. To build it by hand on Linux,
+// from src/, with all of common/ but the Windows, async and V8 files:
+//
+//   g++ -O2 -I . bench/brackets_replay.cpp $(ls common/*.cpp |
+//       grep -v "_win\|async\|v8_util") -lpthread -o brackets_replay
+//
+// Replays a log of the native calls of a Brackets session against the file
+// system core, without a browser, so a slow session can be reproduced and
+// the time of a fix measured against it. Record the log by starting Brackets
+// with BRACKETS_CALL_LOG_FILE set to the file to write (see
+// common/brackets_call_log.h), then:
+//
+//   brackets_replay --dump session.log
+//
+// prints the calls, one JSON object per line, and
+//
+//   brackets_replay --map /Users/jo/project=/home/me/project session.log
+//
+// replays them, with the paths that start with /Users/jo/project moved to
+// /home/me/project, and prints the stats of the recorded and the replayed
+// calls by method, as { "recorded": [...], "replayed": [...], "skipped": n },
+// in the format of Metrics::AppendStatsJSON().
+//
+// Calls are replayed one after the other, each until its results are
+// complete, e.g. until a walk found every file. The time that took is in the
+// callbackLatency of the replayed calls that had a callback, and in their
+// latency otherwise, so it compares to the same field of the recorded calls,
+// which also includes the bridge and the wait for the UI thread. The
+// replayed bytesOut only counts file contents.
+//
+// Calls that change files (WriteFile, Rename, DeleteRecursive...) are
+// skipped unless --writes is given. File contents are only logged up to
+// CallLog::kMaxStringLength, longer ones are written as that many 'x's.
+// Calls that don't reach the file system (dialogs, live browser, stats,
+// cancels) and calls that were rejected for their arguments are skipped.
+
+#include "common/brackets_call_log.h"
+#include "common/brackets_fs.h"
+#include "common/brackets_fs_content_cache.h"
+#include "common/brackets_fs_copy.h"
+#include "common/brackets_fs_delete.h"
+#include "common/brackets_fs_index.h"
+#include "common/brackets_fs_search.h"
+#include "common/brackets_fs_walker.h"
+#include "common/brackets_fs_watcher.h"
+#include "common/brackets_json.h"
+#include "common/brackets_metrics.h"
+#include "common/brackets_threading.h"
+#include "common/brackets_worker_pool.h"
+
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <utility>
+#include <vector>
+
+namespace Brackets {
+namespace Replay {
+
+namespace {
+
+typedef std::vector<std::pair<std::string, std::string> > PathMapList;
+
+// Lets the replay wait for an operation the worker threads finish
+class Completion {
+public:
+    Completion() : m_condition(m_lock), m_done(false), m_error(NO_ERROR) {}
+
+    void Signal(int error)
+    {
+        AutoLock lock(m_lock);
+        m_done = true;
+        m_error = error;
+        m_condition.Signal();
+    }
+
+    int Wait()
+    {
+        AutoLock lock(m_lock);
+        while (!m_done)
+            m_condition.Wait();
+        return m_error;
+    }
+
+private:
+    Lock m_lock;
+    ConditionVariable m_condition;
+    bool m_done;
+    int m_error;
+};
+
+class WalkCompletion : public FileSystem::WalkDelegate {
+public:
+    explicit WalkCompletion(Completion& completion) : m_completion(completion) {}
+    virtual void OnWalkBatch(std::vector<std::string>&) {}
+    virtual void OnWalkDone(int error, bool) { m_completion.Signal(error); }
+
+private:
+    Completion& m_completion;
+};
+
+class SearchCompletion : public FileSystem::SearchDelegate {
+public:
+    explicit SearchCompletion(Completion& completion) : m_completion(completion) {}
+    virtual void OnSearchMatches(FileSystem::SearchMatchList&) {}
+    virtual void OnSearchDone(int error, bool, bool) { m_completion.Signal(error); }
+
+private:
+    Completion& m_completion;
+};
+
+class IndexCompletion : public FileSystem::IndexDelegate {
+public:
+    explicit IndexCompletion(Completion& completion) : m_completion(completion) {}
+    virtual void OnIndexReady(int error, size_t) { m_completion.Signal(error); }
+
+private:
+    Completion& m_completion;
+};
+
+class CopyCompletion : public FileSystem::CopyDelegate {
+public:
+    explicit CopyCompletion(Completion& completion) : m_completion(completion) {}
+    virtual void OnCopyProgress(const FileSystem::CopyProgress&) {}
+    virtual void OnCopyDone(int error, bool, const FileSystem::CopyProgress&) { m_completion.Signal(error); }
+
+private:
+    Completion& m_completion;
+};
+
+class DeleteCompletion : public FileSystem::DeleteDelegate {
+public:
+    explicit DeleteCompletion(Completion& completion) : m_completion(completion) {}
+    virtual void OnDeleteProgress(const FileSystem::DeleteProgress&) {}
+    virtual void OnDeleteDone(int error, bool, const FileSystem::DeleteProgress&, const FileSystem::DeleteFailureList&)
+    {
+        m_completion.Signal(error);
+    }
+
+private:
+    Completion& m_completion;
+};
+
+// Watches are kept for the index to follow the changes, like in the app.
+// Their events are dropped.
+class IgnoreWatch : public FileSystem::WatchDelegate {
+public:
+    virtual void OnWatchError(int) {}
+    virtual void OnWatchEvents(FileSystem::WatchEventList&) {}
+    virtual void OnWatchStopped() {}
+};
+
+bool IsWrite(const std::string& method)
+{
+    static const char* const kWrites[] = {
+        "WriteFile", "SetPosixPermissions", "DeleteFileOrDirectory", "MakeDir", "Rename", "Copy", "Move",
+        "DeleteRecursive"
+    };
+    for (size_t i = 0; i < sizeof(kWrites) / sizeof(kWrites[0]); i++) {
+        if (method == kWrites[i])
+            return true;
+    }
+    return false;
+}
+
+class Replayer {
+public:
+    Replayer(const PathMapList& pathMaps, bool writes) : m_pathMaps(pathMaps), m_writes(writes) {}
+
+    // Runs the call against the core and sets error to what it returned, or
+    // passed to the callback, and bytesOut to the size of the file contents
+    // it read. Returns false if the call was skipped.
+    bool Replay(const CallLog::Call& call, int& error, unsigned long long& bytesOut);
+
+private:
+    bool HasArg(const CallLog::Call& call, size_t index, CallLog::ArgType type) const
+    {
+        return index < call.args.size() && call.args[index].type == type;
+    }
+
+    std::string MapPath(const std::string& path) const
+    {
+        for (size_t i = 0; i < m_pathMaps.size(); i++) {
+            const std::string& from = m_pathMaps[i].first;
+            if (path.compare(0, from.length(), from) == 0)
+                return m_pathMaps[i].second + path.substr(from.length());
+        }
+        return path;
+    }
+
+    std::string GetString(const CallLog::Call& call, size_t index) const
+    {
+        return HasArg(call, index, CallLog::ARG_STRING) ? call.args[index].string : std::string();
+    }
+
+    std::string GetPath(const CallLog::Call& call, size_t index) const
+    {
+        return MapPath(GetString(call, index));
+    }
+
+    // The contents of a WriteFile, or as many bytes as they had
+    std::string GetContents(const CallLog::Call& call, size_t index) const
+    {
+        if (HasArg(call, index, CallLog::ARG_LONG_STRING))
+            return std::string((size_t)call.args[index].number, 'x');
+        return GetString(call, index);
+    }
+
+    std::vector<std::string> GetPaths(const CallLog::Call& call, size_t index) const
+    {
+        std::vector<std::string> paths;
+        if (HasArg(call, index, CallLog::ARG_STRING_ARRAY)) {
+            paths = call.args[index].strings;
+            for (size_t i = 0; i < paths.size(); i++)
+                paths[i] = MapPath(paths[i]);
+        }
+        return paths;
+    }
+
+    // Names to exclude, which are not paths
+    std::vector<std::string> GetStrings(const CallLog::Call& call, size_t index) const
+    {
+        return HasArg(call, index, CallLog::ARG_STRING_ARRAY) ? call.args[index].strings
+                                                               : std::vector<std::string>();
+    }
+
+    double GetNumber(const CallLog::Call& call, size_t index) const
+    {
+        if (HasArg(call, index, CallLog::ARG_INT) || HasArg(call, index, CallLog::ARG_DOUBLE))
+            return call.args[index].number;
+        return 0;
+    }
+
+    // Like JavaScript, for the bool arguments that can be anything
+    bool GetBool(const CallLog::Call& call, size_t index) const
+    {
+        if (index >= call.args.size())
+            return false;
+        const CallLog::Arg& arg = call.args[index];
+        switch (arg.type) {
+        case CallLog::ARG_BOOL:
+        case CallLog::ARG_INT:
+        case CallLog::ARG_DOUBLE:
+            return arg.number != 0;
+        case CallLog::ARG_STRING:
+            return !arg.string.empty();
+        case CallLog::ARG_LONG_STRING:
+        case CallLog::ARG_STRING_ARRAY:
+        case CallLog::ARG_FUNCTION:
+        case CallLog::ARG_OBJECT:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // The id of the index or watch the recorded call returned, in the replay
+    int MapId(const std::map<int, int>& ids, const CallLog::Call& call, size_t index) const
+    {
+        std::map<int, int>::const_iterator it = ids.find((int)GetNumber(call, index));
+        return (it != ids.end()) ? it->second : -1;
+    }
+
+    void RememberId(std::map<int, int>& ids, const CallLog::Call& call, int id)
+    {
+        if (call.hasResult)
+            ids[call.result] = id;
+    }
+
+    const PathMapList& m_pathMaps;
+    bool m_writes;
+    std::map<int, int> m_indexIds;
+    std::map<int, int> m_watchIds;
+};
+
+bool Replayer::Replay(const CallLog::Call& call, int& error, unsigned long long& bytesOut)
+{
+    const std::string& method = call.method;
+    if (call.error == ERR_INVALID_PARAMS || (!m_writes && IsWrite(method)))
+        return false;
+
+    error = NO_ERROR;
+    bytesOut = 0;
+    if (method == "ReadDir") {
+        FileSystem::DirEntryList entries;
+        error = FileSystem::ReadDir(GetPath(call, 0), entries, GetBool(call, 1));
+    } else if (method == "Stat") {
+        FileSystem::FileInfo info;
+        error = FileSystem::Stat(GetPath(call, 0), info);
+    } else if (method == "StatMany") {
+        FileSystem::StatResultList results;
+        FileSystem::StatMany(GetPaths(call, 0), results);
+    } else if (method == "ReadFile") {
+        Encoding::UTF16Buffer contents;
+        std::string usedEncoding;
+        error = FileSystem::ReadFileUTF16(GetPath(call, 0), GetString(call, 1), contents, usedEncoding);
+        bytesOut = contents.size() * sizeof(Encoding::UTF16Char);
+    } else if (method == "ReadFileRange") {
+        Encoding::UTF16Buffer contents;
+        size_t bytesRead;
+        long long fileSize;
+        error = FileSystem::ReadFileRange(GetPath(call, 0), GetString(call, 1), (long long)GetNumber(call, 2),
+                                          (size_t)GetNumber(call, 3), contents, bytesRead, fileSize);
+        bytesOut = contents.size() * sizeof(Encoding::UTF16Char);
+    } else if (method == "ReadFileStream") {
+        // Chunk after chunk, like FileStream does when nothing is cancelled
+        std::string path = GetPath(call, 0);
+        std::string encoding = GetString(call, 1);
+        size_t chunkSize = (size_t)GetNumber(call, 2);
+        long long offset = 0;
+        for (;;) {
+            Encoding::UTF16Buffer contents;
+            size_t bytesRead = 0;
+            long long fileSize = 0;
+            error = FileSystem::ReadFileRange(path, encoding, offset, chunkSize, contents, bytesRead, fileSize);
+            bytesOut += contents.size() * sizeof(Encoding::UTF16Char);
+            offset += bytesRead;
+            if (error != NO_ERROR || offset >= fileSize)
+                break;
+        }
+    } else if (method == "WriteFile") {
+        error = FileSystem::WriteFile(GetPath(call, 0), GetContents(call, 1), GetString(call, 2));
+    } else if (method == "SetSyncPolicy") {
+        FileSystem::SetSyncPolicy((FileSystem::SyncPolicy)(int)GetNumber(call, 0));
+    } else if (method == "SetContentCacheBudget") {
+        FileSystem::ContentCache::SetBudget((size_t)GetNumber(call, 0));
+    } else if (method == "SetPosixPermissions") {
+        error = FileSystem::SetPosixPermissions(GetPath(call, 0), (int)GetNumber(call, 1));
+    } else if (method == "DeleteFileOrDirectory") {
+        std::string path = GetPath(call, 0);
+        FileSystem::FileInfo info;
+        if (GetBool(call, 1) && FileSystem::Stat(path, info) == NO_ERROR && info.isDir)
+            error = ERR_NOT_FILE;
+        else
+            error = FileSystem::DeleteFileOrDirectory(path);
+    } else if (method == "MakeDir") {
+        error = FileSystem::MakeDir(GetPath(call, 0), (int)GetNumber(call, 1));
+    } else if (method == "Rename") {
+        error = FileSystem::Rename(GetPath(call, 0), GetPath(call, 1));
+    } else if (method == "Copy" || method == "Move") {
+        Completion completion;
+        FileSystem::StartCopy(GetPath(call, 0), GetPath(call, 1), method == "Move", new CopyCompletion(completion));
+        error = completion.Wait();
+    } else if (method == "DeleteRecursive") {
+        Completion completion;
+        FileSystem::StartDelete(GetPath(call, 0), new DeleteCompletion(completion));
+        error = completion.Wait();
+    } else if (method == "ReadDirRecursive") {
+        FileSystem::WalkOptions options;
+        options.excludes = GetStrings(call, 1);
+        options.batchSize = (size_t)GetNumber(call, 2);
+        Completion completion;
+        FileSystem::StartWalk(GetPath(call, 0), options, new WalkCompletion(completion));
+        error = completion.Wait();
+    } else if (method == "FindInFiles") {
+        FileSystem::SearchOptions options;
+        options.isRegexp = GetBool(call, 2);
+        options.ignoreCase = GetBool(call, 3);
+        options.excludes = GetStrings(call, 4);
+        options.maxResults = (size_t)GetNumber(call, 5);
+        Completion completion;
+        FileSystem::StartSearch(GetPath(call, 0), GetString(call, 1), options, new SearchCompletion(completion));
+        error = completion.Wait();
+    } else if (method == "Watch") {
+        RememberId(m_watchIds, call, FileSystem::Watch(GetPath(call, 0), new IgnoreWatch));
+    } else if (method == "Unwatch") {
+        FileSystem::Unwatch(MapId(m_watchIds, call, 0));
+    } else if (method == "CreateFileIndex") {
+        Completion completion;
+        RememberId(m_indexIds, call,
+                   FileSystem::CreateIndex(GetPath(call, 0), GetStrings(call, 1), new IndexCompletion(completion)));
+        error = completion.Wait();
+    } else if (method == "QueryFileIndex") {
+        std::vector<std::string> paths;
+        if (!FileSystem::QueryIndex(MapId(m_indexIds, call, 0), GetString(call, 1), (size_t)GetNumber(call, 2),
+                                    paths))
+            error = ERR_INVALID_PARAMS;
+    } else if (method == "FuzzyQueryFileIndex") {
+        FileSystem::FuzzyResultList results;
+        if (!FileSystem::FuzzyQueryIndex(MapId(m_indexIds, call, 0), GetString(call, 1),
+                                         (size_t)GetNumber(call, 2), results))
+            error = ERR_INVALID_PARAMS;
+    } else if (method == "GetFileIndexStats") {
+        FileSystem::IndexStats stats;
+        if (!FileSystem::GetIndexStats(MapId(m_indexIds, call, 0), stats))
+            error = ERR_INVALID_PARAMS;
+    } else if (method == "UpdateFileIndex") {
+        FileSystem::RefreshIndexedPaths(GetPaths(call, 0));
+    } else if (method == "CloseFileIndex") {
+        FileSystem::CloseIndex(MapId(m_indexIds, call, 0));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// The size of the string arguments, as Metrics counts them
+unsigned long long GetBytesIn(const CallLog::Call& call)
+{
+    unsigned long long bytes = 0;
+    for (size_t i = 0; i < call.args.size(); i++) {
+        const CallLog::Arg& arg = call.args[i];
+        if (arg.type == CallLog::ARG_STRING)
+            bytes += arg.string.length();
+        else if (arg.type == CallLog::ARG_LONG_STRING)
+            bytes += (unsigned long long)arg.number;
+    }
+    return bytes;
+}
+
+Metrics::MethodStats& GetMethodStats(Metrics::MethodStatsList& stats, const std::string& name)
+{
+    for (size_t i = 0; i < stats.size(); i++) {
+        if (stats[i].name == name)
+            return stats[i];
+    }
+    stats.push_back(Metrics::MethodStats());
+    Metrics::MethodStats& method = stats.back();
+    method.name = name;
+    method.calls = 0;
+    method.errors = 0;
+    method.bytesIn = 0;
+    method.bytesOut = 0;
+    return method;
+}
+
+void AppendNumber(std::string& out, double value)
+{
+    char buffer[32];
+    sprintf(buffer, "%.17g", value);
+    out += buffer;
+}
+
+void AppendArgJSON(std::string& out, const CallLog::Arg& arg)
+{
+    switch (arg.type) {
+    case CallLog::ARG_BOOL:
+        out += arg.number ? "true" : "false";
+        break;
+    case CallLog::ARG_INT:
+    case CallLog::ARG_DOUBLE:
+        AppendNumber(out, arg.number);
+        break;
+    case CallLog::ARG_STRING:
+        JSON::AppendString(out, arg.string);
+        break;
+    case CallLog::ARG_LONG_STRING:
+        out += "{\"length\":";
+        AppendNumber(out, arg.number);
+        out += '}';
+        break;
+    case CallLog::ARG_STRING_ARRAY:
+        JSON::AppendStringArray(out, arg.strings);
+        break;
+    case CallLog::ARG_FUNCTION:
+        out += "\"function\"";
+        break;
+    case CallLog::ARG_OBJECT:
+        out += "{}";
+        break;
+    default:
+        out += "null";
+        break;
+    }
+}
+
+void PrintCall(const CallLog::Call& call)
+{
+    std::string line;
+    char buffer[128];
+    sprintf(buffer, "{\"id\":%u,\"method\":", call.id);
+    line += buffer;
+    JSON::AppendString(line, call.method);
+    sprintf(buffer, ",\"start\":%llu,\"duration\":%llu,\"error\":%d", call.start, call.duration, call.error);
+    line += buffer;
+    if (call.hasResult) {
+        sprintf(buffer, ",\"result\":%d", call.result);
+        line += buffer;
+    }
+    line += ",\"args\":[";
+    for (size_t i = 0; i < call.args.size(); i++) {
+        if (i)
+            line += ',';
+        AppendArgJSON(line, call.args[i]);
+    }
+    line += ']';
+    if (call.bytesOut) {
+        sprintf(buffer, ",\"bytesOut\":%llu", call.bytesOut);
+        line += buffer;
+    }
+    if (call.done) {
+        sprintf(buffer, ",\"callbackLatency\":%llu,\"callbackError\":%d", call.callbackLatency, call.callbackError);
+        line += buffer;
+    }
+    line += '}';
+    printf("%s\n", line.c_str());
+}
+
+int PrintUsage()
+{
+    fprintf(stderr, "usage: brackets_replay [--dump] [--writes] [--map FROM=TO]... log\n");
+    return 2;
+}
+
+} // namespace
+
+int Run(int argc, char* argv[])
+{
+    bool dump = false;
+    bool writes = false;
+    PathMapList pathMaps;
+    std::string path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--dump") {
+            dump = true;
+        } else if (arg == "--writes") {
+            writes = true;
+        } else if (arg == "--map" && i + 1 < argc) {
+            std::string map = argv[++i];
+            size_t equals = map.find('=');
+            if (equals == std::string::npos || equals == 0)
+                return PrintUsage();
+            pathMaps.push_back(std::make_pair(map.substr(0, equals), map.substr(equals + 1)));
+        } else if (path.empty() && arg.compare(0, 2, "--") != 0) {
+            path = arg;
+        } else {
+            return PrintUsage();
+        }
+    }
+    if (path.empty())
+        return PrintUsage();
+
+    CallLog::CallList calls;
+    bool truncated = false;
+    int error = CallLog::ReadLog(path, calls, truncated);
+    if (error != NO_ERROR && calls.empty()) {
+        fprintf(stderr, "brackets_replay: can't read %s (error %d)\n", path.c_str(), error);
+        return 1;
+    }
+    if (error != NO_ERROR)
+        fprintf(stderr, "brackets_replay: %s is not valid after call %u\n", path.c_str(), calls.back().id);
+    if (truncated)
+        fprintf(stderr, "brackets_replay: %s was truncated\n", path.c_str());
+
+    if (dump) {
+        for (size_t i = 0; i < calls.size(); i++)
+            PrintCall(calls[i]);
+        return 0;
+    }
+
+    Metrics::MethodStatsList recorded;
+    Metrics::MethodStatsList replayed;
+    unsigned long long skipped = 0;
+    Replayer replayer(pathMaps, writes);
+    for (size_t i = 0; i < calls.size(); i++) {
+        const CallLog::Call& call = calls[i];
+        unsigned long long bytesIn = GetBytesIn(call);
+
+        Metrics::MethodStats& recordedStats = GetMethodStats(recorded, call.method);
+        recordedStats.calls++;
+        if (call.error != NO_ERROR || (call.done && call.callbackError != NO_ERROR))
+            recordedStats.errors++;
+        recordedStats.bytesIn += bytesIn;
+        recordedStats.bytesOut += call.bytesOut;
+        recordedStats.latency.Record(call.duration);
+        if (call.done)
+            recordedStats.callbackLatency.Record(call.callbackLatency);
+
+        int replayError = NO_ERROR;
+        unsigned long long bytesOut = 0;
+        unsigned long long start = GetMonotonicTime();
+        if (!replayer.Replay(call, replayError, bytesOut)) {
+            skipped++;
+            continue;
+        }
+        unsigned long long elapsed = GetMonotonicTime() - start;
+
+        Metrics::MethodStats& replayedStats = GetMethodStats(replayed, call.method);
+        replayedStats.calls++;
+        if (replayError != NO_ERROR)
+            replayedStats.errors++;
+        replayedStats.bytesIn += bytesIn;
+        replayedStats.bytesOut += bytesOut;
+        if (call.done)
+            replayedStats.callbackLatency.Record(elapsed);
+        else
+            replayedStats.latency.Record(elapsed);
+    }
+
+    FileSystem::ShutdownWatcher();
+    WorkerPool::Shutdown();
+
+    std::string json = "{\"recorded\":";
+    Metrics::AppendStatsJSON(json, recorded);
+    json += ",\"replayed\":";
+    Metrics::AppendStatsJSON(json, replayed);
+    char buffer[64];
+    sprintf(buffer, ",\"skipped\":%llu}", skipped);
+    json += buffer;
+    printf("%s\n", json.c_str());
+    return 0;
+}
+
+} // namespace Replay
+} // namespace Brackets
+
+int main(int argc, char* argv[])
+{
+    return Brackets::Replay::Run(argc, argv);
+}
@@ -0,0 +1,1186 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_async.h"
+#include "brackets_call_log.h"
+#include "brackets_metrics.h"
+#include "brackets_threading.h"
+#include "brackets_trace.h"
+#include "brackets_v8_util.h"
+#include "include/cef_runnable.h"
+#include "brackets_worker_pool.h"
+#include "cefclient/util.h"
+
+#include <deque>
+#include <map>
+
+namespace Brackets {
+namespace AsyncCallbacks {
+
+namespace {
+
+struct Callback {
+    CefRefPtr<CefV8Value> function;
+    CefRefPtr<CefV8Context> context;
+    int methodId;                       // The native method that registered it, for Metrics
+    unsigned int callId;                // The call that registered it, for the CallLog
+    unsigned long long startTime;
+};
+
+// Only used on the UI thread. V8 objects never leave it.
+std::map<int, Callback> g_callbacks;
+int g_nextCallbackId = 1;
+
+void DeliverResult(int callbackId, AsyncResult* result, bool last)
+{
+    REQUIRE_UI_THREAD();
+
+    std::map<int, Callback>::iterator it = g_callbacks.find(callbackId);
+    if (it == g_callbacks.end()) {
+        delete result;
+        return;
+    }
+
+    Callback callback = it->second;
+    if (last)
+        g_callbacks.erase(it);
+
+    // Drop the result if the page was reloaded since the call was made
+    CefRefPtr<CefV8Context> context = callback.context;
+    CefRefPtr<CefFrame> frame = context->GetFrame();
+    if (frame.get() && frame->GetV8Context()->IsSame(context) && context->Enter()) {
+        CefV8ValueList args;
+        result->GetArguments(args);
+
+        Metrics::RecordResult(callback.methodId, result->GetSize());
+        CallLog::RecordResult(callback.callId, result->GetSize());
+        if (last) {
+            int error = (!args.empty() && args[0]->IsInt()) ? args[0]->GetIntValue() : NO_ERROR;
+            unsigned long long latency = GetMonotonicTime() - callback.startTime;
+            Metrics::RecordCallbackDone(callback.methodId, error, latency);
+            CallLog::RecordCallbackDone(callback.callId, error, latency);
+        }
+
+        CefRefPtr<CefV8Value> r;
+        CefRefPtr<CefV8Exception> e;
+        callback.function->ExecuteFunctionWithContext(context, context->GetGlobal(), args, r, e, false);
+
+        context->Exit();
+    }
+
+    delete result;
+}
+
+void ReleaseCallback(int callbackId)
+{
+    REQUIRE_UI_THREAD();
+
+    g_callbacks.erase(callbackId);
+}
+
+} // namespace
+
+int Register(CefRefPtr<CefV8Value> function)
+{
+    REQUIRE_UI_THREAD();
+
+    Callback callback;
+    callback.function = function;
+    callback.context = CefV8Context::GetCurrentContext();
+    callback.methodId = Metrics::GetCurrentMethod();
+    callback.callId = CallLog::GetCurrentCall();
+    callback.startTime = GetMonotonicTime();
+
+    int id = g_nextCallbackId++;
+    g_callbacks[id] = callback;
+    return id;
+}
+
+void Post(int callbackId, AsyncResult* result, bool last)
+{
+    CefPostTask(TID_UI, NewCefRunnableFunction(&DeliverResult, callbackId, result, last));
+}
+
+void Release(int callbackId)
+{
+    CefPostTask(TID_UI, NewCefRunnableFunction(&ReleaseCallback, callbackId));
+}
+
+void Clear()
+{
+    REQUIRE_UI_THREAD();
+
+    g_callbacks.clear();
+}
+
+} // namespace AsyncCallbacks
+
+namespace FileSystem {
+
+namespace {
+
+// A file system call made on the worker pool. Once it ran, it is posted to its
+// callback as the result.
+class FileRequest : public AsyncResult {
+public:
+    explicit FileRequest(int callbackId) : m_callbackId(callbackId), m_error(NO_ERROR) {}
+
+    // Name of the call in traces
+    virtual const char* GetName() const = 0;
+
+    // Called on a worker thread
+    virtual void Run() = 0;
+
+    // Posts the request to its callback once it ran. This gives up ownership.
+    virtual void PostResult()
+    {
+        AsyncCallbacks::Post(m_callbackId, this, true);
+    }
+
+    // Called with g_requestsLock held on the last request queued for a path,
+    // if it hasn't started yet. Returns true if the request also writes
+    // contents for callbackId, in which case no new request is queued.
+    virtual bool CoalesceWrite(const std::string& /* path */, std::string& /* contents */,
+                               const std::string& /* encoding */, int /* callbackId */)
+    {
+        return false;
+    }
+
+protected:
+    int m_callbackId;
+    int m_error;
+};
+
+// Requests waiting for an earlier request on the same path, by path. The first
+// request in each queue is the one running.
+Lock g_requestsLock;
+std::map<std::string, std::deque<FileRequest*> > g_pathRequests;
+
+class FileRequestTask : public WorkerTask {
+public:
+    // Runs the first request queued for key, then starts the next one
+    explicit FileRequestTask(const std::string& key) : m_key(key), m_request(NULL) {}
+
+    // Runs request, which isn't queued
+    explicit FileRequestTask(FileRequest* request) : m_request(request) {}
+
+    virtual void Run()
+    {
+        if (!m_request) {
+            RunQueued();
+            return;
+        }
+
+        RunRequest(m_request);
+        m_request->PostResult();
+    }
+
+private:
+    static void RunRequest(FileRequest* request)
+    {
+        Trace::Scope scope(request->GetName(), "fs");
+        request->Run();
+    }
+
+    void RunQueued()
+    {
+        FileRequest* request;
+        {
+            AutoLock lock(g_requestsLock);
+            request = g_pathRequests[m_key].front();
+        }
+
+        // The result is posted before the next request starts, so results
+        // for the same path arrive in order
+        RunRequest(request);
+        request->PostResult();
+
+        bool more;
+        {
+            AutoLock lock(g_requestsLock);
+            std::map<std::string, std::deque<FileRequest*> >::iterator it = g_pathRequests.find(m_key);
+            it->second.pop_front();
+            more = !it->second.empty();
+            if (!more)
+                g_pathRequests.erase(it);
+        }
+
+        WorkerPool* pool = more ? WorkerPool::GetInstance() : NULL;
+        if (pool)
+            pool->PostTask(new FileRequestTask(m_key));
+    }
+
+    std::string m_key;
+    FileRequest* m_request;
+};
+
+// Returns the g_pathRequests key of path. "dir" and "dir/" are the same
+// directory.
+std::string GetRequestKey(const std::string& path)
+{
+    std::string key = path;
+    while (key.length() > 1 && (key[key.length() - 1] == '/' || key[key.length() - 1] == '\\'))
+        key.erase(key.length() - 1);
+    return key;
+}
+
+// Queues request behind earlier requests for path. An empty path means the
+// request doesn't need to be ordered.
+void QueueFileRequest(const std::string& path, FileRequest* request)
+{
+    WorkerPool* pool = WorkerPool::GetInstance();
+    if (!pool) {
+        delete request;
+        return;
+    }
+
+    if (path.empty()) {
+        pool->PostTask(new FileRequestTask(request));
+        return;
+    }
+
+    std::string key = GetRequestKey(path);
+    bool first;
+    {
+        AutoLock lock(g_requestsLock);
+        std::deque<FileRequest*>& requests = g_pathRequests[key];
+        requests.push_back(request);
+        first = (requests.size() == 1);
+    }
+
+    if (first)
+        pool->PostTask(new FileRequestTask(key));
+}
+
+class ReadDirRequest : public FileRequest {
+public:
+    ReadDirRequest(const std::string& path, bool withInfo, int callbackId)
+        : FileRequest(callbackId), m_path(path), m_withInfo(withInfo)
+    {
+    }
+
+    virtual const char* GetName() const { return "ReadDir"; }
+
+    virtual void Run()
+    {
+        m_error = ReadDir(m_path, m_entries, m_withInfo);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(V8Util::CreateDirEntryArray(m_entries, m_withInfo));
+    }
+
+private:
+    std::string m_path;
+    bool m_withInfo;
+    DirEntryList m_entries;
+};
+
+class StatRequest : public FileRequest {
+public:
+    StatRequest(const std::string& path, int callbackId)
+        : FileRequest(callbackId), m_path(path)
+    {
+    }
+
+    virtual const char* GetName() const { return "Stat"; }
+
+    virtual void Run()
+    {
+        m_error = Stat(m_path, m_info);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        if (m_error == NO_ERROR) {
+            CefRefPtr<CefV8Value> info = CefV8Value::CreateObject(NULL);
+            V8Util::SetFileInfoProperties(info, m_info);
+            args.push_back(info);
+        } else {
+            args.push_back(CefV8Value::CreateNull());
+        }
+    }
+
+private:
+    std::string m_path;
+    FileInfo m_info;
+};
+
+class StatManyRequest : public FileRequest {
+public:
+    StatManyRequest(const std::vector<std::string>& paths, int callbackId)
+        : FileRequest(callbackId), m_paths(paths)
+    {
+    }
+
+    virtual const char* GetName() const { return "StatMany"; }
+
+    virtual void Run()
+    {
+        StatMany(m_paths, m_results);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(NO_ERROR));
+        args.push_back(V8Util::CreateStatResultArray(m_results));
+    }
+
+private:
+    std::vector<std::string> m_paths;
+    StatResultList m_results;
+};
+
+class RefreshIndexedPathsRequest : public FileRequest {
+public:
+    RefreshIndexedPathsRequest(const std::vector<std::string>& paths, int callbackId)
+        : FileRequest(callbackId), m_paths(paths)
+    {
+    }
+
+    virtual const char* GetName() const { return "RefreshIndexedPaths"; }
+
+    virtual void Run()
+    {
+        RefreshIndexedPaths(m_paths);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(NO_ERROR));
+    }
+
+private:
+    std::vector<std::string> m_paths;
+};
+
+class ReadFileRequest : public FileRequest {
+public:
+    ReadFileRequest(const std::string& path, const std::string& encoding, int callbackId)
+        : FileRequest(callbackId), m_path(path), m_encoding(encoding)
+    {
+    }
+
+    virtual const char* GetName() const { return "ReadFile"; }
+
+    virtual void Run()
+    {
+        m_error = ReadFileUTF16(m_path, m_encoding, m_contents, m_usedEncoding);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        if (m_error == NO_ERROR) {
+            args.push_back(V8Util::CreateString(m_contents));
+            args.push_back(CefV8Value::CreateString(m_usedEncoding));
+        } else {
+            args.push_back(CefV8Value::CreateUndefined());
+        }
+    }
+
+    virtual size_t GetSize() const
+    {
+        return m_contents.size() * sizeof(Encoding::UTF16Buffer::value_type);
+    }
+
+private:
+    std::string m_path;
+    std::string m_encoding;
+    Encoding::UTF16Buffer m_contents;   // Decoded on the worker thread
+    std::string m_usedEncoding;
+};
+
+class ReadFileRangeRequest : public FileRequest {
+public:
+    ReadFileRangeRequest(const std::string& path, const std::string& encoding, long long offset, size_t length,
+                         int callbackId)
+        : FileRequest(callbackId), m_path(path), m_encoding(encoding), m_offset(offset), m_length(length)
+        , m_bytesRead(0), m_fileSize(0)
+    {
+    }
+
+    virtual const char* GetName() const { return "ReadFileRange"; }
+
+    virtual void Run()
+    {
+        m_error = ReadFileRange(m_path, m_encoding, m_offset, m_length, m_contents, m_bytesRead, m_fileSize);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(V8Util::CreateString(m_contents));
+        args.push_back(CefV8Value::CreateDouble((double)m_bytesRead));
+        args.push_back(CefV8Value::CreateDouble((double)m_fileSize));
+    }
+
+    virtual size_t GetSize() const
+    {
+        return m_contents.size() * sizeof(Encoding::UTF16Buffer::value_type);
+    }
+
+private:
+    std::string m_path;
+    std::string m_encoding;
+    long long m_offset;
+    size_t m_length;
+    Encoding::UTF16Buffer m_contents;
+    size_t m_bytesRead;
+    long long m_fileSize;
+};
+
+class WriteFileResult : public AsyncResult {
+public:
+    explicit WriteFileResult(int error) : m_error(error) {}
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+    }
+
+private:
+    int m_error;
+};
+
+class WriteFileRequest : public FileRequest {
+public:
+    WriteFileRequest(const std::string& path, std::string& contents, const std::string& encoding, int callbackId)
+        : FileRequest(callbackId), m_path(path), m_encoding(encoding)
+    {
+        m_contents.swap(contents);
+    }
+
+    virtual const char* GetName() const { return "WriteFile"; }
+
+    virtual void Run()
+    {
+        m_error = WriteFile(m_path, m_contents, m_encoding);
+    }
+
+    virtual void PostResult()
+    {
+        // Nothing else touches the request once it ran
+        std::vector<int> callbackIds;
+        callbackIds.swap(m_coalescedCallbackIds);
+        int error = m_error;
+
+        FileRequest::PostResult();
+        for (size_t i = 0; i < callbackIds.size(); i++)
+            AsyncCallbacks::Post(callbackIds[i], new WriteFileResult(error), true);
+    }
+
+    // A later save of the same file replaces the contents of this one. Only
+    // the last contents are written, and every caller gets the result.
+    virtual bool CoalesceWrite(const std::string& path, std::string& contents, const std::string& encoding,
+                               int callbackId)
+    {
+        if (path != m_path || encoding != m_encoding)
+            return false;
+
+        m_contents.swap(contents);
+        m_coalescedCallbackIds.push_back(callbackId);
+        return true;
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+    }
+
+private:
+    std::string m_path;
+    std::string m_contents;
+    std::string m_encoding;
+    std::vector<int> m_coalescedCallbackIds;
+};
+
+class SetPosixPermissionsRequest : public FileRequest {
+public:
+    SetPosixPermissionsRequest(const std::string& path, int mode, int callbackId)
+        : FileRequest(callbackId), m_path(path), m_mode(mode)
+    {
+    }
+
+    virtual const char* GetName() const { return "SetPosixPermissions"; }
+
+    virtual void Run()
+    {
+        m_error = SetPosixPermissions(m_path, m_mode);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+    }
+
+private:
+    std::string m_path;
+    int m_mode;
+};
+
+class DeleteFileOrDirectoryRequest : public FileRequest {
+public:
+    DeleteFileOrDirectoryRequest(const std::string& path, bool filesOnly, int callbackId)
+        : FileRequest(callbackId), m_path(path), m_filesOnly(filesOnly)
+    {
+    }
+
+    virtual const char* GetName() const { return "DeleteFileOrDirectory"; }
+
+    virtual void Run()
+    {
+        if (m_filesOnly) {
+            FileInfo info;
+            if (Stat(m_path, info) == NO_ERROR && info.isDir) {
+                m_error = ERR_NOT_FILE;
+                return;
+            }
+        }
+
+        m_error = DeleteFileOrDirectory(m_path);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+    }
+
+private:
+    std::string m_path;
+    bool m_filesOnly;
+};
+
+class MakeDirRequest : public FileRequest {
+public:
+    MakeDirRequest(const std::string& path, int mode, int callbackId)
+        : FileRequest(callbackId), m_path(path), m_mode(mode)
+    {
+    }
+
+    virtual const char* GetName() const { return "MakeDir"; }
+
+    virtual void Run()
+    {
+        m_error = MakeDir(m_path, m_mode);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+    }
+
+private:
+    std::string m_path;
+    int m_mode;
+};
+
+class RenameRequest : public FileRequest {
+public:
+    RenameRequest(const std::string& oldPath, const std::string& newPath, int callbackId)
+        : FileRequest(callbackId), m_oldPath(oldPath), m_newPath(newPath)
+    {
+    }
+
+    virtual const char* GetName() const { return "Rename"; }
+
+    virtual void Run()
+    {
+        m_error = Rename(m_oldPath, m_newPath);
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+    }
+
+private:
+    std::string m_oldPath;
+    std::string m_newPath;
+};
+
+class FileStream;
+
+// Streams in progress, by id, so they can be cancelled
+Lock g_streamsLock;
+std::map<int, FileStream*> g_streams;
+int g_nextStreamId = 1;
+
+class StreamChunkResult : public AsyncResult {
+public:
+    explicit StreamChunkResult(FileStream* stream) : m_stream(stream), m_error(NO_ERROR), m_done(false) {}
+    virtual ~StreamChunkResult();
+
+    Encoding::UTF16Buffer& GetContents() { return m_contents; }
+    void SetStatus(int error, bool done) { m_error = error; m_done = done; }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(V8Util::CreateString(m_contents));
+        args.push_back(CefV8Value::CreateBool(m_done));
+    }
+
+    virtual size_t GetSize() const
+    {
+        return m_contents.size() * sizeof(Encoding::UTF16Buffer::value_type);
+    }
+
+private:
+    FileStream* m_stream;
+    int m_error;
+    bool m_done;
+    Encoding::UTF16Buffer m_contents;
+};
+
+// Reads a file one chunk at a time on the worker pool. At most
+// kMaxQueuedChunks chunks wait for the UI thread at a time, and the next chunk
+// is read when one of them was delivered, so the reads keep pace with the
+// callback.
+class FileStream {
+public:
+    static const int kMaxQueuedChunks = 2;
+
+    FileStream(int id, const std::string& path, const std::string& encoding, size_t chunkSize, int callbackId)
+        : m_id(id), m_path(path), m_encoding(encoding), m_chunkSize(chunkSize), m_callbackId(callbackId)
+        , m_offset(0), m_queuedChunks(0), m_reading(false), m_finished(false), m_cancelled(false)
+    {
+    }
+
+    void Start()
+    {
+        AutoLock lock(m_lock);
+        ScheduleRead();
+    }
+
+    void Cancel()
+    {
+        AutoLock lock(m_lock);
+        m_cancelled = true;
+    }
+
+    // Called on a worker thread
+    void ReadChunk()
+    {
+        long long offset;
+        bool cancelled;
+        {
+            AutoLock lock(m_lock);
+            offset = m_offset;
+            cancelled = m_cancelled;
+        }
+
+        StreamChunkResult* result = new StreamChunkResult(this);
+        int error = NO_ERROR;
+        size_t bytesRead = 0;
+        bool done = true;
+        if (!cancelled) {
+            long long fileSize;
+            error = ReadFileRange(m_path, m_encoding, offset, m_chunkSize, result->GetContents(), bytesRead, fileSize);
+            done = (error != NO_ERROR || offset + (long long)bytesRead >= fileSize);
+        }
+        result->SetStatus(error, done);
+
+        AutoLock lock(m_lock);
+        m_offset += bytesRead;
+        m_reading = false;
+        m_finished = done;
+        m_queuedChunks++;
+
+        // Posted under the lock, so the next chunk can't overtake this one
+        AsyncCallbacks::Post(m_callbackId, result, done);
+        ScheduleRead();
+    }
+
+    // Called on the UI thread when a chunk was delivered (or dropped)
+    void OnChunkDelivered()
+    {
+        bool finished;
+        {
+            AutoLock lock(m_lock);
+            m_queuedChunks--;
+            ScheduleRead();
+            finished = (m_finished && m_queuedChunks == 0 && !m_reading);
+        }
+
+        if (finished) {
+            {
+                AutoLock lock(g_streamsLock);
+                g_streams.erase(m_id);
+            }
+            delete this;
+        }
+    }
+
+private:
+    class ReadChunkTask : public WorkerTask {
+    public:
+        explicit ReadChunkTask(FileStream* stream) : m_stream(stream) {}
+        virtual void Run() { m_stream->ReadChunk(); }
+        virtual const char* GetName() const { return "ReadFileStream"; }
+
+    private:
+        FileStream* m_stream;
+    };
+
+    // m_lock must be held
+    void ScheduleRead()
+    {
+        if (m_reading || m_finished || m_queuedChunks >= kMaxQueuedChunks)
+            return;
+
+        WorkerPool* pool = WorkerPool::GetInstance();
+        if (pool) {
+            m_reading = true;
+            pool->PostTask(new ReadChunkTask(this));
+        }
+    }
+
+    int m_id;
+    std::string m_path;
+    std::string m_encoding;
+    size_t m_chunkSize;
+    int m_callbackId;
+
+    Lock m_lock;
+    long long m_offset;
+    int m_queuedChunks;     // Posted to the UI thread, not delivered yet
+    bool m_reading;
+    bool m_finished;
+    bool m_cancelled;
+};
+
+StreamChunkResult::~StreamChunkResult()
+{
+    m_stream->OnChunkDelivered();
+}
+
+class WalkBatchResult : public AsyncResult {
+public:
+    WalkBatchResult(int error, bool done) : m_error(error), m_done(done) {}
+
+    std::vector<std::string>& GetPaths() { return m_paths; }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(V8Util::CreateStringArray(m_paths));
+        args.push_back(CefV8Value::CreateBool(m_done));
+    }
+
+private:
+    int m_error;
+    bool m_done;
+    std::vector<std::string> m_paths;
+};
+
+class AsyncWalkDelegate : public WalkDelegate {
+public:
+    explicit AsyncWalkDelegate(int callbackId) : m_callbackId(callbackId) {}
+
+    virtual void OnWalkBatch(std::vector<std::string>& paths)
+    {
+        WalkBatchResult* result = new WalkBatchResult(NO_ERROR, false);
+        result->GetPaths().swap(paths);
+        AsyncCallbacks::Post(m_callbackId, result, false);
+    }
+
+    virtual void OnWalkDone(int error, bool /* cancelled */)
+    {
+        AsyncCallbacks::Post(m_callbackId, new WalkBatchResult(error, true), true);
+    }
+
+private:
+    int m_callbackId;
+};
+
+class SearchMatchesResult : public AsyncResult {
+public:
+    SearchMatchesResult(int error, bool done, bool truncated) : m_error(error), m_done(done), m_truncated(truncated) {}
+
+    SearchMatchList& GetMatches() { return m_matches; }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(V8Util::CreateSearchMatchArray(m_matches));
+        args.push_back(CefV8Value::CreateBool(m_done));
+        args.push_back(CefV8Value::CreateBool(m_truncated));
+    }
+
+private:
+    int m_error;
+    bool m_done;
+    bool m_truncated;
+    SearchMatchList m_matches;
+};
+
+class AsyncSearchDelegate : public SearchDelegate {
+public:
+    explicit AsyncSearchDelegate(int callbackId) : m_callbackId(callbackId) {}
+
+    virtual void OnSearchMatches(SearchMatchList& matches)
+    {
+        SearchMatchesResult* result = new SearchMatchesResult(NO_ERROR, false, false);
+        result->GetMatches().swap(matches);
+        AsyncCallbacks::Post(m_callbackId, result, false);
+    }
+
+    virtual void OnSearchDone(int error, bool /* cancelled */, bool truncated)
+    {
+        AsyncCallbacks::Post(m_callbackId, new SearchMatchesResult(error, true, truncated), true);
+    }
+
+private:
+    int m_callbackId;
+};
+
+class CopyProgressResult : public AsyncResult {
+public:
+    CopyProgressResult(int error, const CopyProgress& progress, bool done)
+        : m_error(error), m_progress(progress), m_done(done)
+    {
+    }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        CefRefPtr<CefV8Value> progress = CefV8Value::CreateObject(NULL);
+        progress->SetValue("files", CefV8Value::CreateInt((int)m_progress.files), V8_PROPERTY_ATTRIBUTE_NONE);
+        progress->SetValue("totalFiles", CefV8Value::CreateInt((int)m_progress.totalFiles), V8_PROPERTY_ATTRIBUTE_NONE);
+        progress->SetValue("bytes", CefV8Value::CreateDouble((double)m_progress.bytes), V8_PROPERTY_ATTRIBUTE_NONE);
+        progress->SetValue("totalBytes", CefV8Value::CreateDouble((double)m_progress.totalBytes),
+                           V8_PROPERTY_ATTRIBUTE_NONE);
+
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(progress);
+        args.push_back(CefV8Value::CreateBool(m_done));
+    }
+
+private:
+    int m_error;
+    CopyProgress m_progress;
+    bool m_done;
+};
+
+class AsyncCopyDelegate : public CopyDelegate {
+public:
+    explicit AsyncCopyDelegate(int callbackId) : m_callbackId(callbackId) {}
+
+    virtual void OnCopyProgress(const CopyProgress& progress)
+    {
+        AsyncCallbacks::Post(m_callbackId, new CopyProgressResult(NO_ERROR, progress, false), false);
+    }
+
+    virtual void OnCopyDone(int error, bool cancelled, const CopyProgress& progress)
+    {
+        if (cancelled && error == NO_ERROR)
+            error = ERR_UNKNOWN;
+        AsyncCallbacks::Post(m_callbackId, new CopyProgressResult(error, progress, true), true);
+    }
+
+private:
+    int m_callbackId;
+};
+
+class DeleteProgressResult : public AsyncResult {
+public:
+    DeleteProgressResult(int error, const DeleteProgress& progress, bool done)
+        : m_error(error), m_progress(progress), m_done(done)
+    {
+    }
+
+    DeleteFailureList& GetFailures() { return m_failures; }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        CefRefPtr<CefV8Value> progress = CefV8Value::CreateObject(NULL);
+        progress->SetValue("deleted", CefV8Value::CreateInt((int)m_progress.deleted), V8_PROPERTY_ATTRIBUTE_NONE);
+        progress->SetValue("failed", CefV8Value::CreateInt((int)m_progress.failed), V8_PROPERTY_ATTRIBUTE_NONE);
+
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(progress);
+        args.push_back(V8Util::CreateDeleteFailureArray(m_failures));
+        args.push_back(CefV8Value::CreateBool(m_done));
+    }
+
+private:
+    int m_error;
+    DeleteProgress m_progress;
+    bool m_done;
+    DeleteFailureList m_failures;
+};
+
+class AsyncDeleteDelegate : public DeleteDelegate {
+public:
+    explicit AsyncDeleteDelegate(int callbackId) : m_callbackId(callbackId) {}
+
+    virtual void OnDeleteProgress(const DeleteProgress& progress)
+    {
+        AsyncCallbacks::Post(m_callbackId, new DeleteProgressResult(NO_ERROR, progress, false), false);
+    }
+
+    virtual void OnDeleteDone(int error, bool cancelled, const DeleteProgress& progress,
+                              const DeleteFailureList& failures)
+    {
+        if (cancelled && error == NO_ERROR)
+            error = ERR_UNKNOWN;
+        DeleteProgressResult* result = new DeleteProgressResult(error, progress, true);
+        result->GetFailures() = failures;
+        AsyncCallbacks::Post(m_callbackId, result, true);
+    }
+
+private:
+    int m_callbackId;
+};
+
+class IndexReadyResult : public AsyncResult {
+public:
+    IndexReadyResult(int error, size_t count) : m_error(error), m_count(count) {}
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(CefV8Value::CreateInt((int)m_count));
+    }
+
+private:
+    int m_error;
+    size_t m_count;
+};
+
+class AsyncIndexDelegate : public IndexDelegate {
+public:
+    explicit AsyncIndexDelegate(int callbackId) : m_callbackId(callbackId), m_posted(false) {}
+
+    // The callback is released here if the index was closed before it was
+    // ready
+    virtual ~AsyncIndexDelegate()
+    {
+        if (!m_posted)
+            AsyncCallbacks::Release(m_callbackId);
+    }
+
+    virtual void OnIndexReady(int error, size_t count)
+    {
+        m_posted = true;
+        AsyncCallbacks::Post(m_callbackId, new IndexReadyResult(error, count), true);
+    }
+
+private:
+    int m_callbackId;
+    bool m_posted;
+};
+
+class WatchEventsResult : public AsyncResult {
+public:
+    explicit WatchEventsResult(int error) : m_error(error) {}
+
+    WatchEventList& GetEvents() { return m_events; }
+
+    virtual void GetArguments(CefV8ValueList& args)
+    {
+        args.push_back(CefV8Value::CreateInt(m_error));
+        args.push_back(V8Util::CreateWatchEventArray(m_events));
+    }
+
+private:
+    int m_error;
+    WatchEventList m_events;
+};
+
+class AsyncWatchDelegate : public WatchDelegate {
+public:
+    explicit AsyncWatchDelegate(int callbackId) : m_callbackId(callbackId) {}
+
+    virtual void OnWatchError(int error)
+    {
+        AsyncCallbacks::Post(m_callbackId, new WatchEventsResult(error), true);
+    }
+
+    virtual void OnWatchEvents(WatchEventList& events)
+    {
+        // Watched projects keep their file index up to date without a
+        // watch of their own
+        ApplyWatchEvents(events);
+
+        WatchEventsResult* result = new WatchEventsResult(NO_ERROR);
+        result->GetEvents().swap(events);
+        AsyncCallbacks::Post(m_callbackId, result, false);
+    }
+
+    virtual void OnWatchStopped()
+    {
+        AsyncCallbacks::Release(m_callbackId);
+    }
+
+private:
+    int m_callbackId;
+};
+
+} // namespace
+
+void ReadDirAsync(const std::string& path, bool withInfo, int callbackId)
+{
+    QueueFileRequest(path, new ReadDirRequest(path, withInfo, callbackId));
+}
+
+void StatAsync(const std::string& path, int callbackId)
+{
+    QueueFileRequest(path, new StatRequest(path, callbackId));
+}
+
+void StatManyAsync(const std::vector<std::string>& paths, int callbackId)
+{
+    QueueFileRequest("", new StatManyRequest(paths, callbackId));
+}
+
+void ReadFileAsync(const std::string& path, const std::string& encoding, int callbackId)
+{
+    QueueFileRequest(path, new ReadFileRequest(path, encoding, callbackId));
+}
+
+void ReadFileRangeAsync(const std::string& path, const std::string& encoding, long long offset, size_t length,
+                        int callbackId)
+{
+    QueueFileRequest(path, new ReadFileRangeRequest(path, encoding, offset, length, callbackId));
+}
+
+int ReadFileStreamAsync(const std::string& path, const std::string& encoding, size_t chunkSize, int callbackId)
+{
+    int id;
+    FileStream* stream;
+    {
+        AutoLock lock(g_streamsLock);
+        id = g_nextStreamId++;
+        stream = new FileStream(id, path, encoding, chunkSize, callbackId);
+        g_streams[id] = stream;
+    }
+
+    stream->Start();
+    return id;
+}
+
+void CancelReadFileStream(int streamId)
+{
+    AutoLock lock(g_streamsLock);
+    std::map<int, FileStream*>::iterator it = g_streams.find(streamId);
+    if (it != g_streams.end())
+        it->second->Cancel();
+}
+
+void WriteFileAsync(const std::string& path, std::string& contents, const std::string& encoding, int callbackId)
+{
+    // Repeated saves that pile up behind a slow write are merged. Only the
+    // last request of the queue is looked at, so no other call for the path
+    // is reordered.
+    if (!path.empty()) {
+        AutoLock lock(g_requestsLock);
+        std::map<std::string, std::deque<FileRequest*> >::iterator it = g_pathRequests.find(GetRequestKey(path));
+        if (it != g_pathRequests.end() && it->second.size() > 1 &&
+            it->second.back()->CoalesceWrite(path, contents, encoding, callbackId))
+            return;
+    }
+
+    QueueFileRequest(path, new WriteFileRequest(path, contents, encoding, callbackId));
+}
+
+void SetPosixPermissionsAsync(const std::string& path, int mode, int callbackId)
+{
+    QueueFileRequest(path, new SetPosixPermissionsRequest(path, mode, callbackId));
+}
+
+void DeleteFileOrDirectoryAsync(const std::string& path, bool filesOnly, int callbackId)
+{
+    QueueFileRequest(path, new DeleteFileOrDirectoryRequest(path, filesOnly, callbackId));
+}
+
+void MakeDirAsync(const std::string& path, int mode, int callbackId)
+{
+    QueueFileRequest(path, new MakeDirRequest(path, mode, callbackId));
+}
+
+void RenameAsync(const std::string& oldPath, const std::string& newPath, int callbackId)
+{
+    QueueFileRequest(oldPath, new RenameRequest(oldPath, newPath, callbackId));
+}
+
+int CopyAsync(const std::string& path, const std::string& newPath, bool move, int callbackId)
+{
+    return StartCopy(path, newPath, move, new AsyncCopyDelegate(callbackId));
+}
+
+void CancelCopyAsync(int copyId)
+{
+    CancelCopy(copyId);
+}
+
+int DeleteRecursiveAsync(const std::string& path, int callbackId)
+{
+    return StartDelete(path, new AsyncDeleteDelegate(callbackId));
+}
+
+void CancelDeleteAsync(int deleteId)
+{
+    CancelDelete(deleteId);
+}
+
+int ReadDirRecursiveAsync(const std::string& root, const WalkOptions& options, int callbackId)
+{
+    return StartWalk(root, options, new AsyncWalkDelegate(callbackId));
+}
+
+int SearchAsync(const std::string& root, const std::string& query, const SearchOptions& options, int callbackId)
+{
+    return StartSearch(root, query, options, new AsyncSearchDelegate(callbackId));
+}
+
+void CancelSearchAsync(int searchId)
+{
+    CancelSearch(searchId);
+}
+
+int CreateIndexAsync(const std::string& root, const std::vector<std::string>& excludes, int callbackId)
+{
+    return CreateIndex(root, excludes, new AsyncIndexDelegate(callbackId));
+}
+
+void RefreshIndexedPathsAsync(const std::vector<std::string>& paths, int callbackId)
+{
+    QueueFileRequest("", new RefreshIndexedPathsRequest(paths, callbackId));
+}
+
+int WatchAsync(const std::string& path, int callbackId)
+{
+    return Watch(path, new AsyncWatchDelegate(callbackId));
+}
+
+void UnwatchAsync(int watchId)
+{
+    Unwatch(watchId);
+}
+
+} // namespace FileSystem
+} // namespace Brackets
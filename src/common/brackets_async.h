@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_ASYNC_H
+#define _BRACKETS_ASYNC_H
+
+#include "include/cef.h"
+#include "brackets_fs_copy.h"
+#include "brackets_fs_delete.h"
+#include "brackets_fs_index.h"
+#include "brackets_fs_search.h"
+#include "brackets_fs_walker.h"
+#include "brackets_fs_watcher.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Support for native calls that finish in the background.
+ *
+ * The JavaScript callback of such a call is registered with AsyncCallbacks on
+ * the UI thread, together with the V8 context it was passed in. Background
+ * threads only see the callback id: they post AsyncResults for it, and the
+ * callback is called with ExecuteFunctionWithContext() on the UI thread, the
+ * same way the CloseLiveBrowser callback is fired.
+ */
+namespace Brackets {
+
+// The outcome of background work, turned into callback arguments on the UI
+// thread
+class AsyncResult {
+public:
+    virtual ~AsyncResult() {}
+
+    // Called on the UI thread, with the callback's context entered
+    virtual void GetArguments(CefV8ValueList& args) = 0;
+
+    // Size of the file contents passed to the callback, counted in Metrics
+    // as the bytes out of the call
+    virtual size_t GetSize() const { return 0; }
+};
+
+namespace AsyncCallbacks {
+
+// Stores function and the current V8 context. Returns the callback id.
+// The results posted to it are recorded in Metrics for the native method
+// that registered it. Must be called on the UI thread.
+int Register(CefRefPtr<CefV8Value> function);
+
+// Calls the callback with the arguments from result on the UI thread. Results
+// posted from one thread are delivered in order. If last is true, the callback
+// is released after the call. Takes ownership of result. Can be called from
+// any thread.
+void Post(int callbackId, AsyncResult* result, bool last);
+
+// Releases the callback on the UI thread without calling it. Results posted
+// before from the same thread are still delivered. Can be called from any
+// thread.
+void Release(int callbackId);
+
+// Releases all callbacks. Results that are still queued are dropped. Called by
+// ShutdownBracketsExtensions() on the UI thread.
+void Clear();
+
+} // namespace AsyncCallbacks
+
+namespace FileSystem {
+
+// Asynchronous versions of the functions in brackets_fs.h. Each one runs on
+// the worker pool and calls the callback registered as callbackId with
+// (err, ...) on the UI thread.
+//
+// Calls for the same path run one at a time, in the order they were made, so
+// e.g. a readFile() after a writeFile() sees the new contents. Calls for
+// different paths run in parallel and can finish in any order.
+
+// callback(err, entries), entries as returned by V8Util::CreateDirEntryArray()
+void ReadDirAsync(const std::string& path, bool withInfo, int callbackId);
+
+// callback(err, info), info is an { isDir, size, mtime } object
+void StatAsync(const std::string& path, int callbackId);
+
+// callback(err, results), results as returned by V8Util::CreateStatResultArray().
+// Not ordered with respect to other calls.
+void StatManyAsync(const std::vector<std::string>& paths, int callbackId);
+
+// callback(err, contents)
+void ReadFileAsync(const std::string& path, const std::string& encoding, int callbackId);
+
+// callback(err, contents, bytesRead, fileSize), see FileSystem::ReadFileRange()
+void ReadFileRangeAsync(const std::string& path, const std::string& encoding, long long offset, size_t length,
+                        int callbackId);
+
+// Reads the whole file in chunks of chunkSize bytes, shortened to end on a
+// character boundary. callback(err, contents, done) is called for each chunk;
+// done is true on the last call. Only a few chunks are read ahead of the
+// callback, so large files are never in memory all at once. Not ordered with
+// respect to other calls. Returns the stream id for CancelReadFileStream().
+int ReadFileStreamAsync(const std::string& path, const std::string& encoding, size_t chunkSize, int callbackId);
+
+// Stops a stream started by ReadFileStreamAsync(). Its callback is called
+// once more, with done set to true.
+void CancelReadFileStream(int streamId);
+
+// callback(err). contents is swapped out, to save copying large files. If
+// the previous call queued for path is a WriteFileAsync() that hasn't
+// started yet, the two are merged: only the newer contents are written, and
+// both callbacks get its result.
+void WriteFileAsync(const std::string& path, std::string& contents, const std::string& encoding, int callbackId);
+
+// callback(err)
+void SetPosixPermissionsAsync(const std::string& path, int mode, int callbackId);
+
+// callback(err). If filesOnly is true, directories are not deleted and
+// ERR_NOT_FILE is returned instead.
+void DeleteFileOrDirectoryAsync(const std::string& path, bool filesOnly, int callbackId);
+
+// Starts StartWalk() on root. callback(err, paths, done) is called once per
+// batch of paths, and a last time with done set to true. err is the error
+// reading root. Returns the walk id for CancelWalk().
+int ReadDirRecursiveAsync(const std::string& root, const WalkOptions& options, int callbackId);
+
+// callback(err). Creates the parents of path too, see FileSystem::MakeDir().
+void MakeDirAsync(const std::string& path, int mode, int callbackId);
+
+// callback(err). Ordered with respect to other calls for oldPath.
+void RenameAsync(const std::string& oldPath, const std::string& newPath, int callbackId);
+
+// Copies or moves path to newPath, see FileSystem::StartCopy().
+// callback(err, progress, done) is called with the progress every
+// kProgressInterval, and a last time with done set to true. progress is a
+// { files, totalFiles, bytes, totalBytes } object. A cancelled copy ends with
+// ERR_UNKNOWN. Not ordered with respect to other calls. Returns the copy id
+// for CancelCopyAsync().
+int CopyAsync(const std::string& path, const std::string& newPath, bool move, int callbackId);
+
+// Stops a copy started by CopyAsync(). Its callback is still called with
+// done set to true.
+void CancelCopyAsync(int copyId);
+
+// Deletes path and everything in it, see FileSystem::StartDelete().
+// callback(err, progress, failures, done) is called with the progress every
+// kProgressInterval, and a last time with done set to true. progress is a
+// { deleted, failed } object. failures is empty until the last call, where
+// it is an array as returned by V8Util::CreateDeleteFailureArray(). A
+// cancelled delete ends with ERR_UNKNOWN if nothing failed. Not ordered with
+// respect to other calls. Returns the delete id for CancelDeleteAsync().
+int DeleteRecursiveAsync(const std::string& path, int callbackId);
+
+// Stops a delete started by DeleteRecursiveAsync(). Its callback is still
+// called with done set to true.
+void CancelDeleteAsync(int deleteId);
+
+// Searches the files below root, see FileSystem::StartSearch().
+// callback(err, matches, done, truncated) is called with each batch of
+// matches, as returned by V8Util::CreateSearchMatchArray(), and a last time
+// with done set to true. truncated is true if the search stopped at
+// options.maxResults. Returns the search id for CancelSearchAsync().
+int SearchAsync(const std::string& root, const std::string& query, const SearchOptions& options, int callbackId);
+
+// Stops a search started by SearchAsync(). Its callback is still called with
+// done set to true.
+void CancelSearchAsync(int searchId);
+
+// Starts indexing the files below root, see FileSystem::CreateIndex().
+// callback(err, count) is called once the index is complete, with the number
+// of files in it. The callback is not called if the index is closed first.
+// Returns the index id for QueryIndex() and CloseIndex().
+int CreateIndexAsync(const std::string& root, const std::vector<std::string>& excludes, int callbackId);
+
+// callback(err), once RefreshIndexedPaths() ran for paths. Not ordered with
+// respect to other calls.
+void RefreshIndexedPathsAsync(const std::vector<std::string>& paths, int callbackId);
+
+// Watches a file or directory, see FileSystem::Watch(). callback(err, events)
+// is called with each batch of changes, or once with the error if the watch
+// could not be started. Returns the watch id for UnwatchAsync().
+int WatchAsync(const std::string& path, int callbackId);
+
+// Stops a watch started by WatchAsync(). Its callback is not called again.
+void UnwatchAsync(int watchId);
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_ASYNC_H
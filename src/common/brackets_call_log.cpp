@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_call_log.h"
+#include "brackets_fs.h"
+#include "brackets_threading.h"
+
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+
+namespace Brackets {
+namespace CallLog {
+
+const char kMagic[] = "BRCALLS1";
+const char kCallLogFileVariable[] = "BRACKETS_CALL_LOG_FILE";
+
+namespace {
+
+// Guards everything below. Calls are only recorded on the UI thread, but
+// results may be, and the log is written on exit.
+Lock g_lock;
+bool g_recording = false;           // Only set before the first call
+std::string g_path;
+std::string g_log;
+bool g_truncated = false;
+std::vector<bool> g_methodsLogged;  // By Metrics id
+unsigned int g_nextCallId = 1;
+unsigned int g_currentCall = 0;
+unsigned long long g_lastCallStart = 0;
+
+void AppendVarint(std::string& out, unsigned long long value)
+{
+    while (value >= 0x80) {
+        out += (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+void AppendSigned(std::string& out, long long value)
+{
+    AppendVarint(out, ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+}
+
+void AppendString(std::string& out, const std::string& value)
+{
+    AppendVarint(out, value.length());
+    out += value;
+}
+
+void AppendDouble(std::string& out, double value)
+{
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++)
+        out += (char)((bits >> (i * 8)) & 0xFF);
+}
+
+void AppendArg(std::string& out, const Arg& arg)
+{
+    out += (char)arg.type;
+    switch (arg.type) {
+    case ARG_BOOL:
+        out += (char)(arg.number ? 1 : 0);
+        break;
+    case ARG_INT:
+        AppendSigned(out, (long long)arg.number);
+        break;
+    case ARG_DOUBLE:
+        AppendDouble(out, arg.number);
+        break;
+    case ARG_STRING:
+        AppendString(out, arg.string);
+        break;
+    case ARG_LONG_STRING:
+        AppendVarint(out, (unsigned long long)arg.number);
+        break;
+    case ARG_STRING_ARRAY:
+        AppendVarint(out, arg.strings.size());
+        for (size_t i = 0; i < arg.strings.size(); i++)
+            AppendString(out, arg.strings[i]);
+        break;
+    default:
+        break;
+    }
+}
+
+// Returns false once the log is full. g_lock must be held.
+bool CanAppend()
+{
+    if (!g_recording || g_truncated)
+        return false;
+    if (g_log.length() < kMaxSize)
+        return true;
+
+    g_log += (char)RECORD_TRUNCATED;
+    g_truncated = true;
+    return false;
+}
+
+// Reads the values written by the Append functions above. Each function
+// returns false if the data ends first, or doesn't make sense.
+class Reader {
+public:
+    explicit Reader(const std::string& data) : m_data(data), m_offset(kMagicLength) {}
+
+    bool AtEnd() const { return m_offset >= m_data.length(); }
+
+    bool ReadByte(unsigned char& value)
+    {
+        if (AtEnd())
+            return false;
+        value = (unsigned char)m_data[m_offset++];
+        return true;
+    }
+
+    bool ReadVarint(unsigned long long& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            unsigned char byte;
+            if (!ReadByte(byte))
+                return false;
+            value |= (unsigned long long)(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    bool ReadSigned(long long& value)
+    {
+        unsigned long long encoded;
+        if (!ReadVarint(encoded))
+            return false;
+        value = (long long)(encoded >> 1) ^ -(long long)(encoded & 1);
+        return true;
+    }
+
+    bool ReadString(std::string& value)
+    {
+        unsigned long long length;
+        if (!ReadVarint(length) || length > m_data.length() - m_offset)
+            return false;
+        value.assign(m_data, m_offset, (size_t)length);
+        m_offset += (size_t)length;
+        return true;
+    }
+
+    bool ReadDouble(double& value)
+    {
+        if (m_data.length() - m_offset < 8)
+            return false;
+        unsigned long long bits = 0;
+        for (int i = 0; i < 8; i++)
+            bits |= (unsigned long long)(unsigned char)m_data[m_offset++] << (i * 8);
+        memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    bool ReadArg(Arg& arg)
+    {
+        unsigned char type;
+        if (!ReadByte(type) || type > ARG_OBJECT)
+            return false;
+        arg.type = (ArgType)type;
+
+        unsigned char byte;
+        long long number = 0;
+        unsigned long long count;
+        switch (arg.type) {
+        case ARG_BOOL:
+            if (!ReadByte(byte))
+                return false;
+            arg.number = byte;
+            return true;
+        case ARG_INT:
+            if (!ReadSigned(number))
+                return false;
+            arg.number = (double)number;
+            return true;
+        case ARG_DOUBLE:
+            return ReadDouble(arg.number);
+        case ARG_STRING:
+            return ReadString(arg.string);
+        case ARG_LONG_STRING:
+            if (!ReadVarint(count))
+                return false;
+            arg.number = (double)count;
+            return true;
+        case ARG_STRING_ARRAY:
+            // Each string takes a byte at least
+            if (!ReadVarint(count) || count > m_data.length() - m_offset)
+                return false;
+            arg.strings.resize((size_t)count);
+            for (size_t i = 0; i < arg.strings.size(); i++) {
+                if (!ReadString(arg.strings[i]))
+                    return false;
+            }
+            return true;
+        default:
+            return true;
+        }
+    }
+
+private:
+    const std::string& m_data;
+    size_t m_offset;
+};
+
+} // namespace
+
+void StartRecordingIfRequested()
+{
+    const char* path = getenv(kCallLogFileVariable);
+    if (!path || !*path)
+        return;
+
+    AutoLock lock(g_lock);
+    g_path = path;
+    g_log.assign(kMagic, kMagicLength);
+    g_lastCallStart = GetMonotonicTime();
+    g_recording = true;
+}
+
+bool IsRecording()
+{
+    return g_recording;
+}
+
+unsigned int BeginCall()
+{
+    if (!g_recording)
+        return 0;
+
+    AutoLock lock(g_lock);
+    g_currentCall = g_nextCallId++;
+    return g_currentCall;
+}
+
+void EndCall(unsigned int callId, int methodId, const char* method, const ArgList& args,
+             unsigned long long start, unsigned long long duration, int error, bool hasResult, int result)
+{
+    if (!callId)
+        return;
+
+    AutoLock lock(g_lock);
+    g_currentCall = 0;
+    if (!CanAppend() || methodId < 0)
+        return;
+
+    if ((size_t)methodId >= g_methodsLogged.size())
+        g_methodsLogged.resize(methodId + 1);
+    if (!g_methodsLogged[methodId]) {
+        g_log += (char)RECORD_METHOD;
+        AppendVarint(g_log, methodId);
+        AppendString(g_log, method);
+        g_methodsLogged[methodId] = true;
+    }
+
+    g_log += (char)RECORD_CALL;
+    AppendVarint(g_log, callId);
+    AppendVarint(g_log, methodId);
+    AppendVarint(g_log, (start > g_lastCallStart) ? start - g_lastCallStart : 0);
+    AppendVarint(g_log, duration);
+    AppendSigned(g_log, error);
+    AppendVarint(g_log, hasResult ? 1 : 0);
+    if (hasResult)
+        AppendSigned(g_log, result);
+    AppendVarint(g_log, args.size());
+    for (size_t i = 0; i < args.size(); i++)
+        AppendArg(g_log, args[i]);
+
+    if (start > g_lastCallStart)
+        g_lastCallStart = start;
+}
+
+unsigned int GetCurrentCall()
+{
+    if (!g_recording)
+        return 0;
+
+    AutoLock lock(g_lock);
+    return g_currentCall;
+}
+
+void RecordResult(unsigned int callId, size_t bytes)
+{
+    if (!callId)
+        return;
+
+    AutoLock lock(g_lock);
+    if (!CanAppend())
+        return;
+    g_log += (char)RECORD_RESULT;
+    AppendVarint(g_log, callId);
+    AppendVarint(g_log, bytes);
+}
+
+void RecordCallbackDone(unsigned int callId, int error, unsigned long long nanoseconds)
+{
+    if (!callId)
+        return;
+
+    AutoLock lock(g_lock);
+    if (!CanAppend())
+        return;
+    g_log += (char)RECORD_DONE;
+    AppendVarint(g_log, callId);
+    AppendVarint(g_log, nanoseconds);
+    AppendSigned(g_log, error);
+}
+
+void WriteCallLogOnExit()
+{
+    AutoLock lock(g_lock);
+    if (g_recording)
+        FileSystem::WriteFileBytes(g_path, g_log);
+}
+
+int Parse(const std::string& data, CallList& calls, bool& truncated)
+{
+    calls.clear();
+    truncated = false;
+    if (data.compare(0, kMagicLength, kMagic, kMagicLength) != 0)
+        return ERR_CANT_READ;
+
+    Reader reader(data);
+    std::vector<std::string> methods;
+    std::map<unsigned int, size_t> callIndexes;
+    unsigned long long time = 0;
+    while (!reader.AtEnd()) {
+        unsigned char type;
+        unsigned long long id, value;
+        long long number = 0;
+        reader.ReadByte(type);
+
+        if (type == RECORD_METHOD) {
+            std::string name;
+            if (!reader.ReadVarint(id) || id > 0xFFFF || !reader.ReadString(name))
+                return ERR_CANT_READ;
+            if (id >= methods.size())
+                methods.resize((size_t)id + 1);
+            methods[(size_t)id] = name;
+        } else if (type == RECORD_CALL) {
+            Call call;
+            if (!reader.ReadVarint(id) || !reader.ReadVarint(value) || value >= methods.size())
+                return ERR_CANT_READ;
+            call.id = (unsigned int)id;
+            call.method = methods[(size_t)value];
+            if (!reader.ReadVarint(value) || !reader.ReadVarint(call.duration) || !reader.ReadSigned(number))
+                return ERR_CANT_READ;
+            time += value;
+            call.start = time;
+            call.error = (int)number;
+            if (!reader.ReadVarint(value))
+                return ERR_CANT_READ;
+            call.hasResult = (value != 0);
+            call.result = 0;
+            if (call.hasResult) {
+                if (!reader.ReadSigned(number))
+                    return ERR_CANT_READ;
+                call.result = (int)number;
+            }
+            if (!reader.ReadVarint(value) || value > data.length())
+                return ERR_CANT_READ;
+            call.args.resize((size_t)value);
+            for (size_t i = 0; i < call.args.size(); i++) {
+                if (!reader.ReadArg(call.args[i]))
+                    return ERR_CANT_READ;
+            }
+            call.bytesOut = 0;
+            call.done = false;
+            call.callbackLatency = 0;
+            call.callbackError = NO_ERROR;
+
+            callIndexes[call.id] = calls.size();
+            calls.push_back(call);
+        } else if (type == RECORD_RESULT || type == RECORD_DONE) {
+            if (!reader.ReadVarint(id) || !reader.ReadVarint(value))
+                return ERR_CANT_READ;
+            if (type == RECORD_DONE && !reader.ReadSigned(number))
+                return ERR_CANT_READ;
+
+            std::map<unsigned int, size_t>::iterator it = callIndexes.find((unsigned int)id);
+            if (it == callIndexes.end())
+                continue;
+            Call& call = calls[it->second];
+            if (type == RECORD_RESULT) {
+                call.bytesOut += value;
+            } else {
+                call.done = true;
+                call.callbackLatency = value;
+                call.callbackError = (int)number;
+            }
+        } else if (type == RECORD_TRUNCATED) {
+            truncated = true;
+            break;
+        } else {
+            return ERR_CANT_READ;
+        }
+    }
+    return NO_ERROR;
+}
+
+int ReadLog(const std::string& path, CallList& calls, bool& truncated)
+{
+    std::string data;
+    int error = FileSystem::ReadFileBytes(path, data);
+    if (error != NO_ERROR)
+        return error;
+    return Parse(data, calls, truncated);
+}
+
+} // namespace CallLog
+} // namespace Brackets
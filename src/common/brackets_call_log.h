@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_CALL_LOG_H
+#define _BRACKETS_CALL_LOG_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * A log of the native calls a session makes, so they can be replayed later
+ * without the app, e.g. to reproduce a slow session on a large project
+ * (see bench/brackets_replay.cpp). Every call through V8Binding::MethodTable
+ * is recorded with its arguments, when it was made, how long it took, its
+ * error and the int it returned, if any (the ids of walks, indexes,
+ * watches...). For the asynchronous calls, the size of the results passed to
+ * their callback and the time of the last one are recorded too (see
+ * AsyncCallbacks).
+ *
+ * Recording is off unless kCallLogFileVariable names a file when
+ * StartRecordingIfRequested() is called, by InitBracketsExtensions(). The
+ * log is kept in memory, at most kMaxSize bytes of it, and written to the
+ * file on exit. Calls are recorded on the UI thread.
+ *
+ * The log is binary, kMagic followed by records. Numbers are LEB128 varints,
+ * zigzag encoded where they can be negative. Strings are their length and
+ * their UTF-8 bytes.
+ *
+ *     RECORD_METHOD     method id, name, before the first call of a method
+ *     RECORD_CALL       call id, method id, ns since the previous call
+ *                       (or the start of the recording), duration ns, error, 1 and the int returned or 0,
+ *                       argument count, arguments
+ *     RECORD_RESULT     call id, bytes passed to the callback
+ *     RECORD_DONE       call id, ns from the call to its last callback, error
+ *     RECORD_TRUNCATED  the log reached kMaxSize, nothing follows
+ *
+ * An argument is its ArgType as a byte, then its value: 0 or 1 for a bool,
+ * the number for an int, the 8 bytes of the double, little endian, for a
+ * double, the string for a string, the length of a long string, the count
+ * and the strings of a string array, and nothing for the other types.
+ */
+namespace Brackets {
+namespace CallLog {
+
+extern const char kMagic[];                     // "BRCALLS1", without a terminating NUL
+const size_t kMagicLength = 8;
+
+// Strings longer than this, i.e. file contents, are logged as their length
+const size_t kMaxStringLength = 4096;
+const size_t kMaxSize = 64 * 1024 * 1024;
+
+enum RecordType {
+    RECORD_METHOD = 1,
+    RECORD_CALL,
+    RECORD_RESULT,
+    RECORD_DONE,
+    RECORD_TRUNCATED
+};
+
+enum ArgType {
+    ARG_UNDEFINED = 0,
+    ARG_NULL,
+    ARG_BOOL,
+    ARG_INT,
+    ARG_DOUBLE,
+    ARG_STRING,
+    ARG_LONG_STRING,
+    ARG_STRING_ARRAY,       // an array, with its entries that aren't strings as empty strings
+    ARG_FUNCTION,
+    ARG_OBJECT
+};
+
+struct Arg {
+    Arg() : type(ARG_UNDEFINED), number(0) {}
+
+    ArgType type;
+    double number;                      // the value of a bool, int or double, the length of a long string
+    std::string string;
+    std::vector<std::string> strings;
+};
+
+typedef std::vector<Arg> ArgList;
+
+// A call read back from a log
+struct Call {
+    unsigned int id;
+    std::string method;
+    unsigned long long start;           // ns since the recording started
+    unsigned long long duration;
+    int error;
+    bool hasResult;
+    int result;                         // the int the call returned, if hasResult
+    ArgList args;
+    unsigned long long bytesOut;        // passed to the callback
+    bool done;                          // the last callback was called
+    unsigned long long callbackLatency; // from the call to its last callback, if done
+    int callbackError;
+};
+
+typedef std::vector<Call> CallList;
+
+// Environment variable with the path StartRecordingIfRequested() records to
+extern const char kCallLogFileVariable[];
+
+// Starts recording if kCallLogFileVariable is set
+void StartRecordingIfRequested();
+
+bool IsRecording();
+
+// Returns the id of a new call, and makes it the current call until
+// EndCall(). Returns 0 if nothing is recorded.
+unsigned int BeginCall();
+
+// Records the call started by BeginCall(). methodId is its Metrics id.
+void EndCall(unsigned int callId, int methodId, const char* method, const ArgList& args,
+             unsigned long long start, unsigned long long duration, int error, bool hasResult, int result);
+
+// Returns the call between BeginCall() and EndCall(), or 0. The callbacks
+// registered by the call remember it.
+unsigned int GetCurrentCall();
+
+// Records a result passed to the callback of callId, unless it is 0
+void RecordResult(unsigned int callId, size_t bytes);
+
+// Records the last callback of callId, passed error, nanoseconds after the
+// call was made, unless callId is 0
+void RecordCallbackDone(unsigned int callId, int error, unsigned long long nanoseconds);
+
+// Writes the log recorded so far to the file named by kCallLogFileVariable,
+// if recording. Called by ShutdownBracketsExtensions().
+void WriteCallLogOnExit();
+
+// Reads a log. Results and callbacks are added to their calls. truncated is
+// set if the log reached kMaxSize. Returns ERR_CANT_READ if the log is not
+// valid, with the calls read before the error.
+int Parse(const std::string& data, CallList& calls, bool& truncated);
+
+// Parse()s the log in the file at path
+int ReadLog(const std::string& path, CallList& calls, bool& truncated);
+
+} // namespace CallLog
+} // namespace Brackets
+
+#endif // _BRACKETS_CALL_LOG_H
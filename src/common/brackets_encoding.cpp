@@ -0,0 +1,539 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_encoding.h"
+
+#include <string.h>
+
+// SSE2 is always there on x64 and on Intel Macs. There is no runtime check for
+// anything newer, since the builds don't target it.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRACKETS_ENCODING_USE_SSE2 1
+#else
+#define BRACKETS_ENCODING_USE_SSE2 0
+#endif
+
+// UTF-16 code units are stored in the byte order of the machine, and every
+// platform we build for is little-endian
+
+namespace Brackets {
+namespace Encoding {
+
+namespace {
+
+const unsigned long long kHighBits = 0x8080808080808080ULL;
+
+// DetectEncoding() only looks at the start of a file for UTF-16
+const size_t kDetectSampleSize = 4096;
+
+struct EncodingName {
+    TextEncoding encoding;
+    const char* name;
+};
+
+const EncodingName kEncodingNames[] = {
+    { ENCODING_UTF8,        "utf8" },
+    { ENCODING_UTF8_BOM,    "utf8bom" },
+    { ENCODING_UTF16LE,     "utf16le" },
+    { ENCODING_UTF16BE,     "utf16be" },
+    { ENCODING_LATIN1,      "latin1" },
+    { ENCODING_WINDOWS1252, "windows1252" }
+};
+
+// Characters of the Windows-1252 bytes 0x80-0x9F. The five bytes that don't
+// have one are mapped to the C1 control with the same value, like browsers do.
+const UTF16Char kWindows1252High[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+};
+
+// Returns true if the 8 bytes at p are all ASCII
+inline bool IsASCIIWord(const unsigned char* p)
+{
+    unsigned long long word;
+    memcpy(&word, p, sizeof(word));
+    return (word & kHighBits) == 0;
+}
+
+// Returns the number of ASCII bytes at the start of p
+size_t CountASCII(const unsigned char* p, size_t length)
+{
+    size_t i = 0;
+#if BRACKETS_ENCODING_USE_SSE2
+    for (; i + 16 <= length; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))))
+            break;
+    }
+#endif
+    for (; i + 8 <= length && IsASCIIWord(p + i); i += 8) {
+    }
+    while (i < length && p[i] < 0x80)
+        i++;
+    return i;
+}
+
+// Zero-extends the ASCII bytes at the start of p to UTF-16 and returns how
+// many there were
+size_t WidenASCII(const unsigned char* p, size_t length, UTF16Char* out)
+{
+    size_t i = 0;
+#if BRACKETS_ENCODING_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(bytes))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#endif
+    for (; i + 8 <= length && IsASCIIWord(p + i); i += 8) {
+        for (int j = 0; j < 8; j++)
+            out[i + j] = p[i + j];
+    }
+    while (i < length && p[i] < 0x80) {
+        out[i] = p[i];
+        i++;
+    }
+    return i;
+}
+
+// Zero-extends every byte to UTF-16, which decodes Latin-1
+void Widen(const unsigned char* p, size_t length, UTF16Char* out)
+{
+    size_t i = 0;
+#if BRACKETS_ENCODING_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#endif
+    for (; i < length; i++)
+        out[i] = p[i];
+}
+
+void DecodeWindows1252(const unsigned char* p, size_t length, UTF16Char* out)
+{
+    // Windows-1252 is Latin-1 except for 0x80-0x9F
+    Widen(p, length, out);
+
+    size_t i = 0;
+#if BRACKETS_ENCODING_USE_SSE2
+    // As signed bytes, 0x80-0x9F are the ones below (char)0xA0
+    const __m128i limit = _mm_set1_epi8((char)0xA0);
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        int mask = _mm_movemask_epi8(_mm_cmplt_epi8(bytes, limit));
+        for (int j = 0; mask; j++, mask >>= 1) {
+            if (mask & 1)
+                out[i + j] = kWindows1252High[p[i + j] - 0x80];
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (p[i] >= 0x80 && p[i] < 0xA0)
+            out[i] = kWindows1252High[p[i] - 0x80];
+    }
+}
+
+// Copies count 16 bit units from p to out, swapping the two bytes of each
+void SwapBytes16(const unsigned char* p, size_t count, unsigned char* out)
+{
+    size_t i = 0;
+#if BRACKETS_ENCODING_USE_SSE2
+    for (; i + 8 <= count; i += 8) {
+        __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2 * i));
+        units = _mm_or_si128(_mm_slli_epi16(units, 8), _mm_srli_epi16(units, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), units);
+    }
+#endif
+    for (; i < count; i++) {
+        out[2 * i] = p[2 * i + 1];
+        out[2 * i + 1] = p[2 * i];
+    }
+}
+
+// Decodes the multi-byte sequence starting at p, whose first byte is not
+// ASCII. Returns the length of the sequence, or 0 if it is malformed.
+inline int DecodeSequence(const unsigned char* p, const unsigned char* end, unsigned int& codePoint)
+{
+    unsigned char c = *p;
+    int trailing;
+    if (c >= 0xC2 && c <= 0xDF) {
+        trailing = 1;
+        codePoint = c & 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        trailing = 2;
+        codePoint = c & 0x0F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        trailing = 3;
+        codePoint = c & 0x07;
+    } else {
+        return 0;
+    }
+
+    if (end - p <= trailing)
+        return 0;
+
+    for (int i = 1; i <= trailing; i++) {
+        if ((p[i] & 0xC0) != 0x80)
+            return 0;
+        codePoint = (codePoint << 6) | (p[i] & 0x3F);
+    }
+
+    if ((trailing == 2 && (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF))) ||
+        (trailing == 3 && (codePoint < 0x10000 || codePoint > 0x10FFFF)))
+        return 0;
+
+    return trailing + 1;
+}
+
+// Returns the Latin-1 or Windows-1252 byte for codePoint, or -1 if there is
+// none
+int EncodeSingleByte(TextEncoding encoding, unsigned int codePoint)
+{
+    if (codePoint < 0x80 || (codePoint >= 0xA0 && codePoint <= 0xFF))
+        return (int)codePoint;
+
+    if (encoding == ENCODING_LATIN1)
+        return (codePoint <= 0xFF) ? (int)codePoint : -1;
+
+    for (int i = 0; i < 32; i++) {
+        if (kWindows1252High[i] == codePoint)
+            return 0x80 + i;
+    }
+    return -1;
+}
+
+bool EncodeSingleByte(TextEncoding encoding, const std::string& text, std::string& result)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.length();
+    result.reserve(text.length());
+
+    while (p < end) {
+        size_t ascii = CountASCII(p, end - p);
+        result.append(reinterpret_cast<const char*>(p), ascii);
+        p += ascii;
+        if (p == end)
+            break;
+
+        unsigned int codePoint;
+        int sequenceLength = DecodeSequence(p, end, codePoint);
+        int byte = sequenceLength ? EncodeSingleByte(encoding, codePoint) : -1;
+        if (byte < 0) {
+            result.clear();
+            return false;
+        }
+        result += (char)byte;
+        p += sequenceLength;
+    }
+
+    return true;
+}
+
+bool EncodeUTF16(TextEncoding encoding, const std::string& text, std::string& result)
+{
+    UTF16Buffer units;
+    if (!UTF8ToUTF16(text.data(), text.length(), units))
+        return false;
+
+    bool bigEndian = (encoding == ENCODING_UTF16BE);
+    result.resize(2 + units.size() * 2);
+    result[0] = bigEndian ? '\xFE' : '\xFF';
+    result[1] = bigEndian ? '\xFF' : '\xFE';
+    if (units.empty())
+        return true;
+
+    if (bigEndian)
+        SwapBytes16(reinterpret_cast<const unsigned char*>(&units[0]), units.size(),
+                    reinterpret_cast<unsigned char*>(&result[2]));
+    else
+        memcpy(&result[2], &units[0], units.size() * 2);
+    return true;
+}
+
+} // namespace
+
+bool ParseEncoding(const std::string& name, TextEncoding& encoding)
+{
+    for (size_t i = 0; i < sizeof(kEncodingNames) / sizeof(kEncodingNames[0]); i++) {
+        if (name == kEncodingNames[i].name) {
+            encoding = kEncodingNames[i].encoding;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* GetEncodingName(TextEncoding encoding)
+{
+    for (size_t i = 0; i < sizeof(kEncodingNames) / sizeof(kEncodingNames[0]); i++) {
+        if (encoding == kEncodingNames[i].encoding)
+            return kEncodingNames[i].name;
+    }
+    return "";
+}
+
+TextEncoding DetectEncoding(const char* data, size_t length, size_t& bomLength)
+{
+    const TextEncoding withBOM[] = { ENCODING_UTF8_BOM, ENCODING_UTF16LE, ENCODING_UTF16BE };
+    for (size_t i = 0; i < sizeof(withBOM) / sizeof(withBOM[0]); i++) {
+        bomLength = GetBOMLength(withBOM[i], data, length);
+        if (bomLength)
+            return withBOM[i];
+    }
+
+    // Text files hardly ever contain NUL characters, while most code units
+    // of UTF-16 text in a Latin script have a zero byte
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    size_t units = (length < kDetectSampleSize ? length : kDetectSampleSize) / 2;
+    size_t evenZeros = 0;
+    size_t oddZeros = 0;
+    for (size_t i = 0; i < units; i++) {
+        if (!p[2 * i])
+            evenZeros++;
+        if (!p[2 * i + 1])
+            oddZeros++;
+    }
+
+    if (oddZeros * 5 > units * 2 && evenZeros * 20 < units)
+        return ENCODING_UTF16LE;
+    if (evenZeros * 5 > units * 2 && oddZeros * 20 < units)
+        return ENCODING_UTF16BE;
+
+    return IsValidUTF8(data, length) ? ENCODING_UTF8 : ENCODING_WINDOWS1252;
+}
+
+size_t GetBOMLength(TextEncoding encoding, const char* data, size_t length)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    switch (encoding) {
+    case ENCODING_UTF8_BOM:
+        return (length >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) ? 3 : 0;
+    case ENCODING_UTF16LE:
+        return (length >= 2 && p[0] == 0xFF && p[1] == 0xFE) ? 2 : 0;
+    case ENCODING_UTF16BE:
+        return (length >= 2 && p[0] == 0xFE && p[1] == 0xFF) ? 2 : 0;
+    default:
+        return 0;
+    }
+}
+
+bool DecodeToUTF16(TextEncoding encoding, const char* data, size_t length, UTF16Buffer& result)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+
+    switch (encoding) {
+    case ENCODING_UTF8:
+    case ENCODING_UTF8_BOM:
+        return UTF8ToUTF16(data, length, result);
+
+    case ENCODING_UTF16LE:
+    case ENCODING_UTF16BE:
+        if (length % 2) {
+            result.clear();
+            return false;
+        }
+        result.resize(length / 2);
+        if (!length)
+            return true;
+        if (encoding == ENCODING_UTF16BE)
+            SwapBytes16(p, length / 2, reinterpret_cast<unsigned char*>(&result[0]));
+        else
+            memcpy(&result[0], data, length);
+        return true;
+
+    case ENCODING_LATIN1:
+    case ENCODING_WINDOWS1252:
+        result.resize(length);
+        if (!length)
+            return true;
+        if (encoding == ENCODING_WINDOWS1252)
+            DecodeWindows1252(p, length, &result[0]);
+        else
+            Widen(p, length, &result[0]);
+        return true;
+    }
+
+    result.clear();
+    return false;
+}
+
+bool EncodeFromUTF8(TextEncoding encoding, const std::string& text, std::string& result)
+{
+    result.clear();
+
+    switch (encoding) {
+    case ENCODING_UTF8:
+    case ENCODING_UTF8_BOM:
+        if (!IsValidUTF8(text.data(), text.length()))
+            return false;
+        if (encoding == ENCODING_UTF8_BOM)
+            result = "\xEF\xBB\xBF";
+        result += text;
+        return true;
+
+    case ENCODING_UTF16LE:
+    case ENCODING_UTF16BE:
+        return EncodeUTF16(encoding, text, result);
+
+    case ENCODING_LATIN1:
+    case ENCODING_WINDOWS1252:
+        return EncodeSingleByte(encoding, text, result);
+    }
+
+    return false;
+}
+
+size_t FindBoundary(TextEncoding encoding, const char* data, size_t length)
+{
+    switch (encoding) {
+    case ENCODING_UTF8:
+    case ENCODING_UTF8_BOM:
+        return FindUTF8Boundary(data, length);
+    case ENCODING_UTF16LE:
+    case ENCODING_UTF16BE:
+        // A surrogate pair may be split, JavaScript strings are UTF-16 anyway
+        return length & ~(size_t)1;
+    default:
+        return length;
+    }
+}
+
+bool IsValidUTF8(const char* data, size_t length)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+
+    while (p < end) {
+        // Source files are mostly ASCII, so skip it a block at a time
+        p += CountASCII(p, end - p);
+        if (p == end)
+            break;
+
+        unsigned int codePoint;
+        int sequenceLength = DecodeSequence(p, end, codePoint);
+        if (!sequenceLength)
+            return false;
+        p += sequenceLength;
+    }
+
+    return true;
+}
+
+bool UTF8ToUTF16(const char* data, size_t length, UTF16Buffer& result)
+{
+    // Every UTF-8 byte produces at most one UTF-16 code unit
+    result.resize(length);
+    if (!length)
+        return true;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+    UTF16Char* out = &result[0];
+
+    while (p < end) {
+        size_t ascii = WidenASCII(p, end - p, out);
+        p += ascii;
+        out += ascii;
+        if (p == end)
+            break;
+
+        unsigned int codePoint;
+        int sequenceLength = DecodeSequence(p, end, codePoint);
+        if (!sequenceLength) {
+            result.clear();
+            return false;
+        }
+        p += sequenceLength;
+
+        if (codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            *out++ = (UTF16Char)(0xD800 + (codePoint >> 10));
+            *out++ = (UTF16Char)(0xDC00 + (codePoint & 0x3FF));
+        } else {
+            *out++ = (UTF16Char)codePoint;
+        }
+    }
+
+    result.resize(out - &result[0]);
+    return true;
+}
+
+size_t CountUTF16Units(const char* data, size_t length)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+    size_t count = 0;
+
+    while (p < end) {
+        size_t ascii = CountASCII(p, end - p);
+        p += ascii;
+        count += ascii;
+        if (p == end)
+            break;
+
+        // Continuation bytes don't count, and four byte sequences become a
+        // surrogate pair
+        if ((*p & 0xC0) != 0x80)
+            count += (*p >= 0xF0) ? 2 : 1;
+        p++;
+    }
+
+    return count;
+}
+
+size_t FindUTF8Boundary(const char* data, size_t length)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+
+    // Look back at most 3 bytes for the first byte of a sequence
+    for (size_t i = 1; i <= 3 && i <= length; i++) {
+        unsigned char c = p[length - i];
+        if ((c & 0xC0) == 0x80)
+            continue;
+
+        size_t sequenceLength = 1;
+        if (c >= 0xF0)
+            sequenceLength = 4;
+        else if (c >= 0xE0)
+            sequenceLength = 3;
+        else if (c >= 0xC0)
+            sequenceLength = 2;
+
+        // Split before an incomplete sequence. Invalid bytes are left where
+        // they are, for the decoder to reject.
+        return (sequenceLength > i) ? length - i : length;
+    }
+
+    return length;
+}
+
+} // namespace Encoding
+} // namespace Brackets
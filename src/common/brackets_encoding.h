@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_ENCODING_H
+#define _BRACKETS_ENCODING_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Text encoding helpers for file contents. Kept free of CEF so they can run
+ * on any thread. Runs of ASCII, which make up most source files, are handled
+ * 16 bytes at a time with SSE2 where the compiler targets it.
+ */
+namespace Brackets {
+namespace Encoding {
+
+// A UTF-16 code unit, the string representation used by V8 and CefString
+typedef unsigned short UTF16Char;
+typedef std::vector<UTF16Char> UTF16Buffer;
+
+// Encodings of file contents
+enum TextEncoding {
+    ENCODING_UTF8 = 0,
+    ENCODING_UTF8_BOM,      // UTF-8 starting with a byte order mark
+    ENCODING_UTF16LE,       // written with a byte order mark
+    ENCODING_UTF16BE,       // written with a byte order mark
+    ENCODING_LATIN1,        // ISO-8859-1
+    ENCODING_WINDOWS1252
+};
+
+// Looks up an encoding by the name used in the JavaScript API: "utf8",
+// "utf8bom", "utf16le", "utf16be", "latin1" or "windows1252". Returns false
+// for any other name.
+bool ParseEncoding(const std::string& name, TextEncoding& encoding);
+
+const char* GetEncodingName(TextEncoding encoding);
+
+// Guesses the encoding of file contents: from the byte order mark if there
+// is one, then UTF-16 if every other byte is mostly zero, then UTF-8 if data
+// is well-formed UTF-8, and Windows-1252 otherwise. bomLength is set to the
+// length of the byte order mark, or 0.
+TextEncoding DetectEncoding(const char* data, size_t length, size_t& bomLength);
+
+// Returns the length of the byte order mark of encoding at the start of data,
+// or 0 if there is none
+size_t GetBOMLength(TextEncoding encoding, const char* data, size_t length);
+
+// Converts data in encoding to UTF-16. data must not include the byte order
+// mark. Returns false, and clears result, if data is not well-formed UTF-8 or
+// has an odd length for UTF-16. Windows-1252 bytes without a character are
+// mapped to the C1 control with the same value, so nothing else can fail.
+bool DecodeToUTF16(TextEncoding encoding, const char* data, size_t length, UTF16Buffer& result);
+
+// Converts UTF-8 text to encoding, adding the byte order mark for the
+// encodings that have one. Returns false, and clears result, if text has
+// characters that can't be represented in encoding or is not well-formed
+// UTF-8.
+bool EncodeFromUTF8(TextEncoding encoding, const std::string& text, std::string& result);
+
+// Like FindUTF8Boundary(), for any encoding
+size_t FindBoundary(TextEncoding encoding, const char* data, size_t length);
+
+// Returns true if data is well-formed UTF-8. Overlong forms, surrogates and
+// code points above U+10FFFF are rejected.
+bool IsValidUTF8(const char* data, size_t length);
+
+// Converts UTF-8 to UTF-16, validating the input in the same pass. Returns
+// false, and clears result, if data is not well-formed UTF-8.
+bool UTF8ToUTF16(const char* data, size_t length, UTF16Buffer& result);
+
+// Returns the number of UTF-16 code units the UTF-8 text in data converts to,
+// that is the length of the JavaScript string. Used for column numbers. data
+// is expected to be well-formed.
+size_t CountUTF16Units(const char* data, size_t length);
+
+// Returns the length of the longest prefix of data that doesn't end in the
+// middle of a UTF-8 sequence. Used to split a file into chunks on character
+// boundaries; the remaining bytes belong to the next chunk.
+size_t FindUTF8Boundary(const char* data, size_t length);
+
+} // namespace Encoding
+} // namespace Brackets
+
+#endif // _BRACKETS_ENCODING_H
@@ -0,0 +1,501 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs.h"
+#include "brackets_fs_platform.h"
+#include "brackets_fs_metadata_cache.h"
+#include "brackets_fs_content_cache.h"
+#include "brackets_fs_index.h"
+#include "brackets_encoding.h"
+#include "brackets_threading.h"
+#include "brackets_worker_pool.h"
+
+#include <errno.h>
+#include <map>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+// Smallest number of paths worth handing to another thread
+const size_t kStatManyBatchSize = 64;
+
+// What the last WriteFile() to a path left on disk. Saving the same contents
+// again is skipped while the file still holds them.
+struct WrittenFile {
+    unsigned long long hash;
+    long long size;
+    double mtime;
+    FileId id;
+};
+
+// The entries are small, but there is no point in remembering every file
+// ever saved
+const size_t kMaxWrittenFiles = 1024;
+
+Lock g_writtenFilesLock;
+std::map<std::string, WrittenFile> g_writtenFiles;
+
+Lock g_syncPolicyLock;
+SyncPolicy g_syncPolicy = SYNC_DATA;
+
+// 64 bit FNV-1a
+unsigned long long HashContents(const char* data, size_t length)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool GetWrittenFile(const std::string& path, WrittenFile& written)
+{
+    FileInfo info;
+    if (Platform::GetFileId(path, written.id, &info) != NO_ERROR || info.isDir)
+        return false;
+
+    written.size = info.size;
+    written.mtime = info.mtime;
+    return true;
+}
+
+// Returns true if path still holds data, as written by the last WriteFile().
+// The size, modification time and id of the file only tell when it surely
+// changed: another program can rewrite it in place within the precision of
+// the modification time, or restore it. So the contents are compared too,
+// which is still cheaper than writing and syncing them again.
+bool IsUnchanged(const std::string& path, const std::string& data, unsigned long long hash)
+{
+    WrittenFile last;
+    {
+        AutoLock lock(g_writtenFilesLock);
+        std::map<std::string, WrittenFile>::const_iterator it = g_writtenFiles.find(path);
+        if (it == g_writtenFiles.end() || it->second.hash != hash || it->second.size != (long long)data.length())
+            return false;
+        last = it->second;
+    }
+
+    WrittenFile current;
+    if (!GetWrittenFile(path, current) || current.size != last.size || current.mtime != last.mtime ||
+        !(current.id == last.id))
+        return false;
+
+    std::string contents;
+    return Platform::ReadFile(path, contents) == NO_ERROR && contents == data;
+}
+
+void RememberWrite(const std::string& path, unsigned long long hash, bool written)
+{
+    WrittenFile current;
+    written = written && GetWrittenFile(path, current);
+    current.hash = hash;
+
+    AutoLock lock(g_writtenFilesLock);
+    if (!written) {
+        g_writtenFiles.erase(path);
+        return;
+    }
+
+    if (g_writtenFiles.size() >= kMaxWrittenFiles && g_writtenFiles.find(path) == g_writtenFiles.end())
+        g_writtenFiles.clear();
+    g_writtenFiles[path] = current;
+}
+
+inline bool IsSeparator(char c)
+{
+#if defined(_WIN32)
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+// Returns the directory path is in, or an empty string for a root
+std::string GetParentPath(const std::string& path)
+{
+    size_t end = path.length();
+    while (end > 1 && IsSeparator(path[end - 1]))
+        end--;
+    while (end > 0 && !IsSeparator(path[end - 1]))
+        end--;
+    while (end > 1 && IsSeparator(path[end - 1]))
+        end--;
+    return (end > 1) ? path.substr(0, end) : std::string();
+}
+
+// Platform::ReadFile() through the ContentCache
+int ReadFileContents(const std::string& path, std::string& contents)
+{
+    // Let Platform::ReadFile() report any errors
+    FileId id;
+    FileInfo info;
+    bool known = (Platform::GetFileId(path, id, &info) == NO_ERROR && !info.isDir);
+    if (known && ContentCache::Lookup(path, id, info, contents))
+        return NO_ERROR;
+
+    int error = Platform::ReadFile(path, contents);
+    if (error == NO_ERROR && known)
+        ContentCache::Store(path, id, info, contents);
+    return error;
+}
+
+class StatManyTask : public RangeTask {
+public:
+    StatManyTask(const std::vector<std::string>& paths, StatResultList& results)
+        : m_paths(paths), m_results(results)
+    {
+    }
+
+    virtual void Run(size_t begin, size_t end)
+    {
+        Platform::StatMany(m_paths, begin, end, m_results);
+    }
+
+private:
+    const std::vector<std::string>& m_paths;
+    StatResultList& m_results;
+};
+
+} // namespace
+
+int ReadDir(const std::string& path, DirEntryList& entries, bool withInfo)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    entries.clear();
+    unsigned int generation = MetadataCache::GetGeneration();
+    double dirMtime;
+    if (MetadataCache::LookupDir(path, withInfo, entries, dirMtime))
+        return NO_ERROR;
+
+    int error = Platform::ReadDir(path, entries, withInfo);
+    if (error == NO_ERROR)
+        MetadataCache::StoreDir(path, withInfo, entries, dirMtime, generation);
+    return error;
+}
+
+int Stat(const std::string& path, FileInfo& info)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    unsigned int generation = MetadataCache::GetGeneration();
+    if (MetadataCache::LookupStat(path, info))
+        return NO_ERROR;
+
+    int error = Platform::Stat(path, info);
+    if (error == NO_ERROR)
+        MetadataCache::StoreStat(path, info, generation);
+    return error;
+}
+
+void StatMany(const std::vector<std::string>& paths, StatResultList& results)
+{
+    results.clear();
+    results.resize(paths.size());
+
+    StatManyTask task(paths, results);
+    ParallelFor(paths.size(), kStatManyBatchSize, task);
+}
+
+int GetFileId(const std::string& path, FileId& id)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    return Platform::GetFileId(path, id);
+}
+
+int ReadFile(const std::string& path, const std::string& encoding, std::string& contents)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    if (encoding != "utf8")
+        return ERR_UNSUPPORTED_ENCODING;
+
+    contents.clear();
+    int error = ReadFileContents(path, contents);
+    if (error != NO_ERROR)
+        return error;
+
+    if (!Encoding::IsValidUTF8(contents.data(), contents.length())) {
+        contents.clear();
+        return ERR_UNSUPPORTED_ENCODING;
+    }
+
+    return NO_ERROR;
+}
+
+int ReadFileUTF16(const std::string& path, const std::string& encoding, Encoding::UTF16Buffer& contents,
+                  std::string& usedEncoding)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    bool detect = (encoding == "auto");
+    Encoding::TextEncoding textEncoding = Encoding::ENCODING_UTF8;
+    if (!detect && !Encoding::ParseEncoding(encoding, textEncoding))
+        return ERR_UNSUPPORTED_ENCODING;
+
+    contents.clear();
+    usedEncoding.clear();
+    std::string data;
+    int error = ReadFileContents(path, data);
+    if (error != NO_ERROR)
+        return error;
+
+    size_t bomLength;
+    if (detect)
+        textEncoding = Encoding::DetectEncoding(data.data(), data.length(), bomLength);
+    else
+        bomLength = Encoding::GetBOMLength(textEncoding, data.data(), data.length());
+
+    if (!Encoding::DecodeToUTF16(textEncoding, data.data() + bomLength, data.length() - bomLength, contents))
+        return ERR_UNSUPPORTED_ENCODING;
+
+    usedEncoding = Encoding::GetEncodingName(textEncoding);
+    return NO_ERROR;
+}
+
+int ReadFileRange(const std::string& path, const std::string& encoding, long long offset, size_t length,
+                  Encoding::UTF16Buffer& contents, size_t& bytesRead, long long& fileSize)
+{
+    // A range shorter than the longest UTF-8 sequence might not contain a
+    // whole character
+    if (path.empty() || offset < 0 || length < 4)
+        return ERR_INVALID_PARAMS;
+
+    Encoding::TextEncoding textEncoding;
+    if (!Encoding::ParseEncoding(encoding, textEncoding))
+        return ERR_UNSUPPORTED_ENCODING;
+
+    contents.clear();
+    bytesRead = 0;
+    fileSize = 0;
+    std::string data;
+    int error = Platform::ReadFileRange(path, offset, length, data, fileSize);
+    if (error != NO_ERROR)
+        return error;
+
+    size_t usable = data.length();
+    if (offset + (long long)usable < fileSize)
+        usable = Encoding::FindBoundary(textEncoding, data.data(), usable);
+
+    // The byte order mark only counts as read
+    size_t bomLength = (offset == 0) ? Encoding::GetBOMLength(textEncoding, data.data(), usable) : 0;
+    if (!Encoding::DecodeToUTF16(textEncoding, data.data() + bomLength, usable - bomLength, contents))
+        return ERR_UNSUPPORTED_ENCODING;
+
+    bytesRead = usable;
+    return NO_ERROR;
+}
+
+int WriteFile(const std::string& path, const std::string& contents, const std::string& encoding)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    Encoding::TextEncoding textEncoding;
+    if (!Encoding::ParseEncoding(encoding, textEncoding))
+        return ERR_UNSUPPORTED_ENCODING;
+
+    // UTF-8 is written as it is
+    std::string encoded;
+    if (textEncoding != Encoding::ENCODING_UTF8 && !Encoding::EncodeFromUTF8(textEncoding, contents, encoded))
+        return ERR_UNSUPPORTED_ENCODING;
+    return WriteFileBytes(path, (textEncoding == Encoding::ENCODING_UTF8) ? contents : encoded);
+}
+
+int ReadFileBytes(const std::string& path, std::string& contents)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    contents.clear();
+    return ReadFileContents(path, contents);
+}
+
+int WriteFileBytes(const std::string& path, const std::string& data)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    unsigned long long hash = HashContents(data.data(), data.length());
+    if (IsUnchanged(path, data, hash))
+        return NO_ERROR;
+
+    SyncPolicy sync;
+    {
+        AutoLock lock(g_syncPolicyLock);
+        sync = g_syncPolicy;
+    }
+
+    int error = Platform::WriteFile(path, data.data(), data.length(), sync);
+    MetadataCache::Invalidate(path, false);
+    ContentCache::Invalidate(path, false);
+    RememberWrite(path, hash, error == NO_ERROR);
+    if (error == NO_ERROR)
+        AddIndexedFile(path);
+    return error;
+}
+
+void SetSyncPolicy(SyncPolicy policy)
+{
+    AutoLock lock(g_syncPolicyLock);
+    g_syncPolicy = policy;
+}
+
+int SetPosixPermissions(const std::string& path, int mode)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    return Platform::SetPosixPermissions(path, mode);
+}
+
+int DeleteFileOrDirectory(const std::string& path)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    int error = Platform::DeleteFileOrDirectory(path);
+    MetadataCache::Invalidate(path, true);
+    ContentCache::Invalidate(path, true);
+    if (error == NO_ERROR)
+        RemoveIndexedPath(path);
+    return error;
+}
+
+int DeleteFilesIn(const std::string& path, std::vector<std::string>& subdirectories, DeleteFailureList& failures,
+                  DeleteObserver* observer)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    int error = Platform::DeleteFilesIn(path, subdirectories, failures, observer);
+    MetadataCache::Invalidate(path, true);
+    ContentCache::Invalidate(path, true);
+    return error;
+}
+
+int DeleteEmptyDirectory(const std::string& path)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    int error = Platform::DeleteEmptyDirectory(path);
+    MetadataCache::Invalidate(path, true);
+    ContentCache::Invalidate(path, true);
+    return error;
+}
+
+int MakeDir(const std::string& path, int mode)
+{
+    if (path.empty())
+        return ERR_INVALID_PARAMS;
+
+    int error = Platform::MakeDir(path, mode);
+    if (error == ERR_NOT_FOUND) {
+        std::string parent = GetParentPath(path);
+        int parentError = parent.empty() ? ERR_NOT_FOUND : MakeDir(parent, mode);
+        if (parentError == NO_ERROR || parentError == ERR_FILE_EXISTS)
+            error = Platform::MakeDir(path, mode);
+    }
+
+    MetadataCache::Invalidate(path, false);
+    return error;
+}
+
+int Rename(const std::string& oldPath, const std::string& newPath, bool* crossDevice)
+{
+    if (crossDevice)
+        *crossDevice = false;
+    if (oldPath.empty() || newPath.empty())
+        return ERR_INVALID_PARAMS;
+
+    bool isCrossDevice = false;
+    int error = Platform::Rename(oldPath, newPath, isCrossDevice);
+    if (crossDevice)
+        *crossDevice = isCrossDevice;
+
+    MetadataCache::Invalidate(oldPath, true);
+    MetadataCache::Invalidate(newPath, true);
+    ContentCache::Invalidate(oldPath, true);
+    ContentCache::Invalidate(newPath, true);
+    if (error == NO_ERROR) {
+        RemoveIndexedPath(oldPath);
+        RefreshIndexedPaths(std::vector<std::string>(1, newPath));
+    }
+    return error;
+}
+
+int CopyFileTo(const std::string& path, const std::string& newPath, CopyObserver* observer)
+{
+    if (path.empty() || newPath.empty())
+        return ERR_INVALID_PARAMS;
+
+    int error = Platform::CopyFileTo(path, newPath, observer);
+    MetadataCache::Invalidate(newPath, false);
+    ContentCache::Invalidate(newPath, false);
+    if (error == NO_ERROR)
+        AddIndexedFile(newPath);
+    return error;
+}
+
+int ConvertErrnoCode(int errorCode, bool isReading)
+{
+    switch (errorCode) {
+    case 0:
+        return NO_ERROR;
+    case EINVAL:
+    case ENAMETOOLONG:
+        return ERR_INVALID_PARAMS;
+    case ENOENT:
+    case ENOTDIR:
+        return ERR_NOT_FOUND;
+    case EPERM:
+    case EACCES:
+    case EISDIR:
+        return isReading ? ERR_CANT_READ : ERR_CANT_WRITE;
+    case EROFS:
+    case EXDEV:
+        return ERR_CANT_WRITE;
+    case EEXIST:
+        return ERR_FILE_EXISTS;
+    case ENOSPC:
+#if defined(EDQUOT)
+    case EDQUOT:
+#endif
+        return ERR_OUT_OF_SPACE;
+    default:
+        return ERR_UNKNOWN;
+    }
+}
+
+} // namespace FileSystem
+} // namespace Brackets
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_H
+#define _BRACKETS_FS_H
+
+#include "brackets_encoding.h"
+
+#include <string>
+#include <vector>
+
+// Error values. These MUST be in sync with the error values
+// in brackets_extensions.js (win/cefclient/res and mac/Resources)
+#if defined(_WIN32)
+#include <winerror.h>   // NO_ERROR is already defined by the Windows headers
+#else
+static const int NO_ERROR                   = 0;
+#endif
+static const int ERR_UNKNOWN                = 1;
+static const int ERR_INVALID_PARAMS         = 2;
+static const int ERR_NOT_FOUND              = 3;
+static const int ERR_CANT_READ              = 4;
+static const int ERR_UNSUPPORTED_ENCODING   = 5;
+static const int ERR_CANT_WRITE             = 6;
+static const int ERR_OUT_OF_SPACE           = 7;
+static const int ERR_NOT_FILE               = 8;
+static const int ERR_NOT_DIRECTORY          = 9;
+static const int ERR_FILE_EXISTS            = 10;
+
+/**
+ * Platform-neutral file system core used by the BracketsExtensionHandler on
+ * every platform. The native handlers convert their V8 arguments and call
+ * into these functions, so all of the file I/O lives in one place.
+ *
+ * All paths and file contents are UTF-8 encoded. Every function returns one
+ * of the error values above.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+enum EntryType {
+    ENTRY_UNKNOWN = 0,
+    ENTRY_FILE,
+    ENTRY_DIRECTORY
+};
+
+// How hard WriteFile() tries to get the new contents to disk before it
+// returns
+enum SyncPolicy {
+    SYNC_NONE = 0,      // leave it to the OS
+    SYNC_DATA,          // flush the file before it replaces the old one, so a
+                        // crash leaves either the old or the new contents
+    SYNC_FULL           // also flush the directory (and the drive's write
+                        // cache on Mac), so the new file survives a crash
+};
+
+// Result of Stat()
+struct FileInfo {
+    bool        isDir;
+    double      mtime;      // seconds since the epoch
+    long long   size;       // in bytes
+};
+
+// A single entry of a directory listing
+struct DirEntry {
+    std::string name;
+    EntryType   type;
+    FileInfo    info;       // only filled in if ReadDir() was asked for it
+};
+
+typedef std::vector<DirEntry> DirEntryList;
+
+// Result for a single path of StatMany()
+struct StatResult {
+    int         error;
+    FileInfo    info;       // zeroed if error is not NO_ERROR
+};
+
+typedef std::vector<StatResult> StatResultList;
+
+// Identifies a file or directory independent of the path used to reach it
+// (device and inode on Mac and Linux, volume and file index on Windows)
+struct FileId {
+    unsigned long long device;
+    unsigned long long inode;
+
+    bool operator<(const FileId& other) const
+    {
+        return (device != other.device) ? (device < other.device) : (inode < other.inode);
+    }
+
+    bool operator==(const FileId& other) const
+    {
+        return device == other.device && inode == other.inode;
+    }
+};
+
+// Reads the contents of a directory, not including '.' and '..'. On Windows
+// directories are listed first, then files. If withInfo is true, the info of
+// each entry is filled in as well; this is much cheaper than calling Stat()
+// for every entry afterwards. Entries that can't be stat'ed (e.g. broken
+// symlinks) have a type of ENTRY_UNKNOWN and zeroed info.
+int ReadDir(const std::string& path, DirEntryList& entries, bool withInfo = false);
+
+// Gets the type, modification time and size of a file or directory.
+int Stat(const std::string& path, FileInfo& info);
+
+// Stat()s every path in one call. results gets one entry per path, each with
+// its own error value. Paths in the same directory are resolved relative to
+// that directory where the platform supports it, and large batches are
+// split across the worker pool.
+void StatMany(const std::vector<std::string>& paths, StatResultList& results);
+
+// Gets the FileId of a file or directory, following symlinks.
+int GetFileId(const std::string& path, FileId& id);
+
+// Reads the entire contents of a file. 'utf8' is the only supported encoding;
+// ERR_UNSUPPORTED_ENCODING is returned if the file is not valid UTF-8.
+// Unchanged files are served from the ContentCache
+// (brackets_fs_content_cache.h).
+int ReadFile(const std::string& path, const std::string& encoding, std::string& contents);
+
+// Like ReadFile(), but decodes the contents to UTF-16, so they can be handed
+// to V8 without another conversion. Any encoding known to
+// Encoding::ParseEncoding() can be used, or 'auto' to detect it with
+// Encoding::DetectEncoding(). usedEncoding is set to the name of the
+// encoding the contents were decoded from. A byte order mark is not part of
+// the contents, except with 'utf8' as before.
+int ReadFileUTF16(const std::string& path, const std::string& encoding, Encoding::UTF16Buffer& contents,
+                  std::string& usedEncoding);
+
+// Reads at most length bytes of a file, starting at byte offset, and decodes
+// them like ReadFileUTF16(), except that 'auto' is not supported. Unless the
+// end of the file is reached, the range is shortened to end on a character
+// boundary. bytesRead is the number of bytes decoded, so the next range
+// starts at offset + bytesRead. fileSize is the current size of the file.
+// length must be at least 4. A range starting in the middle of a character
+// is not valid UTF-8.
+int ReadFileRange(const std::string& path, const std::string& encoding, long long offset, size_t length,
+                  Encoding::UTF16Buffer& contents, size_t& bytesRead, long long& fileSize);
+
+// Writes data to a file, replacing the file if it already exists. data is
+// UTF-8 and is converted to encoding, see Encoding::ParseEncoding().
+// ERR_UNSUPPORTED_ENCODING is returned if data has characters that can't be
+// represented in encoding.
+//
+// The data is written to a temporary file next to path, which then replaces
+// the file, so readers never see a partially written file. Symlinks, files
+// with several hard links and files that can't be replaced (e.g. because the
+// directory isn't writable) are written in place instead. If the file is
+// still the one the last WriteFile() to path wrote, and holds the same
+// contents as data, nothing is written.
+int WriteFile(const std::string& path, const std::string& contents, const std::string& encoding);
+
+// Reads and writes the bytes of a file as they are, for files that aren't
+// text, like ReadFile() and WriteFile() otherwise
+int ReadFileBytes(const std::string& path, std::string& contents);
+int WriteFileBytes(const std::string& path, const std::string& data);
+
+// Sets the SyncPolicy used by WriteFile(). The default is SYNC_DATA.
+void SetSyncPolicy(SyncPolicy policy);
+
+// Told about the progress of CopyFileTo()
+class CopyObserver {
+public:
+    virtual ~CopyObserver() {}
+
+    // Called after each chunk of data with the number of bytes copied since
+    // the last call. Returning false stops the copy.
+    virtual bool OnBytesCopied(long long count) = 0;
+};
+
+// Told about the progress of DeleteFilesIn()
+class DeleteObserver {
+public:
+    virtual ~DeleteObserver() {}
+
+    // Called after each entry deleted. Returning false stops deleting.
+    virtual bool OnEntryDeleted() = 0;
+};
+
+// A file or directory that could not be deleted
+struct DeleteFailure {
+    std::string path;
+    int error;
+};
+
+typedef std::vector<DeleteFailure> DeleteFailureList;
+
+// Minimum time between two progress reports of StartCopy() and StartDelete(),
+// in nanoseconds
+const unsigned long long kProgressInterval = 100 * 1000 * 1000;
+
+// Creates a directory, and the directories above it that are missing.
+// ERR_FILE_EXISTS is returned if path already exists. mode is the POSIX
+// permissions of the new directories, minus the umask; it is ignored on
+// Windows.
+int MakeDir(const std::string& path, int mode);
+
+// Renames a file or directory. ERR_FILE_EXISTS is returned if newPath
+// already exists, unless it is oldPath with another case on a file system
+// that ignores case. The paths must be on the same volume: if they are not,
+// ERR_CANT_WRITE is returned and crossDevice is set to true, see
+// StartCopy() for moving across volumes.
+int Rename(const std::string& oldPath, const std::string& newPath, bool* crossDevice = NULL);
+
+// Copies a file to newPath, which must not exist yet. Where the platform can,
+// the data is copied by the kernel or the file system without passing
+// through this process: reflinks (FICLONE) or copy_file_range() and
+// sendfile() on Linux, copyfile() on Mac and CopyFileEx() on Windows. The
+// permissions are copied as well. A partial copy is removed if the copy
+// fails or observer stops it, in which case ERR_UNKNOWN is returned.
+int CopyFileTo(const std::string& path, const std::string& newPath, CopyObserver* observer = NULL);
+
+// Sets the permissions of a file or directory. On Windows, only the owner
+// write bit is honored and directories are left untouched.
+int SetPosixPermissions(const std::string& path, int mode);
+
+// Deletes a file. On Mac and Linux, directories are removed recursively.
+// See StartDelete() for deleting large trees.
+int DeleteFileOrDirectory(const std::string& path);
+
+// Deletes everything directly in the directory at path except its
+// subdirectories, whose names are added to subdirectories. Symlinks are
+// deleted, not followed. Entries that can't be deleted are added to failures
+// and skipped. Returns ERR_NOT_DIRECTORY if path is not a directory, or the
+// error opening or reading it. On Linux the entries are deleted with
+// unlinkat() relative to the open directory, so their paths are not looked
+// up again for each one.
+int DeleteFilesIn(const std::string& path, std::vector<std::string>& subdirectories, DeleteFailureList& failures,
+                  DeleteObserver* observer = NULL);
+
+// Deletes an empty directory
+int DeleteEmptyDirectory(const std::string& path);
+
+// Maps errors from errno.h to the error values above
+int ConvertErrnoCode(int errorCode, bool isReading = true);
+
+#if defined(_WIN32)
+// Maps errors from WinError.h to the error values above
+int ConvertWinErrorCode(int errorCode, bool isReading = true);
+#endif
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_H
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_content_cache.h"
+#include "brackets_threading.h"
+
+#include <list>
+#include <map>
+#include <time.h>
+
+namespace Brackets {
+namespace FileSystem {
+namespace ContentCache {
+
+namespace {
+
+// See brackets_fs_metadata_cache.cpp
+const double kRacySeconds = 2;
+
+// Rough cost of an entry besides the path and contents: the map node, the
+// list node and the allocator's bookkeeping
+const size_t kEntryOverhead = 128;
+
+struct Entry {
+    FileId id;
+    double mtime;
+    long long size;
+    std::string contents;
+    std::list<std::string>::iterator lru;
+};
+
+typedef std::map<std::string, Entry> EntryMap;
+
+Lock g_lock;
+EntryMap g_entries;
+std::list<std::string> g_lru;   // Most recently used first
+size_t g_bytes = 0;
+size_t g_budget = kDefaultBudget;
+Stats g_stats;
+
+// g_lock must be held for all of these
+
+size_t GetCost(const std::string& path, const std::string& contents)
+{
+    return path.length() + contents.length() + kEntryOverhead;
+}
+
+void Erase(EntryMap::iterator it)
+{
+    g_bytes -= GetCost(it->first, it->second.contents);
+    g_lru.erase(it->second.lru);
+    g_entries.erase(it);
+}
+
+void Erase(const std::string& path)
+{
+    EntryMap::iterator it = g_entries.find(path);
+    if (it != g_entries.end())
+        Erase(it);
+}
+
+void EvictTo(size_t budget)
+{
+    while (g_bytes > budget && !g_lru.empty()) {
+        Erase(g_entries.find(g_lru.back()));
+        g_stats.evictions++;
+    }
+}
+
+} // namespace
+
+bool Lookup(const std::string& path, const FileId& id, const FileInfo& info, std::string& contents)
+{
+    AutoLock lock(g_lock);
+    EntryMap::iterator it = g_entries.find(path);
+    if (it == g_entries.end()) {
+        g_stats.misses++;
+        return false;
+    }
+
+    Entry& entry = it->second;
+    if (!(entry.id == id) || entry.mtime != info.mtime || entry.size != info.size) {
+        Erase(it);
+        g_stats.misses++;
+        return false;
+    }
+
+    contents = entry.contents;
+    g_lru.splice(g_lru.begin(), g_lru, entry.lru);
+    g_stats.hits++;
+    return true;
+}
+
+void Store(const std::string& path, const FileId& id, const FileInfo& info, const std::string& contents)
+{
+    // The file may have changed while it was read
+    if (info.isDir || info.size != (long long)contents.length())
+        return;
+
+    if ((double)time(NULL) - info.mtime < kRacySeconds)
+        return;
+
+    size_t cost = GetCost(path, contents);
+
+    AutoLock lock(g_lock);
+    Erase(path);
+    if (cost > g_budget / 4)
+        return;
+
+    EvictTo(g_budget - cost);
+
+    Entry& entry = g_entries[path];
+    entry.id = id;
+    entry.mtime = info.mtime;
+    entry.size = info.size;
+    entry.contents = contents;
+    g_lru.push_front(path);
+    entry.lru = g_lru.begin();
+    g_bytes += cost;
+}
+
+void Invalidate(const std::string& path, bool withContents)
+{
+    AutoLock lock(g_lock);
+    g_stats.invalidations++;
+    Erase(path);
+
+    if (withContents) {
+        std::string prefix = (!path.empty() && path[path.length() - 1] == '/') ? path : path + "/";
+        EntryMap::iterator it = g_entries.lower_bound(prefix);
+        while (it != g_entries.end() && it->first.compare(0, prefix.length(), prefix) == 0)
+            Erase(it++);
+    }
+}
+
+void SetBudget(size_t budget)
+{
+    AutoLock lock(g_lock);
+    g_budget = budget;
+    EvictTo(budget);
+}
+
+void GetStats(Stats& stats)
+{
+    AutoLock lock(g_lock);
+    stats = g_stats;
+    stats.entries = g_entries.size();
+    stats.bytes = g_bytes;
+    stats.budget = g_budget;
+}
+
+} // namespace ContentCache
+} // namespace FileSystem
+} // namespace Brackets
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_CONTENT_CACHE_H
+#define _BRACKETS_FS_CONTENT_CACHE_H
+
+#include "brackets_fs.h"
+
+#include <string>
+
+/**
+ * Cache of file contents, used by ReadFile() and ReadFileUTF16() in
+ * brackets_fs.cpp. Find in files, opening the files it found, reloading the
+ * window and extensions reading their config files all read the same files
+ * again and again.
+ *
+ * Each entry remembers the FileId, modification time and size the file had
+ * when it was read, and is only served while the file still has them, so a
+ * hit costs one stat instead of reading the file. Files modified in the last
+ * two seconds are not stored, because a later change might not change their
+ * modification time.
+ *
+ * The cache holds at most the budget set with SetBudget() and drops the least
+ * recently used files to stay below it. All functions can be called from any
+ * thread.
+ */
+namespace Brackets {
+namespace FileSystem {
+namespace ContentCache {
+
+const size_t kDefaultBudget = 32 * 1024 * 1024;
+
+struct Stats {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+    unsigned long long invalidations;
+    size_t entries;
+    size_t bytes;       // used by the entries, including some overhead
+    size_t budget;
+};
+
+// Copies the contents of path to contents if they were stored for a file with
+// this id and info
+bool Lookup(const std::string& path, const FileId& id, const FileInfo& info, std::string& contents);
+
+// Stores the contents of path, read from a file with this id and info. Files
+// larger than a quarter of the budget are not stored.
+void Store(const std::string& path, const FileId& id, const FileInfo& info, const std::string& contents);
+
+// Forgets path. If withContents is true, everything below path is forgotten
+// too.
+void Invalidate(const std::string& path, bool withContents);
+
+// Sets the most memory the cache may use, in bytes. 0 turns it off.
+void SetBudget(size_t budget);
+
+void GetStats(Stats& stats);
+
+} // namespace ContentCache
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_CONTENT_CACHE_H
@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_copy.h"
+#include "brackets_fs_delete.h"
+#include "brackets_threading.h"
+#include "brackets_worker_pool.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+class Copy;
+
+// Files copied by one WorkerTask. Large files get a task of their own, so
+// one thread doesn't end up with all of them.
+const size_t kFilesPerTask = 16;
+const long long kBytesPerTask = 4 * 1024 * 1024;
+
+// Copies in progress, by id, so they can be cancelled
+Lock g_copiesLock;
+std::map<int, Copy*> g_copies;
+int g_nextCopyId = 1;
+
+// Removes the separators at the end of path, except for a root
+std::string TrimPath(const std::string& path)
+{
+    std::string result = path;
+    while (result.length() > 1 && (result[result.length() - 1] == '/' || result[result.length() - 1] == '\\'))
+        result.erase(result.length() - 1);
+    return result;
+}
+
+// Finishes a move between volumes once the source was deleted
+class MoveDeleteDelegate : public DeleteDelegate {
+public:
+    MoveDeleteDelegate(CopyDelegate* delegate, const CopyProgress& progress)
+        : m_delegate(delegate), m_progress(progress)
+    {
+    }
+
+    ~MoveDeleteDelegate()
+    {
+        delete m_delegate;
+    }
+
+    virtual void OnDeleteProgress(const DeleteProgress& /* progress */)
+    {
+    }
+
+    virtual void OnDeleteDone(int error, bool /* cancelled */, const DeleteProgress& /* progress */,
+                              const DeleteFailureList& /* failures */)
+    {
+        m_delegate->OnCopyDone(error, false, m_progress);
+    }
+
+private:
+    CopyDelegate* m_delegate;
+    CopyProgress m_progress;
+};
+
+class Copy : public CopyObserver {
+public:
+    Copy(int id, const std::string& path, const std::string& newPath, bool move, CopyDelegate* delegate)
+        : m_id(id)
+        , m_path(TrimPath(path))
+        , m_newPath(TrimPath(newPath))
+        , m_move(move)
+        , m_copying(true)
+        , m_delegate(delegate)
+        , m_pending(0)
+        , m_cancelled(false)
+        , m_error(NO_ERROR)
+        , m_lastProgressTime(0)
+    {
+        m_progress.files = 0;
+        m_progress.totalFiles = 0;
+        m_progress.bytes = 0;
+        m_progress.totalBytes = 0;
+    }
+
+    ~Copy()
+    {
+        delete m_delegate;
+    }
+
+    // Returns false if newPath is path, or inside it
+    bool IsValid() const
+    {
+        if (m_path.empty() || m_newPath.empty() || m_newPath == m_path)
+            return false;
+        if (m_newPath.compare(0, m_path.length(), m_path) != 0)
+            return true;
+        char next = m_newPath[m_path.length()];
+        return next != '/' && next != '\\' && m_path[m_path.length() - 1] != '/';
+    }
+
+    // Posts a task that runs Begin()
+    void Start();
+
+    // Renames or starts copying. Runs on a worker thread.
+    void Begin();
+
+    void Cancel()
+    {
+        AutoLock lock(m_lock);
+        m_cancelled = true;
+    }
+
+    // Creates the directory at relativePath, a path below m_path starting
+    // with a separator, and posts the tasks that copy its contents. Runs on
+    // the worker threads.
+    void CopyDirectory(const std::string& relativePath);
+
+    // Copies files, given like for CopyDirectory(). Runs on the worker
+    // threads.
+    void CopyFiles(const std::vector<std::string>& relativePaths)
+    {
+        for (size_t i = 0; i < relativePaths.size() && !IsStopped(); i++) {
+            int error = CopyFileTo(m_path + relativePaths[i], m_newPath + relativePaths[i], this);
+
+            AutoLock lock(m_lock);
+            if (error != NO_ERROR) {
+                // Files stopped by the observer failed because of another error
+                // or CancelCopy(), which is what gets reported
+                if (!IsStoppedLocked())
+                    m_error = error;
+                break;
+            }
+            m_progress.files++;
+            ReportProgress();
+        }
+        Release();
+    }
+
+    // CopyObserver
+    virtual bool OnBytesCopied(long long count)
+    {
+        AutoLock lock(m_lock);
+        m_progress.bytes += count;
+        ReportProgress();
+        return !IsStoppedLocked();
+    }
+
+private:
+    WorkerTask* CreateBeginTask();
+    WorkerTask* CreateDirectoryTask(const std::string& relativePath);
+    WorkerTask* CreateFilesTask(const std::vector<std::string>& relativePaths);
+
+    bool IsStopped()
+    {
+        AutoLock lock(m_lock);
+        return IsStoppedLocked();
+    }
+
+    // m_lock must be held
+    bool IsStoppedLocked() const
+    {
+        return m_cancelled || m_error != NO_ERROR;
+    }
+
+    // m_lock must be held
+    void ReportProgress()
+    {
+        unsigned long long now = GetMonotonicTime();
+        if (now - m_lastProgressTime < kProgressInterval)
+            return;
+        m_lastProgressTime = now;
+        m_delegate->OnCopyProgress(m_progress);
+    }
+
+    void Fail(int error)
+    {
+        AutoLock lock(m_lock);
+        if (!IsStoppedLocked())
+            m_error = error;
+    }
+
+    // Posts tasks, which were counted in m_pending already. Fails the copy
+    // if the pool is shutting down.
+    void PostTasks(const std::vector<WorkerTask*>& tasks)
+    {
+        WorkerPool* pool = WorkerPool::GetInstance();
+        for (size_t i = 0; i < tasks.size(); i++) {
+            if (pool) {
+                pool->PostTask(tasks[i]);
+            } else {
+                delete tasks[i];
+                Fail(ERR_UNKNOWN);
+                Release();
+            }
+        }
+    }
+
+    // Ends the part of the copy that held a reference: a task or Begin().
+    // The last one finishes the copy.
+    void Release()
+    {
+        {
+            AutoLock lock(m_lock);
+            if (--m_pending != 0)
+                return;
+        }
+
+        int error;
+        bool cancelled;
+        {
+            AutoLock lock(m_lock);
+            error = m_error;
+            cancelled = m_cancelled;
+        }
+
+        // Everything was copied, so the source can go. The delete reports the
+        // end of the move, and can't be cancelled.
+        if (m_move && m_copying && error == NO_ERROR && !cancelled) {
+            StartDelete(m_path, new MoveDeleteDelegate(m_delegate, m_progress));
+            m_delegate = NULL;
+        } else {
+            m_delegate->OnCopyDone(error, cancelled, m_progress);
+        }
+
+        {
+            AutoLock lock(g_copiesLock);
+            g_copies.erase(m_id);
+        }
+        delete this;
+    }
+
+    int m_id;
+    std::string m_path;
+    std::string m_newPath;
+    bool m_move;
+    bool m_copying;             // false if a move was a rename
+    CopyDelegate* m_delegate;
+
+    Lock m_lock;
+    int m_pending;              // tasks queued or running, and Begin()
+    bool m_cancelled;
+    int m_error;
+    CopyProgress m_progress;
+    unsigned long long m_lastProgressTime;
+    std::set<FileId> m_directories;     // copied already, see CopyDirectory()
+};
+
+class CopyBeginTask : public WorkerTask {
+public:
+    explicit CopyBeginTask(Copy* copy) : m_copy(copy) {}
+
+    virtual void Run()
+    {
+        m_copy->Begin();
+    }
+
+    virtual const char* GetName() const { return "CopyBegin"; }
+
+private:
+    Copy* m_copy;
+};
+
+class CopyDirectoryTask : public WorkerTask {
+public:
+    CopyDirectoryTask(Copy* copy, const std::string& relativePath) : m_copy(copy), m_relativePath(relativePath) {}
+
+    virtual void Run()
+    {
+        m_copy->CopyDirectory(m_relativePath);
+    }
+
+    virtual const char* GetName() const { return "CopyDirectory"; }
+
+private:
+    Copy* m_copy;
+    std::string m_relativePath;
+};
+
+class CopyFilesTask : public WorkerTask {
+public:
+    CopyFilesTask(Copy* copy, const std::vector<std::string>& relativePaths)
+        : m_copy(copy), m_relativePaths(relativePaths)
+    {
+    }
+
+    virtual void Run()
+    {
+        m_copy->CopyFiles(m_relativePaths);
+    }
+
+    virtual const char* GetName() const { return "CopyFiles"; }
+
+private:
+    Copy* m_copy;
+    std::vector<std::string> m_relativePaths;
+};
+
+WorkerTask* Copy::CreateBeginTask()
+{
+    return new CopyBeginTask(this);
+}
+
+WorkerTask* Copy::CreateDirectoryTask(const std::string& relativePath)
+{
+    return new CopyDirectoryTask(this, relativePath);
+}
+
+WorkerTask* Copy::CreateFilesTask(const std::vector<std::string>& relativePaths)
+{
+    return new CopyFilesTask(this, relativePaths);
+}
+
+void Copy::Start()
+{
+    // Begin() holds a reference of its own, so tasks finishing right away
+    // can't delete the copy while it is still posting them
+    m_pending = 1;
+    PostTasks(std::vector<WorkerTask*>(1, CreateBeginTask()));
+}
+
+void Copy::Begin()
+{
+    if (m_move) {
+        bool crossDevice;
+        int error = Rename(m_path, m_newPath, &crossDevice);
+        if (!crossDevice) {
+            m_copying = false;
+            if (error != NO_ERROR)
+                Fail(error);
+            Release();
+            return;
+        }
+    }
+
+    FileInfo info;
+    int error = Stat(m_path, info);
+    if (error != NO_ERROR) {
+        Fail(error);
+        Release();
+        return;
+    }
+
+    std::vector<WorkerTask*> tasks;
+    {
+        AutoLock lock(m_lock);
+        if (info.isDir) {
+            tasks.push_back(CreateDirectoryTask(""));
+        } else {
+            m_progress.totalFiles = 1;
+            m_progress.totalBytes = info.size;
+            tasks.push_back(CreateFilesTask(std::vector<std::string>(1, std::string())));
+        }
+        m_pending += (int)tasks.size();
+    }
+
+    PostTasks(tasks);
+    Release();
+}
+
+void Copy::CopyDirectory(const std::string& relativePath)
+{
+    std::string path = m_path + relativePath;
+    DirEntryList entries;
+    FileId id;
+    int error = GetFileId(path, id);
+    bool copied = false;
+    if (error == NO_ERROR) {
+        AutoLock lock(m_lock);
+        copied = !m_directories.insert(id).second;
+    }
+
+    // A directory that was copied already is reached through a symlink, and
+    // might contain it
+    if (error == NO_ERROR && !copied && !IsStopped())
+        error = MakeDir(m_newPath + relativePath, 0777);
+    if (error == NO_ERROR && !copied && !IsStopped())
+        error = ReadDir(path, entries, true);
+    if (error != NO_ERROR) {
+        Fail(error);
+        Release();
+        return;
+    }
+
+    std::vector<WorkerTask*> tasks;
+    {
+        AutoLock lock(m_lock);
+        std::vector<std::string> files;
+        long long bytes = 0;
+        for (size_t i = 0; i < entries.size() && !IsStoppedLocked(); i++) {
+            const DirEntry& entry = entries[i];
+            std::string entryPath = relativePath + "/" + entry.name;
+            if (entry.type == ENTRY_DIRECTORY) {
+                tasks.push_back(CreateDirectoryTask(entryPath));
+                continue;
+            }
+
+            // Broken symlinks, sockets and the like are skipped
+            if (entry.type != ENTRY_FILE)
+                continue;
+
+            files.push_back(entryPath);
+            bytes += entry.info.size;
+            m_progress.totalFiles++;
+            m_progress.totalBytes += entry.info.size;
+            if (files.size() == kFilesPerTask || bytes >= kBytesPerTask) {
+                tasks.push_back(CreateFilesTask(files));
+                files.clear();
+                bytes = 0;
+            }
+        }
+        if (!files.empty())
+            tasks.push_back(CreateFilesTask(files));
+
+        m_pending += (int)tasks.size();
+    }
+
+    PostTasks(tasks);
+    Release();
+}
+
+} // namespace
+
+int StartCopy(const std::string& path, const std::string& newPath, bool move, CopyDelegate* delegate)
+{
+    int id;
+    Copy* copy;
+    {
+        AutoLock lock(g_copiesLock);
+        id = g_nextCopyId++;
+        copy = new Copy(id, path, newPath, move, delegate);
+        if (copy->IsValid())
+            g_copies[id] = copy;
+    }
+
+    if (!copy->IsValid()) {
+        CopyProgress progress = { 0, 0, 0, 0 };
+        delegate->OnCopyDone(ERR_INVALID_PARAMS, false, progress);
+        delete copy;
+        return 0;
+    }
+
+    copy->Start();
+    return id;
+}
+
+void CancelCopy(int copyId)
+{
+    AutoLock lock(g_copiesLock);
+    std::map<int, Copy*>::iterator it = g_copies.find(copyId);
+    if (it != g_copies.end())
+        it->second->Cancel();
+}
+
+} // namespace FileSystem
+} // namespace Brackets
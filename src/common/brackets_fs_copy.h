@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_COPY_H
+#define _BRACKETS_FS_COPY_H
+
+#include "brackets_fs.h"
+
+#include <string>
+#include <stddef.h>
+
+/**
+ * Copying and moving files and directory trees on the shared WorkerPool.
+ * Each directory is read and created by its own WorkerTask, which posts
+ * tasks for its subdirectories and for its files, a few files per task, so
+ * a large tree is copied by all the worker threads at once. The files
+ * themselves are copied with CopyFileTo(), which leaves the data to the
+ * kernel where it can.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+struct CopyProgress {
+    size_t files;           // files copied
+    size_t totalFiles;      // files found so far
+    long long bytes;        // bytes copied
+    long long totalBytes;   // size of the files found so far
+};
+
+// Receives the progress of a copy. Called from the worker threads, never
+// more than one call at a time.
+class CopyDelegate {
+public:
+    virtual ~CopyDelegate() {}
+
+    // Called every kProgressInterval at most, while the copy goes on. The
+    // totals grow as more directories are read.
+    virtual void OnCopyProgress(const CopyProgress& progress) = 0;
+
+    // Called once, at the end. error is the first error that stopped the
+    // copy. cancelled is true if CancelCopy() stopped it. What was copied
+    // before it stopped is left in place.
+    virtual void OnCopyDone(int error, bool cancelled, const CopyProgress& progress) = 0;
+};
+
+// Starts copying the file or directory at path to newPath, which must not
+// exist yet (ERR_FILE_EXISTS). Symlinks are copied as what they point to;
+// directories reachable through several symlinks are copied once.
+//
+// If move is true, path is renamed to newPath instead. If the two are on
+// different volumes, path is copied and then deleted with StartDelete(),
+// unless the copy failed. An error deleting it is passed to OnCopyDone().
+//
+// ERR_INVALID_PARAMS is passed to OnCopyDone() right away if newPath is
+// inside path. The copy takes ownership of the delegate and deletes it after
+// OnCopyDone(). Returns an id for CancelCopy().
+int StartCopy(const std::string& path, const std::string& newPath, bool move, CopyDelegate* delegate);
+
+// Stops a copy started by StartCopy(). Files that are being copied stop
+// too, and are removed. OnCopyDone() is still called. Does nothing if the
+// copy already finished.
+void CancelCopy(int copyId);
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_COPY_H
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_delete.h"
+#include "brackets_fs_index.h"
+#include "brackets_threading.h"
+#include "brackets_worker_pool.h"
+
+#include <map>
+#include <vector>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+class Deletion;
+
+// Deletes in progress, by id, so they can be cancelled
+Lock g_deletesLock;
+std::map<int, Deletion*> g_deletes;
+int g_nextDeleteId = 1;
+
+// Removes the separators at the end of path, except for a root
+std::string TrimPath(const std::string& path)
+{
+    std::string result = path;
+    while (result.length() > 1 && (result[result.length() - 1] == '/' || result[result.length() - 1] == '\\'))
+        result.erase(result.length() - 1);
+    return result;
+}
+
+// A directory being emptied. It is removed when pending drops to 0.
+struct Directory {
+    std::string path;
+    Directory* parent;
+    int pending;                // its own task, and subdirectories not removed yet
+    bool incomplete;            // something in it could not be deleted
+};
+
+class Deletion : public DeleteObserver {
+public:
+    Deletion(int id, const std::string& path, DeleteDelegate* delegate)
+        : m_id(id)
+        , m_path(TrimPath(path))
+        , m_delegate(delegate)
+        , m_cancelled(false)
+        , m_error(NO_ERROR)
+        , m_lastProgressTime(0)
+    {
+        m_progress.deleted = 0;
+        m_progress.failed = 0;
+    }
+
+    ~Deletion()
+    {
+        delete m_delegate;
+    }
+
+    void Start()
+    {
+        Directory* root = new Directory;
+        root->path = m_path;
+        root->parent = NULL;
+        root->pending = 1;
+        root->incomplete = false;
+        Post(root);
+    }
+
+    void Cancel()
+    {
+        AutoLock lock(m_lock);
+        m_cancelled = true;
+    }
+
+    // Deletes the files in directory and posts its subdirectories. Runs on
+    // the worker threads.
+    void DeleteDirectory(Directory* directory);
+
+    // DeleteObserver
+    virtual bool OnEntryDeleted()
+    {
+        AutoLock lock(m_lock);
+        m_progress.deleted++;
+        ReportProgress();
+        return !m_cancelled;
+    }
+
+private:
+    bool IsCancelled()
+    {
+        AutoLock lock(m_lock);
+        return m_cancelled;
+    }
+
+    // m_lock must be held
+    void ReportProgress()
+    {
+        unsigned long long now = GetMonotonicTime();
+        if (now - m_lastProgressTime < kProgressInterval)
+            return;
+        m_lastProgressTime = now;
+        m_delegate->OnDeleteProgress(m_progress);
+    }
+
+    // m_lock must be held
+    void AddFailure(const std::string& path, int error)
+    {
+        if (m_error == NO_ERROR)
+            m_error = error;
+        m_progress.failed++;
+        if (m_failures.size() < kMaxDeleteFailures) {
+            DeleteFailure failure;
+            failure.path = path;
+            failure.error = error;
+            m_failures.push_back(failure);
+        }
+    }
+
+    // Posts the task of directory. Leaves the directory in place if the pool
+    // is shutting down.
+    void Post(Directory* directory);
+
+    // Drops a reference to directory. The last one removes it, unless
+    // something in it was left, and then releases its parent.
+    void Release(Directory* directory);
+
+    void Finish(bool removed);
+
+    int m_id;
+    std::string m_path;
+    DeleteDelegate* m_delegate;
+
+    Lock m_lock;
+    bool m_cancelled;
+    int m_error;
+    DeleteProgress m_progress;
+    DeleteFailureList m_failures;
+    unsigned long long m_lastProgressTime;
+};
+
+class DeleteDirectoryTask : public WorkerTask {
+public:
+    DeleteDirectoryTask(Deletion* deletion, Directory* directory) : m_deletion(deletion), m_directory(directory) {}
+
+    virtual void Run()
+    {
+        m_deletion->DeleteDirectory(m_directory);
+    }
+
+    virtual const char* GetName() const { return "DeleteDirectory"; }
+
+private:
+    Deletion* m_deletion;
+    Directory* m_directory;
+};
+
+void Deletion::Post(Directory* directory)
+{
+    WorkerPool* pool = WorkerPool::GetInstance();
+    if (pool) {
+        pool->PostTask(new DeleteDirectoryTask(this, directory));
+        return;
+    }
+
+    {
+        AutoLock lock(m_lock);
+        directory->incomplete = true;
+    }
+    Release(directory);
+}
+
+void Deletion::DeleteDirectory(Directory* directory)
+{
+    if (IsCancelled()) {
+        AutoLock lock(m_lock);
+        directory->incomplete = true;
+    } else {
+        std::vector<std::string> subdirectories;
+        DeleteFailureList failures;
+        int error = DeleteFilesIn(directory->path, subdirectories, failures, this);
+
+        // The path StartDelete() was given can be a file or a symlink
+        bool deleted = false;
+        if (error == ERR_NOT_DIRECTORY && !directory->parent) {
+            error = DeleteFileOrDirectory(directory->path);
+            deleted = (error == NO_ERROR);
+        }
+
+        std::vector<Directory*> children;
+        {
+            AutoLock lock(m_lock);
+            for (size_t i = 0; i < failures.size(); i++)
+                AddFailure(failures[i].path, failures[i].error);
+            if (error != NO_ERROR)
+                AddFailure(directory->path, error);
+            if (error != NO_ERROR || !failures.empty())
+                directory->incomplete = true;
+            if (deleted)
+                m_progress.deleted++;
+
+            // Nothing was read if the call failed
+            std::string prefix = directory->path;
+            if (prefix[prefix.length() - 1] != '/')
+                prefix += '/';
+            for (size_t i = 0; i < subdirectories.size(); i++) {
+                Directory* child = new Directory;
+                child->path = prefix + subdirectories[i];
+                child->parent = directory;
+                child->pending = 1;
+                child->incomplete = false;
+                children.push_back(child);
+            }
+            directory->pending += (int)children.size();
+        }
+
+        for (size_t i = 0; i < children.size(); i++)
+            Post(children[i]);
+
+        if (deleted) {
+            delete directory;
+            Finish(true);
+            return;
+        }
+    }
+
+    Release(directory);
+}
+
+void Deletion::Release(Directory* directory)
+{
+    // Walk up as long as this was the last reference to the directory, so
+    // deep trees don't recurse
+    while (directory) {
+        bool incomplete;
+        {
+            AutoLock lock(m_lock);
+            if (--directory->pending != 0)
+                return;
+            incomplete = directory->incomplete || m_cancelled;
+        }
+
+        bool removed = false;
+        if (!incomplete) {
+            int error = DeleteEmptyDirectory(directory->path);
+            AutoLock lock(m_lock);
+            if (error == NO_ERROR) {
+                removed = true;
+                m_progress.deleted++;
+                ReportProgress();
+            } else {
+                AddFailure(directory->path, error);
+            }
+        }
+
+        Directory* parent = directory->parent;
+        delete directory;
+        if (!parent) {
+            Finish(removed);
+            return;
+        }
+
+        if (!removed) {
+            AutoLock lock(m_lock);
+            parent->incomplete = true;
+        }
+        directory = parent;
+    }
+}
+
+void Deletion::Finish(bool removed)
+{
+    // The tasks are all done, so nothing else touches the delete anymore
+    if (removed)
+        RemoveIndexedPath(m_path);
+    else
+        RefreshIndexedPaths(std::vector<std::string>(1, m_path));
+
+    bool cancelled;
+    {
+        AutoLock lock(m_lock);
+        cancelled = m_cancelled;
+    }
+    m_delegate->OnDeleteDone(removed ? NO_ERROR : m_error, cancelled, m_progress, m_failures);
+
+    {
+        AutoLock lock(g_deletesLock);
+        g_deletes.erase(m_id);
+    }
+    delete this;
+}
+
+} // namespace
+
+int StartDelete(const std::string& path, DeleteDelegate* delegate)
+{
+    if (path.empty()) {
+        DeleteProgress progress = { 0, 0 };
+        delegate->OnDeleteDone(ERR_INVALID_PARAMS, false, progress, DeleteFailureList());
+        delete delegate;
+        return 0;
+    }
+
+    int id;
+    Deletion* deletion;
+    {
+        AutoLock lock(g_deletesLock);
+        id = g_nextDeleteId++;
+        deletion = new Deletion(id, path, delegate);
+        g_deletes[id] = deletion;
+    }
+
+    deletion->Start();
+    return id;
+}
+
+void CancelDelete(int deleteId)
+{
+    AutoLock lock(g_deletesLock);
+    std::map<int, Deletion*>::iterator it = g_deletes.find(deleteId);
+    if (it != g_deletes.end())
+        it->second->Cancel();
+}
+
+} // namespace FileSystem
+} // namespace Brackets
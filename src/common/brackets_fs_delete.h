@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_DELETE_H
+#define _BRACKETS_FS_DELETE_H
+
+#include "brackets_fs.h"
+
+#include <string>
+#include <stddef.h>
+
+/**
+ * Deleting directory trees on the shared WorkerPool. Each directory is
+ * emptied of its files by its own WorkerTask with DeleteFilesIn(), which
+ * posts tasks for its subdirectories, so a large tree is deleted by all the
+ * worker threads at once. A directory is removed once the tasks of all its
+ * subdirectories have removed them.
+ *
+ * Entries that can't be deleted don't stop the others: the directories above
+ * them are left in place, and the failures are reported at the end.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+struct DeleteProgress {
+    size_t deleted;         // files and directories deleted
+    size_t failed;          // files and directories that could not be deleted
+};
+
+// Receives the progress of a delete. Called from the worker threads, never
+// more than one call at a time.
+class DeleteDelegate {
+public:
+    virtual ~DeleteDelegate() {}
+
+    // Called every kProgressInterval at most, while the delete goes on
+    virtual void OnDeleteProgress(const DeleteProgress& progress) = 0;
+
+    // Called once, at the end. error is NO_ERROR if path is gone, or else the
+    // error of the first entry that could not be deleted. failures has the
+    // first kMaxDeleteFailures of those; directories that were not deleted
+    // because something in them wasn't are not listed. cancelled is true if
+    // CancelDelete() stopped the delete.
+    virtual void OnDeleteDone(int error, bool cancelled, const DeleteProgress& progress,
+                              const DeleteFailureList& failures) = 0;
+};
+
+// Most failures passed to OnDeleteDone()
+const size_t kMaxDeleteFailures = 1000;
+
+// Starts deleting the file or directory at path, with everything in it.
+// Symlinks are deleted, not followed. The delete takes ownership of the
+// delegate and deletes it after OnDeleteDone(). Returns an id for
+// CancelDelete().
+int StartDelete(const std::string& path, DeleteDelegate* delegate);
+
+// Stops a delete started by StartDelete(). What was not deleted yet is left
+// in place. OnDeleteDone() is still called. Does nothing if the delete
+// already finished.
+void CancelDelete(int deleteId);
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_DELETE_H
@@ -0,0 +1,983 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_index.h"
+#include "brackets_encoding.h"
+#include "brackets_fs_walker.h"
+#include "brackets_regex.h"
+#include "brackets_worker_pool.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string.h>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+class Index;
+
+// Slots of the path hash table that don't hold an id + 1
+const unsigned int kEmptySlot = 0;
+const unsigned int kRemovedSlot = 0xFFFFFFFF;
+
+// The string pool is compacted once removed paths take up half of it, and
+// at least this much
+const size_t kMinCompactBytes = 1024 * 1024;
+
+// Paths checked by each range of a query
+const size_t kQueryBatchSize = 8192;
+
+// Paths scored by each range of a fuzzy query
+const size_t kFuzzyBatchSize = 2048;
+
+// Indexes by id
+Lock g_indexesLock;
+std::map<int, Index*> g_indexes;
+int g_nextIndexId = 1;
+
+inline unsigned char FoldASCII(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+// One bit per letter and digit, the other bytes share the remaining 28
+unsigned long long GetCharMask(const char* text, size_t length)
+{
+    unsigned long long mask = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = FoldASCII((unsigned char)text[i]);
+        int bit;
+        if (c >= 'a' && c <= 'z')
+            bit = c - 'a';
+        else if (c >= '0' && c <= '9')
+            bit = 26 + (c - '0');
+        else
+            bit = 36 + c % 28;
+        mask |= 1ULL << bit;
+    }
+    return mask;
+}
+
+// FNV-1a
+unsigned int HashPath(const char* path, size_t length)
+{
+    unsigned int hash = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)path[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+// Compares like memcmp(), ignoring the case of ASCII letters
+int CompareFolded(const char* a, size_t aLength, const char* b, size_t bLength)
+{
+    size_t length = (aLength < bLength) ? aLength : bLength;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char ca = FoldASCII((unsigned char)a[i]);
+        unsigned char cb = FoldASCII((unsigned char)b[i]);
+        if (ca != cb)
+            return (ca < cb) ? -1 : 1;
+    }
+    return (aLength == bLength) ? 0 : (aLength < bLength) ? -1 : 1;
+}
+
+// A file in the index. Entries of removed files are reused.
+struct Entry {
+    unsigned int offset;        // in the string pool
+    unsigned int length;        // 0 if the entry is free
+    unsigned int nameOffset;    // of the file name within the path
+    unsigned long long mask;    // GetCharMask() of the path
+};
+
+// The paths of an index. Queries read it without holding the index's lock,
+// so an Index that changes it while it is being read makes a copy first,
+// see Index::GetWritableData().
+struct IndexData {
+    IndexData() : readers(0) {}
+
+    std::string pool;                   // all paths, back to back
+    std::vector<Entry> entries;
+    std::vector<unsigned int> byName;   // ids sorted with NameLess
+    int readers;                        // queries running, under the index's lock
+};
+
+// Orders ids by file name, then by path, ignoring case
+struct NameLess {
+    explicit NameLess(const IndexData& data) : m_data(data) {}
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        const Entry& ea = m_data.entries[a];
+        const Entry& eb = m_data.entries[b];
+        const char* pool = m_data.pool.data();
+        int result = CompareFolded(pool + ea.offset + ea.nameOffset, ea.length - ea.nameOffset,
+                                   pool + eb.offset + eb.nameOffset, eb.length - eb.nameOffset);
+        if (result == 0)
+            result = CompareFolded(pool + ea.offset, ea.length, pool + eb.offset, eb.length);
+        return (result == 0) ? a < b : result < 0;
+    }
+
+    // For std::lower_bound() with a folded name
+    bool operator()(unsigned int id, const std::string& name) const
+    {
+        const Entry& entry = m_data.entries[id];
+        return CompareFolded(m_data.pool.data() + entry.offset + entry.nameOffset,
+                             entry.length - entry.nameOffset, name.data(), name.length()) < 0;
+    }
+
+    bool operator()(const std::string& name, unsigned int id) const
+    {
+        const Entry& entry = m_data.entries[id];
+        return CompareFolded(name.data(), name.length(),
+                             m_data.pool.data() + entry.offset + entry.nameOffset,
+                             entry.length - entry.nameOffset) < 0;
+    }
+
+    const IndexData& m_data;
+};
+
+struct IsFree {
+    explicit IsFree(const IndexData& data) : m_data(data) {}
+    bool operator()(unsigned int id) const { return m_data.entries[id].length == 0; }
+    const IndexData& m_data;
+};
+
+class Index {
+public:
+    Index(const std::string& root, const std::vector<std::string>& excludes, IndexDelegate* delegate)
+        : m_root(root)
+        , m_excludes(excludes.begin(), excludes.end())
+        , m_delegate(delegate)
+        , m_refCount(1)
+        , m_walkId(0)
+        , m_building(true)
+        , m_sorted(true)
+        , m_closed(false)
+        , m_fileCount(0)
+        , m_garbage(0)
+        , m_usedSlots(0)
+        , m_data(new IndexData())
+    {
+        // Relative paths start after m_root + "/", see Walk
+        if (m_root.length() > 1 && m_root[m_root.length() - 1] == '/')
+            m_root.erase(m_root.length() - 1);
+        if (m_root == "/")
+            m_root.clear();
+    }
+
+    ~Index()
+    {
+        delete m_delegate;
+        delete m_data;
+    }
+
+    void AddRef()
+    {
+        AutoLock lock(m_lock);
+        m_refCount++;
+    }
+
+    void Release()
+    {
+        {
+            AutoLock lock(m_lock);
+            if (--m_refCount != 0)
+                return;
+        }
+        delete this;
+    }
+
+    // Walks directory, which is relativePath in the index, and adds the files
+    // it finds. relativePath is empty or ends with a '/'.
+    void StartIndexWalk(const std::string& directory, const std::string& relativePath, bool initial);
+
+    void OnWalkBatch(const std::string& relativePath, const std::vector<std::string>& paths)
+    {
+        std::vector<std::string> files;
+        files.reserve(paths.size());
+        for (size_t i = 0; i < paths.size(); i++) {
+            const std::string& path = paths[i];
+            if (!path.empty() && path[path.length() - 1] != '/')
+                files.push_back(relativePath + path);
+        }
+
+        AutoLock lock(m_lock);
+        if (!m_closed)
+            AddPaths(files);
+    }
+
+    void OnWalkDone(int error, bool initial)
+    {
+        if (initial) {
+            AutoLock lock(m_lock);
+            SortByName();
+            m_building = false;
+            if (!m_closed)
+                m_delegate->OnIndexReady(error, m_fileCount);
+        }
+        Release();
+    }
+
+    // Returns the id of the initial walk, which has to be cancelled without
+    // holding g_indexesLock, see CloseIndex()
+    int Close()
+    {
+        AutoLock lock(m_lock);
+        m_closed = true;
+        return m_building ? m_walkId : 0;
+    }
+
+    // Sets relativePath to path relative to the root. Returns false if path
+    // is not below the root, or is excluded.
+    bool GetRelativePath(const std::string& path, std::string& relativePath) const
+    {
+        std::string normalized = path;
+        while (normalized.length() > 1 && normalized[normalized.length() - 1] == '/')
+            normalized.erase(normalized.length() - 1);
+
+        if (normalized == m_root) {
+            relativePath.clear();
+            return true;
+        }
+
+        if (normalized.length() <= m_root.length() + 1 ||
+            normalized.compare(0, m_root.length(), m_root) != 0 || normalized[m_root.length()] != '/')
+            return false;
+
+        relativePath = normalized.substr(m_root.length() + 1);
+
+        size_t start = 0;
+        while (start < relativePath.length()) {
+            size_t slash = relativePath.find('/', start);
+            size_t end = (slash == std::string::npos) ? relativePath.length() : slash;
+            if (m_excludes.find(relativePath.substr(start, end - start)) != m_excludes.end())
+                return false;
+            start = end + 1;
+        }
+        return true;
+    }
+
+    void AddFile(const std::string& relativePath)
+    {
+        std::vector<std::string> files(1, relativePath);
+        AutoLock lock(m_lock);
+        AddPaths(files);
+    }
+
+    // Removes relativePath and everything below it
+    void RemovePath(const std::string& relativePath)
+    {
+        AutoLock lock(m_lock);
+        std::string prefix = relativePath.empty() ? relativePath : relativePath + "/";
+        size_t removed = 0;
+        IndexData& data = GetWritableData();
+
+        unsigned int id;
+        if (!relativePath.empty() && Find(relativePath.data(), relativePath.length(), id)) {
+            RemoveEntry(id);
+            removed++;
+        }
+
+        for (size_t i = 0; i < data.entries.size(); i++) {
+            const Entry& entry = data.entries[i];
+            if (entry.length > prefix.length() &&
+                memcmp(data.pool.data() + entry.offset, prefix.data(), prefix.length()) == 0) {
+                RemoveEntry((unsigned int)i);
+                removed++;
+            }
+        }
+
+        if (removed) {
+            std::vector<unsigned int>& byName = data.byName;
+            byName.erase(std::remove_if(byName.begin(), byName.end(), IsFree(data)), byName.end());
+            if (m_garbage >= kMinCompactBytes && m_garbage > data.pool.length() / 2)
+                CompactPool();
+        }
+    }
+
+    void Query(const std::string& query, size_t maxResults, std::vector<std::string>& paths);
+    void FuzzyQuery(const std::string& query, size_t maxResults, FuzzyResultList& results);
+
+    void GetStats(IndexStats& stats)
+    {
+        AutoLock lock(m_lock);
+        stats.files = m_fileCount;
+        stats.poolBytes = m_data->pool.length();
+    }
+
+private:
+    // m_lock must be held for all of these
+
+    // Returns m_data, after copying it if a query is reading it
+    IndexData& GetWritableData()
+    {
+        if (m_data->readers) {
+            IndexData* copy = new IndexData(*m_data);
+            copy->readers = 0;
+            m_data = copy;
+        }
+        return *m_data;
+    }
+
+    // Called when a query is done with data
+    void ReleaseData(IndexData* data)
+    {
+        if (--data->readers || data == m_data)
+            return;
+        delete data;
+    }
+
+    void SortByName()
+    {
+        if (m_sorted)
+            return;
+        IndexData& data = GetWritableData();
+        std::sort(data.byName.begin(), data.byName.end(), NameLess(data));
+        m_sorted = true;
+    }
+
+    // Adds the paths that are not in the index yet
+    void AddPaths(const std::vector<std::string>& relativePaths)
+    {
+        GetWritableData();
+        std::vector<unsigned int> added;
+        for (size_t i = 0; i < relativePaths.size(); i++) {
+            const std::string& path = relativePaths[i];
+            unsigned int id;
+            if (path.empty() || Find(path.data(), path.length(), id))
+                continue;
+            added.push_back(AddEntry(path));
+        }
+
+        if (added.empty())
+            return;
+
+        // While the initial walk runs, byName is sorted when it's done or
+        // when it is queried. Later additions are merged in, which costs one
+        // pass however many there are.
+        IndexData& data = *m_data;
+        if (m_building) {
+            data.byName.insert(data.byName.end(), added.begin(), added.end());
+            m_sorted = false;
+        } else {
+            NameLess less(data);
+            std::sort(added.begin(), added.end(), less);
+            std::vector<unsigned int> merged(data.byName.size() + added.size());
+            std::merge(data.byName.begin(), data.byName.end(), added.begin(), added.end(), merged.begin(), less);
+            data.byName.swap(merged);
+        }
+    }
+
+    unsigned int AddEntry(const std::string& path)
+    {
+        Entry entry;
+        entry.offset = (unsigned int)m_data->pool.length();
+        entry.length = (unsigned int)path.length();
+        size_t slash = path.rfind('/');
+        entry.nameOffset = (slash == std::string::npos) ? 0 : (unsigned int)slash + 1;
+        entry.mask = GetCharMask(path.data(), path.length());
+        m_data->pool.append(path);
+
+        unsigned int id;
+        if (!m_freeIds.empty()) {
+            id = m_freeIds.back();
+            m_freeIds.pop_back();
+            m_data->entries[id] = entry;
+        } else {
+            id = (unsigned int)m_data->entries.size();
+            m_data->entries.push_back(entry);
+        }
+
+        InsertSlot(id);
+        m_fileCount++;
+        return id;
+    }
+
+    // Frees the entry. byName has to be cleaned up by the caller.
+    void RemoveEntry(unsigned int id)
+    {
+        Entry& entry = m_data->entries[id];
+        size_t slot = FindSlot(m_data->pool.data() + entry.offset, entry.length);
+        m_slots[slot] = kRemovedSlot;
+
+        m_garbage += entry.length;
+        entry.length = 0;
+        m_freeIds.push_back(id);
+        m_fileCount--;
+    }
+
+    bool Find(const char* path, size_t length, unsigned int& id) const
+    {
+        if (m_slots.empty())
+            return false;
+        size_t slot = FindSlot(path, length);
+        if (m_slots[slot] == kEmptySlot)
+            return false;
+        id = m_slots[slot] - 1;
+        return true;
+    }
+
+    // Returns the slot holding path, or the empty slot that ends its probe
+    // sequence. m_slots must not be empty.
+    size_t FindSlot(const char* path, size_t length) const
+    {
+        size_t mask = m_slots.size() - 1;
+        size_t slot = HashPath(path, length) & mask;
+        while (m_slots[slot] != kEmptySlot) {
+            if (m_slots[slot] != kRemovedSlot) {
+                const Entry& entry = m_data->entries[m_slots[slot] - 1];
+                if (entry.length == length && memcmp(m_data->pool.data() + entry.offset, path, length) == 0)
+                    return slot;
+            }
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void InsertSlot(unsigned int id)
+    {
+        // Keep the table at most half full, counting removed slots
+        if ((m_usedSlots + 1) * 2 > m_slots.size())
+            Rehash();
+
+        const Entry& entry = m_data->entries[id];
+        size_t mask = m_slots.size() - 1;
+        size_t slot = HashPath(m_data->pool.data() + entry.offset, entry.length) & mask;
+        while (m_slots[slot] != kEmptySlot && m_slots[slot] != kRemovedSlot)
+            slot = (slot + 1) & mask;
+
+        if (m_slots[slot] == kEmptySlot)
+            m_usedSlots++;
+        m_slots[slot] = id + 1;
+    }
+
+    void Rehash()
+    {
+        size_t size = 16;
+        while (size < (m_fileCount + 1) * 4)
+            size *= 2;
+
+        m_slots.assign(size, kEmptySlot);
+        m_usedSlots = 0;
+        for (size_t i = 0; i < m_data->entries.size(); i++) {
+            const Entry& entry = m_data->entries[i];
+            if (!entry.length)
+                continue;
+            size_t slot = HashPath(m_data->pool.data() + entry.offset, entry.length) & (size - 1);
+            while (m_slots[slot] != kEmptySlot)
+                slot = (slot + 1) & (size - 1);
+            m_slots[slot] = (unsigned int)i + 1;
+            m_usedSlots++;
+        }
+    }
+
+    // Drops the bytes of removed paths from the pool. Ids don't change.
+    void CompactPool()
+    {
+        std::string pool;
+        pool.reserve(m_data->pool.length() - m_garbage);
+        for (size_t i = 0; i < m_data->entries.size(); i++) {
+            Entry& entry = m_data->entries[i];
+            if (!entry.length)
+                continue;
+            unsigned int offset = (unsigned int)pool.length();
+            pool.append(m_data->pool, entry.offset, entry.length);
+            entry.offset = offset;
+        }
+        m_data->pool.swap(pool);
+        m_garbage = 0;
+    }
+
+    std::string m_root;
+    std::set<std::string> m_excludes;
+    IndexDelegate* m_delegate;
+
+    Lock m_lock;
+    int m_refCount;             // g_indexes and each walk
+    int m_walkId;               // of the initial walk
+    bool m_building;            // the initial walk is running
+    bool m_sorted;              // byName is sorted, see AddPaths()
+    bool m_closed;
+    size_t m_fileCount;
+
+    size_t m_garbage;           // bytes of removed paths in the pool
+    std::vector<unsigned int> m_freeIds;
+    std::vector<unsigned int> m_slots;  // open addressing, path to id + 1
+    size_t m_usedSlots;                 // slots that are not empty
+
+    IndexData* m_data;                  // replaced ones are deleted by ReleaseData()
+};
+
+// Looks for the query in a range of entries, see Index::Query()
+class QueryTask : public RangeTask {
+public:
+    QueryTask(const IndexData& data, const std::string& query, size_t maxResults)
+        : m_data(data), m_query(query), m_mask(GetCharMask(query.data(), query.length())), m_maxResults(maxResults)
+    {
+    }
+
+    virtual void Run(size_t begin, size_t end)
+    {
+        std::vector<unsigned int> ids;
+        const char* pool = m_data.pool.data();
+        for (size_t i = begin; i < end && ids.size() < m_maxResults; i++) {
+            const Entry& entry = m_data.entries[i];
+            if (!entry.length || (entry.mask & m_mask) != m_mask)
+                continue;
+
+            // Names starting with the query were found by Index::Query()
+            const char* path = pool + entry.offset;
+            const char* name = path + entry.nameOffset;
+            size_t nameLength = entry.length - entry.nameOffset;
+            if (nameLength >= m_query.length() && CompareFolded(name, m_query.length(), m_query.data(),
+                                                                m_query.length()) == 0)
+                continue;
+
+            if (FindLiteral(path, entry.length, 0, m_query, true) != kNotFound)
+                ids.push_back((unsigned int)i);
+        }
+
+        AutoLock lock(m_lock);
+        m_ranges[begin].swap(ids);
+    }
+
+    // Appends the matches in id order, up to maxResults in total
+    void GetResults(std::vector<unsigned int>& ids)
+    {
+        std::map<size_t, std::vector<unsigned int> >::iterator it;
+        for (it = m_ranges.begin(); it != m_ranges.end(); ++it) {
+            for (size_t i = 0; i < it->second.size() && ids.size() < m_maxResults; i++)
+                ids.push_back(it->second[i]);
+        }
+    }
+
+private:
+    const IndexData& m_data;
+    std::string m_query;
+    unsigned long long m_mask;
+    size_t m_maxResults;
+
+    Lock m_lock;
+    std::map<size_t, std::vector<unsigned int> > m_ranges;  // by start of the range
+};
+
+void Index::Query(const std::string& query, size_t maxResults, std::vector<std::string>& paths)
+{
+    std::string folded = FoldLiteral(query);
+    std::vector<unsigned int> ids;
+
+    // The data is read without the lock, so the worker threads that update
+    // the index aren't kept waiting. ParallelFor() may need them.
+    IndexData* data;
+    {
+        AutoLock lock(m_lock);
+        SortByName();
+        data = m_data;
+        data->readers++;
+    }
+
+    // Names starting with the query are next to each other in byName
+    NameLess less(*data);
+    std::vector<unsigned int>::const_iterator it = std::lower_bound(data->byName.begin(), data->byName.end(), folded,
+                                                                    less);
+    for (; it != data->byName.end() && ids.size() < maxResults; ++it) {
+        const Entry& entry = data->entries[*it];
+        size_t nameLength = entry.length - entry.nameOffset;
+        if (nameLength < folded.length() ||
+            CompareFolded(data->pool.data() + entry.offset + entry.nameOffset, folded.length(), folded.data(),
+                          folded.length()) != 0)
+            break;
+        ids.push_back(*it);
+    }
+
+    // The rest of the paths are scanned in parallel
+    if (ids.size() < maxResults && !folded.empty()) {
+        QueryTask task(*data, folded, maxResults - ids.size());
+        ParallelFor(data->entries.size(), kQueryBatchSize, task);
+        task.GetResults(ids);
+    }
+
+    paths.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+        paths.push_back(data->pool.substr(data->entries[ids[i]].offset, data->entries[ids[i]].length));
+
+    AutoLock lock(m_lock);
+    ReleaseData(data);
+}
+
+// A path scored by a fuzzy query
+struct Candidate {
+    int score;
+    unsigned int id;
+};
+
+// Orders candidates best first: by score, then shorter paths first, then by
+// path ignoring case
+struct BetterCandidate {
+    explicit BetterCandidate(const IndexData& data) : m_data(data) {}
+
+    bool operator()(const Candidate& a, const Candidate& b) const
+    {
+        if (a.score != b.score)
+            return a.score > b.score;
+        const Entry& ea = m_data.entries[a.id];
+        const Entry& eb = m_data.entries[b.id];
+        if (ea.length != eb.length)
+            return ea.length < eb.length;
+        int result = CompareFolded(m_data.pool.data() + ea.offset, ea.length, m_data.pool.data() + eb.offset,
+                                   eb.length);
+        return (result == 0) ? a.id < b.id : result < 0;
+    }
+
+private:
+    const IndexData& m_data;
+};
+
+// Adds candidate to heap, which keeps the best maxResults candidates with the
+// worst one on top
+void AddCandidate(std::vector<Candidate>& heap, const Candidate& candidate, size_t maxResults,
+                  const BetterCandidate& better)
+{
+    if (heap.size() < maxResults) {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end(), better);
+    } else if (better(candidate, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+}
+
+// Scores a range of entries, see Index::FuzzyQuery()
+class FuzzyQueryTask : public RangeTask {
+public:
+    FuzzyQueryTask(const IndexData& data, const std::string& query, size_t maxResults)
+        : m_data(data), m_query(query), m_mask(GetCharMask(query.data(), query.length())),
+          m_maxResults(maxResults), m_better(data)
+    {
+    }
+
+    virtual void Run(size_t begin, size_t end)
+    {
+        FuzzyMatcher matcher(m_query);
+        std::vector<Candidate> heap;
+        const char* pool = m_data.pool.data();
+        for (size_t i = begin; i < end; i++) {
+            const Entry& entry = m_data.entries[i];
+            if (!entry.length || (entry.mask & m_mask) != m_mask)
+                continue;
+
+            Candidate candidate;
+            candidate.id = (unsigned int)i;
+            if (matcher.Score(pool + entry.offset, entry.length, entry.nameOffset, candidate.score))
+                AddCandidate(heap, candidate, m_maxResults, m_better);
+        }
+
+        AutoLock lock(m_lock);
+        for (size_t i = 0; i < heap.size(); i++)
+            AddCandidate(m_best, heap[i], m_maxResults, m_better);
+    }
+
+    // Returns the best candidates, best first
+    void GetResults(std::vector<Candidate>& candidates)
+    {
+        std::sort_heap(m_best.begin(), m_best.end(), m_better);
+        candidates.swap(m_best);
+    }
+
+private:
+    const IndexData& m_data;
+    std::string m_query;
+    unsigned long long m_mask;
+    size_t m_maxResults;
+    BetterCandidate m_better;
+
+    Lock m_lock;
+    std::vector<Candidate> m_best;  // heap, see AddCandidate()
+};
+
+void Index::FuzzyQuery(const std::string& query, size_t maxResults, FuzzyResultList& results)
+{
+    if (maxResults == 0)
+        return;
+
+    std::string folded = FoldLiteral(query);
+
+    // Read without the lock, like in Query()
+    IndexData* data;
+    {
+        AutoLock lock(m_lock);
+        data = m_data;
+        data->readers++;
+    }
+
+    std::vector<Candidate> candidates;
+    FuzzyQueryTask task(*data, folded, maxResults);
+    ParallelFor(data->entries.size(), kFuzzyBatchSize, task);
+    task.GetResults(candidates);
+
+    // Only the paths that are returned are matched again, to find the
+    // characters to highlight
+    FuzzyMatcher matcher(folded);
+    results.resize(candidates.size());
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const Entry& entry = data->entries[candidates[i].id];
+        const char* path = data->pool.data() + entry.offset;
+        FuzzyResult& result = results[i];
+        result.path.assign(path, entry.length);
+        matcher.Match(path, entry.length, entry.nameOffset, result.score, result.ranges);
+
+        for (size_t j = 0; j < result.ranges.size(); j++) {
+            FuzzyRange& range = result.ranges[j];
+            size_t start = Encoding::CountUTF16Units(path, range.start);
+            range.length = Encoding::CountUTF16Units(path + range.start, range.length);
+            range.start = start;
+        }
+    }
+
+    AutoLock lock(m_lock);
+    ReleaseData(data);
+}
+
+class IndexWalkDelegate : public WalkDelegate {
+public:
+    IndexWalkDelegate(Index* index, const std::string& relativePath, bool initial)
+        : m_index(index), m_relativePath(relativePath), m_initial(initial)
+    {
+    }
+
+    virtual void OnWalkBatch(std::vector<std::string>& paths)
+    {
+        m_index->OnWalkBatch(m_relativePath, paths);
+    }
+
+    virtual void OnWalkDone(int error, bool /* cancelled */)
+    {
+        m_index->OnWalkDone(error, m_initial);
+    }
+
+private:
+    Index* m_index;
+    std::string m_relativePath;
+    bool m_initial;
+};
+
+void Index::StartIndexWalk(const std::string& directory, const std::string& relativePath, bool initial)
+{
+    WalkOptions options;
+    options.excludes.assign(m_excludes.begin(), m_excludes.end());
+
+    // Released by OnWalkDone()
+    AddRef();
+    int walkId = StartWalk(directory, options, new IndexWalkDelegate(this, relativePath, initial));
+    if (!initial)
+        return;
+
+    bool closed;
+    {
+        AutoLock lock(m_lock);
+        m_walkId = walkId;
+        closed = m_closed;
+    }
+    if (closed)
+        CancelWalk(walkId);
+}
+
+class RefreshPathsTask : public WorkerTask {
+public:
+    explicit RefreshPathsTask(const std::vector<std::string>& paths) : m_paths(paths) {}
+
+    virtual void Run()
+    {
+        RefreshIndexedPaths(m_paths);
+    }
+
+    virtual const char* GetName() const { return "RefreshIndexedPaths"; }
+
+private:
+    std::vector<std::string> m_paths;
+};
+
+} // namespace
+
+int CreateIndex(const std::string& root, const std::vector<std::string>& excludes, IndexDelegate* delegate)
+{
+    if (root.empty()) {
+        delegate->OnIndexReady(ERR_INVALID_PARAMS, 0);
+        delete delegate;
+        return 0;
+    }
+
+    int id;
+    Index* index;
+    {
+        AutoLock lock(g_indexesLock);
+        id = g_nextIndexId++;
+        index = new Index(root, excludes, delegate);
+        g_indexes[id] = index;
+    }
+
+    // Excludes are checked by the walk for the names it finds, and by
+    // GetRelativePath() for paths that come from elsewhere
+    index->StartIndexWalk(root, "", true);
+    return id;
+}
+
+void CloseIndex(int indexId)
+{
+    Index* index = NULL;
+    int walkId = 0;
+    {
+        AutoLock lock(g_indexesLock);
+        std::map<int, Index*>::iterator it = g_indexes.find(indexId);
+        if (it == g_indexes.end())
+            return;
+        index = it->second;
+        g_indexes.erase(it);
+        walkId = index->Close();
+    }
+
+    // See CancelSearch()
+    if (walkId)
+        CancelWalk(walkId);
+    index->Release();
+}
+
+bool QueryIndex(int indexId, const std::string& query, size_t maxResults, std::vector<std::string>& paths)
+{
+    Index* index;
+    {
+        AutoLock lock(g_indexesLock);
+        std::map<int, Index*>::iterator it = g_indexes.find(indexId);
+        if (it == g_indexes.end())
+            return false;
+        index = it->second;
+        index->AddRef();
+    }
+
+    index->Query(query, maxResults, paths);
+    index->Release();
+    return true;
+}
+
+bool FuzzyQueryIndex(int indexId, const std::string& query, size_t maxResults, FuzzyResultList& results)
+{
+    Index* index;
+    {
+        AutoLock lock(g_indexesLock);
+        std::map<int, Index*>::iterator it = g_indexes.find(indexId);
+        if (it == g_indexes.end())
+            return false;
+        index = it->second;
+        index->AddRef();
+    }
+
+    index->FuzzyQuery(query, maxResults, results);
+    index->Release();
+    return true;
+}
+
+bool GetIndexStats(int indexId, IndexStats& stats)
+{
+    AutoLock lock(g_indexesLock);
+    std::map<int, Index*>::iterator it = g_indexes.find(indexId);
+    if (it == g_indexes.end())
+        return false;
+    it->second->GetStats(stats);
+    return true;
+}
+
+void AddIndexedFile(const std::string& path)
+{
+    AutoLock lock(g_indexesLock);
+    for (std::map<int, Index*>::iterator it = g_indexes.begin(); it != g_indexes.end(); ++it) {
+        std::string relativePath;
+        if (it->second->GetRelativePath(path, relativePath) && !relativePath.empty())
+            it->second->AddFile(relativePath);
+    }
+}
+
+void RemoveIndexedPath(const std::string& path)
+{
+    AutoLock lock(g_indexesLock);
+    for (std::map<int, Index*>::iterator it = g_indexes.begin(); it != g_indexes.end(); ++it) {
+        std::string relativePath;
+        if (it->second->GetRelativePath(path, relativePath))
+            it->second->RemovePath(relativePath);
+    }
+}
+
+void RefreshIndexedPaths(const std::vector<std::string>& paths)
+{
+    {
+        AutoLock lock(g_indexesLock);
+        if (g_indexes.empty())
+            return;
+    }
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        FileInfo info;
+        int error = Stat(paths[i], info);
+        if (error == ERR_NOT_FOUND) {
+            RemoveIndexedPath(paths[i]);
+        } else if (error == NO_ERROR && !info.isDir) {
+            AddIndexedFile(paths[i]);
+        } else if (error == NO_ERROR) {
+            AutoLock lock(g_indexesLock);
+            for (std::map<int, Index*>::iterator it = g_indexes.begin(); it != g_indexes.end(); ++it) {
+                std::string relativePath;
+                if (it->second->GetRelativePath(paths[i], relativePath))
+                    it->second->StartIndexWalk(paths[i], relativePath.empty() ? "" : relativePath + "/", false);
+            }
+        }
+    }
+}
+
+void ApplyWatchEvents(const WatchEventList& events)
+{
+    {
+        AutoLock lock(g_indexesLock);
+        if (g_indexes.empty())
+            return;
+    }
+
+    std::vector<std::string> created;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].type == WATCH_DELETED)
+            RemoveIndexedPath(events[i].path);
+        else if (events[i].type == WATCH_CREATED)
+            created.push_back(events[i].path);
+    }
+
+    // Stat'ing and walking the new paths is left to the worker pool
+    WorkerPool* pool = created.empty() ? NULL : WorkerPool::GetInstance();
+    if (pool)
+        pool->PostTask(new RefreshPathsTask(created));
+}
+
+} // namespace FileSystem
+} // namespace Brackets
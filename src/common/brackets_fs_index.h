@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_INDEX_H
+#define _BRACKETS_FS_INDEX_H
+
+#include "brackets_fs.h"
+#include "brackets_fs_watcher.h"
+#include "brackets_fuzzy.h"
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Index of the file names of a project, for Quick Open. The index is built
+ * once with StartWalk() and then kept up to date, so a query never has to
+ * list the project again.
+ *
+ * The relative paths are packed into a single string pool. Next to each path
+ * the index keeps a 64 bit mask of the characters it contains, so most paths
+ * are ruled out by a query without looking at them, and the ids of all files
+ * sorted by file name, so names starting with the query are found by binary
+ * search. Fuzzy queries score every path that may match on the WorkerPool,
+ * with FuzzyMatcher, and keep only the best ones.
+ *
+ * The index is updated by WriteFile(), DeleteFileOrDirectory(), Rename() and
+ * CopyFileTo() in brackets_fs.cpp, by StartDelete(), by the events of the
+ * watches started from JavaScript (see ApplyWatchEvents()) and by
+ * RefreshIndexedPaths(). All functions can be called from any thread.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+// Receives the result of building an index. Called once, from a worker
+// thread, unless the index is closed first.
+class IndexDelegate {
+public:
+    virtual ~IndexDelegate() {}
+
+    // error is the error reading the root. count is the number of files in
+    // the index.
+    virtual void OnIndexReady(int error, size_t count) = 0;
+};
+
+struct FuzzyResult {
+    std::string path;       // relative to the root of the index
+    int score;
+    FuzzyRangeList ranges;  // matched characters, in UTF-16 code units like JavaScript strings
+};
+
+typedef std::vector<FuzzyResult> FuzzyResultList;
+
+struct IndexStats {
+    size_t files;
+    size_t poolBytes;       // used by the string pool, including removed paths
+};
+
+// Starts indexing the files below root, skipping the file and directory
+// names in excludes (see WalkOptions). The index can be queried right away,
+// but is only complete once delegate->OnIndexReady() was called. The index
+// takes ownership of the delegate. Returns an id for the other functions.
+int CreateIndex(const std::string& root, const std::vector<std::string>& excludes, IndexDelegate* delegate);
+
+// Forgets an index. Does nothing if the id is not known.
+void CloseIndex(int indexId);
+
+// Finds files whose relative path contains query, ignoring the case of ASCII
+// letters. Files whose name starts with query come first, sorted by name,
+// followed by the other matches. At most maxResults relative paths are
+// returned. Returns false if the id is not known.
+bool QueryIndex(int indexId, const std::string& query, size_t maxResults, std::vector<std::string>& paths);
+
+// Finds the maxResults files whose relative path matches query best, see
+// brackets_fuzzy.h. Results are sorted by score, then shorter paths first.
+// Returns false if the id is not known.
+bool FuzzyQueryIndex(int indexId, const std::string& query, size_t maxResults, FuzzyResultList& results);
+
+// Returns false if the id is not known
+bool GetIndexStats(int indexId, IndexStats& stats);
+
+// Adds a file that was just written to the indexes that contain it
+void AddIndexedFile(const std::string& path);
+
+// Removes a file or directory, and everything below it, from the indexes
+// that contain it
+void RemoveIndexedPath(const std::string& path);
+
+// Brings the indexes that contain paths up to date with the disk: files are
+// added, missing paths are removed, and directories are walked again.
+// Stats each path, so it should not be called on the UI thread.
+void RefreshIndexedPaths(const std::vector<std::string>& paths);
+
+// Applies the events of a watch to the indexes. Created paths are refreshed
+// on the worker pool.
+void ApplyWatchEvents(const WatchEventList& events);
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_INDEX_H
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_metadata_cache.h"
+#include "brackets_fs_platform.h"
+#include "brackets_threading.h"
+
+#include <list>
+#include <map>
+#include <time.h>
+
+namespace Brackets {
+namespace FileSystem {
+namespace MetadataCache {
+
+namespace {
+
+// A directory modified this recently may be modified again without its
+// modification time changing (HFS+ only has whole seconds), so its listing
+// can't be checked against the modification time later
+const double kRacySeconds = 2;
+
+struct Entry {
+    Entry() : hasInfo(false), hasListing(false), listingHasInfo(false), listingMtime(0) {}
+
+    bool hasInfo;
+    FileInfo info;
+
+    bool hasListing;
+    bool listingHasInfo;
+    double listingMtime;
+    DirEntryList listing;
+
+    std::list<std::string>::iterator lru;
+};
+
+typedef std::map<std::string, Entry> EntryMap;
+
+Lock g_lock;
+EntryMap g_entries;
+std::list<std::string> g_lru;   // Most recently used first
+std::map<std::string, int> g_watchedPaths;
+unsigned int g_generation = 0;
+Stats g_stats;
+
+// "dir" and "dir/" are the same directory
+std::string GetKey(const std::string& path)
+{
+    std::string key = path;
+    while (key.length() > 1 && key[key.length() - 1] == '/')
+        key.erase(key.length() - 1);
+    return key;
+}
+
+std::string GetParent(const std::string& key)
+{
+    size_t slash = key.rfind('/');
+    if (slash == std::string::npos)
+        return "";
+    return (slash == 0) ? "/" : key.substr(0, slash);
+}
+
+// g_lock must be held for all of these
+
+bool IsWatched(const std::string& key)
+{
+    return g_watchedPaths.find(key) != g_watchedPaths.end();
+}
+
+void Touch(Entry& entry)
+{
+    g_lru.splice(g_lru.begin(), g_lru, entry.lru);
+}
+
+Entry& GetEntry(const std::string& key)
+{
+    EntryMap::iterator it = g_entries.find(key);
+    if (it != g_entries.end()) {
+        Touch(it->second);
+        return it->second;
+    }
+
+    while (g_entries.size() >= kMaxEntries) {
+        g_entries.erase(g_lru.back());
+        g_lru.pop_back();
+        g_stats.evictions++;
+    }
+
+    Entry& entry = g_entries[key];
+    g_lru.push_front(key);
+    entry.lru = g_lru.begin();
+    return entry;
+}
+
+void Erase(EntryMap::iterator it)
+{
+    g_lru.erase(it->second.lru);
+    g_entries.erase(it);
+}
+
+void Erase(const std::string& key)
+{
+    EntryMap::iterator it = g_entries.find(key);
+    if (it != g_entries.end())
+        Erase(it);
+}
+
+} // namespace
+
+unsigned int GetGeneration()
+{
+    AutoLock lock(g_lock);
+    return g_generation;
+}
+
+bool LookupStat(const std::string& path, FileInfo& info)
+{
+    std::string key = GetKey(path);
+
+    AutoLock lock(g_lock);
+    EntryMap::iterator it = g_entries.find(key);
+    if (it == g_entries.end() || !it->second.hasInfo) {
+        g_stats.misses++;
+        return false;
+    }
+
+    info = it->second.info;
+    Touch(it->second);
+    g_stats.hits++;
+    return true;
+}
+
+void StoreStat(const std::string& path, const FileInfo& info, unsigned int generation)
+{
+    std::string key = GetKey(path);
+
+    // Only a watch can tell when a file's info changes. The watch of a
+    // directory reports the changes of the files in it, but not the changes
+    // inside its subdirectories, which change their modification time.
+    AutoLock lock(g_lock);
+    if (generation != g_generation || !(IsWatched(key) || (!info.isDir && IsWatched(GetParent(key)))))
+        return;
+
+    Entry& entry = GetEntry(key);
+    entry.hasInfo = true;
+    entry.info = info;
+}
+
+bool LookupDir(const std::string& path, bool withInfo, DirEntryList& entries, double& dirMtime)
+{
+    std::string key = GetKey(path);
+    dirMtime = -1;
+
+    {
+        AutoLock lock(g_lock);
+        EntryMap::iterator it = g_entries.find(key);
+        bool cached = (it != g_entries.end() && it->second.hasListing && (it->second.listingHasInfo || !withInfo));
+
+        // The info of the entries can change without the directory's
+        // modification time changing, so only a watch can vouch for it
+        if (IsWatched(key) || withInfo) {
+            if (cached && IsWatched(key)) {
+                entries = it->second.listing;
+                Touch(it->second);
+                g_stats.hits++;
+                return true;
+            }
+            g_stats.misses++;
+            return false;
+        }
+    }
+
+    FileInfo info;
+    if (Platform::Stat(path, info) != NO_ERROR) {
+        AutoLock lock(g_lock);
+        g_stats.misses++;
+        return false;
+    }
+    dirMtime = info.mtime;
+
+    AutoLock lock(g_lock);
+    EntryMap::iterator it = g_entries.find(key);
+    if (it == g_entries.end() || !it->second.hasListing || it->second.listingMtime != dirMtime) {
+        g_stats.misses++;
+        return false;
+    }
+
+    entries = it->second.listing;
+    Touch(it->second);
+    g_stats.hits++;
+    return true;
+}
+
+void StoreDir(const std::string& path, bool withInfo, const DirEntryList& entries, double dirMtime,
+              unsigned int generation)
+{
+    std::string key = GetKey(path);
+
+    AutoLock lock(g_lock);
+    if (generation != g_generation)
+        return;
+
+    if (!IsWatched(key) && (withInfo || dirMtime < 0 || (double)time(NULL) - dirMtime < kRacySeconds))
+        return;
+
+    Entry& entry = GetEntry(key);
+    entry.hasListing = true;
+    entry.listingHasInfo = withInfo;
+    entry.listingMtime = dirMtime;
+    entry.listing = entries;
+}
+
+void Invalidate(const std::string& path, bool withContents)
+{
+    std::string key = GetKey(path);
+
+    AutoLock lock(g_lock);
+    g_generation++;
+    g_stats.invalidations++;
+
+    Erase(key);
+    Erase(GetParent(key));
+
+    if (withContents) {
+        std::string prefix = (key == "/") ? key : key + "/";
+        EntryMap::iterator it = g_entries.lower_bound(prefix);
+        while (it != g_entries.end() && it->first.compare(0, prefix.length(), prefix) == 0)
+            Erase(it++);
+    }
+}
+
+void AddWatchedPath(const std::string& path)
+{
+    // Anything cached before the watch started may be out of date already
+    Invalidate(path, true);
+
+    AutoLock lock(g_lock);
+    g_watchedPaths[GetKey(path)]++;
+}
+
+void RemoveWatchedPath(const std::string& path)
+{
+    std::string key = GetKey(path);
+    {
+        AutoLock lock(g_lock);
+        std::map<std::string, int>::iterator it = g_watchedPaths.find(key);
+        if (it == g_watchedPaths.end())
+            return;
+        if (--it->second == 0)
+            g_watchedPaths.erase(it);
+    }
+
+    // Nothing tells us about changes anymore
+    Invalidate(path, true);
+}
+
+void GetStats(Stats& stats)
+{
+    AutoLock lock(g_lock);
+    stats = g_stats;
+    stats.entries = g_entries.size();
+}
+
+} // namespace MetadataCache
+} // namespace FileSystem
+} // namespace Brackets
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_METADATA_CACHE_H
+#define _BRACKETS_FS_METADATA_CACHE_H
+
+#include "brackets_fs.h"
+
+#include <string>
+
+/**
+ * Cache of Stat() and ReadDir() results, used by brackets_fs.cpp. The file
+ * tree, quick open and the focus check ask for the same paths over and over.
+ *
+ * Listings of a directory are served as long as the directory's modification
+ * time hasn't changed, which takes one stat instead of reading the directory.
+ * A path that the watcher (brackets_fs_watcher.h) is watching with a backend
+ * that reports changes right away, and the files directly in such a
+ * directory, are served without touching the disk at all, until a change
+ * notification invalidates them. Subdirectories are not: the watch doesn't
+ * see the changes inside them.
+ *
+ * The cache holds at most kMaxEntries paths and drops the least recently used
+ * ones. All functions can be called from any thread.
+ */
+namespace Brackets {
+namespace FileSystem {
+namespace MetadataCache {
+
+const size_t kMaxEntries = 20000;
+
+struct Stats {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+    unsigned long long invalidations;
+    size_t entries;
+};
+
+// Returns a number that changes with every invalidation. Get it before
+// reading from the disk and pass it to Store*(), so a result that may be
+// older than an invalidation is not stored.
+unsigned int GetGeneration();
+
+bool LookupStat(const std::string& path, FileInfo& info);
+void StoreStat(const std::string& path, const FileInfo& info, unsigned int generation);
+
+// On a miss, dirMtime is set to the directory's modification time if it had
+// to be looked up, or to -1. Pass it on to StoreDir().
+bool LookupDir(const std::string& path, bool withInfo, DirEntryList& entries, double& dirMtime);
+void StoreDir(const std::string& path, bool withInfo, const DirEntryList& entries, double dirMtime,
+              unsigned int generation);
+
+// Forgets path and the listing of its parent directory. If withContents is
+// true, everything below path is forgotten too.
+void Invalidate(const std::string& path, bool withContents);
+
+// Called by the watcher for paths it gets change notifications for right
+// away. Calls nest.
+void AddWatchedPath(const std::string& path);
+void RemoveWatchedPath(const std::string& path);
+
+void GetStats(Stats& stats);
+
+} // namespace MetadataCache
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_METADATA_CACHE_H
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_PLATFORM_H
+#define _BRACKETS_FS_PLATFORM_H
+
+#include "brackets_fs.h"
+
+/**
+ * Interface implemented by each file system backend (brackets_fs_posix.cpp,
+ * brackets_fs_win.cpp). Arguments have already been validated by the
+ * platform-neutral layer in brackets_fs.cpp. Only that layer should call
+ * these functions.
+ */
+namespace Brackets {
+namespace FileSystem {
+namespace Platform {
+
+int ReadDir(const std::string& path, DirEntryList& entries, bool withInfo);
+int Stat(const std::string& path, FileInfo& info);
+// Fills in results[begin, end) for paths[begin, end). Called concurrently
+// for different ranges.
+void StatMany(const std::vector<std::string>& paths, size_t begin, size_t end, StatResultList& results);
+// Also fills in info if it's not NULL, which saves a Stat()
+int GetFileId(const std::string& path, FileId& id, FileInfo* info = NULL);
+int ReadFile(const std::string& path, std::string& contents);
+// Reads at most length bytes at offset. Reading past the end is not an error.
+int ReadFileRange(const std::string& path, long long offset, size_t length, std::string& data, long long& fileSize);
+// Replaces the file with a temporary file where possible, see
+// FileSystem::WriteFile()
+int WriteFile(const std::string& path, const char* data, size_t length, SyncPolicy sync);
+int SetPosixPermissions(const std::string& path, int mode);
+int DeleteFileOrDirectory(const std::string& path);
+// Returns ERR_NOT_DIRECTORY if path is a symlink or not a directory
+int DeleteFilesIn(const std::string& path, std::vector<std::string>& subdirectories, DeleteFailureList& failures,
+                  DeleteObserver* observer);
+int DeleteEmptyDirectory(const std::string& path);
+// Creates a single directory
+int MakeDir(const std::string& path, int mode);
+// Sets crossDevice if the paths are on different volumes
+int Rename(const std::string& oldPath, const std::string& newPath, bool& crossDevice);
+int CopyFileTo(const std::string& path, const std::string& newPath, CopyObserver* observer);
+
+} // namespace Platform
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_PLATFORM_H
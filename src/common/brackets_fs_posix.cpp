@@ -0,0 +1,932 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_platform.h"
+#include "brackets_threading.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+
+// Linux has the *at() family and getdents64, which let us read a directory in
+// large batches and resolve its entries relative to a directory descriptor.
+// Mac OS X 10.5 (our deployment target) has neither, so it falls back to
+// readdir() and full paths.
+#define BRACKETS_FS_USE_AT_CALLS 1
+
+// Not in the headers of older distributions
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#ifndef RENAME_NOREPLACE
+#define RENAME_NOREPLACE (1 << 0)
+#endif
+#endif
+
+#if defined(__APPLE__)
+#include <copyfile.h>
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+namespace Brackets {
+namespace FileSystem {
+namespace Platform {
+
+namespace {
+
+// Size of the buffer handed to getdents64. Big enough to read most
+// directories with a single system call.
+const size_t kDirBufferSize = 32 * 1024;
+
+// Bytes copied by CopyFileTo() between two calls to the CopyObserver
+const size_t kCopyChunkSize = 8 * 1024 * 1024;
+
+EntryType EntryTypeFromMode(mode_t mode)
+{
+    if (S_ISDIR(mode))
+        return ENTRY_DIRECTORY;
+    if (S_ISREG(mode))
+        return ENTRY_FILE;
+    return ENTRY_UNKNOWN;
+}
+
+void FileInfoFromStat(const struct stat& st, FileInfo& info)
+{
+    info.isDir = S_ISDIR(st.st_mode);
+#if defined(__APPLE__)
+    info.mtime = st.st_mtimespec.tv_sec + st.st_mtimespec.tv_nsec / 1e9;
+#else
+    info.mtime = st.st_mtim.tv_sec + st.st_mtim.tv_nsec / 1e9;
+#endif
+    info.size = st.st_size;
+}
+
+// An open directory that names can be resolved against.
+class DirHandle {
+public:
+    DirHandle()
+#if BRACKETS_FS_USE_AT_CALLS
+        : m_fd(-1)
+#endif
+    {
+    }
+
+    ~DirHandle()
+    {
+        Close();
+    }
+
+    // Returns an errno value: ENOTDIR if path is not a directory, or ELOOP if
+    // it is a symlink and followLinks is false
+    int Open(const std::string& path, bool followLinks = true)
+    {
+        Close();
+#if BRACKETS_FS_USE_AT_CALLS
+        int flags = followLinks ? 0 : O_NOFOLLOW;
+        m_fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | flags);
+        return (m_fd == -1) ? errno : 0;
+#else
+        struct stat st;
+        if ((followLinks ? stat(path.c_str(), &st) : lstat(path.c_str(), &st)) == -1)
+            return errno;
+        if (S_ISLNK(st.st_mode))
+            return ELOOP;
+        if (!S_ISDIR(st.st_mode))
+            return ENOTDIR;
+        m_path = path;
+        return 0;
+#endif
+    }
+
+    // Opens the directory |name| inside |parent| without following symlinks.
+    // Returns an errno value
+    int OpenAt(const DirHandle& parent, const std::string& name)
+    {
+        Close();
+#if BRACKETS_FS_USE_AT_CALLS
+        m_fd = openat(parent.m_fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        return (m_fd == -1) ? errno : 0;
+#else
+        std::string path = parent.PathOf(name);
+        struct stat st;
+        if (lstat(path.c_str(), &st) == -1)
+            return errno;
+        if (!S_ISDIR(st.st_mode))
+            return ENOTDIR;
+        m_path = path;
+        return 0;
+#endif
+    }
+
+    void Close()
+    {
+#if BRACKETS_FS_USE_AT_CALLS
+        if (m_fd != -1) {
+            close(m_fd);
+            m_fd = -1;
+        }
+#else
+        m_path.clear();
+#endif
+    }
+
+    // Returns an errno value
+    int StatAt(const std::string& name, struct stat& st, bool followLinks) const
+    {
+#if BRACKETS_FS_USE_AT_CALLS
+        int flags = followLinks ? 0 : AT_SYMLINK_NOFOLLOW;
+        return (fstatat(m_fd, name.c_str(), &st, flags) == -1) ? errno : 0;
+#else
+        std::string path = PathOf(name);
+        int result = followLinks ? stat(path.c_str(), &st) : lstat(path.c_str(), &st);
+        return (result == -1) ? errno : 0;
+#endif
+    }
+
+    // Returns an errno value
+    int UnlinkAt(const std::string& name, bool isDir) const
+    {
+#if BRACKETS_FS_USE_AT_CALLS
+        return (unlinkat(m_fd, name.c_str(), isDir ? AT_REMOVEDIR : 0) == -1) ? errno : 0;
+#else
+        std::string path = PathOf(name);
+        int result = isDir ? rmdir(path.c_str()) : unlink(path.c_str());
+        return (result == -1) ? errno : 0;
+#endif
+    }
+
+    // Reads all entries except '.' and '..'. Symlinks and entries with an
+    // unknown d_type are resolved with a stat of the target, as is every
+    // entry if withInfo is true. Returns an errno value
+    int Read(DirEntryList& entries, bool withInfo) const
+    {
+#if BRACKETS_FS_USE_AT_CALLS
+        // Read from the start even if the descriptor was read before
+        if (lseek(m_fd, 0, SEEK_SET) == -1)
+            return errno;
+
+        std::vector<char> buffer(kDirBufferSize);
+        for (;;) {
+            long count = syscall(SYS_getdents64, m_fd, &buffer[0], buffer.size());
+            if (count == -1)
+                return errno;
+            if (count == 0)
+                break;
+
+            for (long offset = 0; offset < count; ) {
+                const struct dirent64* ent = reinterpret_cast<const struct dirent64*>(&buffer[offset]);
+                offset += ent->d_reclen;
+                AddEntry(ent->d_name, ent->d_type, withInfo, entries);
+            }
+        }
+        return 0;
+#else
+        DIR* dir = opendir(m_path.c_str());
+        if (!dir)
+            return errno;
+
+        struct dirent* ent;
+        errno = 0;
+        while ((ent = readdir(dir)) != NULL) {
+            AddEntry(ent->d_name, ent->d_type, withInfo, entries);
+            errno = 0;
+        }
+        int error = errno;
+        closedir(dir);
+        return error;
+#endif
+    }
+
+private:
+    void AddEntry(const char* name, unsigned char type, bool withInfo, DirEntryList& entries) const
+    {
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            return;
+
+        entries.push_back(DirEntry());
+        DirEntry& entry = entries.back();
+        entry.name = name;
+        entry.info.isDir = false;
+        entry.info.mtime = 0;
+        entry.info.size = 0;
+
+        if (withInfo) {
+            struct stat st;
+            if (StatAt(entry.name, st, true) == 0) {
+                entry.type = EntryTypeFromMode(st.st_mode);
+                FileInfoFromStat(st, entry.info);
+            } else {
+                entry.type = ENTRY_UNKNOWN;
+            }
+            return;
+        }
+
+        switch (type) {
+        case DT_DIR:
+            entry.type = ENTRY_DIRECTORY;
+            break;
+        case DT_REG:
+            entry.type = ENTRY_FILE;
+            break;
+        default: {
+            // DT_LNK, DT_UNKNOWN (some file systems don't fill in d_type) and
+            // special files. Report what the entry points to.
+            struct stat st;
+            entry.type = (StatAt(entry.name, st, true) == 0) ? EntryTypeFromMode(st.st_mode) : ENTRY_UNKNOWN;
+            break;
+        }
+        }
+    }
+
+#if BRACKETS_FS_USE_AT_CALLS
+    int m_fd;
+#else
+    std::string PathOf(const std::string& name) const
+    {
+        if (!m_path.empty() && m_path[m_path.length() - 1] == '/')
+            return m_path + name;
+        return m_path + "/" + name;
+    }
+
+    std::string m_path;
+#endif
+
+    // Not copyable
+    DirHandle(const DirHandle&);
+    DirHandle& operator=(const DirHandle&);
+};
+
+// Removes everything inside |dir|. Returns an errno value
+int RemoveContents(const DirHandle& dir)
+{
+    DirEntryList entries;
+    int error = dir.Read(entries, false);
+    if (error)
+        return error;
+
+    for (DirEntryList::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        // Don't trust the (followed) entry type: a symlink to a directory must
+        // be unlinked, not descended into.
+        struct stat st;
+        error = dir.StatAt(it->name, st, false);
+        if (error)
+            return error;
+
+        if (S_ISDIR(st.st_mode)) {
+            DirHandle child;
+            error = child.OpenAt(dir, it->name);
+            if (!error)
+                error = RemoveContents(child);
+            if (error)
+                return error;
+        }
+
+        error = dir.UnlinkAt(it->name, S_ISDIR(st.st_mode));
+        if (error)
+            return error;
+    }
+
+    return 0;
+}
+
+void ClearFileInfo(FileInfo& info)
+{
+    info.isDir = false;
+    info.mtime = 0;
+    info.size = 0;
+}
+
+// Returns 0 or the errno value
+int WriteAll(int fd, const char* data, size_t length)
+{
+    while (length > 0) {
+        ssize_t count = write(fd, data, length);
+        if (count == -1) {
+            if (errno == EINTR)
+                continue;
+            return errno;
+        }
+        data += count;
+        length -= count;
+    }
+    return 0;
+}
+
+// Returns 0 or the errno value
+int SyncFile(int fd, SyncPolicy sync)
+{
+#if defined(__APPLE__)
+    // fsync() doesn't flush the drive's write cache on Mac
+    if (sync == SYNC_FULL && fcntl(fd, F_FULLFSYNC) != -1)
+        return 0;
+#endif
+    if (sync != SYNC_NONE && fsync(fd) == -1)
+        return errno;
+    return 0;
+}
+
+void SyncDirectory(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return;
+
+    // Not every file system can sync a directory. The file itself is safe
+    // either way, so errors are ignored.
+    fsync(fd);
+    close(fd);
+}
+
+int WriteFileInPlace(const std::string& path, const char* data, size_t length, SyncPolicy sync)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd == -1)
+        return ConvertErrnoCode(errno, false);
+
+    int error = WriteAll(fd, data, length);
+    if (!error)
+        error = SyncFile(fd, sync);
+
+    if (close(fd) == -1 && !error)
+        error = errno;
+
+    return ConvertErrnoCode(error, false);
+}
+
+Lock g_tempFileLock;
+unsigned int g_nextTempFileId = 0;
+
+// Creates a new, empty file for writing in the directory of path, named
+// after it. Returns the descriptor, or -1 with errno set.
+int CreateTempFile(const std::string& path, std::string& tempPath)
+{
+    size_t slash = path.rfind('/');
+    std::string dir = (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+    for (int attempt = 0; attempt < 100; attempt++) {
+        unsigned int id;
+        {
+            AutoLock lock(g_tempFileLock);
+            id = g_nextTempFileId++;
+        }
+
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%x.%x~", (unsigned int)getpid(), id);
+        tempPath = dir + "." + name + suffix;
+
+        // Created with the same default permissions as a new file
+        int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd != -1 || errno != EEXIST)
+            return fd;
+    }
+
+    errno = EEXIST;
+    return -1;
+}
+
+#if defined(__linux__)
+// The ways CopyFileTo() can move data between two descriptors, best first
+enum CopyMethod {
+    COPY_FILE_RANGE,    // in the kernel, or offloaded to the file system
+    COPY_SENDFILE,      // in the kernel
+    COPY_READ_WRITE
+};
+
+// Copies one chunk of at most length bytes with method. Returns the number of
+// bytes copied, 0 at the end of the file, or -1 with errno set.
+ssize_t CopyChunk(CopyMethod method, int from, int to, size_t length, std::vector<char>& buffer)
+{
+    switch (method) {
+    case COPY_FILE_RANGE:
+#if defined(SYS_copy_file_range)
+        return syscall(SYS_copy_file_range, from, NULL, to, NULL, length, 0);
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+    case COPY_SENDFILE:
+        return sendfile(to, from, NULL, length);
+    default:
+        break;
+    }
+
+    buffer.resize(1024 * 1024);
+    ssize_t count = read(from, &buffer[0], buffer.size() < length ? buffer.size() : length);
+    if (count > 0 && WriteAll(to, &buffer[0], count) != 0)
+        return -1;
+    return count;
+}
+
+// Returns true if method can't be used on these files, but the next one
+// might. Nothing was copied yet when this happens.
+bool IsUnsupported(int error)
+{
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP || error == ENOTSUP ||
+           error == EBADF;
+}
+#endif
+
+// Copies the data of the open file from to the open file to. Returns an
+// errno value, or ECANCELED if observer stopped the copy.
+int CopyData(int from, int to, long long size, CopyObserver* observer)
+{
+#if defined(__linux__)
+    // A reflink shares the blocks of the file instead of copying them, on
+    // file systems like Btrfs and XFS
+    if (ioctl(to, FICLONE, from) == 0) {
+        if (observer && !observer->OnBytesCopied(size))
+            return ECANCELED;
+        return 0;
+    }
+
+    CopyMethod method = COPY_FILE_RANGE;
+    bool copied = false;
+    std::vector<char> buffer;
+    for (;;) {
+        ssize_t count = CopyChunk(method, from, to, kCopyChunkSize, buffer);
+        if (count == -1) {
+            if (errno == EINTR)
+                continue;
+            if (!copied && method != COPY_READ_WRITE && IsUnsupported(errno)) {
+                method = (CopyMethod)(method + 1);
+                continue;
+            }
+            return errno;
+        }
+        if (count == 0)
+            return 0;
+
+        copied = true;
+        if (observer && !observer->OnBytesCopied(count))
+            return ECANCELED;
+    }
+#else
+    // Mac OS X 10.5 has no way to report progress from copyfile()
+    if (fcopyfile(from, to, NULL, COPYFILE_DATA) == -1)
+        return errno;
+    if (observer && !observer->OnBytesCopied(size))
+        return ECANCELED;
+    return 0;
+#endif
+}
+
+#if BRACKETS_FS_USE_AT_CALLS
+// A path of a StatMany() batch, split into parent directory and name
+struct SplitPath {
+    const std::string* path;
+    size_t index;
+    size_t slash;
+
+    bool SameParent(const SplitPath& other) const
+    {
+        return slash == other.slash && path->compare(0, slash, *other.path, 0, slash) == 0;
+    }
+
+    bool operator<(const SplitPath& other) const
+    {
+        int result = path->compare(0, slash, *other.path, 0, other.slash);
+        return (result != 0) ? (result < 0) : (index < other.index);
+    }
+};
+#endif
+
+} // namespace
+
+int ReadDir(const std::string& path, DirEntryList& entries, bool withInfo)
+{
+    DirHandle dir;
+    int error = dir.Open(path);
+    if (!error)
+        error = dir.Read(entries, withInfo);
+
+    return ConvertErrnoCode(error, true);
+}
+
+int Stat(const std::string& path, FileInfo& info)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) == -1)
+        return ConvertErrnoCode(errno, true);
+
+    FileInfoFromStat(st, info);
+    return NO_ERROR;
+}
+
+void StatMany(const std::vector<std::string>& paths, size_t begin, size_t end, StatResultList& results)
+{
+#if BRACKETS_FS_USE_AT_CALLS
+    // Group the paths by parent directory. Directories with more than one
+    // path are opened once and the names are looked up with fstatat(), so
+    // the kernel doesn't walk the whole path again for every file.
+    std::vector<SplitPath> split;
+    split.reserve(end - begin);
+#endif
+
+    for (size_t i = begin; i < end; i++) {
+        const std::string& path = paths[i];
+        StatResult& result = results[i];
+        ClearFileInfo(result.info);
+
+        if (path.empty()) {
+            result.error = ERR_INVALID_PARAMS;
+            continue;
+        }
+
+#if BRACKETS_FS_USE_AT_CALLS
+        size_t slash = path.rfind('/');
+        if (slash != std::string::npos && slash != 0 && slash != path.length() - 1) {
+            SplitPath item = { &path, i, slash };
+            split.push_back(item);
+            continue;
+        }
+#endif
+
+        result.error = Platform::Stat(path, result.info);
+        if (result.error != NO_ERROR)
+            ClearFileInfo(result.info);
+    }
+
+#if BRACKETS_FS_USE_AT_CALLS
+    std::sort(split.begin(), split.end());
+
+    DirHandle dir;
+    for (size_t i = 0; i < split.size(); ) {
+        // Find the paths with the same parent
+        size_t groupEnd = i + 1;
+        while (groupEnd < split.size() && split[groupEnd].SameParent(split[i]))
+            groupEnd++;
+
+        // For a single path, stat() is cheaper than open + fstatat + close
+        bool useDir = (groupEnd - i > 1 && dir.Open(split[i].path->substr(0, split[i].slash)) == 0);
+
+        for (; i < groupEnd; i++) {
+            const std::string& path = *split[i].path;
+            StatResult& result = results[split[i].index];
+
+            int error;
+            struct stat st;
+            if (useDir)
+                error = dir.StatAt(path.substr(split[i].slash + 1), st, true);
+            else
+                error = (stat(path.c_str(), &st) == -1) ? errno : 0;
+
+            result.error = ConvertErrnoCode(error, true);
+            if (result.error == NO_ERROR)
+                FileInfoFromStat(st, result.info);
+        }
+    }
+#endif
+}
+
+int GetFileId(const std::string& path, FileId& id, FileInfo* info)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) == -1)
+        return ConvertErrnoCode(errno, true);
+
+    id.device = st.st_dev;
+    id.inode = st.st_ino;
+    if (info)
+        FileInfoFromStat(st, *info);
+    return NO_ERROR;
+}
+
+int ReadFile(const std::string& path, std::string& contents)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return ConvertErrnoCode(errno, true);
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        int error = errno;
+        close(fd);
+        return ConvertErrnoCode(error, true);
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        close(fd);
+        return ERR_CANT_READ;
+    }
+
+    // The size is only a hint: some files (e.g. in /proc) report a size of 0,
+    // and the file may change while we read it. Read until end of file.
+    size_t used = 0;
+    contents.resize(st.st_size > 0 ? (size_t)st.st_size : 4096);
+    for (;;) {
+        if (used == contents.size())
+            contents.resize(contents.size() * 2);
+
+        ssize_t count = read(fd, &contents[used], contents.size() - used);
+        if (count == -1) {
+            if (errno == EINTR)
+                continue;
+            int error = errno;
+            close(fd);
+            contents.clear();
+            return ConvertErrnoCode(error, true);
+        }
+        if (count == 0)
+            break;
+        used += count;
+    }
+    contents.resize(used);
+
+    close(fd);
+    return NO_ERROR;
+}
+
+int ReadFileRange(const std::string& path, long long offset, size_t length, std::string& data, long long& fileSize)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return ConvertErrnoCode(errno, true);
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        int error = errno;
+        close(fd);
+        return ConvertErrnoCode(error, true);
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        close(fd);
+        return ERR_CANT_READ;
+    }
+
+    fileSize = st.st_size;
+    if (offset >= fileSize)
+        length = 0;
+    else if ((unsigned long long)(fileSize - offset) < length)
+        length = (size_t)(fileSize - offset);
+
+    size_t used = 0;
+    data.resize(length);
+    while (used < length) {
+        ssize_t count = pread(fd, &data[used], length - used, (off_t)(offset + used));
+        if (count == -1) {
+            if (errno == EINTR)
+                continue;
+            int error = errno;
+            close(fd);
+            data.clear();
+            return ConvertErrnoCode(error, true);
+        }
+        // The file got shorter since fstat()
+        if (count == 0)
+            break;
+        used += count;
+    }
+    data.resize(used);
+
+    close(fd);
+    return NO_ERROR;
+}
+
+int WriteFile(const std::string& path, const char* data, size_t length, SyncPolicy sync)
+{
+    // Replacing the file would break symlinks and hard links, and would take
+    // over files owned by someone else. Those, and files we can't write to
+    // anyway (so they fail like before), are written in place.
+    struct stat st;
+    bool exists = (lstat(path.c_str(), &st) == 0);
+    if (exists && (!S_ISREG(st.st_mode) || st.st_nlink > 1 || st.st_uid != geteuid() ||
+                   access(path.c_str(), W_OK) == -1))
+        return WriteFileInPlace(path, data, length, sync);
+
+    // E.g. the directory isn't writable, or the name is too long to add a
+    // suffix
+    std::string tempPath;
+    int fd = CreateTempFile(path, tempPath);
+    if (fd == -1)
+        return WriteFileInPlace(path, data, length, sync);
+
+    int error = 0;
+    if (exists && fchmod(fd, st.st_mode & 07777) == -1)
+        error = errno;
+    if (!error)
+        error = WriteAll(fd, data, length);
+    if (!error)
+        error = SyncFile(fd, sync);
+
+    if (close(fd) == -1 && !error)
+        error = errno;
+
+    if (!error && rename(tempPath.c_str(), path.c_str()) == -1)
+        error = errno;
+
+    if (error) {
+        unlink(tempPath.c_str());
+        return ConvertErrnoCode(error, false);
+    }
+
+    if (sync == SYNC_FULL) {
+        size_t slash = path.rfind('/');
+        SyncDirectory((slash == std::string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash));
+    }
+
+    return NO_ERROR;
+}
+
+int SetPosixPermissions(const std::string& path, int mode)
+{
+    if (chmod(path.c_str(), (mode_t)mode) == -1)
+        return ConvertErrnoCode(errno, false);
+
+    return NO_ERROR;
+}
+
+int DeleteFileOrDirectory(const std::string& path)
+{
+    struct stat st;
+    if (lstat(path.c_str(), &st) == -1)
+        return ConvertErrnoCode(errno, false);
+
+    if (S_ISDIR(st.st_mode)) {
+        DirHandle dir;
+        int error = dir.Open(path);
+        if (!error)
+            error = RemoveContents(dir);
+        dir.Close();
+        if (!error && rmdir(path.c_str()) == -1)
+            error = errno;
+        return ConvertErrnoCode(error, false);
+    }
+
+    if (unlink(path.c_str()) == -1)
+        return ConvertErrnoCode(errno, false);
+
+    return NO_ERROR;
+}
+
+int DeleteFilesIn(const std::string& path, std::vector<std::string>& subdirectories, DeleteFailureList& failures,
+                  DeleteObserver* observer)
+{
+    DirHandle dir;
+    int error = dir.Open(path, false);
+    if (error == ENOTDIR || error == ELOOP)
+        return ERR_NOT_DIRECTORY;
+
+    DirEntryList entries;
+    if (!error)
+        error = dir.Read(entries, false);
+    if (error)
+        return ConvertErrnoCode(error);
+
+    std::string prefix = path;
+    if (prefix[prefix.length() - 1] != '/')
+        prefix += '/';
+
+    for (DirEntryList::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        // Most entries are files, so unlink first and only look at what the
+        // entry is when that fails. Directories fail with EISDIR on Linux
+        // and EPERM on Mac. The entry types from Read() follow symlinks, which
+        // must be deleted rather than descended into.
+        error = dir.UnlinkAt(it->name, false);
+        if (error == EISDIR || error == EPERM) {
+            struct stat st;
+            if (dir.StatAt(it->name, st, false) == 0 && S_ISDIR(st.st_mode)) {
+                subdirectories.push_back(it->name);
+                continue;
+            }
+        }
+
+        // Gone already
+        if (error == ENOENT)
+            continue;
+
+        if (error) {
+            DeleteFailure failure;
+            failure.path = prefix + it->name;
+            failure.error = ConvertErrnoCode(error, false);
+            failures.push_back(failure);
+            continue;
+        }
+
+        if (observer && !observer->OnEntryDeleted())
+            break;
+    }
+
+    return NO_ERROR;
+}
+
+int DeleteEmptyDirectory(const std::string& path)
+{
+    if (rmdir(path.c_str()) == -1)
+        return ConvertErrnoCode(errno, false);
+
+    return NO_ERROR;
+}
+
+int MakeDir(const std::string& path, int mode)
+{
+    if (mkdir(path.c_str(), (mode_t)mode) == -1)
+        return ConvertErrnoCode(errno, false);
+
+    return NO_ERROR;
+}
+
+int Rename(const std::string& oldPath, const std::string& newPath, bool& crossDevice)
+{
+    crossDevice = false;
+
+#if defined(__linux__) && defined(SYS_renameat2)
+    // Atomic where the kernel and the file system support it. EEXIST may be
+    // oldPath itself, on a file system that ignores case, so that is left to
+    // the check below.
+    if (syscall(SYS_renameat2, AT_FDCWD, oldPath.c_str(), AT_FDCWD, newPath.c_str(), RENAME_NOREPLACE) == 0)
+        return NO_ERROR;
+    if (errno != ENOSYS && errno != EINVAL && errno != EEXIST) {
+        crossDevice = (errno == EXDEV);
+        return ConvertErrnoCode(errno, false);
+    }
+#endif
+
+    // rename() replaces newPath. A file system that ignores case finds
+    // oldPath itself under a new case, which is fine to rename.
+    struct stat oldSt, newSt;
+    if (lstat(oldPath.c_str(), &oldSt) == -1)
+        return ConvertErrnoCode(errno, false);
+    if (lstat(newPath.c_str(), &newSt) == 0 && (oldSt.st_dev != newSt.st_dev || oldSt.st_ino != newSt.st_ino))
+        return ERR_FILE_EXISTS;
+
+    if (rename(oldPath.c_str(), newPath.c_str()) == -1) {
+        crossDevice = (errno == EXDEV);
+        return ConvertErrnoCode(errno, false);
+    }
+
+    return NO_ERROR;
+}
+
+int CopyFileTo(const std::string& path, const std::string& newPath, CopyObserver* observer)
+{
+    int from = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (from == -1)
+        return ConvertErrnoCode(errno);
+
+    struct stat st;
+    int error = (fstat(from, &st) == -1) ? ConvertErrnoCode(errno) : S_ISDIR(st.st_mode) ? ERR_NOT_FILE : NO_ERROR;
+    if (error != NO_ERROR) {
+        close(from);
+        return error;
+    }
+
+    int to = open(newPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 07777);
+    if (to == -1) {
+        error = errno;
+        close(from);
+        return ConvertErrnoCode(error, false);
+    }
+
+    error = CopyData(from, to, st.st_size, observer);
+    if (close(to) == -1 && !error)
+        error = errno;
+    close(from);
+
+    if (error) {
+        unlink(newPath.c_str());
+        return (error == ECANCELED) ? ERR_UNKNOWN : ConvertErrnoCode(error, false);
+    }
+
+    return NO_ERROR;
+}
+
+} // namespace Platform
+} // namespace FileSystem
+} // namespace Brackets
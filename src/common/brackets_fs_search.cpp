@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_search.h"
+#include "brackets_encoding.h"
+#include "brackets_fs_walker.h"
+#include "brackets_regex.h"
+#include "brackets_worker_pool.h"
+
+#include <map>
+#include <string.h>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+class Search;
+
+// Files searched by one WorkerTask. Enough to make the task worth posting,
+// few enough for the first matches to show up quickly.
+const size_t kFilesPerTask = 16;
+
+// Files with a NUL byte this close to the start are taken as binary, like
+// git does
+const size_t kBinaryCheckLength = 8000;
+
+// Long lines, e.g. minified files, are shortened in the preview to this many
+// bytes, starting a little before the match
+const size_t kMaxPreviewLength = 200;
+const size_t kPreviewContext = 50;
+
+// Searches in progress, by id, so they can be cancelled
+Lock g_searchesLock;
+std::map<int, Search*> g_searches;
+int g_nextSearchId = 1;
+
+inline bool IsContinuationByte(char c)
+{
+    return ((unsigned char)c & 0xC0) == 0x80;
+}
+
+class Search {
+public:
+    Search(int id, const std::string& root, const SearchOptions& options, SearchDelegate* delegate)
+        : m_id(id)
+        , m_root(root)
+        , m_options(options)
+        , m_delegate(delegate)
+        , m_pending(0)
+        , m_walkId(0)
+        , m_cancelled(false)
+        , m_truncated(false)
+        , m_rootError(NO_ERROR)
+        , m_resultCount(0)
+    {
+        // Paths are appended as m_root + "/" + relative path, see Walk
+        if (m_root.length() > 1 && m_root[m_root.length() - 1] == '/')
+            m_root.erase(m_root.length() - 1);
+        if (m_root == "/")
+            m_root.clear();
+    }
+
+    ~Search()
+    {
+        delete m_delegate;
+    }
+
+    // Returns false if query can't be searched for
+    bool Compile(const std::string& query)
+    {
+        if (!m_options.isRegexp) {
+            m_literal = m_options.ignoreCase ? FoldLiteral(query) : query;
+            return !query.empty();
+        }
+
+        if (!m_regex.Compile(query, m_options.ignoreCase))
+            return false;
+        m_literal = m_regex.GetRequiredLiteral();
+        return true;
+    }
+
+    void Start(const std::string& root);
+
+    // Returns the id of the walk, which has to be cancelled without holding
+    // g_searchesLock, see CancelSearch()
+    int Cancel()
+    {
+        AutoLock lock(m_lock);
+        m_cancelled = true;
+        return m_walkId;
+    }
+
+    // Called by SearchWalkDelegate with the paths the walk found
+    void OnWalkBatch(std::vector<std::string>& paths)
+    {
+        WorkerPool* pool = WorkerPool::GetInstance();
+        std::vector<std::vector<std::string> > groups;
+        {
+            AutoLock lock(m_lock);
+            if (m_cancelled || !pool)
+                return;
+
+            for (size_t i = 0; i < paths.size(); i++) {
+                const std::string& path = paths[i];
+                if (path.empty() || path[path.length() - 1] == '/')
+                    continue;
+
+                if (groups.empty() || groups.back().size() == kFilesPerTask)
+                    groups.push_back(std::vector<std::string>());
+                groups.back().push_back(m_root + "/" + path);
+            }
+
+            // Counted before they are posted, see Walk::ReadDirectory()
+            m_pending += (int)groups.size();
+        }
+
+        for (size_t i = 0; i < groups.size(); i++)
+            pool->PostTask(CreateTask(groups[i]));
+    }
+
+    void OnWalkDone(int error)
+    {
+        {
+            AutoLock lock(m_lock);
+            m_rootError = error;
+        }
+        Release();
+    }
+
+    // Searches files and delivers their matches. Runs on the worker threads.
+    void SearchFiles(const std::vector<std::string>& paths)
+    {
+        SearchMatchList matches;
+        for (size_t i = 0; i < paths.size() && !IsCancelled(); i++)
+            SearchFile(paths[i], matches);
+
+        if (!matches.empty())
+            Deliver(matches);
+        Release();
+    }
+
+private:
+    WorkerTask* CreateTask(const std::vector<std::string>& paths);
+
+    bool IsCancelled()
+    {
+        AutoLock lock(m_lock);
+        return m_cancelled;
+    }
+
+    // Ends the part of the search that held a reference: the walk, a task or
+    // Start(). The last one finishes the search.
+    void Release()
+    {
+        {
+            AutoLock lock(m_lock);
+            if (--m_pending != 0)
+                return;
+            m_delegate->OnSearchDone(m_rootError, m_cancelled && !m_truncated, m_truncated);
+        }
+
+        {
+            AutoLock lock(g_searchesLock);
+            g_searches.erase(m_id);
+        }
+        delete this;
+    }
+
+    void Deliver(SearchMatchList& matches)
+    {
+        int walkId = 0;
+        {
+            AutoLock lock(m_lock);
+            if (m_cancelled)
+                return;
+
+            if (m_resultCount + matches.size() > m_options.maxResults) {
+                matches.resize(m_options.maxResults - m_resultCount);
+                m_truncated = true;
+                m_cancelled = true;
+                walkId = m_walkId;
+            }
+
+            m_resultCount += matches.size();
+            if (!matches.empty())
+                m_delegate->OnSearchMatches(matches);
+        }
+
+        // See CancelSearch()
+        if (walkId)
+            CancelWalk(walkId);
+    }
+
+    void SearchFile(const std::string& path, SearchMatchList& matches)
+    {
+        FileInfo info;
+        if (Stat(path, info) != NO_ERROR || info.isDir || info.size > m_options.maxFileSize)
+            return;
+
+        // Files that are not UTF-8 are not text, or at least not text the
+        // editor would open without asking
+        std::string contents;
+        if (ReadFile(path, "utf8", contents) != NO_ERROR)
+            return;
+
+        const char* data = contents.data();
+        size_t length = contents.length();
+        if (memchr(data, 0, (length < kBinaryCheckLength) ? length : kBinaryCheckLength))
+            return;
+
+        // The byte order mark is not part of the first line
+        size_t start = (length >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+
+        if (!m_literal.empty() && FindLiteral(data, length, start, m_literal, m_options.ignoreCase) == kNotFound)
+            return;
+
+        size_t lineStart = start;
+        int line = 0;
+
+        while (lineStart <= length && matches.size() < m_options.maxResults) {
+            // Skip straight to the next line that contains the literal
+            if (!m_literal.empty()) {
+                size_t found = FindLiteral(data, length, lineStart, m_literal, m_options.ignoreCase);
+                if (found == kNotFound)
+                    break;
+                while (lineStart < found) {
+                    const char* lineBreak = (const char*)memchr(data + lineStart, '\n', found - lineStart);
+                    if (!lineBreak)
+                        break;
+                    lineStart = lineBreak - data + 1;
+                    line++;
+                }
+            }
+
+            const char* lineBreak = (const char*)memchr(data + lineStart, '\n', length - lineStart);
+            size_t lineEnd = lineBreak ? lineBreak - data : length;
+            size_t textEnd = (lineEnd > lineStart && data[lineEnd - 1] == '\r') ? lineEnd - 1 : lineEnd;
+
+            SearchLine(path, line, data + lineStart, textEnd - lineStart, matches);
+
+            if (!lineBreak)
+                break;
+            lineStart = lineEnd + 1;
+            line++;
+        }
+    }
+
+    void SearchLine(const std::string& path, int line, const char* text, size_t length, SearchMatchList& matches)
+    {
+        size_t pos = 0;
+        while (pos <= length && matches.size() < m_options.maxResults) {
+            size_t matchStart;
+            size_t matchEnd;
+            if (m_options.isRegexp) {
+                if (!m_regex.Search(text, length, pos, matchStart, matchEnd))
+                    break;
+            } else {
+                matchStart = FindLiteral(text, length, pos, m_literal, m_options.ignoreCase);
+                if (matchStart == kNotFound)
+                    break;
+                matchEnd = matchStart + m_literal.length();
+            }
+
+            // Empty matches, e.g. of "a*", are not shown
+            if (matchEnd == matchStart) {
+                pos = matchStart + 1;
+                while (pos < length && IsContinuationByte(text[pos]))
+                    pos++;
+                continue;
+            }
+
+            matches.push_back(SearchMatch());
+            SearchMatch& match = matches.back();
+            match.path = path;
+            match.line = line;
+            match.column = (int)Encoding::CountUTF16Units(text, matchStart);
+            match.length = (int)Encoding::CountUTF16Units(text + matchStart, matchEnd - matchStart);
+            SetPreview(text, length, matchStart, match);
+
+            pos = matchEnd;
+        }
+    }
+
+    static void SetPreview(const char* text, size_t length, size_t matchStart, SearchMatch& match)
+    {
+        if (length <= kMaxPreviewLength) {
+            match.preview.assign(text, length);
+            match.previewColumn = match.column;
+            return;
+        }
+
+        size_t start = (matchStart > kPreviewContext) ? matchStart - kPreviewContext : 0;
+        while (start > 0 && IsContinuationByte(text[start]))
+            start--;
+        size_t previewLength = (length - start < kMaxPreviewLength) ? length - start : kMaxPreviewLength;
+        previewLength = Encoding::FindUTF8Boundary(text + start, previewLength);
+
+        match.preview.assign(text + start, previewLength);
+        match.previewColumn = (int)Encoding::CountUTF16Units(text + start, matchStart - start);
+    }
+
+    int m_id;
+    std::string m_root;
+    SearchOptions m_options;
+    SearchDelegate* m_delegate;
+    Regex m_regex;
+    std::string m_literal;      // Folded if ignoring case
+
+    Lock m_lock;
+    int m_pending;              // The walk, tasks queued or running, and Start()
+    int m_walkId;
+    bool m_cancelled;
+    bool m_truncated;
+    int m_rootError;
+    size_t m_resultCount;
+};
+
+class SearchWalkDelegate : public WalkDelegate {
+public:
+    explicit SearchWalkDelegate(Search* search) : m_search(search) {}
+
+    virtual void OnWalkBatch(std::vector<std::string>& paths)
+    {
+        m_search->OnWalkBatch(paths);
+    }
+
+    virtual void OnWalkDone(int error, bool /* cancelled */)
+    {
+        m_search->OnWalkDone(error);
+    }
+
+private:
+    Search* m_search;
+};
+
+class SearchFilesTask : public WorkerTask {
+public:
+    SearchFilesTask(Search* search, const std::vector<std::string>& paths)
+        : m_search(search), m_paths(paths)
+    {
+    }
+
+    virtual void Run()
+    {
+        m_search->SearchFiles(m_paths);
+    }
+
+    virtual const char* GetName() const { return "SearchFiles"; }
+
+private:
+    Search* m_search;
+    std::vector<std::string> m_paths;
+};
+
+WorkerTask* Search::CreateTask(const std::vector<std::string>& paths)
+{
+    return new SearchFilesTask(this, paths);
+}
+
+void Search::Start(const std::string& root)
+{
+    // Start() holds a reference of its own, so the walk finishing right away
+    // can't delete the search before the walk id is stored
+    m_pending = 2;
+
+    WalkOptions walkOptions;
+    walkOptions.excludes = m_options.excludes;
+    walkOptions.batchSize = kFilesPerTask * 4;
+    int walkId = StartWalk(root, walkOptions, new SearchWalkDelegate(this));
+
+    bool cancelled;
+    {
+        AutoLock lock(m_lock);
+        m_walkId = walkId;
+        cancelled = m_cancelled;
+    }
+
+    if (cancelled)
+        CancelWalk(walkId);
+    Release();
+}
+
+} // namespace
+
+int StartSearch(const std::string& root, const std::string& query, const SearchOptions& options,
+                SearchDelegate* delegate)
+{
+    int id;
+    Search* search;
+    {
+        AutoLock lock(g_searchesLock);
+        id = g_nextSearchId++;
+        search = new Search(id, root, options, delegate);
+    }
+
+    if (root.empty() || !search->Compile(query)) {
+        delegate->OnSearchDone(ERR_INVALID_PARAMS, false, false);
+        delete search;
+        return 0;
+    }
+
+    {
+        AutoLock lock(g_searchesLock);
+        g_searches[id] = search;
+    }
+
+    search->Start(root);
+    return id;
+}
+
+void CancelSearch(int searchId)
+{
+    // CancelWalk() takes the walk's lock, which is held while the walk calls
+    // into the search, and the search takes g_searchesLock when it finishes
+    int walkId = 0;
+    {
+        AutoLock lock(g_searchesLock);
+        std::map<int, Search*>::iterator it = g_searches.find(searchId);
+        if (it != g_searches.end())
+            walkId = it->second->Cancel();
+    }
+
+    if (walkId)
+        CancelWalk(walkId);
+}
+
+} // namespace FileSystem
+} // namespace Brackets
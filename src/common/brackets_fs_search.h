@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_SEARCH_H
+#define _BRACKETS_FS_SEARCH_H
+
+#include "brackets_fs.h"
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Find in Files. The files below a directory are found with StartWalk() and
+ * searched on the shared WorkerPool, a few files per WorkerTask. Matches are
+ * handed to a SearchDelegate as each task finishes, so the first results show
+ * up long before the whole project was searched.
+ *
+ * Files are searched line by line. Text that every match must contain (the
+ * whole query for plain text searches) is looked for first with
+ * FindLiteral(), so most lines are never seen by the regular expression.
+ * Files that are not UTF-8, contain NUL bytes or are larger than
+ * maxFileSize are skipped.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+struct SearchOptions {
+    SearchOptions()
+        : isRegexp(false), ignoreCase(true), maxResults(kDefaultMaxResults), maxFileSize(kDefaultMaxFileSize)
+    {
+    }
+
+    static const size_t kDefaultMaxResults = 10000;
+    static const long long kDefaultMaxFileSize = 16 * 1024 * 1024;
+
+    // The query is a JavaScript regular expression, see brackets_regex.h,
+    // rather than plain text
+    bool isRegexp;
+    bool ignoreCase;
+
+    // Names of files and directories to skip, see WalkOptions
+    std::vector<std::string> excludes;
+
+    // The search stops after this many matches
+    size_t maxResults;
+    long long maxFileSize;
+};
+
+struct SearchMatch {
+    std::string path;       // full path of the file
+    int line;               // 0-based
+    int column;             // 0-based, in UTF-16 code units like JavaScript strings
+    int length;             // in UTF-16 code units
+    std::string preview;    // the line, shortened around the match if it is long
+    int previewColumn;      // column of the match in preview
+};
+
+typedef std::vector<SearchMatch> SearchMatchList;
+
+// Receives the results of a search. Called from the worker threads, never
+// more than one call at a time.
+class SearchDelegate {
+public:
+    virtual ~SearchDelegate() {}
+
+    // The matches of one or more files, in order within each file. The
+    // delegate may swap the contents out of matches.
+    virtual void OnSearchMatches(SearchMatchList& matches) = 0;
+
+    // Called once, after the last matches. error is the error reading root.
+    // cancelled is true if CancelSearch() stopped the search early, truncated
+    // is true if it stopped because maxResults matches were found.
+    virtual void OnSearchDone(int error, bool cancelled, bool truncated) = 0;
+};
+
+// Starts searching the files below root for query. ERR_INVALID_PARAMS is
+// passed to OnSearchDone() right away if query is empty or not a regular
+// expression that is supported. The search takes ownership of the delegate
+// and deletes it after OnSearchDone(). Returns an id for CancelSearch().
+int StartSearch(const std::string& root, const std::string& query, const SearchOptions& options,
+                SearchDelegate* delegate);
+
+// Stops a search started by StartSearch(). Files that are being searched
+// finish, and OnSearchDone() is still called. Does nothing if the search
+// already finished.
+void CancelSearch(int searchId);
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_SEARCH_H
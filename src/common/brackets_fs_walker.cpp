@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_walker.h"
+#include "brackets_worker_pool.h"
+
+#include <map>
+#include <set>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+class Walk;
+class WalkDirectoryTask;
+
+// Walks in progress, by id, so they can be cancelled
+Lock g_walksLock;
+std::map<int, Walk*> g_walks;
+int g_nextWalkId = 1;
+
+class Walk {
+public:
+    Walk(int id, const std::string& root, const WalkOptions& options, WalkDelegate* delegate)
+        : m_id(id)
+        , m_root(root)
+        , m_excludes(options.excludes.begin(), options.excludes.end())
+        , m_batchSize(options.batchSize ? options.batchSize : 1)
+        , m_delegate(delegate)
+        , m_pending(0)
+        , m_cancelled(false)
+        , m_rootError(NO_ERROR)
+    {
+        // Entries are appended as m_root + "/" + name
+        if (m_root.length() > 1 && m_root[m_root.length() - 1] == '/')
+            m_root.erase(m_root.length() - 1);
+        if (m_root == "/")
+            m_root.clear();
+    }
+
+    ~Walk()
+    {
+        delete m_delegate;
+    }
+
+    void Start(WorkerPool* pool)
+    {
+        m_pending = 1;
+        pool->PostTask(CreateTask(""));
+    }
+
+    void Cancel()
+    {
+        AutoLock lock(m_lock);
+        m_cancelled = true;
+    }
+
+    // Lists one directory, queues its subdirectories and delivers its entries.
+    // relativePath is empty for the root, otherwise it ends with a '/'.
+    void ReadDirectory(const std::string& relativePath)
+    {
+        std::vector<std::string> paths;
+        std::vector<std::string> subdirectories;
+        int error = NO_ERROR;
+
+        if (!IsCancelled()) {
+            std::string path = m_root + "/" + relativePath;
+            FileId id;
+            DirEntryList entries;
+            error = GetFileId(path, id);
+            if (error == NO_ERROR && MarkVisited(id))
+                error = FileSystem::ReadDir(path, entries);
+
+            for (size_t i = 0; i < entries.size(); i++) {
+                const DirEntry& entry = entries[i];
+                if (m_excludes.find(entry.name) != m_excludes.end())
+                    continue;
+
+                if (entry.type == ENTRY_DIRECTORY) {
+                    subdirectories.push_back(relativePath + entry.name + "/");
+                    paths.push_back(subdirectories.back());
+                } else if (entry.type == ENTRY_FILE) {
+                    paths.push_back(relativePath + entry.name);
+                }
+            }
+        }
+
+        // Subdirectories are counted in m_pending before they are posted, so
+        // the walk can't finish (and delete itself) while they are queued.
+        WorkerPool* pool = subdirectories.empty() ? NULL : WorkerPool::GetInstance();
+        bool finished;
+        {
+            AutoLock lock(m_lock);
+
+            if (relativePath.empty())
+                m_rootError = error;
+
+            m_batch.insert(m_batch.end(), paths.begin(), paths.end());
+            if (m_batch.size() >= m_batchSize && !m_cancelled)
+                DeliverBatch();
+
+            if (pool)
+                m_pending += (int)subdirectories.size();
+            finished = (--m_pending == 0);
+
+            if (finished) {
+                if (!m_batch.empty() && !m_cancelled)
+                    DeliverBatch();
+                m_delegate->OnWalkDone(m_rootError, m_cancelled);
+            }
+        }
+
+        if (pool) {
+            for (size_t i = 0; i < subdirectories.size(); i++)
+                pool->PostTask(CreateTask(subdirectories[i]));
+        }
+
+        if (finished) {
+            {
+                AutoLock lock(g_walksLock);
+                g_walks.erase(m_id);
+            }
+            delete this;
+        }
+    }
+
+private:
+    WorkerTask* CreateTask(const std::string& relativePath);
+
+    bool IsCancelled()
+    {
+        AutoLock lock(m_lock);
+        return m_cancelled;
+    }
+
+    // Returns false if the directory was already listed through another path
+    bool MarkVisited(const FileId& id)
+    {
+        AutoLock lock(m_lock);
+        return m_visited.insert(id).second;
+    }
+
+    // m_lock must be held. Delivering under the lock keeps the delegate calls
+    // serialized.
+    void DeliverBatch()
+    {
+        m_delegate->OnWalkBatch(m_batch);
+        m_batch.clear();
+    }
+
+    int m_id;
+    std::string m_root;
+    std::set<std::string> m_excludes;
+    size_t m_batchSize;
+    WalkDelegate* m_delegate;
+
+    Lock m_lock;
+    int m_pending;          // Directories queued or being read
+    bool m_cancelled;
+    int m_rootError;
+    std::set<FileId> m_visited;
+    std::vector<std::string> m_batch;
+};
+
+class WalkDirectoryTask : public WorkerTask {
+public:
+    WalkDirectoryTask(Walk* walk, const std::string& relativePath)
+        : m_walk(walk), m_relativePath(relativePath)
+    {
+    }
+
+    virtual void Run()
+    {
+        m_walk->ReadDirectory(m_relativePath);
+    }
+
+    virtual const char* GetName() const { return "WalkDirectory"; }
+
+private:
+    Walk* m_walk;
+    std::string m_relativePath;
+};
+
+WorkerTask* Walk::CreateTask(const std::string& relativePath)
+{
+    return new WalkDirectoryTask(this, relativePath);
+}
+
+} // namespace
+
+int StartWalk(const std::string& root, const WalkOptions& options, WalkDelegate* delegate)
+{
+    WorkerPool* pool = WorkerPool::GetInstance();
+    if (root.empty() || !pool) {
+        delegate->OnWalkDone(root.empty() ? ERR_INVALID_PARAMS : ERR_UNKNOWN, false);
+        delete delegate;
+        return 0;
+    }
+
+    int id;
+    Walk* walk;
+    {
+        AutoLock lock(g_walksLock);
+        id = g_nextWalkId++;
+        walk = new Walk(id, root, options, delegate);
+        g_walks[id] = walk;
+    }
+
+    walk->Start(pool);
+    return id;
+}
+
+void CancelWalk(int walkId)
+{
+    AutoLock lock(g_walksLock);
+    std::map<int, Walk*>::iterator it = g_walks.find(walkId);
+    if (it != g_walks.end())
+        it->second->Cancel();
+}
+
+} // namespace FileSystem
+} // namespace Brackets
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_WALKER_H
+#define _BRACKETS_FS_WALKER_H
+
+#include "brackets_fs.h"
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Recursive directory walking on the shared WorkerPool. Each directory is
+ * read by its own WorkerTask, so a large tree is listed by all the worker
+ * threads at once. Results are handed to a WalkDelegate in batches.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+struct WalkOptions {
+    WalkOptions() : batchSize(kDefaultBatchSize) {}
+
+    static const size_t kDefaultBatchSize = 1000;
+
+    // Names of files and directories to skip, e.g. "node_modules" or ".git".
+    // Matched against the entry name only, not the whole path.
+    std::vector<std::string> excludes;
+
+    // Number of paths collected before a batch is delivered
+    size_t batchSize;
+};
+
+// Receives the results of a walk. Called from the worker threads, never
+// more than one call at a time.
+class WalkDelegate {
+public:
+    virtual ~WalkDelegate() {}
+
+    // paths are relative to the root, separated by '/'. Directories end with
+    // a '/'. The delegate may swap the contents out of paths.
+    virtual void OnWalkBatch(std::vector<std::string>& paths) = 0;
+
+    // Called once, after the last batch. error is the error reading the root
+    // directory; errors reading directories below the root are ignored.
+    // cancelled is true if CancelWalk() stopped the walk early.
+    virtual void OnWalkDone(int error, bool cancelled) = 0;
+};
+
+// Starts walking root. Every directory is listed once, even if symlinks make
+// it reachable by several paths, so symlink cycles are not followed. The walk
+// takes ownership of the delegate and deletes it after OnWalkDone(). Returns
+// an id for CancelWalk().
+int StartWalk(const std::string& root, const WalkOptions& options, WalkDelegate* delegate);
+
+// Stops a walk started by StartWalk(). Directories that are being read finish,
+// and OnWalkDone() is still called. Does nothing if the walk already finished.
+void CancelWalk(int walkId);
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_WALKER_H
@@ -0,0 +1,587 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_watcher.h"
+#include "brackets_fs_watcher_backend.h"
+#include "brackets_fs_metadata_cache.h"
+#include "brackets_threading.h"
+
+#include <map>
+#include <set>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+// A burst of changes is reported once nothing changed for kQuietMs, or
+// kMaxDelayMs after its first change, whichever comes first. Saving a file
+// usually touches it several times in a row.
+const unsigned long long kQuietMs = 50;
+const unsigned long long kMaxDelayMs = 500;
+
+// How often PollingWatchBackend looks at every watch
+const unsigned long long kPollIntervalMs = 2000;
+
+unsigned long long GetTimeMs()
+{
+    return GetMonotonicTime() / 1000000;
+}
+
+// Used where there is no native backend. Every watch is looked at again every
+// kPollIntervalMs, which is still much cheaper than doing it on the UI thread
+// whenever the window gets focus.
+class PollingWatchBackend : public WatchBackend {
+public:
+    PollingWatchBackend() : m_wakeup(m_lock), m_woken(false), m_nextPoll(0) {}
+
+    virtual int AddWatch(int watchId, const std::string& /* path */, bool /* isDir */)
+    {
+        m_watchIds.insert(watchId);
+        return NO_ERROR;
+    }
+
+    virtual void RemoveWatch(int watchId)
+    {
+        m_watchIds.erase(watchId);
+    }
+
+    virtual bool NotifiesImmediately() const
+    {
+        return false;
+    }
+
+    virtual void Wait(int timeoutMs, WatchChangeList& changes)
+    {
+        unsigned long long now = GetTimeMs();
+        if (now >= m_nextPoll) {
+            for (std::set<int>::const_iterator it = m_watchIds.begin(); it != m_watchIds.end(); ++it) {
+                WatchChange change;
+                change.watchId = *it;
+                changes.push_back(change);
+            }
+            m_nextPoll = now + kPollIntervalMs;
+            return;
+        }
+
+        int untilPoll = (int)(m_nextPoll - now);
+        if (timeoutMs < 0 || timeoutMs > untilPoll)
+            timeoutMs = untilPoll;
+
+        AutoLock lock(m_lock);
+        if (!m_woken)
+            m_wakeup.TimedWait(timeoutMs);
+        m_woken = false;
+    }
+
+    virtual void Wakeup()
+    {
+        AutoLock lock(m_lock);
+        m_woken = true;
+        m_wakeup.Signal();
+    }
+
+private:
+    std::set<int> m_watchIds;
+
+    Lock m_lock;
+    ConditionVariable m_wakeup;
+    bool m_woken;
+    unsigned long long m_nextPoll;
+};
+
+// What a watch saw the last time it looked
+struct WatchedPath {
+    WatchedPath(const std::string& path, WatchDelegate* delegate)
+        : path(path), delegate(delegate), isDir(false), exists(true), cached(false), lost(false)
+    {
+    }
+
+    ~WatchedPath()
+    {
+        delete delegate;
+    }
+
+    std::string path;
+    WatchDelegate* delegate;
+    bool isDir;
+    bool exists;
+    bool cached;    // added to the MetadataCache
+    bool lost;      // the backend stopped watching the path
+
+    // The entries of a directory by name, or the file itself as ""
+    std::map<std::string, FileInfo> entries;
+};
+
+typedef std::map<std::string, FileInfo> EntryMap;
+
+// Changes the backend reported for a watch that haven't been looked at yet
+struct PendingChanges {
+    PendingChanges() : all(false) {}
+
+    bool all;
+    std::set<std::string> names;
+};
+
+std::string GetEntryPath(const WatchedPath& watch, const std::string& name)
+{
+    if (name.empty())
+        return watch.path;
+    if (watch.path[watch.path.length() - 1] == '/')
+        return watch.path + name;
+    return watch.path + "/" + name;
+}
+
+int ReadEntries(const WatchedPath& watch, EntryMap& entries)
+{
+    entries.clear();
+    if (!watch.isDir) {
+        FileInfo info;
+        int error = Stat(watch.path, info);
+        if (error == NO_ERROR)
+            entries[""] = info;
+        return error;
+    }
+
+    DirEntryList list;
+    int error = ReadDir(watch.path, list, true);
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i].type != ENTRY_UNKNOWN)
+            entries[list[i].name] = list[i].info;
+    }
+    return error;
+}
+
+// Compares what an entry was and is, and adds the event, if any. NULL means
+// the entry doesn't exist.
+void AddEvent(const WatchedPath& watch, const std::string& name, const FileInfo* before, const FileInfo* after,
+              WatchEventList& events)
+{
+    WatchEvent event;
+    if (before && after) {
+        // A subdirectory's modification time changes with its contents,
+        // which aren't watched
+        if (before->isDir == after->isDir &&
+            (after->isDir || (before->mtime == after->mtime && before->size == after->size)))
+            return;
+        event.type = WATCH_CHANGED;
+    } else if (after) {
+        event.type = WATCH_CREATED;
+    } else if (before) {
+        event.type = WATCH_DELETED;
+    } else {
+        return;
+    }
+
+    event.path = GetEntryPath(watch, name);
+    events.push_back(event);
+}
+
+// Reads the whole watch again and compares it with the last time
+void RescanAll(WatchedPath& watch, WatchEventList& events)
+{
+    EntryMap entries;
+    int error = ReadEntries(watch, entries);
+    if (error != NO_ERROR && error != ERR_NOT_FOUND)
+        return;
+
+    // Once the watched path is gone, the backend stops reporting changes
+    // for it, even if it comes back
+    if (error == ERR_NOT_FOUND && watch.cached) {
+        MetadataCache::RemoveWatchedPath(watch.path);
+        watch.cached = false;
+    }
+
+    if (watch.isDir) {
+        bool exists = (error == NO_ERROR);
+        if (exists != watch.exists) {
+            WatchEvent event;
+            event.path = watch.path;
+            event.type = exists ? WATCH_CREATED : WATCH_DELETED;
+            events.push_back(event);
+            watch.exists = exists;
+        }
+
+        // The entries of a deleted directory go with it
+        if (!exists) {
+            watch.entries.clear();
+            return;
+        }
+    }
+
+    // Both maps are sorted by name
+    EntryMap::const_iterator before = watch.entries.begin();
+    EntryMap::const_iterator after = entries.begin();
+    while (before != watch.entries.end() || after != entries.end()) {
+        if (after == entries.end() || (before != watch.entries.end() && before->first < after->first)) {
+            AddEvent(watch, before->first, &before->second, NULL, events);
+            ++before;
+        } else if (before == watch.entries.end() || after->first < before->first) {
+            AddEvent(watch, after->first, NULL, &after->second, events);
+            ++after;
+        } else {
+            AddEvent(watch, after->first, &before->second, &after->second, events);
+            ++before;
+            ++after;
+        }
+    }
+
+    watch.entries.swap(entries);
+}
+
+// Looks at the given entries of a watched directory only
+void RescanEntries(WatchedPath& watch, const std::set<std::string>& names, WatchEventList& events)
+{
+    for (std::set<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+        FileInfo info;
+        int error = Stat(GetEntryPath(watch, *it), info);
+        if (error != NO_ERROR && error != ERR_NOT_FOUND)
+            continue;
+
+        EntryMap::iterator entry = watch.entries.find(*it);
+        const FileInfo* before = (entry != watch.entries.end()) ? &entry->second : NULL;
+        const FileInfo* after = (error == NO_ERROR) ? &info : NULL;
+        AddEvent(watch, *it, before, after, events);
+
+        if (after)
+            watch.entries[*it] = info;
+        else if (entry != watch.entries.end())
+            watch.entries.erase(entry);
+    }
+}
+
+class Watcher : public Thread {
+public:
+    explicit Watcher(WatchBackend* backend)
+        : m_backend(backend), m_nextId(1), m_stopping(false), m_firstChange(0), m_lastChange(0)
+    {
+    }
+
+    ~Watcher()
+    {
+        delete m_backend;
+    }
+
+    int Add(const std::string& path, WatchDelegate* delegate)
+    {
+        int id;
+        {
+            AutoLock lock(m_lock);
+            id = m_nextId++;
+            m_requests.push_back(Request(id, path, delegate));
+        }
+
+        m_backend->Wakeup();
+        return id;
+    }
+
+    void Remove(int id)
+    {
+        {
+            AutoLock lock(m_lock);
+            m_requests.push_back(Request(id, "", NULL));
+        }
+
+        m_backend->Wakeup();
+    }
+
+    void Stop()
+    {
+        {
+            AutoLock lock(m_lock);
+            m_stopping = true;
+        }
+
+        m_backend->Wakeup();
+        Join();
+    }
+
+protected:
+    virtual void Run()
+    {
+        WatchChangeList changes;
+        while (HandleRequests()) {
+            int timeoutMs = -1;
+            if (!m_pending.empty()) {
+                unsigned long long now = GetTimeMs();
+                unsigned long long flushTime = m_lastChange + kQuietMs;
+                if (flushTime > m_firstChange + kMaxDelayMs)
+                    flushTime = m_firstChange + kMaxDelayMs;
+                timeoutMs = (flushTime > now) ? (int)(flushTime - now) : 0;
+            }
+
+            changes.clear();
+            m_backend->Wait(timeoutMs, changes);
+
+            unsigned long long now = GetTimeMs();
+            if (!changes.empty()) {
+                if (m_pending.empty())
+                    m_firstChange = now;
+                m_lastChange = now;
+
+                for (size_t i = 0; i < changes.size(); i++) {
+                    // Cached info must not outlive the change, even while
+                    // it's being debounced
+                    std::map<int, WatchedPath*>::const_iterator watch = m_watches.find(changes[i].watchId);
+                    if (watch != m_watches.end() && watch->second->cached) {
+                        MetadataCache::Invalidate(GetEntryPath(*watch->second, changes[i].name),
+                                                  changes[i].name.empty() || changes[i].lost);
+                    }
+                    if (watch != m_watches.end() && changes[i].lost)
+                        watch->second->lost = true;
+
+                    PendingChanges& pending = m_pending[changes[i].watchId];
+                    if (changes[i].name.empty() || changes[i].lost)
+                        pending.all = true;
+                    else if (!pending.all)
+                        pending.names.insert(changes[i].name);
+                }
+            }
+
+            if (!m_pending.empty() && (now >= m_lastChange + kQuietMs || now >= m_firstChange + kMaxDelayMs))
+                Flush();
+        }
+
+        // Watches that were never started are stopped too
+        std::vector<Request> requests;
+        {
+            AutoLock lock(m_lock);
+            requests.swap(m_requests);
+        }
+        for (size_t i = 0; i < requests.size(); i++) {
+            if (requests[i].delegate) {
+                requests[i].delegate->OnWatchStopped();
+                delete requests[i].delegate;
+            }
+        }
+
+        while (!m_watches.empty())
+            StopWatch(m_watches.begin()->first);
+    }
+
+private:
+    // Watch() or Unwatch() call. Unwatch() has no delegate.
+    struct Request {
+        Request(int id, const std::string& path, WatchDelegate* delegate)
+            : id(id), path(path), delegate(delegate)
+        {
+        }
+
+        int id;
+        std::string path;
+        WatchDelegate* delegate;
+    };
+
+    // Returns false when the thread should stop
+    bool HandleRequests()
+    {
+        std::vector<Request> requests;
+        {
+            AutoLock lock(m_lock);
+            if (m_stopping)
+                return false;
+            requests.swap(m_requests);
+        }
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            if (requests[i].delegate)
+                StartWatch(requests[i].id, requests[i].path, requests[i].delegate);
+            else
+                StopWatch(requests[i].id);
+        }
+        return true;
+    }
+
+    void StartWatch(int id, const std::string& path, WatchDelegate* delegate)
+    {
+        WatchedPath* watch = new WatchedPath(path, delegate);
+
+        // The backend watch is added first, so nothing that changes while the
+        // entries are read is missed
+        FileInfo info;
+        int error = Stat(path, info);
+        if (error == NO_ERROR) {
+            watch->isDir = info.isDir;
+            error = m_backend->AddWatch(id, path, info.isDir);
+        }
+        if (error == NO_ERROR) {
+            error = ReadEntries(*watch, watch->entries);
+            if (error != NO_ERROR)
+                m_backend->RemoveWatch(id);
+        }
+
+        if (error != NO_ERROR) {
+            delegate->OnWatchError(error);
+            delete watch;
+            return;
+        }
+
+        m_watches[id] = watch;
+        if (m_backend->NotifiesImmediately()) {
+            MetadataCache::AddWatchedPath(path);
+            watch->cached = true;
+        }
+    }
+
+    void StopWatch(int id)
+    {
+        std::map<int, WatchedPath*>::iterator it = m_watches.find(id);
+        if (it == m_watches.end())
+            return;
+
+        m_backend->RemoveWatch(id);
+        m_pending.erase(id);
+
+        WatchedPath* watch = it->second;
+        m_watches.erase(it);
+        if (watch->cached)
+            MetadataCache::RemoveWatchedPath(watch->path);
+        watch->delegate->OnWatchStopped();
+        delete watch;
+    }
+
+    // The backend stopped watching the path, e.g. because it was replaced
+    // by another file. Watches the path again, or takes it out of the
+    // MetadataCache if it can't, since nothing would invalidate it anymore.
+    void Reattach(int id, WatchedPath& watch)
+    {
+        watch.lost = false;
+        m_backend->RemoveWatch(id);
+
+        FileInfo info;
+        if (Stat(watch.path, info) == NO_ERROR && info.isDir == watch.isDir &&
+            m_backend->AddWatch(id, watch.path, watch.isDir) == NO_ERROR) {
+            // What was cached since the change may be older than the new watch
+            if (watch.cached)
+                MetadataCache::Invalidate(watch.path, true);
+            return;
+        }
+
+        if (watch.cached) {
+            MetadataCache::RemoveWatchedPath(watch.path);
+            watch.cached = false;
+        }
+    }
+
+    void Flush()
+    {
+        std::map<int, PendingChanges> pending;
+        pending.swap(m_pending);
+
+        for (std::map<int, PendingChanges>::const_iterator it = pending.begin(); it != pending.end(); ++it) {
+            std::map<int, WatchedPath*>::iterator watch = m_watches.find(it->first);
+            if (watch == m_watches.end())
+                continue;
+
+            if (watch->second->lost)
+                Reattach(it->first, *watch->second);
+
+            WatchEventList events;
+            if (it->second.all || !watch->second->isDir)
+                RescanAll(*watch->second, events);
+            else
+                RescanEntries(*watch->second, it->second.names, events);
+
+            if (!events.empty())
+                watch->second->delegate->OnWatchEvents(events);
+        }
+    }
+
+    WatchBackend* m_backend;
+
+    Lock m_lock;
+    std::vector<Request> m_requests;
+    int m_nextId;
+    bool m_stopping;
+
+    // Only used on the watcher thread
+    std::map<int, WatchedPath*> m_watches;
+    std::map<int, PendingChanges> m_pending;
+    unsigned long long m_firstChange;
+    unsigned long long m_lastChange;
+};
+
+// Started by the first Watch()
+Lock g_watcherLock;
+Watcher* g_watcher = NULL;
+
+} // namespace
+
+WatchBackend* CreateWatchBackend()
+{
+#if defined(__linux__)
+    WatchBackend* backend = CreateInotifyWatchBackend();
+    if (backend)
+        return backend;
+#endif
+    return new PollingWatchBackend();
+}
+
+int Watch(const std::string& path, WatchDelegate* delegate)
+{
+    std::string watchPath = path;
+    while (watchPath.length() > 1 && watchPath[watchPath.length() - 1] == '/')
+        watchPath.erase(watchPath.length() - 1);
+
+    AutoLock lock(g_watcherLock);
+    if (!g_watcher) {
+        g_watcher = new Watcher(CreateWatchBackend());
+        if (!g_watcher->Start()) {
+            delete g_watcher;
+            g_watcher = NULL;
+        }
+    }
+
+    if (!g_watcher || watchPath.empty()) {
+        delegate->OnWatchError(g_watcher ? ERR_INVALID_PARAMS : ERR_UNKNOWN);
+        delete delegate;
+        return 0;
+    }
+
+    return g_watcher->Add(watchPath, delegate);
+}
+
+void Unwatch(int watchId)
+{
+    AutoLock lock(g_watcherLock);
+    if (g_watcher)
+        g_watcher->Remove(watchId);
+}
+
+void ShutdownWatcher()
+{
+    Watcher* watcher;
+    {
+        AutoLock lock(g_watcherLock);
+        watcher = g_watcher;
+        g_watcher = NULL;
+    }
+
+    if (watcher) {
+        watcher->Stop();
+        delete watcher;
+    }
+}
+
+} // namespace FileSystem
+} // namespace Brackets
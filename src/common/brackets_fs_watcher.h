@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_WATCHER_H
+#define _BRACKETS_FS_WATCHER_H
+
+#include "brackets_fs.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Watches files and directories for changes made by other programs, so they
+ * don't have to be polled from the UI thread.
+ *
+ * A single watcher thread waits for notifications from the platform's
+ * WatchBackend (see brackets_fs_watcher_backend.h), waits for things to
+ * settle, and compares the changed entries with what it saw last time. Each
+ * watch then gets one batch of events per burst of changes.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+enum WatchEventType {
+    WATCH_CREATED = 0,
+    WATCH_CHANGED,
+    WATCH_DELETED
+};
+
+struct WatchEvent {
+    std::string     path;   // full path of the file or directory
+    WatchEventType  type;
+};
+
+typedef std::vector<WatchEvent> WatchEventList;
+
+// Receives the events of a watch. Called on the watcher thread.
+class WatchDelegate {
+public:
+    virtual ~WatchDelegate() {}
+
+    // Called if the watch could not be started. Nothing else follows, and
+    // the delegate is deleted right after.
+    virtual void OnWatchError(int error) = 0;
+
+    // The delegate may swap the contents out of events
+    virtual void OnWatchEvents(WatchEventList& events) = 0;
+
+    // Called once, after Unwatch(). The delegate is deleted right after.
+    virtual void OnWatchStopped() = 0;
+};
+
+// Watches a file, or a directory and the entries directly in it. Changes to
+// the directory's own modification time, and to the contents of its
+// subdirectories, are not reported. The watcher takes ownership of the
+// delegate. Returns an id for Unwatch().
+int Watch(const std::string& path, WatchDelegate* delegate);
+
+// Stops a watch started by Watch(). OnWatchStopped() follows soon after, on
+// the watcher thread; events may be delivered until then.
+void Unwatch(int watchId);
+
+// Stops all watches and the watcher thread. Called by
+// ShutdownBracketsExtensions().
+void ShutdownWatcher();
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_WATCHER_H
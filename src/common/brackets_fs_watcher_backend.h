@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FS_WATCHER_BACKEND_H
+#define _BRACKETS_FS_WATCHER_BACKEND_H
+
+#include "brackets_fs_watcher.h"
+
+/**
+ * Interface implemented by each source of change notifications. The backend
+ * only says where something may have changed; brackets_fs_watcher.cpp finds
+ * out what changed, so every backend reports the same events.
+ *
+ * All methods except Wakeup() are called on the watcher thread only.
+ */
+namespace Brackets {
+namespace FileSystem {
+
+// Something may have changed in a watch
+struct WatchChange {
+    WatchChange() : watchId(0), lost(false) {}
+
+    int         watchId;
+    std::string name;   // entry of a watched directory, or empty if
+                        // anything in the watch may have changed
+    bool        lost;   // the backend stopped watching the path, e.g.
+                        // because it was deleted or replaced. The watcher
+                        // calls RemoveWatch() and adds it again.
+};
+
+typedef std::vector<WatchChange> WatchChangeList;
+
+class WatchBackend {
+public:
+    virtual ~WatchBackend() {}
+
+    // Starts reporting changes to path as watchId. Returns an error value.
+    virtual int AddWatch(int watchId, const std::string& path, bool isDir) = 0;
+
+    virtual void RemoveWatch(int watchId) = 0;
+
+    // True if Wait() reports changes as soon as they happen, so the
+    // MetadataCache can rely on the watches
+    virtual bool NotifiesImmediately() const = 0;
+
+    // Waits up to timeoutMs (forever if negative) for changes and appends
+    // them to changes. May return early without any.
+    virtual void Wait(int timeoutMs, WatchChangeList& changes) = 0;
+
+    // Makes Wait() return soon. Can be called from any thread.
+    virtual void Wakeup() = 0;
+};
+
+// Returns the best backend for this platform
+WatchBackend* CreateWatchBackend();
+
+#if defined(__linux__)
+// Returns NULL if inotify is not available
+WatchBackend* CreateInotifyWatchBackend();
+#endif
+
+} // namespace FileSystem
+} // namespace Brackets
+
+#endif // _BRACKETS_FS_WATCHER_BACKEND_H
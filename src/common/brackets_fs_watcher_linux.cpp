@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_watcher_backend.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include <map>
+#include <vector>
+
+namespace Brackets {
+namespace FileSystem {
+
+namespace {
+
+const uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM |
+                            IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+// Large enough for a few hundred events per read()
+const size_t kEventBufferSize = 64 * 1024;
+
+class InotifyWatchBackend : public WatchBackend {
+public:
+    InotifyWatchBackend(int fd, int wakeupRead, int wakeupWrite)
+        : m_fd(fd), m_wakeupRead(wakeupRead), m_wakeupWrite(wakeupWrite), m_buffer(kEventBufferSize)
+    {
+    }
+
+    virtual ~InotifyWatchBackend()
+    {
+        close(m_fd);
+        close(m_wakeupRead);
+        close(m_wakeupWrite);
+    }
+
+    virtual int AddWatch(int watchId, const std::string& path, bool /* isDir */)
+    {
+        // Watching the same file twice returns the same descriptor
+        int wd = inotify_add_watch(m_fd, path.c_str(), kWatchMask);
+        if (wd == -1) {
+            // Out of inotify watches (fs.inotify.max_user_watches)
+            if (errno == ENOSPC)
+                return ERR_UNKNOWN;
+            return ConvertErrnoCode(errno);
+        }
+
+        m_watchIds[wd].push_back(watchId);
+        m_descriptors[watchId] = wd;
+        return NO_ERROR;
+    }
+
+    virtual void RemoveWatch(int watchId)
+    {
+        std::map<int, int>::iterator it = m_descriptors.find(watchId);
+        if (it == m_descriptors.end())
+            return;
+
+        int wd = it->second;
+        m_descriptors.erase(it);
+
+        std::map<int, std::vector<int> >::iterator ids = m_watchIds.find(wd);
+        if (ids == m_watchIds.end())
+            return;
+
+        std::vector<int>& watchIds = ids->second;
+        for (size_t i = 0; i < watchIds.size(); i++) {
+            if (watchIds[i] == watchId) {
+                watchIds.erase(watchIds.begin() + i);
+                break;
+            }
+        }
+
+        if (watchIds.empty()) {
+            inotify_rm_watch(m_fd, wd);
+            m_watchIds.erase(ids);
+        }
+    }
+
+    virtual bool NotifiesImmediately() const
+    {
+        return true;
+    }
+
+    virtual void Wait(int timeoutMs, WatchChangeList& changes)
+    {
+        struct pollfd fds[2];
+        fds[0].fd = m_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_wakeupRead;
+        fds[1].events = POLLIN;
+        if (poll(fds, 2, timeoutMs) <= 0)
+            return;
+
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(m_wakeupRead, drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        if (fds[0].revents & POLLIN)
+            ReadEvents(changes);
+    }
+
+    virtual void Wakeup()
+    {
+        char c = 0;
+        while (write(m_wakeupWrite, &c, 1) == -1 && errno == EINTR) {
+        }
+    }
+
+private:
+    void ReadEvents(WatchChangeList& changes)
+    {
+        for (;;) {
+            ssize_t length = read(m_fd, &m_buffer[0], m_buffer.size());
+            if (length == -1 && errno == EINTR)
+                continue;
+            if (length <= 0)
+                return;
+
+            const char* p = &m_buffer[0];
+            const char* end = p + length;
+            while (p < end) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + event->len;
+                AddChanges(*event, changes);
+            }
+        }
+    }
+
+    void AddChanges(const struct inotify_event& event, WatchChangeList& changes)
+    {
+        // Events were dropped, so anything may have changed
+        if (event.mask & IN_Q_OVERFLOW) {
+            for (std::map<int, int>::const_iterator it = m_descriptors.begin(); it != m_descriptors.end(); ++it) {
+                WatchChange change;
+                change.watchId = it->first;
+                changes.push_back(change);
+            }
+            return;
+        }
+
+        std::map<int, std::vector<int> >::iterator ids = m_watchIds.find(event.wd);
+        if (ids == m_watchIds.end())
+            return;
+
+        // Events for the watched file or directory itself have no name.
+        // event.name is padded with '\0's.
+        std::string name;
+        if (event.len > 0)
+            name = event.name;
+
+        // The watch no longer follows the path: the file or directory was
+        // deleted, or moved away, which is how most editors and git replace
+        // a file
+        bool lost = (event.mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) != 0;
+
+        for (size_t i = 0; i < ids->second.size(); i++) {
+            WatchChange change;
+            change.watchId = ids->second[i];
+            change.name = name;
+            change.lost = lost;
+            changes.push_back(change);
+        }
+
+        // The kernel removed the watch
+        if (event.mask & IN_IGNORED) {
+            for (size_t i = 0; i < ids->second.size(); i++)
+                m_descriptors.erase(ids->second[i]);
+            m_watchIds.erase(ids);
+        }
+    }
+
+    int m_fd;
+    int m_wakeupRead;
+    int m_wakeupWrite;
+    std::vector<char> m_buffer;
+
+    // inotify watch descriptor by watch id, and the other way around
+    std::map<int, int> m_descriptors;
+    std::map<int, std::vector<int> > m_watchIds;
+};
+
+bool SetNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1 && fcntl(fd, F_SETFD, FD_CLOEXEC) != -1;
+}
+
+} // namespace
+
+WatchBackend* CreateInotifyWatchBackend()
+{
+    int fd = inotify_init();
+    if (fd == -1)
+        return NULL;
+
+    int wakeup[2];
+    if (pipe(wakeup) == -1) {
+        close(fd);
+        return NULL;
+    }
+
+    if (!SetNonBlocking(fd) || !SetNonBlocking(wakeup[0]) || !SetNonBlocking(wakeup[1])) {
+        close(fd);
+        close(wakeup[0]);
+        close(wakeup[1]);
+        return NULL;
+    }
+
+    return new InotifyWatchBackend(fd, wakeup[0], wakeup[1]);
+}
+
+} // namespace FileSystem
+} // namespace Brackets
@@ -0,0 +1,617 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fs_platform.h"
+
+#include <windows.h>
+#include <errno.h>
+#include <io.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+namespace Brackets {
+namespace FileSystem {
+namespace Platform {
+
+namespace {
+
+// Converts a UTF-8 path to UTF-16 and converts '/' to '\'
+std::wstring ToWinPath(const std::string& path)
+{
+    std::wstring result;
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.data(), (int)path.length(), NULL, 0);
+    if (length > 0) {
+        result.resize(length);
+        MultiByteToWideChar(CP_UTF8, 0, path.data(), (int)path.length(), &result[0], length);
+    }
+
+    std::replace(result.begin(), result.end(), L'/', L'\\');
+    return result;
+}
+
+std::string ToUTF8(const wchar_t* str)
+{
+    std::string result;
+    int length = WideCharToMultiByte(CP_UTF8, 0, str, -1, NULL, 0, NULL, NULL);
+    if (length > 1) {
+        result.resize(length);
+        WideCharToMultiByte(CP_UTF8, 0, str, -1, &result[0], length, NULL, NULL);
+        result.resize(length - 1);  // Drop the null terminator
+    }
+    return result;
+}
+
+// Converts a FILETIME (100ns intervals since 1601) to seconds since the epoch
+double FileTimeToSeconds(const FILETIME& ft)
+{
+    ULARGE_INTEGER ticks;
+    ticks.LowPart = ft.dwLowDateTime;
+    ticks.HighPart = ft.dwHighDateTime;
+    return (double)(ticks.QuadPart - 116444736000000000ULL) / 10000000.0;
+}
+
+// Returns NO_ERROR or one of the error values
+int WriteAll(HANDLE hFile, const char* data, size_t length, SyncPolicy sync)
+{
+    while (length > 0) {
+        DWORD dwBytesWritten = 0;
+        DWORD chunk = (DWORD)(length < 0x40000000 ? length : 0x40000000);
+        if (!::WriteFile(hFile, data, chunk, &dwBytesWritten, NULL))
+            return ConvertWinErrorCode(GetLastError(), false);
+        data += dwBytesWritten;
+        length -= dwBytesWritten;
+    }
+
+    if (sync != SYNC_NONE && !FlushFileBuffers(hFile))
+        return ConvertWinErrorCode(GetLastError(), false);
+
+    return NO_ERROR;
+}
+
+int WriteFileInPlace(const std::wstring& pathStr, const char* data, size_t length, SyncPolicy sync)
+{
+    HANDLE hFile = CreateFileW(pathStr.c_str(), GENERIC_WRITE,
+        0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == hFile)
+        return ConvertWinErrorCode(GetLastError(), false);
+
+    int error = WriteAll(hFile, data, length, sync);
+    CloseHandle(hFile);
+    return error;
+}
+
+struct CopyProgressData {
+    CopyObserver* observer;
+    long long reported;     // bytes passed to the observer so far
+};
+
+volatile LONG g_nextTempFileId = 0;
+
+// Creates a new, empty file for writing next to pathStr, named after it
+HANDLE CreateTempFile(const std::wstring& pathStr, std::wstring& tempPath)
+{
+    for (int attempt = 0; attempt < 100; attempt++) {
+        wchar_t suffix[32];
+        _snwprintf_s(suffix, _TRUNCATE, L".%x.%x~", GetCurrentProcessId(),
+            (unsigned int)InterlockedIncrement(&g_nextTempFileId));
+        tempPath = pathStr + suffix;
+
+        HANDLE hFile = CreateFileW(tempPath.c_str(), GENERIC_WRITE,
+            0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (INVALID_HANDLE_VALUE != hFile || GetLastError() != ERROR_FILE_EXISTS)
+            return hFile;
+    }
+
+    return INVALID_HANDLE_VALUE;
+}
+
+// Returns true if the file at pathStr has other hard links than pathStr.
+// Files that can't be opened to check are assumed to have none.
+bool HasOtherLinks(const std::wstring& pathStr)
+{
+    HANDLE hFile = CreateFileW(pathStr.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, 0, NULL);
+    if (INVALID_HANDLE_VALUE == hFile)
+        return false;
+
+    BY_HANDLE_FILE_INFORMATION info;
+    bool otherLinks = GetFileInformationByHandle(hFile, &info) && info.nNumberOfLinks > 1;
+    CloseHandle(hFile);
+    return otherLinks;
+}
+
+// Reports the progress of CopyFileEx() to a CopyObserver
+DWORD CALLBACK CopyProgressRoutine(LARGE_INTEGER /* totalSize */, LARGE_INTEGER transferred,
+                                   LARGE_INTEGER /* streamSize */, LARGE_INTEGER /* streamTransferred */,
+                                   DWORD /* streamNumber */, DWORD /* reason */, HANDLE /* hSource */,
+                                   HANDLE /* hDestination */, LPVOID data)
+{
+    CopyProgressData* progress = reinterpret_cast<CopyProgressData*>(data);
+    long long count = transferred.QuadPart - progress->reported;
+    progress->reported = transferred.QuadPart;
+    if (count > 0 && !progress->observer->OnBytesCopied(count))
+        return PROGRESS_CANCEL;
+    return PROGRESS_CONTINUE;
+}
+
+} // namespace
+
+int ReadDir(const std::string& path, DirEntryList& entries, bool withInfo)
+{
+    std::wstring pathStr = ToWinPath(path);
+    pathStr += L"\\*";
+
+    WIN32_FIND_DATAW ffd;
+    HANDLE hFind = FindFirstFileW(pathStr.c_str(), &ffd);
+    if (hFind == INVALID_HANDLE_VALUE)
+        return ConvertWinErrorCode(GetLastError());
+
+    // On Windows, list directories first, then files
+    DirEntryList files;
+    do
+    {
+        // Ignore '.' and '..'
+        if (!wcscmp(ffd.cFileName, L".") || !wcscmp(ffd.cFileName, L".."))
+            continue;
+
+        DirEntry entry;
+        entry.name = ToUTF8(ffd.cFileName);
+        entry.info.isDir = false;
+        entry.info.mtime = 0;
+        entry.info.size = 0;
+
+        // FindFirstFile already returns everything we need, no extra calls
+        if (withInfo) {
+            ULARGE_INTEGER size;
+            size.LowPart = ffd.nFileSizeLow;
+            size.HighPart = ffd.nFileSizeHigh;
+
+            entry.info.isDir = (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+            entry.info.mtime = FileTimeToSeconds(ffd.ftLastWriteTime);
+            entry.info.size = (long long)size.QuadPart;
+        }
+
+        if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            entry.type = ENTRY_DIRECTORY;
+            entries.push_back(entry);
+        } else {
+            entry.type = ENTRY_FILE;
+            files.push_back(entry);
+        }
+    }
+    while (FindNextFileW(hFind, &ffd) != 0);
+
+    int error = GetLastError();
+    FindClose(hFind);
+    if (error != ERROR_NO_MORE_FILES)
+        return ConvertWinErrorCode(error);
+
+    entries.insert(entries.end(), files.begin(), files.end());
+    return NO_ERROR;
+}
+
+int Stat(const std::string& path, FileInfo& info)
+{
+    std::wstring pathStr = ToWinPath(path);
+
+    // Remove trailing "\", if present. A directory with a trailing '\' in the
+    // name is reported as not found.
+    if (pathStr.length() > 1 && pathStr[pathStr.length() - 1] == L'\\')
+        pathStr.erase(pathStr.length() - 1);
+
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(pathStr.c_str(), GetFileExInfoStandard, &data))
+        return ConvertWinErrorCode(GetLastError());
+
+    ULARGE_INTEGER size;
+    size.LowPart = data.nFileSizeLow;
+    size.HighPart = data.nFileSizeHigh;
+
+    info.isDir = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    info.mtime = FileTimeToSeconds(data.ftLastWriteTime);
+    info.size = (long long)size.QuadPart;
+
+    return NO_ERROR;
+}
+
+void StatMany(const std::vector<std::string>& paths, size_t begin, size_t end, StatResultList& results)
+{
+    // There is no way to look up a name relative to an open directory
+    // handle, so this is just a loop.
+    for (size_t i = begin; i < end; i++) {
+        StatResult& result = results[i];
+        result.error = paths[i].empty() ? ERR_INVALID_PARAMS : Platform::Stat(paths[i], result.info);
+        if (result.error != NO_ERROR) {
+            result.info.isDir = false;
+            result.info.mtime = 0;
+            result.info.size = 0;
+        }
+    }
+}
+
+int GetFileId(const std::string& path, FileId& id, FileInfo* fileInfo)
+{
+    std::wstring pathStr = ToWinPath(path);
+
+    // FILE_FLAG_BACKUP_SEMANTICS is needed to open directories
+    HANDLE hFile = CreateFileW(pathStr.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (INVALID_HANDLE_VALUE == hFile)
+        return ConvertWinErrorCode(GetLastError());
+
+    int error = NO_ERROR;
+    BY_HANDLE_FILE_INFORMATION info;
+    if (GetFileInformationByHandle(hFile, &info)) {
+        id.device = info.dwVolumeSerialNumber;
+        id.inode = ((unsigned long long)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+        if (fileInfo) {
+            fileInfo->isDir = (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+            fileInfo->mtime = FileTimeToSeconds(info.ftLastWriteTime);
+            fileInfo->size = (long long)(((unsigned long long)info.nFileSizeHigh << 32) | info.nFileSizeLow);
+        }
+    } else {
+        error = ConvertWinErrorCode(GetLastError());
+    }
+
+    CloseHandle(hFile);
+    return error;
+}
+
+int ReadFile(const std::string& path, std::string& contents)
+{
+    std::wstring pathStr = ToWinPath(path);
+
+    DWORD dwAttr = GetFileAttributesW(pathStr.c_str());
+    if (INVALID_FILE_ATTRIBUTES == dwAttr)
+        return ConvertWinErrorCode(GetLastError());
+
+    if (dwAttr & FILE_ATTRIBUTE_DIRECTORY)
+        return ERR_CANT_READ;
+
+    HANDLE hFile = CreateFileW(pathStr.c_str(), GENERIC_READ,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (INVALID_HANDLE_VALUE == hFile)
+        return ConvertWinErrorCode(GetLastError());
+
+    int error = NO_ERROR;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        error = ConvertWinErrorCode(GetLastError());
+    } else if (fileSize.HighPart != 0) {
+        // Larger than 4GB, way more than we can hand to JavaScript
+        error = ERR_CANT_READ;
+    } else {
+        // Read directly into the result, no intermediate buffer
+        contents.resize(fileSize.LowPart);
+        DWORD used = 0;
+        while (used < fileSize.LowPart) {
+            DWORD dwBytesRead = 0;
+            if (!::ReadFile(hFile, &contents[used], fileSize.LowPart - used, &dwBytesRead, NULL)) {
+                error = ConvertWinErrorCode(GetLastError());
+                break;
+            }
+            if (dwBytesRead == 0)
+                break;
+            used += dwBytesRead;
+        }
+        contents.resize(error == NO_ERROR ? used : 0);
+    }
+
+    CloseHandle(hFile);
+    return error;
+}
+
+int ReadFileRange(const std::string& path, long long offset, size_t length, std::string& data, long long& fileSize)
+{
+    std::wstring pathStr = ToWinPath(path);
+
+    DWORD dwAttr = GetFileAttributesW(pathStr.c_str());
+    if (INVALID_FILE_ATTRIBUTES == dwAttr)
+        return ConvertWinErrorCode(GetLastError());
+
+    if (dwAttr & FILE_ATTRIBUTE_DIRECTORY)
+        return ERR_CANT_READ;
+
+    HANDLE hFile = CreateFileW(pathStr.c_str(), GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == hFile)
+        return ConvertWinErrorCode(GetLastError());
+
+    int error = NO_ERROR;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size)) {
+        error = ConvertWinErrorCode(GetLastError());
+    } else {
+        fileSize = size.QuadPart;
+        if (offset >= fileSize)
+            length = 0;
+        else if ((unsigned long long)(fileSize - offset) < length)
+            length = (size_t)(fileSize - offset);
+
+        data.resize(length);
+        size_t used = 0;
+        while (used < length) {
+            // ReadFile() takes the offset from an OVERLAPPED structure, even
+            // for synchronous handles
+            OVERLAPPED overlapped = {0};
+            ULARGE_INTEGER position;
+            position.QuadPart = offset + used;
+            overlapped.Offset = position.LowPart;
+            overlapped.OffsetHigh = position.HighPart;
+
+            size_t remaining = length - used;
+            DWORD dwToRead = (remaining > 0x40000000) ? 0x40000000 : (DWORD)remaining;
+            DWORD dwBytesRead = 0;
+            if (!::ReadFile(hFile, &data[used], dwToRead, &dwBytesRead, &overlapped)) {
+                DWORD dwError = GetLastError();
+                if (dwError != ERROR_HANDLE_EOF)
+                    error = ConvertWinErrorCode(dwError);
+                break;
+            }
+            if (dwBytesRead == 0)
+                break;
+            used += dwBytesRead;
+        }
+        data.resize(error == NO_ERROR ? used : 0);
+    }
+
+    CloseHandle(hFile);
+    return error;
+}
+
+int WriteFile(const std::string& path, const char* data, size_t length, SyncPolicy sync)
+{
+    std::wstring pathStr = ToWinPath(path);
+
+    // Replacing would turn a symlink into a regular file, and would leave the
+    // other hard links with the old contents. Read-only files and directories
+    // are written in place, so they fail like before.
+    DWORD dwAttr = GetFileAttributesW(pathStr.c_str());
+    bool exists = (dwAttr != INVALID_FILE_ATTRIBUTES);
+    if (exists && ((dwAttr & (FILE_ATTRIBUTE_READONLY | FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_REPARSE_POINT)) ||
+                   HasOtherLinks(pathStr)))
+        return WriteFileInPlace(pathStr, data, length, sync);
+
+    std::wstring tempPath;
+    HANDLE hFile = CreateTempFile(pathStr, tempPath);
+    if (INVALID_HANDLE_VALUE == hFile)
+        return WriteFileInPlace(pathStr, data, length, sync);
+
+    int error = WriteAll(hFile, data, length, sync);
+    CloseHandle(hFile);
+    if (error != NO_ERROR) {
+        DeleteFileW(tempPath.c_str());
+        return error;
+    }
+
+    // ReplaceFile() keeps the attributes and security descriptor of the old
+    // file
+    BOOL replaced;
+    if (exists) {
+        replaced = ReplaceFileW(pathStr.c_str(), tempPath.c_str(), NULL, REPLACEFILE_IGNORE_MERGE_ERRORS,
+            NULL, NULL);
+    } else {
+        replaced = MoveFileExW(tempPath.c_str(), pathStr.c_str(),
+            MOVEFILE_REPLACE_EXISTING | (sync == SYNC_FULL ? MOVEFILE_WRITE_THROUGH : 0));
+    }
+
+    // E.g. another process has the file open without FILE_SHARE_DELETE
+    if (!replaced) {
+        DeleteFileW(tempPath.c_str());
+        return WriteFileInPlace(pathStr, data, length, sync);
+    }
+
+    return NO_ERROR;
+}
+
+int SetPosixPermissions(const std::string& path, int mode)
+{
+    std::wstring pathStr = ToWinPath(path);
+
+    // Note, Windows cannot set read-only on directories.
+    // See http://support.microsoft.com/kb/326549
+    DWORD dwAttr = GetFileAttributesW(pathStr.c_str());
+    if (dwAttr == INVALID_FILE_ATTRIBUTES)
+        return ConvertWinErrorCode(GetLastError());
+
+    bool isDir = (dwAttr & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    if (isDir)
+        return NO_ERROR;
+
+    // For now only extract permissions for "owner"
+    bool write = (mode & 0200) != 0;
+    bool read = (mode & 0400) != 0;
+    int mask = (write ? _S_IWRITE : 0) | (read ? _S_IREAD : 0);
+
+    // Note _wchmod only supports setting FILE_ATTRIBUTE_READONLY so
+    // _S_IREAD is ignored.
+    if (_wchmod(pathStr.c_str(), mask) == -1)
+        return ConvertErrnoCode(errno, false);
+
+    return NO_ERROR;
+}
+
+int DeleteFileOrDirectory(const std::string& path)
+{
+    std::wstring pathStr = ToWinPath(path);
+
+    if (!DeleteFileW(pathStr.c_str()))
+        return ConvertWinErrorCode(GetLastError(), false);
+
+    return NO_ERROR;
+}
+
+int DeleteFilesIn(const std::string& path, std::vector<std::string>& subdirectories, DeleteFailureList& failures,
+                  DeleteObserver* observer)
+{
+    std::wstring pathStr = ToWinPath(path);
+    DWORD attributes = GetFileAttributesW(pathStr.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+        return ConvertWinErrorCode(GetLastError());
+    if (!(attributes & FILE_ATTRIBUTE_DIRECTORY) || (attributes & FILE_ATTRIBUTE_REPARSE_POINT))
+        return ERR_NOT_DIRECTORY;
+
+    if (pathStr[pathStr.length() - 1] != L'\\')
+        pathStr += L'\\';
+
+    // Read the whole directory before deleting from it
+    std::vector<std::wstring> names;
+    std::vector<DWORD> nameAttributes;
+    WIN32_FIND_DATAW ffd;
+    HANDLE hFind = FindFirstFileW((pathStr + L"*").c_str(), &ffd);
+    if (hFind == INVALID_HANDLE_VALUE)
+        return ConvertWinErrorCode(GetLastError());
+    do
+    {
+        if (!wcscmp(ffd.cFileName, L".") || !wcscmp(ffd.cFileName, L".."))
+            continue;
+        names.push_back(ffd.cFileName);
+        nameAttributes.push_back(ffd.dwFileAttributes);
+    }
+    while (FindNextFileW(hFind, &ffd) != 0);
+
+    int error = GetLastError();
+    FindClose(hFind);
+    if (error != ERROR_NO_MORE_FILES)
+        return ConvertWinErrorCode(error);
+
+    std::string prefix = path;
+    if (prefix[prefix.length() - 1] != '/' && prefix[prefix.length() - 1] != '\\')
+        prefix += '/';
+
+    for (size_t i = 0; i < names.size(); i++) {
+        std::wstring entryPath = pathStr + names[i];
+        DWORD entryAttributes = nameAttributes[i];
+
+        // Junctions and directory symlinks are removed like empty directories,
+        // which leaves what they point to alone
+        BOOL deleted;
+        if (entryAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            if (!(entryAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+                subdirectories.push_back(ToUTF8(names[i].c_str()));
+                continue;
+            }
+            deleted = RemoveDirectoryW(entryPath.c_str());
+        } else {
+            // Read-only files can't be deleted until the attribute is cleared
+            if (entryAttributes & FILE_ATTRIBUTE_READONLY)
+                SetFileAttributesW(entryPath.c_str(), entryAttributes & ~FILE_ATTRIBUTE_READONLY);
+            deleted = DeleteFileW(entryPath.c_str());
+        }
+
+        if (!deleted) {
+            DWORD lastError = GetLastError();
+            if (lastError == ERROR_FILE_NOT_FOUND)
+                continue;
+
+            DeleteFailure failure;
+            failure.path = prefix + ToUTF8(names[i].c_str());
+            failure.error = ConvertWinErrorCode(lastError, false);
+            failures.push_back(failure);
+            continue;
+        }
+
+        if (observer && !observer->OnEntryDeleted())
+            break;
+    }
+
+    return NO_ERROR;
+}
+
+int DeleteEmptyDirectory(const std::string& path)
+{
+    if (!RemoveDirectoryW(ToWinPath(path).c_str()))
+        return ConvertWinErrorCode(GetLastError(), false);
+
+    return NO_ERROR;
+}
+
+int MakeDir(const std::string& path, int /* mode */)
+{
+    if (!CreateDirectoryW(ToWinPath(path).c_str(), NULL))
+        return ConvertWinErrorCode(GetLastError(), false);
+
+    return NO_ERROR;
+}
+
+int Rename(const std::string& oldPath, const std::string& newPath, bool& crossDevice)
+{
+    // Without MOVEFILE_COPY_ALLOWED, moving to another volume fails
+    crossDevice = false;
+    if (!MoveFileExW(ToWinPath(oldPath).c_str(), ToWinPath(newPath).c_str(), 0)) {
+        DWORD error = GetLastError();
+        crossDevice = (error == ERROR_NOT_SAME_DEVICE);
+        return ConvertWinErrorCode(error, false);
+    }
+
+    return NO_ERROR;
+}
+
+int CopyFileTo(const std::string& path, const std::string& newPath, CopyObserver* observer)
+{
+    // CopyFileEx() copies the attributes as well, and removes the new file
+    // if the copy fails or is cancelled
+    CopyProgressData progress = { observer, 0 };
+    if (!CopyFileExW(ToWinPath(path).c_str(), ToWinPath(newPath).c_str(),
+                     observer ? CopyProgressRoutine : NULL, &progress, NULL, COPY_FILE_FAIL_IF_EXISTS)) {
+        DWORD error = GetLastError();
+        return (error == ERROR_REQUEST_ABORTED) ? ERR_UNKNOWN : ConvertWinErrorCode(error, false);
+    }
+
+    return NO_ERROR;
+}
+
+} // namespace Platform
+
+// Maps errors from WinError.h to the error values in brackets_fs.h
+int ConvertWinErrorCode(int errorCode, bool isReading)
+{
+    switch (errorCode) {
+    case NO_ERROR:
+        return NO_ERROR;
+    case ERROR_INVALID_NAME:
+    case ERROR_INVALID_PARAMETER:
+        return ERR_INVALID_PARAMS;
+    case ERROR_PATH_NOT_FOUND:
+    case ERROR_FILE_NOT_FOUND:
+        return ERR_NOT_FOUND;
+    case ERROR_ACCESS_DENIED:
+    case ERROR_SHARING_VIOLATION:
+        return isReading ? ERR_CANT_READ : ERR_CANT_WRITE;
+    case ERROR_WRITE_PROTECT:
+    case ERROR_NOT_SAME_DEVICE:
+        return ERR_CANT_WRITE;
+    case ERROR_FILE_EXISTS:
+    case ERROR_ALREADY_EXISTS:
+        return ERR_FILE_EXISTS;
+    case ERROR_HANDLE_DISK_FULL:
+    case ERROR_DISK_FULL:
+        return ERR_OUT_OF_SPACE;
+    default:
+        return ERR_UNKNOWN;
+    }
+}
+
+} // namespace FileSystem
+} // namespace Brackets
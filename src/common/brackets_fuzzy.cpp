@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_fuzzy.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRACKETS_FUZZY_USE_SSE2 1
+#else
+#define BRACKETS_FUZZY_USE_SSE2 0
+#endif
+
+#if defined(_MSC_VER) && BRACKETS_FUZZY_USE_SSE2
+#include <intrin.h>
+#endif
+
+namespace Brackets {
+
+namespace {
+
+// Scores, see the comment in brackets_fuzzy.h
+const int kScoreMatch = 16;
+const int kGapStart = -3;
+const int kGapExtension = -1;
+const int kBonusBoundary = 8;       // at the start of a path component
+const int kBonusWordStart = 7;      // after a separator, at a camelCase hump or a number
+const int kBonusConsecutive = 4;    // at least, for a character right after the previous one
+const int kBonusFileName = 4;       // for each character matched in the file name
+const int kFirstCharMultiplier = 2; // for the bonus of the first character
+
+// Below any score that can be reached, but far enough from INT_MIN that
+// adding gap costs to it can't overflow
+const int kNoScore = -(1 << 28);
+
+const size_t kNotFound = (size_t)-1;
+
+inline unsigned char FoldASCII(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+inline bool IsSeparator(unsigned char c)
+{
+    return c == '_' || c == '-' || c == '.' || c == ' ';
+}
+
+// The bonus for matching c, which comes after prev
+inline unsigned char GetBonus(unsigned char prev, unsigned char c)
+{
+    if (prev == '/' || prev == '\\')
+        return kBonusBoundary;
+    if (IsSeparator(prev) || (prev >= 'a' && prev <= 'z' && c >= 'A' && c <= 'Z') ||
+        (!(prev >= '0' && prev <= '9') && c >= '0' && c <= '9'))
+        return kBonusWordStart;
+    return 0;
+}
+
+#if BRACKETS_FUZZY_USE_SSE2
+inline int FindFirstBit(int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, (unsigned long)mask);
+    return (int)index;
+#else
+    return __builtin_ctz((unsigned int)mask);
+#endif
+}
+
+// Marks the bytes of block between low and high. Only for ASCII bounds: bytes
+// from 0x80 up compare as negative and are never marked.
+inline __m128i InRange(__m128i block, char low, char high)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8((char)(low - 1))),
+                         _mm_cmplt_epi8(block, _mm_set1_epi8((char)(high + 1))));
+}
+
+inline __m128i Equals(__m128i block, char c)
+{
+    return _mm_cmpeq_epi8(block, _mm_set1_epi8(c));
+}
+#endif
+
+// Returns the first offset at or after start where text has c, or its upper
+// case if c is a lower case letter
+size_t FindFolded(const unsigned char* text, size_t length, size_t start, unsigned char c)
+{
+    size_t i = start;
+#if BRACKETS_FUZZY_USE_SSE2
+    // Setting 0x20 lower cases letters, and only letters have another case
+    bool letter = (c >= 'a' && c <= 'z');
+    __m128i lowerCase = _mm_set1_epi8(letter ? 0x20 : 0);
+    __m128i target = _mm_set1_epi8((char)c);
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)), lowerCase);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, target));
+        if (mask)
+            return i + FindFirstBit(mask);
+    }
+#endif
+
+    for (; i < length; i++) {
+        if (FoldASCII(text[i]) == c)
+            return i;
+    }
+    return kNotFound;
+}
+
+// Lower cases text[begin, end) into folded, and stores the bonus of each
+// byte, without the file name bonus, into bonus
+void Classify(const unsigned char* text, size_t begin, size_t end, unsigned char* folded, unsigned char* bonus)
+{
+    size_t i = begin;
+
+    // The start of the path counts as the start of a component. Starting
+    // here also gives the vector loop a previous byte to load.
+    unsigned char prev = (i == 0) ? '/' : text[i - 1];
+    if (i < end) {
+        folded[0] = FoldASCII(text[i]);
+        bonus[0] = GetBonus(prev, text[i]);
+        i++;
+    }
+
+#if BRACKETS_FUZZY_USE_SSE2
+    for (; i + 16 <= end; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i before = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i - 1));
+
+        __m128i upper = InRange(block, 'A', 'Z');
+        __m128i lower = _mm_or_si128(block, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(folded + (i - begin)), lower);
+
+        __m128i boundary = _mm_or_si128(Equals(before, '/'), Equals(before, '\\'));
+        __m128i separator = _mm_or_si128(_mm_or_si128(Equals(before, '_'), Equals(before, '-')),
+                                         _mm_or_si128(Equals(before, '.'), Equals(before, ' ')));
+        __m128i hump = _mm_and_si128(InRange(before, 'a', 'z'), upper);
+        __m128i number = _mm_andnot_si128(InRange(before, '0', '9'), InRange(block, '0', '9'));
+        __m128i wordStart = _mm_or_si128(separator, _mm_or_si128(hump, number));
+        __m128i result = _mm_max_epu8(_mm_and_si128(boundary, _mm_set1_epi8(kBonusBoundary)),
+                                      _mm_and_si128(wordStart, _mm_set1_epi8(kBonusWordStart)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bonus + (i - begin)), result);
+    }
+#endif
+
+    for (; i < end; i++) {
+        folded[i - begin] = FoldASCII(text[i]);
+        bonus[i - begin] = GetBonus(text[i - 1], text[i]);
+    }
+}
+
+inline int Max(int a, int b)
+{
+    return (a > b) ? a : b;
+}
+
+} // namespace
+
+FuzzyMatcher::FuzzyMatcher(const std::string& query) : m_query(query)
+{
+}
+
+bool FuzzyMatcher::Score(const char* text, size_t length, size_t nameStart, int& score)
+{
+    return Run(text, length, nameStart, score, NULL);
+}
+
+bool FuzzyMatcher::Match(const char* text, size_t length, size_t nameStart, int& score, FuzzyRangeList& ranges)
+{
+    ranges.clear();
+    return Run(text, length, nameStart, score, &ranges);
+}
+
+bool FuzzyMatcher::Run(const char* text, size_t length, size_t nameStart, int& score, FuzzyRangeList* ranges)
+{
+    score = 0;
+    size_t queryLength = m_query.length();
+    if (queryLength == 0)
+        return true;
+
+    // Check that the query occurs at all, and find where the best match can
+    // start: at the first occurrence of its first character
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+    const unsigned char* query = reinterpret_cast<const unsigned char*>(m_query.data());
+    size_t first = kNotFound;
+    size_t offset = 0;
+    for (size_t i = 0; i < queryLength; i++) {
+        offset = FindFolded(p, length, offset, query[i]);
+        if (offset == kNotFound)
+            return false;
+        if (i == 0)
+            first = offset;
+        offset++;
+    }
+
+    // ...and where it can end: at the last occurrence of its last character
+    size_t last = length - 1;
+    while (FoldASCII(p[last]) != query[queryLength - 1])
+        last--;
+
+    size_t width = last - first + 1;
+    m_folded.resize(width);
+    m_bonus.resize(width);
+    Classify(p, first, last + 1, &m_folded[0], &m_bonus[0]);
+
+    // m_scores[i * width + j] is the best score of the first i + 1 query
+    // characters with character i matched at first + j. Only two rows are
+    // kept unless the match has to be traced back.
+    size_t rows = ranges ? queryLength : 2;
+    m_scores.resize(rows * width);
+    int* previous = NULL;
+    for (size_t i = 0; i < queryLength; i++) {
+        int* current = &m_scores[(i % rows) * width];
+        unsigned char c = query[i];
+
+        // Best score of a match of the previous characters, followed by a gap
+        // of at least one byte before j
+        int gap = kNoScore;
+        for (size_t j = 0; j < width; j++) {
+            if (previous && j >= 2) {
+                int extended = (gap > kNoScore) ? gap + kGapExtension : kNoScore;
+                int opened = (previous[j - 2] > kNoScore) ? previous[j - 2] + kGapStart : kNoScore;
+                gap = Max(extended, opened);
+            }
+
+            if (m_folded[j] != c) {
+                current[j] = kNoScore;
+                continue;
+            }
+
+            int bonus = m_bonus[j];
+            int nameBonus = (first + j >= nameStart) ? kBonusFileName : 0;
+            if (!previous) {
+                current[j] = kScoreMatch + bonus * kFirstCharMultiplier + nameBonus;
+                continue;
+            }
+
+            int best = (gap > kNoScore) ? gap + kScoreMatch + bonus + nameBonus : kNoScore;
+            if (j >= 1 && previous[j - 1] > kNoScore)
+                best = Max(best, previous[j - 1] + kScoreMatch + Max(bonus, kBonusConsecutive) + nameBonus);
+            current[j] = best;
+        }
+        previous = current;
+    }
+
+    size_t end = 0;
+    score = kNoScore;
+    for (size_t j = 0; j < width; j++) {
+        if (previous[j] > score) {
+            score = previous[j];
+            end = j;
+        }
+    }
+
+    if (!ranges)
+        return true;
+
+    // Trace the best match back, one query character at a time, from the
+    // last one
+    std::vector<size_t> positions(queryLength);
+    size_t j = end;
+    for (size_t i = queryLength - 1; ; i--) {
+        positions[i] = first + j;
+        if (i == 0)
+            break;
+
+        const int* row = &m_scores[(i - 1) * width];
+        int value = m_scores[i * width + j];
+        int bonus = m_bonus[j];
+        int nameBonus = (first + j >= nameStart) ? kBonusFileName : 0;
+        if (j >= 1 && row[j - 1] > kNoScore &&
+            row[j - 1] + kScoreMatch + Max(bonus, kBonusConsecutive) + nameBonus == value) {
+            j--;
+            continue;
+        }
+
+        size_t k = j - 2;
+        while (row[k] <= kNoScore || row[k] + kGapStart + (int)(j - k - 2) * kGapExtension + kScoreMatch + bonus + nameBonus != value)
+            k--;
+        j = k;
+    }
+
+    for (size_t i = 0; i < queryLength; i++) {
+        if (!ranges->empty() && ranges->back().start + ranges->back().length == positions[i]) {
+            ranges->back().length++;
+        } else {
+            FuzzyRange range = { positions[i], 1 };
+            ranges->push_back(range);
+        }
+    }
+    return true;
+}
+
+} // namespace Brackets
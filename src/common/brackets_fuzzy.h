@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_FUZZY_H
+#define _BRACKETS_FUZZY_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Fuzzy matching of Quick Open queries against paths. A path matches if it
+ * contains the characters of the query in order, ignoring the case of ASCII
+ * letters. Among the ways the characters can be matched, the one with the
+ * best score is found with a small dynamic program over the part of the path
+ * between the first possible and the last possible match:
+ *
+ * - each matched character scores, more so at the start of a path component,
+ *   after '_', '-', '.' or ' ', at a camelCase hump and in the file name
+ * - runs of consecutive characters score extra
+ * - gaps between matched characters cost a little per skipped byte
+ *
+ * The lower casing and the classification of the bytes are done 16 at a time
+ * with SSE2 where the compiler targets it, as is the check that the query
+ * occurs at all.
+ */
+namespace Brackets {
+
+// Matched bytes of a path
+struct FuzzyRange {
+    size_t start;
+    size_t length;
+};
+
+typedef std::vector<FuzzyRange> FuzzyRangeList;
+
+// Scores paths against one query. Keeps scratch space between calls, so each
+// thread should use its own matcher.
+class FuzzyMatcher {
+public:
+    // query must be lower case already, see FoldLiteral()
+    explicit FuzzyMatcher(const std::string& query);
+
+    // Returns false if text doesn't contain the characters of the query in
+    // order. The file name starts at nameStart. An empty query matches
+    // everything with a score of 0.
+    bool Score(const char* text, size_t length, size_t nameStart, int& score);
+
+    // Same as Score(), and also returns the bytes matched by the best scoring
+    // match, in order
+    bool Match(const char* text, size_t length, size_t nameStart, int& score, FuzzyRangeList& ranges);
+
+private:
+    bool Run(const char* text, size_t length, size_t nameStart, int& score, FuzzyRangeList* ranges);
+
+    // Not copyable
+    FuzzyMatcher(const FuzzyMatcher&);
+    FuzzyMatcher& operator=(const FuzzyMatcher&);
+
+    std::string m_query;
+
+    // Scratch space, for the window of the text that is scored
+    std::vector<unsigned char> m_folded;
+    std::vector<unsigned char> m_bonus;
+    std::vector<int> m_scores;          // one row per query character
+};
+
+} // namespace Brackets
+
+#endif // _BRACKETS_FUZZY_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_json.h"
+
+// See brackets_encoding.cpp
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRACKETS_JSON_USE_SSE2 1
+#else
+#define BRACKETS_JSON_USE_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Brackets {
+namespace JSON {
+
+namespace {
+
+const char kHexDigits[] = "0123456789abcdef";
+
+inline bool NeedsEscape(unsigned char c)
+{
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+#if BRACKETS_JSON_USE_SSE2
+// Index of the lowest set bit of a non-zero mask
+inline int FindFirstBit(int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, (unsigned long)mask);
+    return (int)index;
+#else
+    return __builtin_ctz((unsigned int)mask);
+#endif
+}
+#endif
+
+// Returns the number of bytes at the start of p that can be copied as they
+// are
+size_t CountClean(const unsigned char* p, size_t length)
+{
+    size_t i = 0;
+#if BRACKETS_JSON_USE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lastControl = _mm_set1_epi8(0x1F);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // Unsigned saturation leaves 0 for the bytes up to 0x1F only
+        __m128i control = _mm_cmpeq_epi8(_mm_subs_epu8(bytes, lastControl), zero);
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash));
+        int mask = _mm_movemask_epi8(_mm_or_si128(control, special));
+        if (mask)
+            return i + FindFirstBit(mask);
+    }
+#endif
+    while (i < length && !NeedsEscape(p[i]))
+        i++;
+    return i;
+}
+
+void AppendEscaped(std::string& out, unsigned char c)
+{
+    switch (c) {
+    case '"':   out += "\\\"";  break;
+    case '\\':  out += "\\\\";  break;
+    case '\b':  out += "\\b";   break;
+    case '\f':  out += "\\f";   break;
+    case '\n':  out += "\\n";   break;
+    case '\r':  out += "\\r";   break;
+    case '\t':  out += "\\t";   break;
+    default:
+        out += "\\u00";
+        out += kHexDigits[c >> 4];
+        out += kHexDigits[c & 0xF];
+        break;
+    }
+}
+
+} // namespace
+
+void AppendString(std::string& out, const char* data, size_t length)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+
+    // Most strings have nothing to escape
+    out.reserve(out.length() + length + 2);
+    out += '"';
+    while (p < end) {
+        size_t clean = CountClean(p, end - p);
+        out.append(reinterpret_cast<const char*>(p), clean);
+        p += clean;
+        if (p == end)
+            break;
+        AppendEscaped(out, *p++);
+    }
+    out += '"';
+}
+
+void AppendStringArray(std::string& out, const std::vector<std::string>& strings)
+{
+    out += '[';
+    for (size_t i = 0; i < strings.size(); i++) {
+        if (i > 0)
+            out += ',';
+        AppendString(out, strings[i]);
+    }
+    out += ']';
+}
+
+} // namespace JSON
+} // namespace Brackets
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_JSON_H
+#define _BRACKETS_JSON_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Writes JSON for native data that leaves the process as text, e.g. trace
+ * and statistics dumps. Results handed to JavaScript are built as V8 values
+ * instead, see brackets_v8_util.h.
+ */
+namespace Brackets {
+namespace JSON {
+
+// Appends data, which must be UTF-8, to out as a quoted JSON string. Only
+// '"', '\' and control characters are escaped. Everything else is copied as
+// it is, so the result is UTF-8 as well. Runs without anything to escape are
+// found 16 bytes at a time with SSE2 where the compiler targets it, and
+// copied in one go.
+void AppendString(std::string& out, const char* data, size_t length);
+
+inline void AppendString(std::string& out, const std::string& str)
+{
+    AppendString(out, str.data(), str.length());
+}
+
+// Appends strings as a JSON array of strings
+void AppendStringArray(std::string& out, const std::vector<std::string>& strings);
+
+} // namespace JSON
+} // namespace Brackets
+
+#endif // _BRACKETS_JSON_H
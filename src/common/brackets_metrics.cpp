@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_metrics.h"
+#include "brackets_fs.h"
+#include "brackets_json.h"
+#include "brackets_threading.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace Brackets {
+namespace Metrics {
+
+const char kStatsFileVariable[] = "BRACKETS_NATIVE_STATS_FILE";
+
+Histogram::Histogram()
+    : m_count(0)
+    , m_total(0)
+    , m_min(0)
+    , m_max(0)
+{
+    std::fill(m_buckets, m_buckets + kBuckets, 0U);
+}
+
+void Histogram::Record(unsigned long long value)
+{
+    if (m_count == 0 || value < m_min)
+        m_min = value;
+    if (value > m_max)
+        m_max = value;
+    m_count++;
+    m_total += value;
+    m_buckets[GetBucket(value)]++;
+}
+
+void Histogram::Add(const Histogram& other)
+{
+    if (other.m_count == 0)
+        return;
+    if (m_count == 0 || other.m_min < m_min)
+        m_min = other.m_min;
+    if (other.m_max > m_max)
+        m_max = other.m_max;
+    m_count += other.m_count;
+    m_total += other.m_total;
+    for (int i = 0; i < kBuckets; i++)
+        m_buckets[i] += other.m_buckets[i];
+}
+
+unsigned long long Histogram::GetPercentile(double percentile) const
+{
+    if (m_count == 0)
+        return 0;
+
+    // The rank of the value, rounded up
+    double exactRank = percentile / 100 * m_count;
+    unsigned long long rank = (unsigned long long)exactRank;
+    if (rank < exactRank || rank == 0)
+        rank++;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return std::min(GetBucketLimit(i), m_max);
+    }
+    return m_max;
+}
+
+int Histogram::GetBucket(unsigned long long value)
+{
+    if (value < (unsigned long long)kSubBuckets)
+        return (int)value;
+
+    // Index of the highest bit set
+    int magnitude = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if (value >> (magnitude + shift))
+            magnitude += shift;
+    }
+    if (magnitude > kMaxMagnitude)
+        return kBuckets - 1;
+
+    int subBucket = (int)(value >> (magnitude - kSubBucketBits)) & (kSubBuckets - 1);
+    return ((magnitude - kSubBucketBits + 1) << kSubBucketBits) + subBucket;
+}
+
+unsigned long long Histogram::GetBucketLimit(int bucket)
+{
+    if (bucket < kSubBuckets)
+        return (unsigned long long)bucket;
+
+    int magnitude = (bucket >> kSubBucketBits) + kSubBucketBits - 1;
+    unsigned long long width = 1ULL << (magnitude - kSubBucketBits);
+    return (1ULL << magnitude) + (bucket & (kSubBuckets - 1)) * width + width - 1;
+}
+
+namespace {
+
+struct Counters {
+    Counters() : calls(0), errors(0), bytesIn(0), bytesOut(0) {}
+
+    unsigned long long calls;
+    unsigned long long errors;
+    unsigned long long bytesIn;
+    unsigned long long bytesOut;
+    Histogram latency;
+    Histogram callbackLatency;
+};
+
+// The counters of one thread, by method id. Only that thread changes them,
+// so its lock is only ever waited for while GetStats() reads them.
+struct Shard {
+    Shard() : currentMethodId(-1) {}
+
+    Lock lock;
+    std::vector<Counters> methods;
+    int currentMethodId;            // Only used by the thread itself
+};
+
+// Guards the method names and the list of shards. Shards are never deleted,
+// so what threads that exited recorded is still counted.
+Lock g_lock;
+std::vector<std::string> g_names;
+std::vector<Shard*> g_shards;
+
+ThreadLocalPointer g_currentShard;
+
+Shard* GetShard()
+{
+    Shard* shard = static_cast<Shard*>(g_currentShard.Get());
+    if (!shard) {
+        shard = new Shard;
+        g_currentShard.Set(shard);
+
+        AutoLock lock(g_lock);
+        g_shards.push_back(shard);
+    }
+    return shard;
+}
+
+// shard->lock must be held
+Counters& GetCounters(Shard* shard, int methodId)
+{
+    if ((size_t)methodId >= shard->methods.size())
+        shard->methods.resize(methodId + 1);
+    return shard->methods[methodId];
+}
+
+void AppendNumber(std::string& out, unsigned long long value)
+{
+    char buffer[32];
+    sprintf(buffer, "%llu", value);
+    out += buffer;
+}
+
+void AppendMilliseconds(std::string& out, unsigned long long nanoseconds)
+{
+    char buffer[32];
+    sprintf(buffer, "%.6f", nanoseconds / 1000000.0);
+    out += buffer;
+}
+
+void AppendHistogramJSON(std::string& out, const Histogram& histogram)
+{
+    out += "{\"count\":";
+    AppendNumber(out, histogram.GetCount());
+    out += ",\"min\":";
+    AppendMilliseconds(out, histogram.GetMin());
+    out += ",\"mean\":";
+    AppendMilliseconds(out, histogram.GetMean());
+    out += ",\"max\":";
+    AppendMilliseconds(out, histogram.GetMax());
+    out += ",\"p50\":";
+    AppendMilliseconds(out, histogram.GetPercentile(50));
+    out += ",\"p90\":";
+    AppendMilliseconds(out, histogram.GetPercentile(90));
+    out += ",\"p99\":";
+    AppendMilliseconds(out, histogram.GetPercentile(99));
+    out += ",\"p999\":";
+    AppendMilliseconds(out, histogram.GetPercentile(99.9));
+    out += ",\"buckets\":[";
+    bool first = true;
+    for (int i = 0; i < Histogram::kBuckets; i++) {
+        if (!histogram.GetBucketCount(i))
+            continue;
+        if (!first)
+            out += ',';
+        first = false;
+        out += '[';
+        AppendMilliseconds(out, Histogram::GetBucketLimit(i));
+        out += ',';
+        AppendNumber(out, histogram.GetBucketCount(i));
+        out += ']';
+    }
+    out += "]}";
+}
+
+} // namespace
+
+int AddMethod(const std::string& name)
+{
+    AutoLock lock(g_lock);
+    std::vector<std::string>::iterator it = std::find(g_names.begin(), g_names.end(), name);
+    if (it != g_names.end())
+        return (int)(it - g_names.begin());
+    g_names.push_back(name);
+    return (int)g_names.size() - 1;
+}
+
+void RecordCall(int methodId, int error, size_t bytesIn, unsigned long long nanoseconds)
+{
+    if (methodId < 0)
+        return;
+
+    Shard* shard = GetShard();
+    AutoLock lock(shard->lock);
+    Counters& counters = GetCounters(shard, methodId);
+    counters.calls++;
+    if (error != NO_ERROR)
+        counters.errors++;
+    counters.bytesIn += bytesIn;
+    counters.latency.Record(nanoseconds);
+}
+
+void RecordResult(int methodId, size_t bytesOut)
+{
+    if (methodId < 0)
+        return;
+
+    Shard* shard = GetShard();
+    AutoLock lock(shard->lock);
+    GetCounters(shard, methodId).bytesOut += bytesOut;
+}
+
+void RecordCallbackDone(int methodId, int error, unsigned long long nanoseconds)
+{
+    if (methodId < 0)
+        return;
+
+    Shard* shard = GetShard();
+    AutoLock lock(shard->lock);
+    Counters& counters = GetCounters(shard, methodId);
+    if (error != NO_ERROR)
+        counters.errors++;
+    counters.callbackLatency.Record(nanoseconds);
+}
+
+MethodScope::MethodScope(int methodId)
+{
+    Shard* shard = GetShard();
+    m_previousMethodId = shard->currentMethodId;
+    shard->currentMethodId = methodId;
+}
+
+MethodScope::~MethodScope()
+{
+    GetShard()->currentMethodId = m_previousMethodId;
+}
+
+int GetCurrentMethod()
+{
+    return GetShard()->currentMethodId;
+}
+
+void GetStats(MethodStatsList& stats)
+{
+    std::vector<Shard*> shards;
+    {
+        AutoLock lock(g_lock);
+        stats.resize(g_names.size());
+        for (size_t i = 0; i < g_names.size(); i++) {
+            MethodStats& method = stats[i];
+            method.name = g_names[i];
+            method.calls = 0;
+            method.errors = 0;
+            method.bytesIn = 0;
+            method.bytesOut = 0;
+            method.latency = Histogram();
+            method.callbackLatency = Histogram();
+        }
+        shards = g_shards;
+    }
+
+    for (size_t i = 0; i < shards.size(); i++) {
+        AutoLock lock(shards[i]->lock);
+        const std::vector<Counters>& methods = shards[i]->methods;
+        for (size_t j = 0; j < methods.size() && j < stats.size(); j++) {
+            stats[j].calls += methods[j].calls;
+            stats[j].errors += methods[j].errors;
+            stats[j].bytesIn += methods[j].bytesIn;
+            stats[j].bytesOut += methods[j].bytesOut;
+            stats[j].latency.Add(methods[j].latency);
+            stats[j].callbackLatency.Add(methods[j].callbackLatency);
+        }
+    }
+}
+
+void AppendStatsJSON(std::string& out, const MethodStatsList& stats)
+{
+    out += '[';
+    for (size_t i = 0; i < stats.size(); i++) {
+        const MethodStats& method = stats[i];
+        if (i)
+            out += ',';
+        out += "{\"name\":";
+        JSON::AppendString(out, method.name);
+        out += ",\"calls\":";
+        AppendNumber(out, method.calls);
+        out += ",\"errors\":";
+        AppendNumber(out, method.errors);
+        out += ",\"bytesIn\":";
+        AppendNumber(out, method.bytesIn);
+        out += ",\"bytesOut\":";
+        AppendNumber(out, method.bytesOut);
+        out += ",\"latency\":";
+        AppendHistogramJSON(out, method.latency);
+        out += ",\"callbackLatency\":";
+        AppendHistogramJSON(out, method.callbackLatency);
+        out += '}';
+    }
+    out += ']';
+}
+
+int WriteStats(const std::string& path)
+{
+    MethodStatsList stats;
+    GetStats(stats);
+
+    std::string json;
+    AppendStatsJSON(json, stats);
+    json += '\n';
+    return FileSystem::WriteFile(path, json, "utf8");
+}
+
+void WriteStatsOnExit()
+{
+    const char* path = getenv(kStatsFileVariable);
+    if (path && *path)
+        WriteStats(path);
+}
+
+} // namespace Metrics
+} // namespace Brackets
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_METRICS_H
+#define _BRACKETS_METRICS_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Counters for the native methods: calls, errors, bytes in and out, and the
+ * time they take. The native methods record them as they run (see
+ * V8Binding::MethodTable and AsyncCallbacks), and brackets.app.getNativeStats()
+ * returns them, so the cost of the bridge can be measured in the running app.
+ *
+ * Each thread records into its own counters, which only it writes, so
+ * recording never waits for another thread. GetStats() adds them up.
+ */
+namespace Brackets {
+namespace Metrics {
+
+// A latency histogram, in nanoseconds. Like HdrHistogram, every power of two
+// is split into kSubBuckets buckets of the same width, so each value is kept
+// within about 12% whatever its magnitude, in a few hundred counters.
+// Values of 2^kMaxMagnitude ns (about 18 minutes) and more all go in the
+// last bucket.
+class Histogram {
+public:
+    static const int kSubBucketBits = 3;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    static const int kMaxMagnitude = 40;
+    static const int kBuckets = (kMaxMagnitude - kSubBucketBits + 2) * kSubBuckets;
+
+    Histogram();
+
+    void Record(unsigned long long value);
+    void Add(const Histogram& other);
+
+    unsigned long long GetCount() const { return m_count; }
+    unsigned long long GetMin() const { return m_count ? m_min : 0; }
+    unsigned long long GetMax() const { return m_max; }
+    unsigned long long GetMean() const { return m_count ? m_total / m_count : 0; }
+
+    // Returns the value below which percentile % of the values are, to the
+    // precision of the buckets
+    unsigned long long GetPercentile(double percentile) const;
+
+    unsigned int GetBucketCount(int bucket) const { return m_buckets[bucket]; }
+
+    static int GetBucket(unsigned long long value);
+
+    // Returns the largest value that goes in bucket
+    static unsigned long long GetBucketLimit(int bucket);
+
+private:
+    unsigned long long m_count;
+    unsigned long long m_total;
+    unsigned long long m_min;
+    unsigned long long m_max;
+    unsigned int m_buckets[kBuckets];
+};
+
+struct MethodStats {
+    std::string name;
+    unsigned long long calls;
+    unsigned long long errors;          // calls that returned an error, or passed one to their callback
+    unsigned long long bytesIn;         // size of the string arguments
+    unsigned long long bytesOut;        // size of the file contents passed to the callbacks
+    Histogram latency;                  // time spent in the native method
+    Histogram callbackLatency;          // time from the call to its last callback, for asynchronous calls
+};
+
+typedef std::vector<MethodStats> MethodStatsList;
+
+// Returns the id of the method called name, adding it if it is new
+int AddMethod(const std::string& name);
+
+// Records a call to methodId that returned error after nanoseconds
+void RecordCall(int methodId, int error, size_t bytesIn, unsigned long long nanoseconds);
+
+// Records a result passed to the callback of a call to methodId
+void RecordResult(int methodId, size_t bytesOut);
+
+// Records the last callback of a call to methodId, passed error, nanoseconds
+// after the call was made
+void RecordCallbackDone(int methodId, int error, unsigned long long nanoseconds);
+
+// Makes methodId the method running on this thread, for the lifetime of the
+// object, so the callbacks it registers can be attributed to it
+class MethodScope {
+public:
+    explicit MethodScope(int methodId);
+    ~MethodScope();
+
+private:
+    int m_previousMethodId;
+
+    // Not copyable
+    MethodScope(const MethodScope&);
+    MethodScope& operator=(const MethodScope&);
+};
+
+// Returns the method running on this thread, or -1
+int GetCurrentMethod();
+
+// Gets the counters of all threads added up, for each method, in the order
+// they were added
+void GetStats(MethodStatsList& stats);
+
+// Appends the stats as a JSON array of { name, calls, errors, bytesIn,
+// bytesOut, latency, callbackLatency } objects. The histograms are
+// { count, min, mean, max, p50, p90, p99, p999, buckets } objects, in
+// milliseconds, where buckets is an array of [max, count] pairs for the
+// buckets that aren't empty.
+void AppendStatsJSON(std::string& out, const MethodStatsList& stats);
+
+// Writes the stats of all methods to path as JSON. Returns the error of
+// FileSystem::WriteFile().
+int WriteStats(const std::string& path);
+
+// Environment variable with the path WriteStatsOnExit() writes to
+extern const char kStatsFileVariable[];
+
+// Writes the stats to the file named by kStatsFileVariable, if it is set.
+// Called by ShutdownBracketsExtensions().
+void WriteStatsOnExit();
+
+} // namespace Metrics
+} // namespace Brackets
+
+#endif // _BRACKETS_METRICS_H
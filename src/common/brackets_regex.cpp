@@ -0,0 +1,1014 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_regex.h"
+
+#include <algorithm>
+#include <string.h>
+
+// See brackets_encoding.cpp
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRACKETS_REGEX_USE_SSE2 1
+#else
+#define BRACKETS_REGEX_USE_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Brackets {
+
+namespace {
+
+// Patterns like (a{1000}){1000} are refused rather than compiled
+const size_t kMaxProgramSize = 20000;
+
+const unsigned int kMaxCodePoint = 0x10FFFF;
+
+enum Op {
+    OP_CHAR = 0,    // one code point, folded if ignoring case
+    OP_ANY,         // any code point but a line break
+    OP_CLASS,       // a code point in m_classes[value]
+    OP_ASSERT,      // value is an Assertion, consumes nothing
+    OP_SPLIT,       // continue at the next instruction, then at target
+    OP_JUMP,        // continue at target
+    OP_MATCH
+};
+
+enum Assertion {
+    ASSERT_LINE_START = 0,
+    ASSERT_LINE_END,
+    ASSERT_WORD_BOUNDARY,
+    ASSERT_NOT_WORD_BOUNDARY
+};
+
+inline unsigned char FoldASCII(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+inline unsigned int FoldCodePoint(unsigned int c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+inline bool IsWordChar(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Decodes the code point at p. Bytes that don't start a well-formed
+// sequence are taken as one code point each, so any text can be searched.
+inline int DecodeAt(const unsigned char* p, const unsigned char* end, unsigned int& codePoint)
+{
+    unsigned char c = *p;
+    int length = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+    if (length == 1 || end - p < length) {
+        codePoint = c;
+        return 1;
+    }
+
+    codePoint = c & (0x3F >> (length - 1));
+    for (int i = 1; i < length; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            codePoint = c;
+            return 1;
+        }
+        codePoint = (codePoint << 6) | (p[i] & 0x3F);
+    }
+    return length;
+}
+
+#if BRACKETS_REGEX_USE_SSE2
+// Index of the lowest set bit of a non-zero mask
+inline int FindFirstBit(int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, (unsigned long)mask);
+    return (int)index;
+#else
+    return __builtin_ctz((unsigned int)mask);
+#endif
+}
+
+// Marks the bytes of block that equal c, or fold to it if ignoreCase is set
+inline __m128i CompareBytes(__m128i block, unsigned char c, bool ignoreCase)
+{
+    // Only letters have another case, and setting 0x20 lower cases them
+    if (ignoreCase && c >= 'a' && c <= 'z')
+        block = _mm_or_si128(block, _mm_set1_epi8(0x20));
+    return _mm_cmpeq_epi8(block, _mm_set1_epi8((char)c));
+}
+#endif
+
+inline bool MatchesAt(const unsigned char* p, const std::string& literal, bool ignoreCase)
+{
+    if (!ignoreCase)
+        return memcmp(p, literal.data(), literal.length()) == 0;
+
+    for (size_t i = 0; i < literal.length(); i++) {
+        if (FoldASCII(p[i]) != (unsigned char)literal[i])
+            return false;
+    }
+    return true;
+}
+
+// Parsed pattern
+struct Node {
+    enum Type {
+        EMPTY = 0,
+        CHAR,
+        ANY,
+        CLASS,
+        ASSERT,
+        CONCAT,
+        ALTERNATE,
+        REPEAT
+    };
+
+    explicit Node(Type type) : type(type), value(0), min(0), max(0), greedy(true) {}
+
+    Type type;
+    unsigned int value;     // code point, class index or assertion
+    int min;                // REPEAT
+    int max;                // REPEAT, -1 if unbounded
+    bool greedy;            // REPEAT
+    std::vector<Node*> children;
+};
+
+// Recursive descent parser for the pattern, and the compiler that turns the
+// parse tree into the program
+class Compiler {
+public:
+    Compiler(const std::vector<unsigned int>& pattern, bool ignoreCase, std::vector<Regex::Instruction>& program,
+             std::vector<Regex::CharClass>& classes)
+        : m_pattern(pattern), m_pos(0), m_ignoreCase(ignoreCase), m_failed(false), m_program(program)
+        , m_classes(classes)
+    {
+    }
+
+    ~Compiler()
+    {
+        for (size_t i = 0; i < m_nodes.size(); i++)
+            delete m_nodes[i];
+    }
+
+    bool Compile(std::string& requiredLiteral)
+    {
+        Node* root = ParseAlternation();
+        if (m_failed || m_pos != m_pattern.size())
+            return false;
+
+        Emit(root);
+        Add(OP_MATCH, 0, 0);
+        if (m_failed || m_program.size() > kMaxProgramSize)
+            return false;
+
+        FindRequiredLiteral(root, requiredLiteral);
+        return true;
+    }
+
+private:
+    Node* NewNode(Node::Type type)
+    {
+        m_nodes.push_back(new Node(type));
+        return m_nodes.back();
+    }
+
+    bool AtEnd() const { return m_pos >= m_pattern.size(); }
+    unsigned int Peek() const { return m_pattern[m_pos]; }
+
+    Node* Fail()
+    {
+        m_failed = true;
+        return NewNode(Node::EMPTY);
+    }
+
+    Node* ParseAlternation()
+    {
+        Node* first = ParseConcatenation();
+        if (AtEnd() || Peek() != '|')
+            return first;
+
+        Node* node = NewNode(Node::ALTERNATE);
+        node->children.push_back(first);
+        while (!m_failed && !AtEnd() && Peek() == '|') {
+            m_pos++;
+            node->children.push_back(ParseConcatenation());
+        }
+        return node;
+    }
+
+    Node* ParseConcatenation()
+    {
+        Node* node = NewNode(Node::CONCAT);
+        while (!m_failed && !AtEnd() && Peek() != '|' && Peek() != ')')
+            node->children.push_back(ParseRepeat());
+        return node;
+    }
+
+    Node* ParseRepeat()
+    {
+        Node* atom = ParseAtom();
+        if (m_failed || AtEnd())
+            return atom;
+
+        int min;
+        int max;
+        unsigned int c = Peek();
+        if (c == '*') {
+            min = 0;
+            max = -1;
+            m_pos++;
+        } else if (c == '+') {
+            min = 1;
+            max = -1;
+            m_pos++;
+        } else if (c == '?') {
+            min = 0;
+            max = 1;
+            m_pos++;
+        } else if (c != '{' || !ParseBraces(min, max)) {
+            return atom;
+        }
+
+        if (atom->type == Node::ASSERT)
+            return Fail();
+
+        Node* node = NewNode(Node::REPEAT);
+        node->min = min;
+        node->max = max;
+        node->children.push_back(atom);
+        if (!AtEnd() && Peek() == '?') {
+            node->greedy = false;
+            m_pos++;
+        }
+
+        // JavaScript refuses a** and the like
+        if (!AtEnd() && (Peek() == '*' || Peek() == '+' || Peek() == '?'))
+            return Fail();
+        return node;
+    }
+
+    // Parses {n}, {n,} or {n,m}. Anything else is a literal '{', as in
+    // JavaScript.
+    bool ParseBraces(int& min, int& max)
+    {
+        size_t pos = m_pos + 1;
+        if (!ParseNumber(pos, min))
+            return false;
+
+        max = min;
+        if (pos < m_pattern.size() && m_pattern[pos] == ',') {
+            pos++;
+            max = -1;
+            if (pos < m_pattern.size() && m_pattern[pos] != '}' && !ParseNumber(pos, max))
+                return false;
+        }
+
+        if (pos >= m_pattern.size() || m_pattern[pos] != '}')
+            return false;
+
+        if (max != -1 && max < min) {
+            m_failed = true;
+            return false;
+        }
+
+        m_pos = pos + 1;
+        return true;
+    }
+
+    bool ParseNumber(size_t& pos, int& value)
+    {
+        size_t start = pos;
+        value = 0;
+        while (pos < m_pattern.size() && m_pattern[pos] >= '0' && m_pattern[pos] <= '9') {
+            // Anything this large would exceed kMaxProgramSize anyway
+            if (value > 100000)
+                m_failed = true;
+            value = value * 10 + (int)(m_pattern[pos] - '0');
+            pos++;
+        }
+        return pos > start && !m_failed;
+    }
+
+    Node* ParseAtom()
+    {
+        unsigned int c = Peek();
+        m_pos++;
+
+        switch (c) {
+        case '(':
+            return ParseGroup();
+        case '[':
+            return ParseClass();
+        case '.':
+            return NewNode(Node::ANY);
+        case '^':
+            return NewAssertion(ASSERT_LINE_START);
+        case '$':
+            return NewAssertion(ASSERT_LINE_END);
+        case '\\':
+            return ParseEscape();
+        case '*':
+        case '+':
+        case '?':
+            return Fail();
+        default:
+            return NewChar(c);
+        }
+    }
+
+    Node* ParseGroup()
+    {
+        if (!AtEnd() && Peek() == '?') {
+            // Only (?:...). Lookahead and lookbehind are not supported.
+            if (m_pos + 1 >= m_pattern.size() || m_pattern[m_pos + 1] != ':')
+                return Fail();
+            m_pos += 2;
+        }
+
+        Node* node = ParseAlternation();
+        if (AtEnd() || Peek() != ')')
+            return Fail();
+        m_pos++;
+        return node;
+    }
+
+    Node* ParseEscape()
+    {
+        if (AtEnd())
+            return Fail();
+
+        unsigned int c = Peek();
+        m_pos++;
+
+        switch (c) {
+        case 'b':
+            return NewAssertion(ASSERT_WORD_BOUNDARY);
+        case 'B':
+            return NewAssertion(ASSERT_NOT_WORD_BOUNDARY);
+        case 'd':
+        case 'D':
+        case 'w':
+        case 'W':
+        case 's':
+        case 'S': {
+            Regex::CharClass charClass;
+            charClass.negated = false;
+            AddPredefinedClass(c, charClass.ranges);
+            return NewClass(charClass);
+        }
+        default:
+            break;
+        }
+
+        unsigned int codePoint;
+        if (!ParseEscapedChar(c, codePoint))
+            return Fail();
+        return NewChar(codePoint);
+    }
+
+    // Handles the escapes that stand for a single character. c is the
+    // character after the backslash, which has been consumed.
+    bool ParseEscapedChar(unsigned int c, unsigned int& codePoint)
+    {
+        switch (c) {
+        case 't': codePoint = '\t'; return true;
+        case 'n': codePoint = '\n'; return true;
+        case 'r': codePoint = '\r'; return true;
+        case 'f': codePoint = '\f'; return true;
+        case 'v': codePoint = '\v'; return true;
+        case '0':
+            // \0 followed by a digit would be an octal escape
+            if (!AtEnd() && Peek() >= '0' && Peek() <= '9')
+                return false;
+            codePoint = 0;
+            return true;
+        case 'x':
+            return ParseHex(2, codePoint);
+        case 'u':
+            return ParseHex(4, codePoint);
+        case 'c':
+            if (AtEnd() || !((Peek() >= 'a' && Peek() <= 'z') || (Peek() >= 'A' && Peek() <= 'Z')))
+                return false;
+            codePoint = Peek() % 32;
+            m_pos++;
+            return true;
+        default:
+            // Backreferences are not supported
+            if (c >= '1' && c <= '9')
+                return false;
+            codePoint = c;
+            return true;
+        }
+    }
+
+    bool ParseHex(int digits, unsigned int& codePoint)
+    {
+        codePoint = 0;
+        for (int i = 0; i < digits; i++) {
+            if (AtEnd())
+                return false;
+            unsigned int c = Peek();
+            int value;
+            if (c >= '0' && c <= '9')
+                value = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value = c - 'A' + 10;
+            else
+                return false;
+            codePoint = codePoint * 16 + value;
+            m_pos++;
+        }
+        return true;
+    }
+
+    Node* ParseClass()
+    {
+        Regex::CharClass charClass;
+        charClass.negated = false;
+        if (!AtEnd() && Peek() == '^') {
+            charClass.negated = true;
+            m_pos++;
+        }
+
+        // A ']' right at the start never closes the class in JavaScript,
+        // it is an empty class instead
+        while (!AtEnd() && Peek() != ']') {
+            unsigned int low;
+            if (!ParseClassAtom(charClass.ranges, low))
+                return Fail();
+            if (low == kMaxCodePoint + 1)
+                continue;   // \d and friends
+
+            unsigned int high = low;
+            if (m_pos + 1 < m_pattern.size() && Peek() == '-' && m_pattern[m_pos + 1] != ']') {
+                m_pos++;
+                if (!ParseClassAtom(charClass.ranges, high))
+                    return Fail();
+                if (high == kMaxCodePoint + 1) {
+                    // [a-\d] means 'a', '-' or a digit
+                    charClass.ranges.push_back(std::make_pair(low, low));
+                    charClass.ranges.push_back(std::make_pair((unsigned int)'-', (unsigned int)'-'));
+                    continue;
+                }
+                if (high < low)
+                    return Fail();
+            }
+            charClass.ranges.push_back(std::make_pair(low, high));
+        }
+
+        if (AtEnd())
+            return Fail();
+        m_pos++;
+
+        return NewClass(charClass);
+    }
+
+    // Parses one character of a class. Predefined classes are added to
+    // ranges right away, and codePoint is set to kMaxCodePoint + 1.
+    bool ParseClassAtom(std::vector<std::pair<unsigned int, unsigned int> >& ranges, unsigned int& codePoint)
+    {
+        unsigned int c = Peek();
+        m_pos++;
+        if (c != '\\') {
+            codePoint = c;
+            return true;
+        }
+
+        if (AtEnd())
+            return false;
+        c = Peek();
+        m_pos++;
+
+        switch (c) {
+        case 'd':
+        case 'D':
+        case 'w':
+        case 'W':
+        case 's':
+        case 'S':
+            AddPredefinedClass(c, ranges);
+            codePoint = kMaxCodePoint + 1;
+            return true;
+        case 'b':
+            codePoint = '\b';
+            return true;
+        default:
+            return ParseEscapedChar(c, codePoint);
+        }
+    }
+
+    void AddPredefinedClass(unsigned int c, std::vector<std::pair<unsigned int, unsigned int> >& ranges)
+    {
+        std::vector<std::pair<unsigned int, unsigned int> > set;
+        switch (c) {
+        case 'd':
+        case 'D':
+            set.push_back(std::make_pair((unsigned int)'0', (unsigned int)'9'));
+            break;
+        case 'w':
+        case 'W':
+            set.push_back(std::make_pair((unsigned int)'0', (unsigned int)'9'));
+            set.push_back(std::make_pair((unsigned int)'A', (unsigned int)'Z'));
+            set.push_back(std::make_pair((unsigned int)'_', (unsigned int)'_'));
+            set.push_back(std::make_pair((unsigned int)'a', (unsigned int)'z'));
+            break;
+        default: {
+            static const unsigned int kSpaces[][2] = {
+                { 0x09, 0x0D }, { 0x20, 0x20 }, { 0xA0, 0xA0 }, { 0x1680, 0x1680 }, { 0x2000, 0x200A },
+                { 0x2028, 0x2029 }, { 0x202F, 0x202F }, { 0x205F, 0x205F }, { 0x3000, 0x3000 },
+                { 0xFEFF, 0xFEFF }
+            };
+            for (size_t i = 0; i < sizeof(kSpaces) / sizeof(kSpaces[0]); i++)
+                set.push_back(std::make_pair(kSpaces[i][0], kSpaces[i][1]));
+            break;
+        }
+        }
+
+        // The upper case forms are the complements
+        if (c == 'D' || c == 'W' || c == 'S') {
+            unsigned int next = 0;
+            for (size_t i = 0; i < set.size(); i++) {
+                if (set[i].first > next)
+                    ranges.push_back(std::make_pair(next, set[i].first - 1));
+                next = set[i].second + 1;
+            }
+            ranges.push_back(std::make_pair(next, kMaxCodePoint));
+        } else {
+            ranges.insert(ranges.end(), set.begin(), set.end());
+        }
+    }
+
+    Node* NewChar(unsigned int codePoint)
+    {
+        Node* node = NewNode(Node::CHAR);
+        node->value = m_ignoreCase ? FoldCodePoint(codePoint) : codePoint;
+        return node;
+    }
+
+    Node* NewAssertion(Assertion assertion)
+    {
+        Node* node = NewNode(Node::ASSERT);
+        node->value = assertion;
+        return node;
+    }
+
+    Node* NewClass(Regex::CharClass& charClass)
+    {
+        // Classes are matched against the text as it is, so they get both
+        // cases of their letters
+        if (m_ignoreCase) {
+            size_t count = charClass.ranges.size();
+            for (size_t i = 0; i < count; i++) {
+                AddOtherCase(charClass.ranges[i], 'A', 'Z', 'a' - 'A', charClass.ranges);
+                AddOtherCase(charClass.ranges[i], 'a', 'z', -('a' - 'A'), charClass.ranges);
+            }
+        }
+
+        Node* node = NewNode(Node::CLASS);
+        node->value = (unsigned int)m_classes.size();
+        m_classes.push_back(charClass);
+        return node;
+    }
+
+    // Adds the part of range within [first, last], shifted by offset
+    static void AddOtherCase(std::pair<unsigned int, unsigned int> range, unsigned int first, unsigned int last,
+                             int offset, std::vector<std::pair<unsigned int, unsigned int> >& ranges)
+    {
+        unsigned int low = (range.first > first) ? range.first : first;
+        unsigned int high = (range.second < last) ? range.second : last;
+        if (low <= high)
+            ranges.push_back(std::make_pair(low + offset, high + offset));
+    }
+
+    int Add(Op op, unsigned int value, int target)
+    {
+        Regex::Instruction instruction;
+        instruction.op = op;
+        instruction.value = value;
+        instruction.target = target;
+        m_program.push_back(instruction);
+        return (int)m_program.size() - 1;
+    }
+
+    void Emit(const Node* node)
+    {
+        // Stop early instead of running out of memory
+        if (m_program.size() > kMaxProgramSize) {
+            m_failed = true;
+            return;
+        }
+
+        switch (node->type) {
+        case Node::EMPTY:
+            break;
+        case Node::CHAR:
+            Add(OP_CHAR, node->value, 0);
+            break;
+        case Node::ANY:
+            Add(OP_ANY, 0, 0);
+            break;
+        case Node::CLASS:
+            Add(OP_CLASS, node->value, 0);
+            break;
+        case Node::ASSERT:
+            Add(OP_ASSERT, node->value, 0);
+            break;
+        case Node::CONCAT:
+            for (size_t i = 0; i < node->children.size(); i++)
+                Emit(node->children[i]);
+            break;
+        case Node::ALTERNATE:
+            EmitAlternation(node->children, 0);
+            break;
+        case Node::REPEAT:
+            EmitRepeat(node);
+            break;
+        }
+    }
+
+    void EmitAlternation(const std::vector<Node*>& children, size_t index)
+    {
+        if (index == children.size() - 1) {
+            Emit(children[index]);
+            return;
+        }
+
+        int split = Add(OP_SPLIT, 0, 0);
+        Emit(children[index]);
+        int jump = Add(OP_JUMP, 0, 0);
+        m_program[split].target = (int)m_program.size();
+        EmitAlternation(children, index + 1);
+        m_program[jump].target = (int)m_program.size();
+    }
+
+    // A split prefers the next instruction, so a lazy repeat jumps over a
+    // split that prefers leaving the loop
+    void EmitRepeat(const Node* node)
+    {
+        const Node* child = node->children[0];
+        for (int i = 0; i < node->min; i++)
+            Emit(child);
+
+        if (node->max == -1) {
+            int loop = (int)m_program.size();
+            int split = EmitSplit(node->greedy);
+            Emit(child);
+            Add(OP_JUMP, 0, loop);
+            SetSplitExit(split, node->greedy);
+            return;
+        }
+
+        std::vector<int> splits;
+        for (int i = node->min; i < node->max && !m_failed; i++) {
+            splits.push_back(EmitSplit(node->greedy));
+            Emit(child);
+        }
+        for (size_t i = 0; i < splits.size(); i++)
+            SetSplitExit(splits[i], node->greedy);
+    }
+
+    // Emits the split at the top of an optional child. Returns the index to
+    // pass to SetSplitExit() once the child was emitted.
+    int EmitSplit(bool greedy)
+    {
+        if (greedy)
+            return Add(OP_SPLIT, 0, 0);
+
+        // Prefer skipping: jump to the exit first, the split's target enters
+        // the child
+        int split = Add(OP_SPLIT, 0, 0);
+        Add(OP_JUMP, 0, 0);
+        m_program[split].target = (int)m_program.size();
+        return split;
+    }
+
+    void SetSplitExit(int split, bool greedy)
+    {
+        if (greedy)
+            m_program[split].target = (int)m_program.size();
+        else
+            m_program[split + 1].target = (int)m_program.size();
+    }
+
+    // Finds the longest run of characters that every match contains: the
+    // longest sequence of plain characters at the top level of the pattern
+    void FindRequiredLiteral(const Node* root, std::string& literal)
+    {
+        literal.clear();
+        if (root->type != Node::CONCAT)
+            return;
+
+        std::string current;
+        for (size_t i = 0; i <= root->children.size(); i++) {
+            const Node* child = (i < root->children.size()) ? root->children[i] : NULL;
+            if (child && child->type == Node::CHAR) {
+                AppendUTF8(child->value, current);
+                continue;
+            }
+            if (current.length() > literal.length())
+                literal = current;
+            current.clear();
+        }
+    }
+
+    static void AppendUTF8(unsigned int c, std::string& out)
+    {
+        if (c < 0x80) {
+            out += (char)c;
+        } else if (c < 0x800) {
+            out += (char)(0xC0 | (c >> 6));
+            out += (char)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += (char)(0xE0 | (c >> 12));
+            out += (char)(0x80 | ((c >> 6) & 0x3F));
+            out += (char)(0x80 | (c & 0x3F));
+        } else {
+            out += (char)(0xF0 | (c >> 18));
+            out += (char)(0x80 | ((c >> 12) & 0x3F));
+            out += (char)(0x80 | ((c >> 6) & 0x3F));
+            out += (char)(0x80 | (c & 0x3F));
+        }
+    }
+
+    const std::vector<unsigned int>& m_pattern;
+    size_t m_pos;
+    bool m_ignoreCase;
+    bool m_failed;
+    std::vector<Node*> m_nodes;
+    std::vector<Regex::Instruction>& m_program;
+    std::vector<Regex::CharClass>& m_classes;
+};
+
+// The threads of the Pike VM at one position, in priority order. Each
+// instruction is in the list at most once.
+class ThreadList {
+public:
+    explicit ThreadList(size_t programSize) : m_marks(programSize, 0), m_generation(1) {}
+
+    void Clear()
+    {
+        m_threads.clear();
+        m_generation++;
+    }
+
+    // Returns false if pc was added since the last Clear()
+    bool Mark(int pc)
+    {
+        if (m_marks[pc] == m_generation)
+            return false;
+        m_marks[pc] = m_generation;
+        return true;
+    }
+
+    struct Thread {
+        int pc;
+        size_t start;
+    };
+
+    std::vector<Thread>& GetThreads() { return m_threads; }
+
+private:
+    std::vector<Thread> m_threads;
+    std::vector<unsigned int> m_marks;
+    unsigned int m_generation;
+};
+
+bool ClassMatches(const Regex::CharClass& charClass, unsigned int c)
+{
+    bool found = false;
+    for (size_t i = 0; i < charClass.ranges.size() && !found; i++)
+        found = (c >= charClass.ranges[i].first && c <= charClass.ranges[i].second);
+    return found != charClass.negated;
+}
+
+bool AssertionHolds(unsigned int assertion, const unsigned char* line, size_t length, size_t pos)
+{
+    switch (assertion) {
+    case ASSERT_LINE_START:
+        return pos == 0;
+    case ASSERT_LINE_END:
+        return pos == length;
+    default: {
+        bool before = pos > 0 && IsWordChar(line[pos - 1]);
+        bool after = pos < length && IsWordChar(line[pos]);
+        return (before != after) == (assertion == ASSERT_WORD_BOUNDARY);
+    }
+    }
+}
+
+// Adds the thread at pc, following splits, jumps and assertions, in
+// priority order
+void AddThread(const std::vector<Regex::Instruction>& program, ThreadList& list, std::vector<int>& stack, int pc,
+               size_t start, const unsigned char* line, size_t length, size_t pos)
+{
+    stack.clear();
+    stack.push_back(pc);
+    while (!stack.empty()) {
+        pc = stack.back();
+        stack.pop_back();
+        if (!list.Mark(pc))
+            continue;
+
+        const Regex::Instruction& instruction = program[pc];
+        switch (instruction.op) {
+        case OP_JUMP:
+            stack.push_back(instruction.target);
+            break;
+        case OP_SPLIT:
+            // The next instruction is tried first
+            stack.push_back(instruction.target);
+            stack.push_back(pc + 1);
+            break;
+        case OP_ASSERT:
+            if (AssertionHolds(instruction.value, line, length, pos))
+                stack.push_back(pc + 1);
+            break;
+        default: {
+            ThreadList::Thread thread;
+            thread.pc = pc;
+            thread.start = start;
+            list.GetThreads().push_back(thread);
+            break;
+        }
+        }
+    }
+}
+
+} // namespace
+
+size_t FindLiteral(const char* text, size_t length, size_t start, const std::string& literal, bool ignoreCase)
+{
+    size_t n = literal.length();
+    if (n == 0)
+        return (start <= length) ? start : kNotFound;
+    if (start > length || length - start < n)
+        return kNotFound;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+    size_t i = start;
+    size_t last = length - n;     // Last possible start of a match
+
+#if BRACKETS_REGEX_USE_SSE2
+    // Compare the first and the last byte of literal at 16 positions at once,
+    // and check the whole literal only where both match
+    unsigned char first = (unsigned char)literal[0];
+    unsigned char lastByte = (unsigned char)literal[n - 1];
+    for (; i + 16 <= last + 1; i += 16) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + n - 1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(CompareBytes(head, first, ignoreCase),
+                                                   CompareBytes(tail, lastByte, ignoreCase)));
+        while (mask) {
+            int bit = FindFirstBit(mask);
+            if (MatchesAt(p + i + bit, literal, ignoreCase))
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i <= last; i++) {
+        if (MatchesAt(p + i, literal, ignoreCase))
+            return i;
+    }
+    return kNotFound;
+}
+
+std::string FoldLiteral(const std::string& literal)
+{
+    std::string result = literal;
+    for (size_t i = 0; i < result.length(); i++)
+        result[i] = (char)FoldASCII((unsigned char)result[i]);
+    return result;
+}
+
+Regex::Regex() : m_ignoreCase(false)
+{
+}
+
+Regex::~Regex()
+{
+}
+
+bool Regex::Compile(const std::string& pattern, bool ignoreCase)
+{
+    m_program.clear();
+    m_classes.clear();
+    m_requiredLiteral.clear();
+    m_ignoreCase = ignoreCase;
+
+    std::vector<unsigned int> codePoints;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(pattern.data());
+    const unsigned char* end = p + pattern.length();
+    while (p < end) {
+        unsigned int c;
+        p += DecodeAt(p, end, c);
+        codePoints.push_back(c);
+    }
+
+    Compiler compiler(codePoints, ignoreCase, m_program, m_classes);
+    if (!compiler.Compile(m_requiredLiteral)) {
+        m_program.clear();
+        m_classes.clear();
+        m_requiredLiteral.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Regex::Search(const char* text, size_t length, size_t start, size_t& matchStart, size_t& matchEnd) const
+{
+    if (m_program.empty() || start > length)
+        return false;
+
+    const unsigned char* line = reinterpret_cast<const unsigned char*>(text);
+    const unsigned char* end = line + length;
+    ThreadList lists[2] = { ThreadList(m_program.size()), ThreadList(m_program.size()) };
+    ThreadList* current = &lists[0];
+    ThreadList* next = &lists[1];
+    std::vector<int> stack;
+    bool matched = false;
+
+    for (size_t pos = start;; ) {
+        // A new attempt starts at every position until something matched,
+        // with the lowest priority
+        if (!matched)
+            AddThread(m_program, *current, stack, 0, pos, line, length, pos);
+
+        std::vector<ThreadList::Thread>& threads = current->GetThreads();
+        if (threads.empty() && (matched || pos >= length))
+            break;
+
+        unsigned int c = 0;
+        int charLength = 0;
+        if (pos < length)
+            charLength = DecodeAt(line + pos, end, c);
+        unsigned int folded = m_ignoreCase ? FoldCodePoint(c) : c;
+
+        next->Clear();
+        for (size_t i = 0; i < threads.size(); i++) {
+            const Instruction& instruction = m_program[threads[i].pc];
+            bool advance = false;
+            switch (instruction.op) {
+            case OP_MATCH:
+                matched = true;
+                matchStart = threads[i].start;
+                matchEnd = pos;
+                // Threads with a lower priority are cut off
+                i = threads.size();
+                continue;
+            case OP_CHAR:
+                advance = (charLength && folded == instruction.value);
+                break;
+            case OP_ANY:
+                advance = (charLength && c != 0x2028 && c != 0x2029);
+                break;
+            case OP_CLASS:
+                advance = (charLength && ClassMatches(m_classes[instruction.value], c));
+                break;
+            default:
+                break;
+            }
+
+            if (advance)
+                AddThread(m_program, *next, stack, threads[i].pc + 1, threads[i].start, line, length, pos + charLength);
+        }
+
+        std::swap(current, next);
+        if (pos >= length)
+            break;
+        pos += charLength;
+    }
+
+    return matched;
+}
+
+} // namespace Brackets
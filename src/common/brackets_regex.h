@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_REGEX_H
+#define _BRACKETS_REGEX_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * Matching of Find in Files queries against UTF-8 text, on any thread.
+ *
+ * Regex understands the JavaScript syntax that people type into a search
+ * box: literals, '.', character classes with ranges, \d \w \s and their
+ * negations, \b \B ^ $, groups, alternation and the greedy and lazy
+ * quantifiers * + ? {n} {n,} {n,m}. Backreferences and lookaround are not
+ * supported. Patterns are compiled to a program that is run as a Pike VM,
+ * so the time taken is linear in the length of the text, whatever the
+ * pattern. Matches never span lines.
+ *
+ * Ignoring case only folds ASCII letters.
+ */
+namespace Brackets {
+
+const size_t kNotFound = (size_t)-1;
+
+// Returns the offset of the first occurrence of literal in text at or after
+// start, or kNotFound. If ignoreCase is true, literal must be lower case
+// already (see FoldLiteral()). Candidates are found 16 bytes at a time with
+// SSE2 where the compiler targets it.
+size_t FindLiteral(const char* text, size_t length, size_t start, const std::string& literal, bool ignoreCase);
+
+// Lower cases the ASCII letters of literal, for FindLiteral()
+std::string FoldLiteral(const std::string& literal);
+
+class Regex {
+public:
+    Regex();
+    ~Regex();
+
+    // Returns false if pattern is not valid or uses syntax that is not
+    // supported
+    bool Compile(const std::string& pattern, bool ignoreCase);
+
+    // Finds the leftmost match in line at or after start. line must not
+    // contain line breaks; ^ and $ match at its ends. Empty matches are
+    // found as well.
+    bool Search(const char* line, size_t length, size_t start, size_t& matchStart, size_t& matchEnd) const;
+
+    // Text that every match contains, for skipping text with FindLiteral()
+    // before running the program. Lower case if ignoring case. Can be empty.
+    const std::string& GetRequiredLiteral() const { return m_requiredLiteral; }
+
+    // The compiled program, see brackets_regex.cpp
+    struct Instruction {
+        int op;
+        unsigned int value;     // code point, class index or assertion
+        int target;             // second branch of a split, or jump target
+    };
+
+    struct CharClass {
+        std::vector<std::pair<unsigned int, unsigned int> > ranges;    // inclusive
+        bool negated;
+    };
+
+private:
+    // Not copyable
+    Regex(const Regex&);
+    Regex& operator=(const Regex&);
+
+    std::vector<Instruction> m_program;
+    std::vector<CharClass> m_classes;
+    bool m_ignoreCase;
+    std::string m_requiredLiteral;
+};
+
+} // namespace Brackets
+
+#endif // _BRACKETS_REGEX_H
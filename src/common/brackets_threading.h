@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_THREADING_H
+#define _BRACKETS_THREADING_H
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/**
+ * Minimal portable threading primitives for the native file system code.
+ * CEF only gives us one file thread; these are used to run work in parallel
+ * on our own worker threads (see brackets_worker_pool.h).
+ */
+namespace Brackets {
+
+class Lock {
+public:
+    Lock();
+    ~Lock();
+
+    void Acquire();
+    void Release();
+
+private:
+#if defined(_WIN32)
+    CRITICAL_SECTION m_lock;
+#else
+    pthread_mutex_t m_lock;
+#endif
+
+    friend class ConditionVariable;
+
+    // Not copyable
+    Lock(const Lock&);
+    Lock& operator=(const Lock&);
+};
+
+// Acquires a lock for the lifetime of the object
+class AutoLock {
+public:
+    explicit AutoLock(Lock& lock) : m_lock(lock) { m_lock.Acquire(); }
+    ~AutoLock() { m_lock.Release(); }
+
+private:
+    Lock& m_lock;
+
+    // Not copyable
+    AutoLock(const AutoLock&);
+    AutoLock& operator=(const AutoLock&);
+};
+
+class ConditionVariable {
+public:
+    // The lock must be held when calling Wait()
+    explicit ConditionVariable(Lock& lock);
+    ~ConditionVariable();
+
+    void Wait();
+    // Returns false if milliseconds passed without a Signal()/Broadcast().
+    // Like Wait(), it can also return early for no reason.
+    bool TimedWait(int milliseconds);
+    void Signal();
+    void Broadcast();
+
+private:
+    Lock& m_lock;
+#if defined(_WIN32)
+    CONDITION_VARIABLE m_cond;
+#else
+    pthread_cond_t m_cond;
+#endif
+
+    // Not copyable
+    ConditionVariable(const ConditionVariable&);
+    ConditionVariable& operator=(const ConditionVariable&);
+};
+
+// A joinable thread. Subclasses implement Run().
+class Thread {
+public:
+    Thread();
+    virtual ~Thread();
+
+    // Returns false if the thread could not be created
+    bool Start();
+
+    // Waits for Run() to return
+    void Join();
+
+    // Returns true if called on this thread
+    bool IsCurrent() const;
+
+protected:
+    virtual void Run() = 0;
+
+private:
+#if defined(_WIN32)
+    static unsigned __stdcall ThreadMain(void* param);
+    HANDLE m_handle;
+    unsigned m_threadId;
+#else
+    static void* ThreadMain(void* param);
+    pthread_t m_thread;
+    bool m_started;
+#endif
+
+    // Not copyable
+    Thread(const Thread&);
+    Thread& operator=(const Thread&);
+};
+
+// A pointer that has its own value on each thread, NULL until Set() is
+// called on that thread. The values are not deleted when their thread exits.
+class ThreadLocalPointer {
+public:
+    ThreadLocalPointer();
+    ~ThreadLocalPointer();
+
+    void* Get() const;
+    void Set(void* value);
+
+private:
+#if defined(_WIN32)
+    DWORD m_index;
+#else
+    pthread_key_t m_key;
+#endif
+
+    // Not copyable
+    ThreadLocalPointer(const ThreadLocalPointer&);
+    ThreadLocalPointer& operator=(const ThreadLocalPointer&);
+};
+
+// Adds 1 to value and returns the result, as one atomic operation. Also acts
+// as a full memory barrier.
+int AtomicIncrement(volatile int* value);
+
+// Keeps the compiler and the processor from moving reads and writes across
+// the call
+void MemoryFence();
+
+// Number of logical processors, at least 1
+int GetNumberOfProcessors();
+
+// Nanoseconds since an arbitrary point, unaffected by changes to the clock
+unsigned long long GetMonotonicTime();
+
+} // namespace Brackets
+
+#endif // _BRACKETS_THREADING_H
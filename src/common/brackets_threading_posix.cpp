@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_threading.h"
+
+#include <errno.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#endif
+
+namespace Brackets {
+
+Lock::Lock()
+{
+    pthread_mutex_init(&m_lock, NULL);
+}
+
+Lock::~Lock()
+{
+    pthread_mutex_destroy(&m_lock);
+}
+
+void Lock::Acquire()
+{
+    pthread_mutex_lock(&m_lock);
+}
+
+void Lock::Release()
+{
+    pthread_mutex_unlock(&m_lock);
+}
+
+ConditionVariable::ConditionVariable(Lock& lock)
+    : m_lock(lock)
+{
+    pthread_cond_init(&m_cond, NULL);
+}
+
+ConditionVariable::~ConditionVariable()
+{
+    pthread_cond_destroy(&m_cond);
+}
+
+void ConditionVariable::Wait()
+{
+    pthread_cond_wait(&m_cond, &m_lock.m_lock);
+}
+
+bool ConditionVariable::TimedWait(int milliseconds)
+{
+#if defined(__APPLE__)
+    struct timespec delay;
+    delay.tv_sec = milliseconds / 1000;
+    delay.tv_nsec = (milliseconds % 1000) * 1000000L;
+    return pthread_cond_timedwait_relative_np(&m_cond, &m_lock.m_lock, &delay) != ETIMEDOUT;
+#else
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    long long nsec = now.tv_usec * 1000LL + (milliseconds % 1000) * 1000000LL;
+
+    struct timespec deadline;
+    deadline.tv_sec = now.tv_sec + milliseconds / 1000 + (time_t)(nsec / 1000000000LL);
+    deadline.tv_nsec = (long)(nsec % 1000000000LL);
+    return pthread_cond_timedwait(&m_cond, &m_lock.m_lock, &deadline) != ETIMEDOUT;
+#endif
+}
+
+void ConditionVariable::Signal()
+{
+    pthread_cond_signal(&m_cond);
+}
+
+void ConditionVariable::Broadcast()
+{
+    pthread_cond_broadcast(&m_cond);
+}
+
+Thread::Thread()
+    : m_started(false)
+{
+}
+
+Thread::~Thread()
+{
+}
+
+bool Thread::Start()
+{
+    m_started = (pthread_create(&m_thread, NULL, ThreadMain, this) == 0);
+    return m_started;
+}
+
+void Thread::Join()
+{
+    if (m_started) {
+        pthread_join(m_thread, NULL);
+        m_started = false;
+    }
+}
+
+bool Thread::IsCurrent() const
+{
+    return m_started && pthread_equal(m_thread, pthread_self());
+}
+
+void* Thread::ThreadMain(void* param)
+{
+    static_cast<Thread*>(param)->Run();
+    return NULL;
+}
+
+ThreadLocalPointer::ThreadLocalPointer()
+{
+    pthread_key_create(&m_key, NULL);
+}
+
+ThreadLocalPointer::~ThreadLocalPointer()
+{
+    pthread_key_delete(m_key);
+}
+
+void* ThreadLocalPointer::Get() const
+{
+    return pthread_getspecific(m_key);
+}
+
+void ThreadLocalPointer::Set(void* value)
+{
+    pthread_setspecific(m_key, value);
+}
+
+int AtomicIncrement(volatile int* value)
+{
+    return __sync_add_and_fetch(value, 1);
+}
+
+void MemoryFence()
+{
+    __sync_synchronize();
+}
+
+int GetNumberOfProcessors()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+unsigned long long GetMonotonicTime()
+{
+#if defined(__APPLE__)
+    // Mac OS X 10.5 has no clock_gettime()
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+} // namespace Brackets
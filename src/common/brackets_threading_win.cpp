@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_threading.h"
+
+#include <process.h>
+
+namespace Brackets {
+
+Lock::Lock()
+{
+    InitializeCriticalSection(&m_lock);
+}
+
+Lock::~Lock()
+{
+    DeleteCriticalSection(&m_lock);
+}
+
+void Lock::Acquire()
+{
+    EnterCriticalSection(&m_lock);
+}
+
+void Lock::Release()
+{
+    LeaveCriticalSection(&m_lock);
+}
+
+ConditionVariable::ConditionVariable(Lock& lock)
+    : m_lock(lock)
+{
+    InitializeConditionVariable(&m_cond);
+}
+
+ConditionVariable::~ConditionVariable()
+{
+}
+
+void ConditionVariable::Wait()
+{
+    SleepConditionVariableCS(&m_cond, &m_lock.m_lock, INFINITE);
+}
+
+bool ConditionVariable::TimedWait(int milliseconds)
+{
+    return SleepConditionVariableCS(&m_cond, &m_lock.m_lock, (DWORD)milliseconds) != 0;
+}
+
+void ConditionVariable::Signal()
+{
+    WakeConditionVariable(&m_cond);
+}
+
+void ConditionVariable::Broadcast()
+{
+    WakeAllConditionVariable(&m_cond);
+}
+
+Thread::Thread()
+    : m_handle(NULL), m_threadId(0)
+{
+}
+
+Thread::~Thread()
+{
+    if (m_handle)
+        CloseHandle(m_handle);
+}
+
+bool Thread::Start()
+{
+    m_handle = (HANDLE)_beginthreadex(NULL, 0, ThreadMain, this, 0, &m_threadId);
+    return (m_handle != NULL);
+}
+
+void Thread::Join()
+{
+    if (m_handle) {
+        WaitForSingleObject(m_handle, INFINITE);
+        CloseHandle(m_handle);
+        m_handle = NULL;
+    }
+}
+
+bool Thread::IsCurrent() const
+{
+    return m_handle && (GetCurrentThreadId() == m_threadId);
+}
+
+unsigned __stdcall Thread::ThreadMain(void* param)
+{
+    static_cast<Thread*>(param)->Run();
+    return 0;
+}
+
+ThreadLocalPointer::ThreadLocalPointer()
+    : m_index(TlsAlloc())
+{
+}
+
+ThreadLocalPointer::~ThreadLocalPointer()
+{
+    TlsFree(m_index);
+}
+
+void* ThreadLocalPointer::Get() const
+{
+    return TlsGetValue(m_index);
+}
+
+void ThreadLocalPointer::Set(void* value)
+{
+    TlsSetValue(m_index, value);
+}
+
+int AtomicIncrement(volatile int* value)
+{
+    return (int)InterlockedIncrement(reinterpret_cast<volatile LONG*>(value));
+}
+
+void MemoryFence()
+{
+    MemoryBarrier();
+}
+
+int GetNumberOfProcessors()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (int)info.dwNumberOfProcessors : 1;
+}
+
+unsigned long long GetMonotonicTime()
+{
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    // Split up so the multiplication doesn't overflow
+    unsigned long long seconds = now.QuadPart / frequency.QuadPart;
+    unsigned long long rest = now.QuadPart % frequency.QuadPart;
+    return seconds * 1000000000ULL + rest * 1000000000ULL / frequency.QuadPart;
+}
+
+} // namespace Brackets
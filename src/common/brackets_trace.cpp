@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_trace.h"
+#include "brackets_fs.h"
+#include "brackets_json.h"
+#include "brackets_threading.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+namespace Brackets {
+namespace Trace {
+
+const char kTraceFileVariable[] = "BRACKETS_TRACE_FILE";
+
+namespace {
+
+enum EventType {
+    EVENT_SPAN,
+    EVENT_INSTANT
+};
+
+// A slot of the ring. Writers claim the next slot with AtomicIncrement() and
+// fill it in between two writes of sequence, so AppendJSON() can tell when a
+// slot changed while it was reading it, the way a seqlock does.
+struct Event {
+    volatile int sequence;      // Index of the event + 1 once written, 0 while it is being written
+    int type;
+    int threadId;
+    const char* name;
+    const char* category;
+    unsigned long long start;
+    unsigned long long duration;
+};
+
+Event g_startupEvents[kStartupCapacity];
+Event g_events[kCapacity];
+volatile int g_eventCount = 0;  // Events recorded so far. The ring holds the last kCapacity after the startup ones.
+
+// Threads are numbered in the order they record their first event. The id is
+// kept in the thread local pointer itself.
+ThreadLocalPointer g_threadId;
+volatile int g_threadCount = 0;
+
+Lock g_threadNamesLock;
+std::vector<std::pair<int, const char*> > g_threadNames;
+
+int GetThreadId()
+{
+    int id = (int)(size_t)g_threadId.Get();
+    if (!id) {
+        id = AtomicIncrement(&g_threadCount);
+        g_threadId.Set((void*)(size_t)id);
+    }
+    return id;
+}
+
+Event& GetSlot(unsigned int index)
+{
+    if (index < (unsigned int)kStartupCapacity)
+        return g_startupEvents[index];
+    return g_events[(index - kStartupCapacity) % kCapacity];
+}
+
+void AddEvent(EventType type, const char* name, const char* category, unsigned long long start,
+              unsigned long long duration)
+{
+    int threadId = GetThreadId();
+    unsigned int index = (unsigned int)AtomicIncrement(&g_eventCount) - 1;
+    Event& event = GetSlot(index);
+
+    event.sequence = 0;
+    MemoryFence();
+    event.type = type;
+    event.threadId = threadId;
+    event.name = name;
+    event.category = category;
+    event.start = start;
+    event.duration = duration;
+    MemoryFence();
+    event.sequence = (int)(index + 1);
+}
+
+// Appends nanoseconds as microseconds, the unit of the Trace Event Format
+void AppendMicroseconds(std::string& out, unsigned long long nanoseconds)
+{
+    char buffer[32];
+    sprintf(buffer, "%llu.%03u", nanoseconds / 1000, (unsigned int)(nanoseconds % 1000));
+    out += buffer;
+}
+
+void AppendThreadId(std::string& out, int threadId)
+{
+    char buffer[32];
+    sprintf(buffer, ",\"pid\":1,\"tid\":%d", threadId);
+    out += buffer;
+}
+
+// Appends the event at index, unless its slot is being written, or was
+// reused for a newer event while it was copied
+void AppendEvent(std::string& out, unsigned int index, bool& first)
+{
+    const Event& slot = GetSlot(index);
+    int sequence = slot.sequence;
+    MemoryFence();
+    Event event;
+    event.type = slot.type;
+    event.threadId = slot.threadId;
+    event.name = slot.name;
+    event.category = slot.category;
+    event.start = slot.start;
+    event.duration = slot.duration;
+    MemoryFence();
+    if (sequence != (int)(index + 1) || slot.sequence != sequence)
+        return;
+
+    if (!first)
+        out += ',';
+    first = false;
+    out += "{\"name\":";
+    JSON::AppendString(out, event.name);
+    out += ",\"cat\":";
+    JSON::AppendString(out, event.category);
+    if (event.type == EVENT_SPAN) {
+        out += ",\"ph\":\"X\",\"ts\":";
+        AppendMicroseconds(out, event.start);
+        out += ",\"dur\":";
+        AppendMicroseconds(out, event.duration);
+    } else {
+        out += ",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+        AppendMicroseconds(out, event.start);
+    }
+    AppendThreadId(out, event.threadId);
+    out += '}';
+}
+
+} // namespace
+
+void AddSpan(const char* name, const char* category, unsigned long long start, unsigned long long end)
+{
+    AddEvent(EVENT_SPAN, name, category, start, (end > start) ? end - start : 0);
+}
+
+void AddInstant(const char* name, const char* category)
+{
+    AddEvent(EVENT_INSTANT, name, category, GetMonotonicTime(), 0);
+}
+
+void SetThreadName(const char* name)
+{
+    int threadId = GetThreadId();
+
+    AutoLock lock(g_threadNamesLock);
+    g_threadNames.push_back(std::make_pair(threadId, name));
+}
+
+Scope::Scope(const char* name, const char* category)
+    : m_name(name)
+    , m_category(category)
+    , m_start(GetMonotonicTime())
+{
+}
+
+Scope::~Scope()
+{
+    AddSpan(m_name, m_category, m_start, GetMonotonicTime());
+}
+
+void AppendJSON(std::string& out)
+{
+    out += "{\"traceEvents\":[";
+    bool first = true;
+
+    {
+        AutoLock lock(g_threadNamesLock);
+        for (size_t i = 0; i < g_threadNames.size(); i++) {
+            if (!first)
+                out += ',';
+            first = false;
+            out += "{\"name\":\"thread_name\",\"ph\":\"M\"";
+            AppendThreadId(out, g_threadNames[i].first);
+            out += ",\"args\":{\"name\":";
+            JSON::AppendString(out, g_threadNames[i].second);
+            out += "}}";
+        }
+    }
+
+    unsigned int end = (unsigned int)g_eventCount;
+    MemoryFence();
+
+    unsigned int startupEnd = (end < (unsigned int)kStartupCapacity) ? end : (unsigned int)kStartupCapacity;
+    for (unsigned int index = 0; index < startupEnd; index++)
+        AppendEvent(out, index, first);
+
+    // The ring only has the last kCapacity of the others
+    unsigned int ringStart = (unsigned int)kStartupCapacity;
+    if (end > (unsigned int)(kStartupCapacity + kCapacity))
+        ringStart = end - kCapacity;
+    for (unsigned int index = ringStart; index < end; index++)
+        AppendEvent(out, index, first);
+
+    out += "],\"displayTimeUnit\":\"ms\"}";
+}
+
+int WriteJSON(const std::string& path)
+{
+    std::string json;
+    AppendJSON(json);
+    json += '\n';
+    return FileSystem::WriteFile(path, json, "utf8");
+}
+
+void WriteTraceOnExit()
+{
+    const char* path = getenv(kTraceFileVariable);
+    if (path && *path)
+        WriteJSON(path);
+}
+
+} // namespace Trace
+} // namespace Brackets
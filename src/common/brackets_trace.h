@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_TRACE_H
+#define _BRACKETS_TRACE_H
+
+#include <string>
+
+/**
+ * A timeline of what the shell and the native code did, for startup and
+ * bridge performance work. Spans are recorded with GetMonotonicTime()
+ * timestamps into a fixed ring of kCapacity events, so the newest events are
+ * always there and recording never allocates or takes a lock. The first
+ * kStartupCapacity events are kept apart and never overwritten, so the
+ * startup is in every trace. AppendJSON() exports them in the Trace Event
+ * Format, which chrome://tracing loads.
+ *
+ * Spans are recorded for startup (CefInitialize, InitBracketsExtensions,
+ * browser creation, page loads), every native method call
+ * (V8Binding::MethodTable) and every task of the WorkerPool, which includes
+ * the file system calls that run in the background.
+ *
+ * Names and categories are kept as pointers: they must be string literals,
+ * or live as long as the process.
+ */
+namespace Brackets {
+namespace Trace {
+
+const int kStartupCapacity = 1 << 12;
+const int kCapacity = 1 << 16;
+
+// Records a span from start to end, GetMonotonicTime() values, on this thread
+void AddSpan(const char* name, const char* category, unsigned long long start, unsigned long long end);
+
+// Records an event with no duration, now, on this thread
+void AddInstant(const char* name, const char* category);
+
+// Names this thread in the timeline
+void SetThreadName(const char* name);
+
+// Records a span for the lifetime of the object
+class Scope {
+public:
+    Scope(const char* name, const char* category);
+    ~Scope();
+
+private:
+    const char* m_name;
+    const char* m_category;
+    unsigned long long m_start;
+
+    // Not copyable
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+};
+
+// Appends the events that were kept, oldest first, as a Trace Event Format
+// object: { "traceEvents": [...], "displayTimeUnit": "ms" }. Events that are
+// being recorded while this runs are left out.
+void AppendJSON(std::string& out);
+
+// Writes the JSON to path. Returns the error of FileSystem::WriteFile().
+int WriteJSON(const std::string& path);
+
+// Environment variable with the path WriteTraceOnExit() writes to
+extern const char kTraceFileVariable[];
+
+// Writes the trace to the file named by kTraceFileVariable, if it is set.
+// Called by ShutdownBracketsExtensions().
+void WriteTraceOnExit();
+
+} // namespace Trace
+} // namespace Brackets
+
+#endif // _BRACKETS_TRACE_H
@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_V8_BINDING_H
+#define _BRACKETS_V8_BINDING_H
+
+#include "include/cef.h"
+#include "brackets_call_log.h"
+#include "brackets_fs.h"
+#include "brackets_metrics.h"
+#include "brackets_threading.h"
+#include "brackets_trace.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * Binding of the native methods of a CefV8Handler to their JavaScript names.
+ * Each method is declared with its C++ signature, and the templates below
+ * generate the code that checks the number and the types of the arguments
+ * and converts them, so the methods only check what the types can't say
+ * (a path that must not be empty, a count that must be positive...).
+ *
+ * The methods are kept in a table sorted by the hash of their names, built
+ * once when the handler is created, so a call costs one hash of its name and
+ * one comparison instead of a comparison with every name.
+ *
+ * A method returns an error code and sets retval, like this:
+ *
+ *     int ExecuteReadFile(const std::string& path, const std::string& encoding,
+ *                         const V8Binding::Function& callback, CefRefPtr<CefV8Value>& retval);
+ *
+ *     m_methods.Add("ReadFile", &Handler::ExecuteReadFile);
+ *
+ * A call with the wrong number of arguments, or with an argument of the
+ * wrong type, gets ERR_INVALID_PARAMS without calling the method.
+ *
+ * Every call is recorded in Metrics, with its error, the size of its
+ * arguments and the time it took, and as a span in the Trace. While a
+ * CallLog is recorded, the call and its arguments are logged too.
+ */
+namespace Brackets {
+namespace V8Binding {
+
+// A function argument
+class Function : public CefRefPtr<CefV8Value> {
+public:
+    explicit Function(CefRefPtr<CefV8Value> value) : CefRefPtr<CefV8Value>(value) {}
+};
+
+// An array argument, for methods that read it themselves
+class Array : public CefRefPtr<CefV8Value> {
+public:
+    explicit Array(CefRefPtr<CefV8Value> value) : CefRefPtr<CefV8Value>(value) {}
+};
+
+// How an argument of type T is checked and converted. Strings, ints,
+// doubles, functions and arrays must have the matching JavaScript type. A
+// bool can be any value, converted like JavaScript does. A list of strings
+// is an array, where the entries that aren't strings are skipped.
+//
+// Size() is the number of bytes of text an argument brought in, counted in
+// Metrics as the bytes in of the call.
+template <class T> struct ArgType;
+
+template <> struct ArgType<std::string> {
+    typedef std::string Type;
+    static bool Check(const CefRefPtr<CefV8Value>& value) { return value->IsString(); }
+    static std::string Get(const CefRefPtr<CefV8Value>& value) { return value->GetStringValue(); }
+    static size_t Size(const std::string& value) { return value.length(); }
+};
+
+template <> struct ArgType<CefString> {
+    typedef CefString Type;
+    static bool Check(const CefRefPtr<CefV8Value>& value) { return value->IsString(); }
+    static CefString Get(const CefRefPtr<CefV8Value>& value) { return value->GetStringValue(); }
+    static size_t Size(const CefString& value) { return value.length() * sizeof(CefString::char_type); }
+};
+
+template <> struct ArgType<int> {
+    typedef int Type;
+    static bool Check(const CefRefPtr<CefV8Value>& value) { return value->IsInt(); }
+    static int Get(const CefRefPtr<CefV8Value>& value) { return value->GetIntValue(); }
+    static size_t Size(int) { return 0; }
+};
+
+template <> struct ArgType<double> {
+    typedef double Type;
+    static bool Check(const CefRefPtr<CefV8Value>& value) { return value->IsDouble(); }
+    static double Get(const CefRefPtr<CefV8Value>& value) { return value->GetDoubleValue(); }
+    static size_t Size(double) { return 0; }
+};
+
+template <> struct ArgType<bool> {
+    typedef bool Type;
+    static bool Check(const CefRefPtr<CefV8Value>&) { return true; }
+    static bool Get(const CefRefPtr<CefV8Value>& value) { return value->GetBoolValue(); }
+    static size_t Size(bool) { return 0; }
+};
+
+template <> struct ArgType<Function> {
+    typedef Function Type;
+    static bool Check(const CefRefPtr<CefV8Value>& value) { return value->IsFunction(); }
+    static Function Get(const CefRefPtr<CefV8Value>& value) { return Function(value); }
+    static size_t Size(const Function&) { return 0; }
+};
+
+// The method reads the array itself, so its size is not counted
+template <> struct ArgType<Array> {
+    typedef Array Type;
+    static bool Check(const CefRefPtr<CefV8Value>& value) { return value->IsArray(); }
+    static Array Get(const CefRefPtr<CefV8Value>& value) { return Array(value); }
+    static size_t Size(const Array&) { return 0; }
+};
+
+template <> struct ArgType<std::vector<std::string> > {
+    typedef std::vector<std::string> Type;
+    static bool Check(const CefRefPtr<CefV8Value>& value) { return value->IsArray(); }
+    static std::vector<std::string> Get(const CefRefPtr<CefV8Value>& value)
+    {
+        std::vector<std::string> strings;
+        int count = value->GetArrayLength();
+        for (int i = 0; i < count; i++) {
+            CefRefPtr<CefV8Value> entry = value->GetValue(i);
+            if (entry.get() && entry->IsString())
+                strings.push_back(entry->GetStringValue());
+        }
+        return strings;
+    }
+    static size_t Size(const std::vector<std::string>& value)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < value.size(); i++)
+            size += value[i].length();
+        return size;
+    }
+};
+
+// Arguments can be declared as references. The method gets the converted
+// value, so it can e.g. swap a string out of a non-const reference.
+template <class T> struct ArgType<const T&> : ArgType<T> {};
+template <class T> struct ArgType<T&> : ArgType<T> {};
+
+// FNV-1a hash of the code units of name
+inline unsigned int HashName(const CefString& name)
+{
+    const CefString::char_type* units = name.c_str();
+    size_t length = name.length();
+    unsigned int hash = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned int)units[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+// A method bound to a name. The subclasses are generated for each signature.
+template <class Handler>
+class Binding {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+
+    virtual ~Binding() {}
+
+    // Checks and converts the arguments, and calls the method. Adds the size
+    // of the arguments to bytesIn.
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const = 0;
+};
+
+template <class Handler>
+class Binding0 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(Value&);
+
+    explicit Binding0(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t&) const
+    {
+        if (!arguments.empty())
+            return ERR_INVALID_PARAMS;
+
+        return (handler->*m_method)(retval);
+    }
+
+private:
+    Method m_method;
+};
+
+template <class Handler, class A1>
+class Binding1 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(A1, Value&);
+
+    explicit Binding1(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const
+    {
+        if (arguments.size() != 1 || !ArgType<A1>::Check(arguments[0]))
+            return ERR_INVALID_PARAMS;
+
+        typename ArgType<A1>::Type a1 = ArgType<A1>::Get(arguments[0]);
+        bytesIn += ArgType<A1>::Size(a1);
+        return (handler->*m_method)(a1, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+template <class Handler, class A1, class A2>
+class Binding2 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(A1, A2, Value&);
+
+    explicit Binding2(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const
+    {
+        if (arguments.size() != 2 || !ArgType<A1>::Check(arguments[0]) || !ArgType<A2>::Check(arguments[1]))
+            return ERR_INVALID_PARAMS;
+
+        typename ArgType<A1>::Type a1 = ArgType<A1>::Get(arguments[0]);
+        typename ArgType<A2>::Type a2 = ArgType<A2>::Get(arguments[1]);
+        bytesIn += ArgType<A1>::Size(a1) + ArgType<A2>::Size(a2);
+        return (handler->*m_method)(a1, a2, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+template <class Handler, class A1, class A2, class A3>
+class Binding3 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(A1, A2, A3, Value&);
+
+    explicit Binding3(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const
+    {
+        if (arguments.size() != 3 || !ArgType<A1>::Check(arguments[0]) || !ArgType<A2>::Check(arguments[1]) ||
+            !ArgType<A3>::Check(arguments[2]))
+            return ERR_INVALID_PARAMS;
+
+        typename ArgType<A1>::Type a1 = ArgType<A1>::Get(arguments[0]);
+        typename ArgType<A2>::Type a2 = ArgType<A2>::Get(arguments[1]);
+        typename ArgType<A3>::Type a3 = ArgType<A3>::Get(arguments[2]);
+        bytesIn += ArgType<A1>::Size(a1) + ArgType<A2>::Size(a2) + ArgType<A3>::Size(a3);
+        return (handler->*m_method)(a1, a2, a3, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+template <class Handler, class A1, class A2, class A3, class A4>
+class Binding4 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(A1, A2, A3, A4, Value&);
+
+    explicit Binding4(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const
+    {
+        if (arguments.size() != 4 || !ArgType<A1>::Check(arguments[0]) || !ArgType<A2>::Check(arguments[1]) ||
+            !ArgType<A3>::Check(arguments[2]) || !ArgType<A4>::Check(arguments[3]))
+            return ERR_INVALID_PARAMS;
+
+        typename ArgType<A1>::Type a1 = ArgType<A1>::Get(arguments[0]);
+        typename ArgType<A2>::Type a2 = ArgType<A2>::Get(arguments[1]);
+        typename ArgType<A3>::Type a3 = ArgType<A3>::Get(arguments[2]);
+        typename ArgType<A4>::Type a4 = ArgType<A4>::Get(arguments[3]);
+        bytesIn += ArgType<A1>::Size(a1) + ArgType<A2>::Size(a2) + ArgType<A3>::Size(a3) + ArgType<A4>::Size(a4);
+        return (handler->*m_method)(a1, a2, a3, a4, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+template <class Handler, class A1, class A2, class A3, class A4, class A5>
+class Binding5 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(A1, A2, A3, A4, A5, Value&);
+
+    explicit Binding5(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const
+    {
+        if (arguments.size() != 5 || !ArgType<A1>::Check(arguments[0]) || !ArgType<A2>::Check(arguments[1]) ||
+            !ArgType<A3>::Check(arguments[2]) || !ArgType<A4>::Check(arguments[3]) ||
+            !ArgType<A5>::Check(arguments[4]))
+            return ERR_INVALID_PARAMS;
+
+        typename ArgType<A1>::Type a1 = ArgType<A1>::Get(arguments[0]);
+        typename ArgType<A2>::Type a2 = ArgType<A2>::Get(arguments[1]);
+        typename ArgType<A3>::Type a3 = ArgType<A3>::Get(arguments[2]);
+        typename ArgType<A4>::Type a4 = ArgType<A4>::Get(arguments[3]);
+        typename ArgType<A5>::Type a5 = ArgType<A5>::Get(arguments[4]);
+        bytesIn += ArgType<A1>::Size(a1) + ArgType<A2>::Size(a2) + ArgType<A3>::Size(a3) + ArgType<A4>::Size(a4) +
+                   ArgType<A5>::Size(a5);
+        return (handler->*m_method)(a1, a2, a3, a4, a5, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+template <class Handler, class A1, class A2, class A3, class A4, class A5, class A6>
+class Binding6 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(A1, A2, A3, A4, A5, A6, Value&);
+
+    explicit Binding6(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const
+    {
+        if (arguments.size() != 6 || !ArgType<A1>::Check(arguments[0]) || !ArgType<A2>::Check(arguments[1]) ||
+            !ArgType<A3>::Check(arguments[2]) || !ArgType<A4>::Check(arguments[3]) ||
+            !ArgType<A5>::Check(arguments[4]) || !ArgType<A6>::Check(arguments[5]))
+            return ERR_INVALID_PARAMS;
+
+        typename ArgType<A1>::Type a1 = ArgType<A1>::Get(arguments[0]);
+        typename ArgType<A2>::Type a2 = ArgType<A2>::Get(arguments[1]);
+        typename ArgType<A3>::Type a3 = ArgType<A3>::Get(arguments[2]);
+        typename ArgType<A4>::Type a4 = ArgType<A4>::Get(arguments[3]);
+        typename ArgType<A5>::Type a5 = ArgType<A5>::Get(arguments[4]);
+        typename ArgType<A6>::Type a6 = ArgType<A6>::Get(arguments[5]);
+        bytesIn += ArgType<A1>::Size(a1) + ArgType<A2>::Size(a2) + ArgType<A3>::Size(a3) + ArgType<A4>::Size(a4) +
+                   ArgType<A5>::Size(a5) + ArgType<A6>::Size(a6);
+        return (handler->*m_method)(a1, a2, a3, a4, a5, a6, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+template <class Handler, class A1, class A2, class A3, class A4, class A5, class A6, class A7>
+class Binding7 : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(A1, A2, A3, A4, A5, A6, A7, Value&);
+
+    explicit Binding7(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t& bytesIn) const
+    {
+        if (arguments.size() != 7 || !ArgType<A1>::Check(arguments[0]) || !ArgType<A2>::Check(arguments[1]) ||
+            !ArgType<A3>::Check(arguments[2]) || !ArgType<A4>::Check(arguments[3]) ||
+            !ArgType<A5>::Check(arguments[4]) || !ArgType<A6>::Check(arguments[5]) ||
+            !ArgType<A7>::Check(arguments[6]))
+            return ERR_INVALID_PARAMS;
+
+        typename ArgType<A1>::Type a1 = ArgType<A1>::Get(arguments[0]);
+        typename ArgType<A2>::Type a2 = ArgType<A2>::Get(arguments[1]);
+        typename ArgType<A3>::Type a3 = ArgType<A3>::Get(arguments[2]);
+        typename ArgType<A4>::Type a4 = ArgType<A4>::Get(arguments[3]);
+        typename ArgType<A5>::Type a5 = ArgType<A5>::Get(arguments[4]);
+        typename ArgType<A6>::Type a6 = ArgType<A6>::Get(arguments[5]);
+        typename ArgType<A7>::Type a7 = ArgType<A7>::Get(arguments[6]);
+        bytesIn += ArgType<A1>::Size(a1) + ArgType<A2>::Size(a2) + ArgType<A3>::Size(a3) + ArgType<A4>::Size(a4) +
+                   ArgType<A5>::Size(a5) + ArgType<A6>::Size(a6) + ArgType<A7>::Size(a7);
+        return (handler->*m_method)(a1, a2, a3, a4, a5, a6, a7, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+// A method that checks its arguments itself
+template <class Handler>
+class RawBinding : public Binding<Handler> {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+    typedef int (Handler::*Method)(const CefV8ValueList& arguments, Value& retval);
+
+    explicit RawBinding(Method method) : m_method(method) {}
+
+    virtual int Invoke(Handler* handler, const CefV8ValueList& arguments, Value& retval, size_t&) const
+    {
+        return (handler->*m_method)(arguments, retval);
+    }
+
+private:
+    Method m_method;
+};
+
+// Converts the arguments of a call for the CallLog
+inline void GetCallLogArgs(const CefV8ValueList& arguments, CallLog::ArgList& args)
+{
+    args.resize(arguments.size());
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const CefRefPtr<CefV8Value>& value = arguments[i];
+        CallLog::Arg& arg = args[i];
+        if (!value.get() || value->IsUndefined()) {
+            arg.type = CallLog::ARG_UNDEFINED;
+        } else if (value->IsNull()) {
+            arg.type = CallLog::ARG_NULL;
+        } else if (value->IsBool()) {
+            arg.type = CallLog::ARG_BOOL;
+            arg.number = value->GetBoolValue() ? 1 : 0;
+        } else if (value->IsInt()) {
+            arg.type = CallLog::ARG_INT;
+            arg.number = value->GetIntValue();
+        } else if (value->IsDouble()) {
+            arg.type = CallLog::ARG_DOUBLE;
+            arg.number = value->GetDoubleValue();
+        } else if (value->IsString()) {
+            arg.string = value->GetStringValue();
+            arg.type = CallLog::ARG_STRING;
+            if (arg.string.length() > CallLog::kMaxStringLength) {
+                arg.type = CallLog::ARG_LONG_STRING;
+                arg.number = (double)arg.string.length();
+                arg.string.clear();
+            }
+        } else if (value->IsFunction()) {
+            arg.type = CallLog::ARG_FUNCTION;
+        } else if (value->IsArray()) {
+            arg.type = CallLog::ARG_STRING_ARRAY;
+            int count = value->GetArrayLength();
+            arg.strings.resize(count);
+            for (int j = 0; j < count; j++) {
+                CefRefPtr<CefV8Value> entry = value->GetValue(j);
+                if (entry.get() && entry->IsString())
+                    arg.strings[j] = entry->GetStringValue();
+            }
+        } else {
+            arg.type = CallLog::ARG_OBJECT;
+        }
+    }
+}
+
+template <class Handler>
+class MethodTable {
+public:
+    typedef CefRefPtr<CefV8Value> Value;
+
+    MethodTable() {}
+
+    ~MethodTable()
+    {
+        for (size_t i = 0; i < m_entries.size(); i++)
+            delete m_entries[i].binding;
+    }
+
+    template <class A1, class A2, class A3, class A4, class A5, class A6, class A7>
+    void Add(const char* name, int (Handler::*method)(A1, A2, A3, A4, A5, A6, A7, Value&))
+    {
+        Insert(name, new Binding7<Handler, A1, A2, A3, A4, A5, A6, A7>(method));
+    }
+
+    template <class A1, class A2, class A3, class A4, class A5, class A6>
+    void Add(const char* name, int (Handler::*method)(A1, A2, A3, A4, A5, A6, Value&))
+    {
+        Insert(name, new Binding6<Handler, A1, A2, A3, A4, A5, A6>(method));
+    }
+
+    template <class A1, class A2, class A3, class A4, class A5>
+    void Add(const char* name, int (Handler::*method)(A1, A2, A3, A4, A5, Value&))
+    {
+        Insert(name, new Binding5<Handler, A1, A2, A3, A4, A5>(method));
+    }
+
+    template <class A1, class A2, class A3, class A4>
+    void Add(const char* name, int (Handler::*method)(A1, A2, A3, A4, Value&))
+    {
+        Insert(name, new Binding4<Handler, A1, A2, A3, A4>(method));
+    }
+
+    template <class A1, class A2, class A3>
+    void Add(const char* name, int (Handler::*method)(A1, A2, A3, Value&))
+    {
+        Insert(name, new Binding3<Handler, A1, A2, A3>(method));
+    }
+
+    template <class A1, class A2>
+    void Add(const char* name, int (Handler::*method)(A1, A2, Value&))
+    {
+        Insert(name, new Binding2<Handler, A1, A2>(method));
+    }
+
+    template <class A1>
+    void Add(const char* name, int (Handler::*method)(A1, Value&))
+    {
+        Insert(name, new Binding1<Handler, A1>(method));
+    }
+
+    void Add(const char* name, int (Handler::*method)(Value&))
+    {
+        Insert(name, new Binding0<Handler>(method));
+    }
+
+    void AddRaw(const char* name, typename RawBinding<Handler>::Method method)
+    {
+        Insert(name, new RawBinding<Handler>(method));
+    }
+
+    // Calls the method bound to name. Returns false if there is none, or
+    // else sets error to what it returned.
+    bool Invoke(Handler* handler, const CefString& name, const CefV8ValueList& arguments, Value& retval,
+                int& error) const
+    {
+        Entry key;
+        key.hash = HashName(name);
+        typename std::vector<Entry>::const_iterator it =
+            std::lower_bound(m_entries.begin(), m_entries.end(), key, CompareHash);
+        for (; it != m_entries.end() && it->hash == key.hash; ++it) {
+            if (it->name == name) {
+                Trace::Scope span(it->traceName, "native");
+                Metrics::MethodScope scope(it->methodId);
+                size_t bytesIn = 0;
+                unsigned int callId = CallLog::BeginCall();
+                unsigned long long start = GetMonotonicTime();
+                error = it->binding->Invoke(handler, arguments, retval, bytesIn);
+                unsigned long long duration = GetMonotonicTime() - start;
+                Metrics::RecordCall(it->methodId, error, bytesIn, duration);
+                if (callId) {
+                    CallLog::ArgList args;
+                    GetCallLogArgs(arguments, args);
+                    bool hasResult = retval.get() && retval->IsInt();
+                    CallLog::EndCall(callId, it->methodId, it->traceName, args, start, duration, error,
+                                     hasResult, hasResult ? retval->GetIntValue() : 0);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Entry {
+        unsigned int hash;
+        CefString name;
+        const char* traceName;      // The name passed to Add(), for Trace
+        int methodId;               // For Metrics
+        Binding<Handler>* binding;
+    };
+
+    static bool CompareHash(const Entry& a, const Entry& b)
+    {
+        return a.hash < b.hash;
+    }
+
+    void Insert(const char* name, Binding<Handler>* binding)
+    {
+        Entry entry;
+        entry.name = name;
+        entry.traceName = name;
+        entry.hash = HashName(entry.name);
+        entry.methodId = Metrics::AddMethod(name);
+        entry.binding = binding;
+        m_entries.insert(std::upper_bound(m_entries.begin(), m_entries.end(), entry, CompareHash), entry);
+    }
+
+    std::vector<Entry> m_entries;
+
+    // Not copyable, the table owns the bindings
+    MethodTable(const MethodTable&);
+    MethodTable& operator=(const MethodTable&);
+};
+
+} // namespace V8Binding
+} // namespace Brackets
+
+#endif // _BRACKETS_V8_BINDING_H
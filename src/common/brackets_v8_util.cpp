@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_v8_util.h"
+
+namespace Brackets {
+namespace V8Util {
+
+CefRefPtr<CefV8Value> CreateString(const Encoding::UTF16Buffer& text)
+{
+    if (text.empty())
+        return CefV8Value::CreateString(CefString());
+
+    // CefString is UTF-16, so it can reference the buffer without copying or
+    // converting it. V8 makes the only copy.
+    CefString value(reinterpret_cast<const char16*>(&text[0]), text.size(), false);
+    return CefV8Value::CreateString(value);
+}
+
+CefRefPtr<CefV8Value> CreateStringArray(const std::vector<std::string>& strings)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < strings.size(); i++)
+        result->SetValue((int)i, CefV8Value::CreateString(strings[i]));
+
+    return result;
+}
+
+CefRefPtr<CefV8Value> CreateDirEntryArray(const FileSystem::DirEntryList& entries, bool withInfo)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < entries.size(); i++) {
+        const FileSystem::DirEntry& entry = entries[i];
+        CefRefPtr<CefV8Value> name = CefV8Value::CreateString(entry.name);
+
+        if (withInfo) {
+            CefRefPtr<CefV8Value> item = CefV8Value::CreateObject(NULL);
+            item->SetValue("name", name, V8_PROPERTY_ATTRIBUTE_NONE);
+            SetFileInfoProperties(item, entry.info);
+            result->SetValue((int)i, item);
+        } else {
+            result->SetValue((int)i, name);
+        }
+    }
+
+    return result;
+}
+
+CefRefPtr<CefV8Value> CreateStatResultArray(const FileSystem::StatResultList& results)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < results.size(); i++) {
+        CefRefPtr<CefV8Value> item = CefV8Value::CreateObject(NULL);
+        item->SetValue("err", CefV8Value::CreateInt(results[i].error), V8_PROPERTY_ATTRIBUTE_NONE);
+        SetFileInfoProperties(item, results[i].info);
+        result->SetValue((int)i, item);
+    }
+
+    return result;
+}
+
+CefRefPtr<CefV8Value> CreateDeleteFailureArray(const FileSystem::DeleteFailureList& failures)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < failures.size(); i++) {
+        CefRefPtr<CefV8Value> item = CefV8Value::CreateObject(NULL);
+        item->SetValue("path", CefV8Value::CreateString(failures[i].path), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("err", CefV8Value::CreateInt(failures[i].error), V8_PROPERTY_ATTRIBUTE_NONE);
+        result->SetValue((int)i, item);
+    }
+
+    return result;
+}
+
+CefRefPtr<CefV8Value> CreateWatchEventArray(const FileSystem::WatchEventList& events)
+{
+    static const char* const kTypeNames[] = { "created", "changed", "deleted" };
+
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < events.size(); i++) {
+        CefRefPtr<CefV8Value> item = CefV8Value::CreateObject(NULL);
+        item->SetValue("path", CefV8Value::CreateString(events[i].path), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("type", CefV8Value::CreateString(kTypeNames[events[i].type]), V8_PROPERTY_ATTRIBUTE_NONE);
+        result->SetValue((int)i, item);
+    }
+
+    return result;
+}
+
+CefRefPtr<CefV8Value> CreateSearchMatchArray(const FileSystem::SearchMatchList& matches)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < matches.size(); i++) {
+        const FileSystem::SearchMatch& match = matches[i];
+        CefRefPtr<CefV8Value> item = CefV8Value::CreateObject(NULL);
+        item->SetValue("path", CefV8Value::CreateString(match.path), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("line", CefV8Value::CreateInt(match.line), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("column", CefV8Value::CreateInt(match.column), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("length", CefV8Value::CreateInt(match.length), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("preview", CefV8Value::CreateString(match.preview), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("previewColumn", CefV8Value::CreateInt(match.previewColumn), V8_PROPERTY_ATTRIBUTE_NONE);
+        result->SetValue((int)i, item);
+    }
+
+    return result;
+}
+
+CefRefPtr<CefV8Value> CreateFuzzyResultArray(const FileSystem::FuzzyResultList& results)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < results.size(); i++) {
+        const FileSystem::FuzzyResult& match = results[i];
+        CefRefPtr<CefV8Value> ranges = CefV8Value::CreateArray();
+        for (size_t j = 0; j < match.ranges.size(); j++) {
+            CefRefPtr<CefV8Value> range = CefV8Value::CreateObject(NULL);
+            range->SetValue("start", CefV8Value::CreateInt((int)match.ranges[j].start), V8_PROPERTY_ATTRIBUTE_NONE);
+            range->SetValue("length", CefV8Value::CreateInt((int)match.ranges[j].length), V8_PROPERTY_ATTRIBUTE_NONE);
+            ranges->SetValue((int)j, range);
+        }
+
+        CefRefPtr<CefV8Value> item = CefV8Value::CreateObject(NULL);
+        item->SetValue("path", CefV8Value::CreateString(match.path), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("score", CefV8Value::CreateInt(match.score), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("ranges", ranges, V8_PROPERTY_ATTRIBUTE_NONE);
+        result->SetValue((int)i, item);
+    }
+
+    return result;
+}
+
+namespace {
+
+CefRefPtr<CefV8Value> CreateMilliseconds(unsigned long long nanoseconds)
+{
+    return CefV8Value::CreateDouble(nanoseconds / 1000000.0);
+}
+
+// Creates a { count, min, mean, max, p50, p90, p99, p999, buckets } object,
+// see Metrics::AppendStatsJSON()
+CefRefPtr<CefV8Value> CreateHistogramObject(const Metrics::Histogram& histogram)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateObject(NULL);
+    result->SetValue("count", CefV8Value::CreateDouble((double)histogram.GetCount()), V8_PROPERTY_ATTRIBUTE_NONE);
+    result->SetValue("min", CreateMilliseconds(histogram.GetMin()), V8_PROPERTY_ATTRIBUTE_NONE);
+    result->SetValue("mean", CreateMilliseconds(histogram.GetMean()), V8_PROPERTY_ATTRIBUTE_NONE);
+    result->SetValue("max", CreateMilliseconds(histogram.GetMax()), V8_PROPERTY_ATTRIBUTE_NONE);
+    result->SetValue("p50", CreateMilliseconds(histogram.GetPercentile(50)), V8_PROPERTY_ATTRIBUTE_NONE);
+    result->SetValue("p90", CreateMilliseconds(histogram.GetPercentile(90)), V8_PROPERTY_ATTRIBUTE_NONE);
+    result->SetValue("p99", CreateMilliseconds(histogram.GetPercentile(99)), V8_PROPERTY_ATTRIBUTE_NONE);
+    result->SetValue("p999", CreateMilliseconds(histogram.GetPercentile(99.9)), V8_PROPERTY_ATTRIBUTE_NONE);
+
+    CefRefPtr<CefV8Value> buckets = CefV8Value::CreateArray();
+    int count = 0;
+    for (int i = 0; i < Metrics::Histogram::kBuckets; i++) {
+        if (!histogram.GetBucketCount(i))
+            continue;
+        CefRefPtr<CefV8Value> bucket = CefV8Value::CreateArray();
+        bucket->SetValue(0, CreateMilliseconds(Metrics::Histogram::GetBucketLimit(i)));
+        bucket->SetValue(1, CefV8Value::CreateDouble((double)histogram.GetBucketCount(i)));
+        buckets->SetValue(count++, bucket);
+    }
+    result->SetValue("buckets", buckets, V8_PROPERTY_ATTRIBUTE_NONE);
+
+    return result;
+}
+
+} // namespace
+
+CefRefPtr<CefV8Value> CreateMethodStatsArray(const Metrics::MethodStatsList& stats)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    for (size_t i = 0; i < stats.size(); i++) {
+        const Metrics::MethodStats& method = stats[i];
+        CefRefPtr<CefV8Value> item = CefV8Value::CreateObject(NULL);
+        item->SetValue("name", CefV8Value::CreateString(method.name), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("calls", CefV8Value::CreateDouble((double)method.calls), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("errors", CefV8Value::CreateDouble((double)method.errors), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("bytesIn", CefV8Value::CreateDouble((double)method.bytesIn), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("bytesOut", CefV8Value::CreateDouble((double)method.bytesOut), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("latency", CreateHistogramObject(method.latency), V8_PROPERTY_ATTRIBUTE_NONE);
+        item->SetValue("callbackLatency", CreateHistogramObject(method.callbackLatency), V8_PROPERTY_ATTRIBUTE_NONE);
+        result->SetValue((int)i, item);
+    }
+
+    return result;
+}
+
+CefRefPtr<CefV8Value> CreateResult(int error, CefRefPtr<CefV8Value> value)
+{
+    CefRefPtr<CefV8Value> result = CefV8Value::CreateArray();
+    result->SetValue(0, CefV8Value::CreateInt(error));
+    if (value.get())
+        result->SetValue(1, value);
+
+    return result;
+}
+
+void SetFileInfoProperties(CefRefPtr<CefV8Value> object, const FileSystem::FileInfo& info)
+{
+    object->SetValue("isDir", CefV8Value::CreateBool(info.isDir), V8_PROPERTY_ATTRIBUTE_NONE);
+    object->SetValue("size", CefV8Value::CreateDouble((double)info.size), V8_PROPERTY_ATTRIBUTE_NONE);
+    object->SetValue("mtime", CefV8Value::CreateDate(CefTime(info.mtime)), V8_PROPERTY_ATTRIBUTE_NONE);
+}
+
+} // namespace V8Util
+} // namespace Brackets
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_V8_UTIL_H
+#define _BRACKETS_V8_UTIL_H
+
+#include "include/cef.h"
+#include "brackets_fs.h"
+#include "brackets_fs_index.h"
+#include "brackets_fs_search.h"
+#include "brackets_fs_watcher.h"
+#include "brackets_metrics.h"
+
+/**
+ * Helpers for turning Brackets::FileSystem results into V8 values. Building
+ * arrays and objects directly is much cheaper than serializing to JSON and
+ * calling JSON.parse() on the other side.
+ *
+ * These must be called on the UI thread, with a V8 context entered.
+ */
+namespace Brackets {
+namespace V8Util {
+
+// Creates a string from UTF-16 text, copying it once
+CefRefPtr<CefV8Value> CreateString(const Encoding::UTF16Buffer& text);
+
+// Creates an array of strings
+CefRefPtr<CefV8Value> CreateStringArray(const std::vector<std::string>& strings);
+
+// Creates an array of entry names, or an array of
+// { name, isDir, size, mtime } objects if withInfo is true.
+CefRefPtr<CefV8Value> CreateDirEntryArray(const FileSystem::DirEntryList& entries, bool withInfo);
+
+// Creates an array of { err, isDir, size, mtime } objects
+CefRefPtr<CefV8Value> CreateStatResultArray(const FileSystem::StatResultList& results);
+
+// Creates an array of { path, err } objects
+CefRefPtr<CefV8Value> CreateDeleteFailureArray(const FileSystem::DeleteFailureList& failures);
+
+// Creates an array of { path, type } objects. type is "created", "changed"
+// or "deleted".
+CefRefPtr<CefV8Value> CreateWatchEventArray(const FileSystem::WatchEventList& events);
+
+// Creates an array of { path, line, column, length, preview, previewColumn }
+// objects, see FileSystem::SearchMatch
+CefRefPtr<CefV8Value> CreateSearchMatchArray(const FileSystem::SearchMatchList& matches);
+
+// Creates an array of { path, score, ranges } objects, where ranges is an
+// array of { start, length } objects, see FileSystem::FuzzyResult
+CefRefPtr<CefV8Value> CreateFuzzyResultArray(const FileSystem::FuzzyResultList& results);
+
+// Creates an array of { name, calls, errors, bytesIn, bytesOut, latency,
+// callbackLatency } objects, the same as Metrics::AppendStatsJSON() writes
+CefRefPtr<CefV8Value> CreateMethodStatsArray(const Metrics::MethodStatsList& stats);
+
+// Creates the [err, value] array a native function returns. value is left
+// out if it is empty.
+CefRefPtr<CefV8Value> CreateResult(int error, CefRefPtr<CefV8Value> value);
+
+// Sets the isDir, size and mtime properties of object from info
+void SetFileInfoProperties(CefRefPtr<CefV8Value> object, const FileSystem::FileInfo& info);
+
+} // namespace V8Util
+} // namespace Brackets
+
+#endif // _BRACKETS_V8_UTIL_H
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#include "brackets_worker_pool.h"
+#include "brackets_trace.h"
+
+namespace Brackets {
+
+namespace {
+
+Lock s_instanceLock;
+WorkerPool* s_instance = NULL;
+bool s_shutdown = false;
+
+// Ranges of one ParallelFor() call, shared by the calling thread and the
+// worker tasks. Each of them takes the next unstarted range until none are
+// left, so the calling thread doesn't wait for tasks that are still queued
+// behind other work: it runs their ranges itself. A task that gets to run
+// after that finds nothing left to do. The state is reference counted since
+// such a task can run after ParallelFor() returned.
+class ParallelForState {
+public:
+    ParallelForState(RangeTask& task, size_t count, size_t rangeSize, int rangeCount, int refCount)
+        : m_task(task), m_count(count), m_rangeSize(rangeSize), m_rangeCount(rangeCount),
+          m_nextRange(0), m_allDone(m_lock), m_rangesDone(0), m_refCount(refCount)
+    {
+    }
+
+    // Runs unstarted ranges until there are none left
+    void RunRanges()
+    {
+        for (;;) {
+            int range = AtomicIncrement(&m_nextRange) - 1;
+            if (range >= m_rangeCount)
+                return;
+
+            size_t begin = (range * m_rangeSize < m_count) ? range * m_rangeSize : m_count;
+            size_t end = (begin + m_rangeSize < m_count) ? begin + m_rangeSize : m_count;
+            m_task.Run(begin, end);
+
+            AutoLock lock(m_lock);
+            if (++m_rangesDone == m_rangeCount)
+                m_allDone.Broadcast();
+        }
+    }
+
+    // Blocks until every range is done, including those other threads started
+    void WaitForRanges()
+    {
+        AutoLock lock(m_lock);
+        while (m_rangesDone < m_rangeCount)
+            m_allDone.Wait();
+    }
+
+    // Drops one reference, deleting the state after the last one
+    void Release()
+    {
+        bool last;
+        {
+            AutoLock lock(m_lock);
+            last = (--m_refCount == 0);
+        }
+        if (last)
+            delete this;
+    }
+
+private:
+    RangeTask& m_task;
+    const size_t m_count;
+    const size_t m_rangeSize;
+    const int m_rangeCount;
+    volatile int m_nextRange;
+
+    Lock m_lock;
+    ConditionVariable m_allDone;
+    int m_rangesDone;
+    int m_refCount;
+};
+
+// Runs ranges of a ParallelFor() on a worker thread
+class RangeWorkerTask : public WorkerTask {
+public:
+    explicit RangeWorkerTask(ParallelForState* state) : m_state(state) {}
+
+    virtual ~RangeWorkerTask() { m_state->Release(); }
+
+    virtual void Run() { m_state->RunRanges(); }
+
+    virtual const char* GetName() const { return "ParallelFor"; }
+
+private:
+    ParallelForState* m_state;
+};
+
+// Runs task, as a span of the trace if it has a name
+void RunTask(WorkerTask* task)
+{
+    const char* name = task->GetName();
+    if (!name) {
+        task->Run();
+        return;
+    }
+
+    Trace::Scope scope(name, "worker");
+    task->Run();
+}
+
+} // namespace
+
+class WorkerPool::WorkerThread : public Thread {
+public:
+    explicit WorkerThread(WorkerPool* pool) : m_pool(pool) {}
+
+protected:
+    virtual void Run()
+    {
+        Trace::SetThreadName("WorkerPool");
+
+        WorkerTask* task;
+        while ((task = m_pool->WaitForTask()) != NULL) {
+            RunTask(task);
+            delete task;
+        }
+    }
+
+private:
+    WorkerPool* m_pool;
+};
+
+WorkerPool* WorkerPool::GetInstance()
+{
+    AutoLock lock(s_instanceLock);
+    if (!s_instance && !s_shutdown) {
+        int threadCount = GetNumberOfProcessors();
+        if (threadCount > kMaxThreads)
+            threadCount = kMaxThreads;
+        s_instance = new WorkerPool(threadCount);
+    }
+    return s_instance;
+}
+
+void WorkerPool::Shutdown()
+{
+    WorkerPool* pool;
+    {
+        AutoLock lock(s_instanceLock);
+        pool = s_instance;
+        s_instance = NULL;
+        s_shutdown = true;
+    }
+    delete pool;
+}
+
+WorkerPool::WorkerPool(int threadCount)
+    : m_taskAvailable(m_lock), m_stopping(false)
+{
+    for (int i = 0; i < threadCount; i++) {
+        WorkerThread* thread = new WorkerThread(this);
+        if (thread->Start())
+            m_threads.push_back(thread);
+        else
+            delete thread;
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        AutoLock lock(m_lock);
+        m_stopping = true;
+        m_taskAvailable.Broadcast();
+    }
+
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        m_threads[i]->Join();
+        delete m_threads[i];
+    }
+
+    for (size_t i = 0; i < m_tasks.size(); i++)
+        delete m_tasks[i];
+}
+
+void WorkerPool::PostTask(WorkerTask* task)
+{
+    // Without threads (creating them failed), run the task right away
+    if (m_threads.empty()) {
+        RunTask(task);
+        delete task;
+        return;
+    }
+
+    AutoLock lock(m_lock);
+    m_tasks.push_back(task);
+    m_taskAvailable.Signal();
+}
+
+bool WorkerPool::IsWorkerThread() const
+{
+    // m_threads doesn't change after the constructor
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        if (m_threads[i]->IsCurrent())
+            return true;
+    }
+    return false;
+}
+
+WorkerTask* WorkerPool::WaitForTask()
+{
+    AutoLock lock(m_lock);
+    while (m_tasks.empty() && !m_stopping)
+        m_taskAvailable.Wait();
+
+    if (m_stopping)
+        return NULL;
+
+    WorkerTask* task = m_tasks.front();
+    m_tasks.pop_front();
+    return task;
+}
+
+WaitGroup::WaitGroup()
+    : m_allDone(m_lock), m_count(0)
+{
+}
+
+void WaitGroup::Add(int count)
+{
+    AutoLock lock(m_lock);
+    m_count += count;
+}
+
+void WaitGroup::Done()
+{
+    AutoLock lock(m_lock);
+    if (--m_count == 0)
+        m_allDone.Broadcast();
+}
+
+void WaitGroup::Wait()
+{
+    AutoLock lock(m_lock);
+    while (m_count > 0)
+        m_allDone.Wait();
+}
+
+void ParallelFor(size_t count, size_t minBatch, RangeTask& task)
+{
+    if (minBatch == 0)
+        minBatch = 1;
+
+    WorkerPool* pool = (count >= 2 * minBatch) ? WorkerPool::GetInstance() : NULL;
+    if (!pool) {
+        task.Run(0, count);
+        return;
+    }
+
+    // One range per worker thread plus one for the calling thread, but no
+    // smaller than minBatch
+    size_t rangeCount = pool->GetThreadCount() + 1;
+    if (rangeCount > count / minBatch)
+        rangeCount = count / minBatch;
+    size_t rangeSize = (count + rangeCount - 1) / rangeCount;
+
+    // One reference for each worker task and one for the calling thread
+    ParallelForState* state = new ParallelForState(task, count, rangeSize, (int)rangeCount, (int)rangeCount);
+    for (size_t i = 1; i < rangeCount; i++)
+        pool->PostTask(new RangeWorkerTask(state));
+
+    state->RunRanges();
+    state->WaitForRanges();
+    state->Release();
+}
+
+} // namespace Brackets
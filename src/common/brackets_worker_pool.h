@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2012 Adobe Systems Incorporated. All rights reserved.
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"), 
+ * to deal in the Software without restriction, including without limitation 
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ * and/or sell copies of the Software, and to permit persons to whom the 
+ * Software is furnished to do so, subject to the following conditions:
+ *  
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *  
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ */ 
+
+#ifndef _BRACKETS_WORKER_POOL_H
+#define _BRACKETS_WORKER_POOL_H
+
+#include "brackets_threading.h"
+
+#include <deque>
+#include <vector>
+#include <stddef.h>
+
+namespace Brackets {
+
+// A unit of work for the WorkerPool
+class WorkerTask {
+public:
+    virtual ~WorkerTask() {}
+    virtual void Run() = 0;
+
+    // Name of the task in traces, a string literal. Tasks without a name are
+    // not traced.
+    virtual const char* GetName() const { return NULL; }
+};
+
+/**
+ * A fixed set of threads (one per processor, at most kMaxThreads) running
+ * WorkerTasks in FIFO order. Used for file system work that benefits from
+ * running in parallel, like stat'ing or reading many files at once.
+ *
+ * The pool is created on first use and destroyed by Shutdown(), which is
+ * called by ShutdownBracketsExtensions() before CEF shuts down.
+ */
+class WorkerPool {
+public:
+    static const int kMaxThreads = 8;
+
+    // Returns the shared pool, creating it if needed. Returns NULL after
+    // Shutdown().
+    static WorkerPool* GetInstance();
+
+    // Stops the worker threads and deletes the shared pool. Tasks that are
+    // already running finish; queued tasks are deleted without running.
+    static void Shutdown();
+
+    // Queues a task. The pool takes ownership and deletes it after it ran.
+    void PostTask(WorkerTask* task);
+
+    int GetThreadCount() const { return (int)m_threads.size(); }
+
+    // Returns true if called from one of the pool's threads
+    bool IsWorkerThread() const;
+
+private:
+    class WorkerThread;
+
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    // Called by the worker threads. Returns NULL when the pool shuts down.
+    WorkerTask* WaitForTask();
+
+    Lock m_lock;
+    ConditionVariable m_taskAvailable;
+    std::deque<WorkerTask*> m_tasks;
+    std::vector<WorkerThread*> m_threads;
+    bool m_stopping;
+};
+
+// Counts outstanding work, so a thread can wait until all of it is done
+class WaitGroup {
+public:
+    WaitGroup();
+
+    void Add(int count);
+    void Done();
+
+    // Blocks until every Add() has been matched by a Done()
+    void Wait();
+
+private:
+    Lock m_lock;
+    ConditionVariable m_allDone;
+    int m_count;
+};
+
+// Body of a ParallelFor() loop
+class RangeTask {
+public:
+    virtual ~RangeTask() {}
+
+    // Processes items [begin, end). Runs concurrently with other ranges.
+    virtual void Run(size_t begin, size_t end) = 0;
+};
+
+// Runs task over [0, count) split into ranges of at least minBatch items, on
+// the shared WorkerPool and the calling thread, and returns once every range
+// is done. The calling thread runs every range no worker has started yet, so
+// it never waits for tasks queued ahead on the pool, and can be called from
+// a WorkerTask too. Small counts run entirely on the calling thread.
+void ParallelFor(size_t count, size_t minBatch, RangeTask& task);
+
+} // namespace Brackets
+
+#endif // _BRACKETS_WORKER_POOL_H
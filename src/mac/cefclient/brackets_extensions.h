@@ -30,6 +30,10 @@
 // Register the Brackets extension handler.
 void InitBracketsExtensions();
 
+// Stop background work started by the Brackets extension handler. Called
+// before CefShutdown().
+void ShutdownBracketsExtensions();
+
 typedef const std::string BracketsCommandName;
 
 /**
@@ -24,6 +24,17 @@
 
 #include "brackets_extensions.h"
 #include "client_handler.h"
+#include "common/brackets_async.h"
+#include "common/brackets_call_log.h"
+#include "common/brackets_fs.h"
+#include "common/brackets_fs_content_cache.h"
+#include "common/brackets_fs_index.h"
+#include "common/brackets_fs_metadata_cache.h"
+#include "common/brackets_metrics.h"
+#include "common/brackets_trace.h"
+#include "common/brackets_v8_binding.h"
+#include "common/brackets_v8_util.h"
+#include "common/brackets_worker_pool.h"
 
 #import <Cocoa/Cocoa.h>
 
@@ -34,21 +45,6 @@
 extern CefRefPtr<ClientHandler> g_handler;
 extern CFAbsoluteTime g_appStartupTime;
 
-// Error values. These MUST be in sync with the error values
-// in brackets_extensions.js
-static const int NO_ERROR                   = 0;
-static const int ERR_UNKNOWN                = 1;
-static const int ERR_INVALID_PARAMS         = 2;
-static const int ERR_NOT_FOUND              = 3;
-static const int ERR_CANT_READ              = 4;
-static const int ERR_UNSUPPORTED_ENCODING   = 5;
-static const int ERR_CANT_WRITE             = 6;
-static const int ERR_OUT_OF_SPACE           = 7;
-static const int ERR_NOT_FILE               = 8;
-static const int ERR_NOT_DIRECTORY          = 9;
-
-
-
 @interface ChromeWindowsTerminatedObserver : NSObject
 - (void)appTerminated:(NSNotification *)note;
 - (void)timeoutTimer:(NSTimer*)timer;
@@ -60,8 +56,12 @@ static const int ERR_NOT_DIRECTORY          = 9;
 class BracketsExtensionHandler : public CefV8Handler
 {
 public:
-    BracketsExtensionHandler() : lastError(0), m_chromeTerminateObserver(nil), m_closeLiveBrowserTimeoutTimer(nil) {
+    typedef Brackets::V8Binding::Function Function;
+    typedef Brackets::V8Binding::Array Array;
+
+    BracketsExtensionHandler() : m_chromeTerminateObserver(nil), m_closeLiveBrowserTimeoutTimer(nil) {
         s_instance = this;
+        RegisterMethods();
     }
     
     virtual ~BracketsExtensionHandler() {
@@ -71,250 +71,671 @@ public:
     
     // Execute with the specified argument list and return value.  Return true if
     // the method was handled.
+    //
+    // Every native function returns an array [err, value], with the error code
+    // and the value the method set, if any, so JavaScript gets both from the one
+    // call. Overlapping calls can't see each other's errors.
     virtual bool Execute(const CefString& name,
                          CefRefPtr<CefV8Value> object,
                          const CefV8ValueList& arguments,
                          CefRefPtr<CefV8Value>& retval,
                          CefString& exception)
     {
-        int errorCode = -1;
-        
-        if (name == "OpenLiveBrowser")
-        {
-            // OpenLiveBrowser(url)
-            //
-            // Inputs:
-            //  url - url of the document or website to open
-            //
-            // Error:
-            //  NO_ERROR
-            //  ERR_INVALID_PARAMS - invalid parameters
-            //  ERR_UNKNOWN - unable to launch the browser
-            
-            errorCode = OpenLiveBrowser(arguments, retval, exception);
-        }
-        else if (name == "CloseLiveBrowser")
-        {
-            // CloseLiveBrowser()
-            //
-            // Inputs:
-            //  callback - the function to callback when the window has closed or timed out
-            //
-            // Error:
-            //  NO_ERROR - retuned by the function it means the windows where told to close, returned
-            //             in the callback it means the windows are closed
-            //  ERR_INVALID_PARAMS - invalid parameters (the callback is either null or must be a function)
-            //  ERR_UNKNOWN - the timeout expired without the windows closing
-            
-            errorCode = CloseLiveBrowser(arguments, retval, exception);
-        }
-        else if (name == "ShowOpenDialog") 
-        {
-            // showOpenDialog(allowMultipleSelection, chooseDirectory, title, initialPath, fileTypes)
-            //
-            // Inputs:
-            //  allowMultipleSelection - Boolean
-            //  chooseDirectory - Boolean. Choose directory if true, choose file if false
-            //  title - title of the dialog
-            //  initialPath - initial path to display. Pass "" to show default.
-            //  fileTypes - space-delimited string of file extensions, without '.' Pass null to show all file types
-            //
-            // Output:
-            //  "" if no file/directory was selected
-            //  JSON-formatted array of full path names if one or more files were selected
-            //
-            // Error:
-            //  NO_ERROR
-            //  ERR_INVALID_PARAMS - invalid parameters
-            
-            errorCode = ExecuteShowOpenDialog(arguments, retval, exception);
-        }
-        else if (name == "ReadDir")
-        {
-            // ReadDir(path)
-            //
-            // Inputs:
-            //  path - full path of directory to be read
-            //
-            // Outputs:
-            //  JSON-formatted array of the names of the files in the directory, not including '.' and '..'.
-            //
-            // Error:
-            //   NO_ERROR - no error
-            //   ERR_UNKNOWN - unknown error
-            //   ERR_INVALID_PARAMS - invalid parameters
-            //   ERR_NOT_FOUND - directory could not be found
-            //   ERR_CANT_READ - could not read directory
-            
-            errorCode = ExecuteReadDir(arguments, retval, exception);
-        }
-        else if (name == "IsDirectory")
-        {
-            // IsDirectory(path)
-            //
-            // Inputs:
-            //  path - full path of directory to test
-            //
-            // Outputs:
-            //  true if path is a directory, false if error or it is a file
-            //
-            // Error:
-            //  NO_ERROR - no error
-            //  ERR_INVALID_PARAMS - invalid parameters
-            //  ERR_NOT_FOUND - file/directory could not be found
-            
-            errorCode = ExecuteIsDirectory(arguments, retval, exception);
-        }
-        else if (name == "ReadFile")
-        {
-            // ReadFile(path, encoding)
-            //
-            // Inputs:
-            //  path - full path of file to read
-            //  encoding - 'utf8' is the only supported format for now
-            //
-            // Output:
-            //  String - contents of the file
-            //
-            // Error:
-            //  NO_ERROR - no error
-            //  ERR_UNKNOWN - unknown error
-            //  ERR_INVALID_PARAMS - invalid parameters
-            //  ERR_NOT_FOUND - file could not be found
-            //  ERR_CANT_READ - file could not be read
-            //  ERR_UNSUPPORTED_ENCODING - unsupported encoding value 
-            
-            errorCode = ExecuteReadFile(arguments, retval, exception);
-        }
-        else if (name == "WriteFile")
-        {
-            // WriteFile(path, data, encoding)
-            //
-            // Inputs:
-            //  path - full path of file to write
-            //  data - data to write to file
-            //  encoding - 'utf8' is the only supported format for now
-            //
-            // Output:
-            //  none
-            //
-            // Error:
-            //  NO_ERROR - no error
-            //  ERR_UNKNOWN - unknown error
-            //  ERR_INVALID_PARAMS - invalid parameters
-            //  ERR_UNSUPPORTED_ENCODING - unsupported encoding value
-            //  ERR_CANT_WRITE - file could not be written
-            //  ERR_OUT_OF_SPACE - no more space for file
-            
-            errorCode = ExecuteWriteFile(arguments, retval, exception);
-        }
-        else if (name == "SetPosixPermissions")
-        {
-            // SetPosixPermissions(path, mode)
-            //
-            // Inputs:
-            //  path - full path of file or directory
-            //  mode - permissions for file or directory, in numeric format
-            //
-            // Output:
-            //  none
-            //
-            // Errors
-            //  NO_ERROR - no error
-            //  ERR_UNKNOWN - unknown error
-            //  ERR_INVALID_PARAMS - invalid parameters
-            //  ERR_NOT_FOUND - can't file file/directory
-            //  ERR_UNSUPPORTED_ENCODING - unsupported encoding value
-            //  ERR_CANT_WRITE - permissions could not be written
-            
-            errorCode = ExecuteSetPosixPermissions(arguments, retval, exception);
-            
-        }
-        else if ( name == "GetFileModificationTime")
-        {
-            // Returns the time stamp for a file or directory
-            // 
-            // Inputs:
-            //  path - full path of file or directory
-            //
-            // Outputs:
-            // Date - timestamp of file
-            // 
-            // Possible error values:
-            //    NO_ERROR
-            //    ERR_UNKNOWN
-            //    ERR_INVALID_PARAMS
-            //    ERR_NOT_FOUND
-            
-            errorCode = ExecuteGetFileModificationTime( arguments, retval, exception);
-        }
-        else if (name == "DeleteFileOrDirectory")
-        {
-            // DeleteFileOrDirectory(path)
-            //
-            // Inputs:
-            //  path - full path of file or directory
-            //
-            // Ouput:
-            //  none
-            //
-            // Errors
-            //  NO_ERROR - no error
-            //  ERR_UNKNOWN - unknown error
-            //  ERR_INVALID_PARAMS - invalid parameters
-            //  ERR_NOT_FOUND - can't file file/directory
-            
-            errorCode = ExecuteDeleteFileOrDirectory(arguments, retval, exception);
-        }
-        else if (name == "QuitApplication")
-        {
-            // QuitApplication
-            //
-            // Inputs: none
-            // Output: none
-            errorCode = ExecuteQuitApplication(arguments, retval, exception);
-        }
-        else if (name == "ShowDeveloperTools")
-        {
-            errorCode = ExecuteShowDeveloperTools(arguments, retval, exception);
-        }
-        else if (name == "GetElapsedMilliseconds")
-        {
-            // Get
-            //
-            // Inputs: 
-            //  none
-            // Output: 
-            //  Number of milliseconds that have elapsed since the application
-            //  was launched.
-            errorCode = ExecuteGetElapsedMilliseconds(arguments, retval, exception); 
-        }
-        else if (name == "GetLastError")
-        {
-            // Special case private native function to return the last error code.
-            retval = CefV8Value::CreateInt(lastError);
-            
-            // Early exit since we are just returning the last error code
-            return true;
-        }
-        
-        if (errorCode != -1) 
-        {
-            lastError = errorCode;
-            return true;
-        }
-        
-        return false;
+        CefRefPtr<CefV8Value> value;
+        int errorCode;
+        if (!m_methods.Invoke(this, name, arguments, value, errorCode))
+            return false;
+
+        retval = Brackets::V8Util::CreateResult(errorCode, value);
+        return true;
+    }
+
+    // Binds the native methods to their names. Each one is listed with the
+    // JavaScript arguments it takes, which its C++ signature matches.
+    void RegisterMethods()
+    {
+        // OpenLiveBrowser(url)
+        //
+        // Inputs:
+        //  url - url of the document or website to open
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_UNKNOWN - unable to launch the browser
+        m_methods.Add("OpenLiveBrowser", &BracketsExtensionHandler::OpenLiveBrowser);
+
+        // CloseLiveBrowser()
+        //
+        // Inputs:
+        //  callback - the function to callback when the window has closed or timed out
+        //
+        // Error:
+        //  NO_ERROR - retuned by the function it means the windows where told to close, returned
+        //             in the callback it means the windows are closed
+        //  ERR_INVALID_PARAMS - invalid parameters (the callback is either null or must be a function)
+        //  ERR_UNKNOWN - the timeout expired without the windows closing
+        m_methods.AddRaw("CloseLiveBrowser", &BracketsExtensionHandler::CloseLiveBrowser);
+
+        // showOpenDialog(allowMultipleSelection, chooseDirectory, title, initialPath, fileTypes)
+        //
+        // Inputs:
+        //  allowMultipleSelection - Boolean
+        //  chooseDirectory - Boolean. Choose directory if true, choose file if false
+        //  title - title of the dialog
+        //  initialPath - initial path to display. Pass "" to show default.
+        //  fileTypes - space-delimited string of file extensions, without '.' Pass null to show all file types
+        //
+        // Output:
+        //  Array of full path names of the selected files/directories. Empty if
+        //  nothing was selected.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("ShowOpenDialog", &BracketsExtensionHandler::ExecuteShowOpenDialog);
+
+        // ReadDir(path, withInfo, callback)
+        //
+        // Inputs:
+        //  path - full path of directory to be read
+        //  withInfo - Boolean. If true, return info for each entry as well
+        //  callback - called as callback(err, entries) when the directory was read
+        //
+        // Callback:
+        //  entries - array of the names of the files in the directory, not including '.'
+        //            and '..'. If withInfo is true, an array of { name, isDir, size, mtime }
+        //            objects instead. Entries that can't be stat'ed have isDir false,
+        //            size 0 and mtime 0.
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //   NO_ERROR - no error
+        //   ERR_UNKNOWN - unknown error
+        //   ERR_INVALID_PARAMS - invalid parameters
+        //   ERR_NOT_FOUND - directory could not be found
+        //   ERR_CANT_READ - could not read directory
+        m_methods.Add("ReadDir", &BracketsExtensionHandler::ExecuteReadDir);
+
+        // Stat(path, callback)
+        //
+        // Inputs:
+        //  path - full path of file or directory
+        //  callback - called as callback(err, info) when the file was stat'ed
+        //
+        // Callback:
+        //  info - { isDir, size, mtime } object, null if there was an error
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //   NO_ERROR - no error
+        //   ERR_UNKNOWN - unknown error
+        //   ERR_INVALID_PARAMS - invalid parameters
+        //   ERR_NOT_FOUND - file/directory could not be found
+        m_methods.Add("Stat", &BracketsExtensionHandler::ExecuteStat);
+
+        // ReadFile(path, encoding, callback)
+        //
+        // Inputs:
+        //  path - full path of file to read
+        //  encoding - 'utf8', 'utf8bom', 'utf16le', 'utf16be', 'latin1', 'windows1252',
+        //             or 'auto' to detect it, see common/brackets_encoding.h
+        //  callback - called as callback(err, contents, encoding) when the file was read
+        //
+        // Callback:
+        //  contents - String, contents of the file
+        //  encoding - String, the encoding the contents were decoded from
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - file could not be found
+        //  ERR_CANT_READ - file could not be read
+        //  ERR_UNSUPPORTED_ENCODING - unsupported encoding value
+        m_methods.Add("ReadFile", &BracketsExtensionHandler::ExecuteReadFile);
+
+        // ReadFileRange(path, encoding, offset, length, callback)
+        //
+        // Inputs:
+        //  path - full path of file to read
+        //  encoding - see ReadFile, except that 'auto' is not supported
+        //  offset - byte offset to start reading at
+        //  length - maximum number of bytes to read, at least 4
+        //  callback - called as callback(err, contents, bytesRead, fileSize)
+        //
+        // Callback:
+        //  contents - String, the range, shortened so it ends on a character
+        //             boundary. The next range starts at offset + bytesRead.
+        //  bytesRead - number of bytes of the file contents holds
+        //  fileSize - current size of the file in bytes
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - file could not be found
+        //  ERR_CANT_READ - file could not be read
+        //  ERR_UNSUPPORTED_ENCODING - unsupported encoding value, or the range
+        //                             doesn't start on a character boundary
+        m_methods.Add("ReadFileRange", &BracketsExtensionHandler::ExecuteReadFileRange);
+
+        // ReadFileStream(path, encoding, chunkSize, callback)
+        //
+        // Inputs:
+        //  path - full path of file to read
+        //  encoding - see ReadFile, except that 'auto' is not supported
+        //  chunkSize - number of bytes to read per chunk, at least 4
+        //  callback - called as callback(err, contents, done) for each chunk.
+        //             done is true on the last call.
+        //
+        // Outputs:
+        //  Id of the stream, for CancelReadFileStream
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - file could not be found
+        //  ERR_CANT_READ - file could not be read
+        //  ERR_UNSUPPORTED_ENCODING - unsupported encoding value
+        m_methods.Add("ReadFileStream", &BracketsExtensionHandler::ExecuteReadFileStream);
+
+        // CancelReadFileStream(streamId)
+        //
+        // Inputs:
+        //  streamId - id returned by ReadFileStream. Its callback is still
+        //             called once more with done set to true.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("CancelReadFileStream", &BracketsExtensionHandler::ExecuteCancelReadFileStream);
+
+        // WriteFile(path, data, encoding, callback)
+        //
+        // Inputs:
+        //  path - full path of file to write
+        //  data - data to write to file
+        //  encoding - see ReadFile, except that 'auto' is not supported. data is
+        //             converted to it.
+        //  callback - called as callback(err) when the file was written
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_UNSUPPORTED_ENCODING - unsupported encoding value, or data has characters
+        //                             that can't be written in it
+        //  ERR_CANT_WRITE - file could not be written
+        //  ERR_OUT_OF_SPACE - no more space for file
+        m_methods.Add("WriteFile", &BracketsExtensionHandler::ExecuteWriteFile);
+
+        // SetSyncPolicy(policy)
+        //
+        // Inputs:
+        //  policy - SYNC_NONE, SYNC_DATA or SYNC_FULL, see common/brackets_fs.h.
+        //           Applies to the WriteFile calls that start after this one.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("SetSyncPolicy", &BracketsExtensionHandler::ExecuteSetSyncPolicy);
+
+        // SetPosixPermissions(path, mode, callback)
+        //
+        // Inputs:
+        //  path - full path of file or directory
+        //  mode - permissions for file or directory, in numeric format
+        //  callback - called as callback(err) when the permissions were set
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Errors (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - can't file file/directory
+        //  ERR_CANT_WRITE - permissions could not be written
+        m_methods.Add("SetPosixPermissions", &BracketsExtensionHandler::ExecuteSetPosixPermissions);
+
+        // StatMany(paths, callback)
+        //
+        // Inputs:
+        //  paths - array of full paths of files or directories
+        //  callback - called as callback(err, results) when all paths were stat'ed
+        //
+        // Callback:
+        //  results - array with one { err, isDir, size, mtime } object per path. err is
+        //            the error value for that path (NO_ERROR, ERR_INVALID_PARAMS,
+        //            ERR_NOT_FOUND, ERR_CANT_READ or ERR_UNKNOWN).
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error:
+        //  NO_ERROR - no error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("StatMany", &BracketsExtensionHandler::ExecuteStatMany);
+
+        // ReadDirRecursive(path, excludes, batchSize, callback)
+        //
+        // Inputs:
+        //  path - full path of the directory to walk
+        //  excludes - array of file and directory names to skip, e.g. "node_modules"
+        //  batchSize - number of paths to collect before calling callback
+        //  callback - called as callback(err, paths, done) on the main thread.
+        //             paths are relative to path, directories end with '/'.
+        //             done is true on the last call. err is the error reading
+        //             path itself.
+        //
+        // Outputs:
+        //  Id of the walk, for CancelReadDirRecursive
+        //
+        // Error:
+        //  NO_ERROR - the walk started
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("ReadDirRecursive", &BracketsExtensionHandler::ExecuteReadDirRecursive);
+
+        // CancelReadDirRecursive(walkId)
+        //
+        // Inputs:
+        //  walkId - id returned by ReadDirRecursive. Its callback is still
+        //           called once more with done set to true.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("CancelReadDirRecursive", &BracketsExtensionHandler::ExecuteCancelReadDirRecursive);
+
+        // FindInFiles(root, query, isRegexp, ignoreCase, excludes, maxResults, callback)
+        //
+        // Inputs:
+        //  root - full path of the directory to search
+        //  query - text to find, or a JavaScript regular expression if isRegexp
+        //          is true. Backreferences and lookaround are not supported.
+        //  isRegexp - true if query is a regular expression
+        //  ignoreCase - true to ignore the case of ASCII letters
+        //  excludes - array of file and directory names to skip, e.g. "node_modules"
+        //  maxResults - number of matches after which the search stops
+        //  callback - called as callback(err, matches, done, truncated) on the
+        //             main thread. matches is an array of { path, line, column,
+        //             length, preview, previewColumn } objects. done is true on
+        //             the last call, truncated is true if the search stopped at
+        //             maxResults. err is the error reading root.
+        //
+        // Outputs:
+        //  Id of the search, for CancelFindInFiles
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away for invalid arguments,
+        // an unsupported query and the others go to callback):
+        //  NO_ERROR - the search started
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - root could not be found
+        //  ERR_CANT_READ - root could not be read
+        m_methods.Add("FindInFiles", &BracketsExtensionHandler::ExecuteFindInFiles);
+
+        // CancelFindInFiles(searchId)
+        //
+        // Inputs:
+        //  searchId - id returned by FindInFiles. Its callback is still
+        //             called once more with done set to true.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("CancelFindInFiles", &BracketsExtensionHandler::ExecuteCancelFindInFiles);
+
+        // Watch(path, callback)
+        //
+        // Inputs:
+        //  path - full path of the file or directory to watch. For a directory,
+        //         the entries directly in it are watched as well.
+        //  callback - called as callback(err, events) on the main thread with
+        //             each batch of changes made by other programs. events is
+        //             an array of { path, type } objects, where type is
+        //             "created", "changed" or "deleted". If the watch could not
+        //             be started, it is called once with the error instead.
+        //
+        // Outputs:
+        //  Id of the watch, for Unwatch
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error, e.g. too many watches
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - file/directory could not be found
+        //  ERR_CANT_READ - directory could not be read
+        m_methods.Add("Watch", &BracketsExtensionHandler::ExecuteWatch);
+
+        // Unwatch(watchId)
+        //
+        // Inputs:
+        //  watchId - id returned by Watch. Its callback is not called again.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("Unwatch", &BracketsExtensionHandler::ExecuteUnwatch);
+
+        // CreateFileIndex(root, excludes, callback)
+        //
+        // Inputs:
+        //  root - full path of the directory whose files are indexed
+        //  excludes - array of file and directory names to skip, e.g. "node_modules"
+        //  callback - called as callback(err, count) on the main thread once
+        //             the index is complete. count is the number of files in
+        //             it, err is the error reading root. Not called if the
+        //             index is closed first.
+        //
+        // Outputs:
+        //  Id of the index, for QueryFileIndex and CloseFileIndex. The index
+        //  is kept up to date by writeFile, unlink, the events of watches
+        //  and UpdateFileIndex.
+        //
+        // Error:
+        //  NO_ERROR - indexing started
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("CreateFileIndex", &BracketsExtensionHandler::ExecuteCreateFileIndex);
+
+        // QueryFileIndex(indexId, query, maxResults)
+        //
+        // Inputs:
+        //  indexId - id returned by CreateFileIndex
+        //  query - text the relative path must contain, ignoring the case of
+        //          ASCII letters
+        //  maxResults - most paths to return
+        //
+        // Outputs:
+        //  Array of paths relative to the root of the index. Files whose name
+        //  starts with query come first, sorted by name.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters or unknown index
+        m_methods.Add("QueryFileIndex", &BracketsExtensionHandler::ExecuteQueryFileIndex);
+
+        // FuzzyQueryFileIndex(indexId, query, maxResults)
+        //
+        // Inputs:
+        //  indexId - id returned by CreateFileIndex
+        //  query - characters the relative path must contain in order,
+        //          ignoring the case of ASCII letters
+        //  maxResults - number of best matches to return
+        //
+        // Outputs:
+        //  Array of { path, score, ranges } objects, best first. path is
+        //  relative to the root of the index, ranges is an array of
+        //  { start, length } objects with the matched characters of path.
+        //  The paths are scored on background threads, see
+        //  common/brackets_fuzzy.h.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters or unknown index
+        m_methods.Add("FuzzyQueryFileIndex", &BracketsExtensionHandler::ExecuteFuzzyQueryFileIndex);
+
+        // UpdateFileIndex(paths, callback)
+        //
+        // Inputs:
+        //  paths - array of full paths that changed. Files are added,
+        //          missing paths are removed and directories are indexed
+        //          again, in every index that contains them.
+        //  callback - called as callback(err) once the indexes are updated.
+        //             Directories may still be being indexed.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("UpdateFileIndex", &BracketsExtensionHandler::ExecuteUpdateFileIndex);
+
+        // CloseFileIndex(indexId)
+        //
+        // Inputs:
+        //  indexId - id returned by CreateFileIndex
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("CloseFileIndex", &BracketsExtensionHandler::ExecuteCloseFileIndex);
+
+        // GetFileIndexStats(indexId)
+        //
+        // Inputs:
+        //  indexId - id returned by CreateFileIndex
+        //
+        // Outputs:
+        //  { files, poolBytes } object, see common/brackets_fs_index.h
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters or unknown index
+        m_methods.Add("GetFileIndexStats", &BracketsExtensionHandler::ExecuteGetFileIndexStats);
+
+        // GetMetadataCacheStats()
+        //
+        // Outputs:
+        //  { hits, misses, evictions, invalidations, entries } object with the
+        //  counters of the Stat/ReadDir cache, see common/brackets_fs_metadata_cache.h
+        //
+        // Error:
+        //  NO_ERROR
+        m_methods.Add("GetMetadataCacheStats", &BracketsExtensionHandler::ExecuteGetMetadataCacheStats);
+
+        // GetContentCacheStats()
+        //
+        // Outputs:
+        //  { hits, misses, evictions, invalidations, entries, bytes, budget } object
+        //  with the counters of the ReadFile cache, see common/brackets_fs_content_cache.h
+        //
+        // Error:
+        //  NO_ERROR
+        m_methods.Add("GetContentCacheStats", &BracketsExtensionHandler::ExecuteGetContentCacheStats);
+
+        // SetContentCacheBudget(bytes)
+        //
+        // Inputs:
+        //  bytes - most memory the ReadFile cache may use. 0 turns it off.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("SetContentCacheBudget", &BracketsExtensionHandler::ExecuteSetContentCacheBudget);
+
+        // DeleteFileOrDirectory(path, filesOnly, callback)
+        //
+        // Inputs:
+        //  path - full path of file or directory
+        //  filesOnly - Boolean. If true, directories are not deleted
+        //  callback - called as callback(err) when the file was deleted
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - file/directory could not be found
+        //  ERR_NOT_FILE - path is a directory and filesOnly is true
+        //  ERR_CANT_WRITE - file/directory could not be deleted
+        m_methods.Add("DeleteFileOrDirectory", &BracketsExtensionHandler::ExecuteDeleteFileOrDirectory);
+
+        // MakeDir(path, mode, callback)
+        //
+        // Inputs:
+        //  path - full path of the directory. Missing parent directories are
+        //         created too.
+        //  mode - permissions for the new directories, in numeric format
+        //  callback - called as callback(err) when the directory was created
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_FILE_EXISTS - path exists already
+        //  ERR_CANT_WRITE - directory could not be created
+        m_methods.Add("MakeDir", &BracketsExtensionHandler::ExecuteMakeDir);
+
+        // Rename(oldPath, newPath, callback)
+        //
+        // Inputs:
+        //  oldPath - full path of the file or directory
+        //  newPath - its new full path, on the same volume. Changing only the
+        //            case of the name is allowed.
+        //  callback - called as callback(err) when the file was renamed
+        //
+        // Outputs:
+        //  Id of the request
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - file/directory could not be found
+        //  ERR_FILE_EXISTS - newPath exists already
+        //  ERR_CANT_WRITE - file/directory could not be renamed, e.g. because
+        //                   newPath is on another volume
+        m_methods.Add("Rename", &BracketsExtensionHandler::ExecuteRename);
+
+        // Copy(path, newPath, callback)
+        // Move(path, newPath, callback)
+        //
+        // Inputs:
+        //  path - full path of the file or directory. Directories are copied
+        //         with everything in them.
+        //  newPath - full path of the copy, which must not exist yet
+        //  callback - called as callback(err, progress, done) on the main
+        //             thread about ten times a second while files are copied,
+        //             and a last time with done set to true. progress is a
+        //             { files, totalFiles, bytes, totalBytes } object; the
+        //             totals grow as directories are read.
+        //
+        // Move renames path. If newPath is on another volume, path is copied
+        // and deleted once the copy succeeded.
+        //
+        // Outputs:
+        //  Id of the copy, for CancelCopy
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - no error
+        //  ERR_UNKNOWN - unknown error, or the copy was cancelled
+        //  ERR_INVALID_PARAMS - invalid parameters, or newPath is inside path
+        //  ERR_NOT_FOUND - file/directory could not be found
+        //  ERR_CANT_READ - file/directory could not be read
+        //  ERR_FILE_EXISTS - newPath, or a file in it, exists already
+        //  ERR_CANT_WRITE - file/directory could not be written
+        m_methods.Add("Copy", &BracketsExtensionHandler::ExecuteCopy);
+        m_methods.Add("Move", &BracketsExtensionHandler::ExecuteMove);
+
+        // CancelCopy(copyId)
+        //
+        // Inputs:
+        //  copyId - id returned by Copy or Move. Its callback is still called
+        //           once more with done set to true. What was copied so far
+        //           is left in place.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("CancelCopy", &BracketsExtensionHandler::ExecuteCancelCopy);
+
+        // DeleteRecursive(path, callback)
+        //
+        // Inputs:
+        //  path - full path of the file or directory to delete, with everything
+        //         in it. Symlinks are deleted, not followed.
+        //  callback - called as callback(err, progress, failures, done) on the
+        //             main thread about ten times a second while entries are
+        //             deleted, and a last time with done set to true. progress
+        //             is a { deleted, failed } object. failures is an array of
+        //             { path, err } objects for the entries that could not be
+        //             deleted; it is only filled in on the last call. Entries
+        //             that fail don't stop the others.
+        //
+        // Outputs:
+        //  Id of the delete, for CancelDeleteRecursive
+        //
+        // Error (ERR_INVALID_PARAMS is returned right away, the others go to callback):
+        //  NO_ERROR - path is gone
+        //  ERR_UNKNOWN - unknown error, or the delete was cancelled
+        //  ERR_INVALID_PARAMS - invalid parameters
+        //  ERR_NOT_FOUND - file/directory could not be found
+        //  ERR_CANT_READ - a directory could not be read
+        //  ERR_CANT_WRITE - an entry could not be deleted
+        m_methods.Add("DeleteRecursive", &BracketsExtensionHandler::ExecuteDeleteRecursive);
+
+        // CancelDeleteRecursive(deleteId)
+        //
+        // Inputs:
+        //  deleteId - id returned by DeleteRecursive. Its callback is still
+        //             called once more with done set to true. What was not
+        //             deleted yet is left in place.
+        //
+        // Error:
+        //  NO_ERROR
+        //  ERR_INVALID_PARAMS - invalid parameters
+        m_methods.Add("CancelDeleteRecursive", &BracketsExtensionHandler::ExecuteCancelDeleteRecursive);
+
+        // QuitApplication
+        //
+        // Inputs: none
+        // Output: none
+        m_methods.Add("QuitApplication", &BracketsExtensionHandler::ExecuteQuitApplication);
+
+        m_methods.Add("ShowDeveloperTools", &BracketsExtensionHandler::ExecuteShowDeveloperTools);
+
+        // Get
+        //
+        // Inputs:
+        //  none
+        // Output:
+        //  Number of milliseconds that have elapsed since the application
+        //  was launched.
+        m_methods.Add("GetElapsedMilliseconds", &BracketsExtensionHandler::ExecuteGetElapsedMilliseconds);
+
+        // GetNativeStats
+        //
+        // Inputs:
+        //  none
+        // Output:
+        //  Array of { name, calls, errors, bytesIn, bytesOut, latency,
+        //  callbackLatency } objects, one for each native function, as
+        //  recorded by Brackets::Metrics since the application was launched.
+        //  latency and callbackLatency are { count, min, mean, max, p50,
+        //  p90, p99, p999, buckets } objects, in milliseconds.
+        m_methods.Add("GetNativeStats", &BracketsExtensionHandler::ExecuteGetNativeStats);
+
+        // GetTrace
+        //
+        // Inputs:
+        //  none
+        // Output:
+        //  The spans recorded by Brackets::Trace, as a string of Trace Event
+        //  Format JSON that chrome://tracing can load.
+        m_methods.Add("GetTrace", &BracketsExtensionHandler::ExecuteGetTrace);
     }
     
-    int OpenLiveBrowser(const CefV8ValueList& args,
-                              CefRefPtr<CefV8Value>& retval,
-                              CefString& exception)
+    int OpenLiveBrowser(const std::string& argURL,
+                        CefRefPtr<CefV8Value>& retval)
     {
-        // Parse the arguments
-        if (args.size() != 1 || !args[0]->IsString())
-            return ERR_INVALID_PARAMS;
-        std::string argURL = args[0]->GetStringValue();
         NSString *urlString = [NSString stringWithUTF8String:argURL.c_str()];
         NSURL *url = [NSURL URLWithString:urlString];
         
@@ -424,8 +845,7 @@ public:
     }
   
     int CloseLiveBrowser(const CefV8ValueList& args,
-                      CefRefPtr<CefV8Value>& retval,
-                      CefString& exception)
+                         CefRefPtr<CefV8Value>& retval)
     {
         // Reset timeout timer
         CloseLiveBrowserKillTimers();
@@ -482,21 +902,15 @@ public:
         return NO_ERROR;
     }
     
-    int ExecuteShowOpenDialog(const CefV8ValueList& arguments,
-                               CefRefPtr<CefV8Value>& retval,
-                               CefString& exception)
+    int ExecuteShowOpenDialog(bool allowsMultipleSelection,
+                              bool canChooseDirectories,
+                              const std::string& title,
+                              const std::string& initialPath,
+                              const std::string& fileTypesStr,
+                              CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 5 || !arguments[2]->IsString() || !arguments[3]->IsString() || !arguments[4]->IsString())
-            return ERR_INVALID_PARAMS;
-        
-        // Grab the arguments
-        bool allowsMultipleSelection = arguments[0]->GetBoolValue();
-        bool canChooseDirectories = arguments[1]->GetBoolValue();
         bool canChooseFiles = !canChooseDirectories;
-        std::string title = arguments[2]->GetStringValue();
-        std::string initialPath = arguments[3]->GetStringValue();
-        std::string fileTypesStr = arguments[4]->GetStringValue();
-        std::string result = "";
+        std::vector<std::string> selection;
         
         NSArray* allowedFileTypes = nil;
         
@@ -523,184 +937,448 @@ public:
         
         if ([openPanel runModal] == NSOKButton)
         {
-            NSArrayToJSONString([openPanel filenames], result);
+            NSArray* filenames = [openPanel filenames];
+            for (NSUInteger i = 0; i < [filenames count]; i++)
+                selection.push_back([[filenames objectAtIndex:i] UTF8String]);
         }
         
-        retval = CefV8Value::CreateString(result);
+        retval = Brackets::V8Util::CreateStringArray(selection);
         
         return NO_ERROR;
         
         
     }
     
-    int ExecuteReadDir(const CefV8ValueList& arguments,
-                       CefRefPtr<CefV8Value>& retval,
-                       CefString& exception)
+    int ExecuteReadDir(const std::string& path,
+                       bool withInfo,
+                       const Function& callback,
+                       CefRefPtr<CefV8Value>& retval)
+    {
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::ReadDirAsync(path, withInfo, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteStat(const std::string& path,
+                    const Function& callback,
+                    CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 1 || !arguments[0]->IsString())
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::StatAsync(path, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteReadFile(const std::string& path,
+                        const std::string& encoding,
+                        const Function& callback,
+                        CefRefPtr<CefV8Value>& retval)
+    {
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::ReadFileAsync(path, encoding, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteReadFileRange(const std::string& path,
+                             const std::string& encoding,
+                             double offset,
+                             int length,
+                             const Function& callback,
+                             CefRefPtr<CefV8Value>& retval)
+    {
+        if (offset < 0 || length <= 0)
             return ERR_INVALID_PARAMS;
-        
-        std::string pathStr = arguments[0]->GetStringValue();
-        std::string result = "";
-        NSString* path = [NSString stringWithUTF8String:pathStr.c_str()];
-        NSError* error = nil;
-        
-        NSArray* contents = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:path error:&error];
-        
-        if (contents != nil)
-        {
-            NSArrayToJSONString(contents, result);
-            retval = CefV8Value::CreateString(result);
-            return NO_ERROR; 
-        }
-        
-        return ConvertNSErrorCode(error, true);
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::ReadFileRangeAsync(path, encoding, (long long)offset, length, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
     }
     
-    int ExecuteIsDirectory(const CefV8ValueList& arguments,
-                            CefRefPtr<CefV8Value>& retval,
-                            CefString& exception)
+    int ExecuteReadFileStream(const std::string& path,
+                              const std::string& encoding,
+                              int chunkSize,
+                              const Function& callback,
+                              CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 1 || !arguments[0]->IsString())
+        if (path.empty() || chunkSize < 4)
             return ERR_INVALID_PARAMS;
-        
-        std::string pathStr = arguments[0]->GetStringValue();
-        NSString* path = [NSString stringWithUTF8String:pathStr.c_str()];
-        BOOL isDirectory;
-        
-        if ([[NSFileManager defaultManager] fileExistsAtPath:path isDirectory:&isDirectory])
-        {
-            retval = CefV8Value::CreateBool(isDirectory);
-            return NO_ERROR;
-        }
-        
-        return ERR_NOT_FOUND;
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        int streamId = Brackets::FileSystem::ReadFileStreamAsync(path, encoding, chunkSize, callbackId);
+
+        retval = CefV8Value::CreateInt(streamId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteCancelReadFileStream(int streamId,
+                                    CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::CancelReadFileStream(streamId);
+        return NO_ERROR;
     }
     
-    int ExecuteReadFile(const CefV8ValueList& arguments,
-                       CefRefPtr<CefV8Value>& retval,
-                       CefString& exception)
+    int ExecuteWriteFile(const std::string& path,
+                         std::string& contents,
+                         const std::string& encoding,
+                         const Function& callback,
+                         CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 2 || !arguments[0]->IsString() || !arguments[1]->IsString())
+        // contents is the binding's copy, so WriteFileAsync() can swap it out
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::WriteFileAsync(path, contents, encoding, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteSetSyncPolicy(int policy,
+                             CefRefPtr<CefV8Value>& retval)
+    {
+        if (policy < Brackets::FileSystem::SYNC_NONE || policy > Brackets::FileSystem::SYNC_FULL)
             return ERR_INVALID_PARAMS;
 
-        std::string pathStr = arguments[0]->GetStringValue();
-        std::string encodingStr = arguments[1]->GetStringValue();
-        NSString* path = [NSString stringWithUTF8String:pathStr.c_str()];
-        
-        NSStringEncoding encoding;
-        NSError* error = nil;
-        
-        if (encodingStr == "utf8")
-            encoding = NSUTF8StringEncoding;
-        else
-            return ERR_UNSUPPORTED_ENCODING; 
-        
-        NSString* contents = [NSString stringWithContentsOfFile:path encoding:encoding error:&error];
-        
-        if (contents) 
-        {
-            retval = CefV8Value::CreateString([contents UTF8String]);
-            return NO_ERROR;
+        Brackets::FileSystem::SetSyncPolicy((Brackets::FileSystem::SyncPolicy)policy);
+        return NO_ERROR;
+    }
+    
+    int ExecuteStatMany(const Array& pathsArray,
+                        const Function& callback,
+                        CefRefPtr<CefV8Value>& retval)
+    {
+        // Entries that aren't strings are left empty, and get ERR_INVALID_PARAMS
+        int count = pathsArray->GetArrayLength();
+        std::vector<std::string> paths(count);
+        for (int i = 0; i < count; i++) {
+            CefRefPtr<CefV8Value> path = pathsArray->GetValue(i);
+            if (path.get() && path->IsString())
+                paths[i] = path->GetStringValue();
         }
-        
-        return ConvertNSErrorCode(error, true);
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::StatManyAsync(paths, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
     }
     
-    int ExecuteWriteFile(const CefV8ValueList& arguments,
-                       CefRefPtr<CefV8Value>& retval,
-                       CefString& exception)
+    int ExecuteReadDirRecursive(const std::string& path,
+                                const std::vector<std::string>& excludes,
+                                int batchSize,
+                                const Function& callback,
+                                CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 3 || !arguments[0]->IsString() || !arguments[1]->IsString() || !arguments[2]->IsString())
+        if (path.empty() || batchSize <= 0)
             return ERR_INVALID_PARAMS;
 
-        std::string pathStr = arguments[0]->GetStringValue();
-        std::string contentsStr = arguments[1]->GetStringValue();
-        std::string encodingStr = arguments[2]->GetStringValue();
-        
-        NSString* path = [NSString stringWithUTF8String:pathStr.c_str()];
-        NSString* contents = [NSString stringWithUTF8String:contentsStr.c_str()];
-        NSStringEncoding encoding;
-        NSError* error = nil;
-        
-        if (encodingStr == "utf8")
-            encoding = NSUTF8StringEncoding;
-        else
-            return ERR_UNSUPPORTED_ENCODING;
-        
-        const NSData* encodedContents = [ contents dataUsingEncoding:encoding ];
-        NSUInteger len = [ encodedContents length ];
-        NSOutputStream* oStream = [NSOutputStream outputStreamToFileAtPath:path append:NO ];
-        
-        [ oStream open ];
-        NSInteger res = [ oStream write:(const uint8_t*)[encodedContents bytes] maxLength:len];
-        [ oStream close ];
-        
-        if (res == -1) {
-            error = [ oStream streamError ];
-        }        
-        return ConvertNSErrorCode(error, false);
+        Brackets::FileSystem::WalkOptions options;
+        options.excludes = excludes;
+        options.batchSize = batchSize;
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        int walkId = Brackets::FileSystem::ReadDirRecursiveAsync(path, options, callbackId);
+
+        retval = CefV8Value::CreateInt(walkId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteCancelReadDirRecursive(int walkId,
+                                      CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::CancelWalk(walkId);
+        return NO_ERROR;
     }
     
-    int ExecuteGetFileModificationTime(const CefV8ValueList& arguments,
-                                       CefRefPtr<CefV8Value>& retval,
-                                       CefString& exception)
+    int ExecuteFindInFiles(const std::string& root,
+                           const std::string& query,
+                           bool isRegexp,
+                           bool ignoreCase,
+                           const std::vector<std::string>& excludes,
+                           int maxResults,
+                           const Function& callback,
+                           CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 1 || !arguments[0]->IsString())
+        if (root.empty() || query.empty() || maxResults <= 0)
             return ERR_INVALID_PARAMS;
-        
-        std::string pathStr = arguments[0]->GetStringValue();
-        NSString* path = [NSString stringWithUTF8String:pathStr.c_str()];
-        
-        NSError* error = nil;
-        NSDictionary* fileAttribs = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:&error];
-        NSDate *modDate = [fileAttribs valueForKey:NSFileModificationDate];
-        retval = CefV8Value::CreateDate(CefTime([modDate timeIntervalSince1970]));
-        
-        return ConvertNSErrorCode(error, true);
+
+        Brackets::FileSystem::SearchOptions options;
+        options.isRegexp = isRegexp;
+        options.ignoreCase = ignoreCase;
+        options.excludes = excludes;
+        options.maxResults = maxResults;
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        int searchId = Brackets::FileSystem::SearchAsync(root, query, options, callbackId);
+
+        retval = CefV8Value::CreateInt(searchId);
+        return NO_ERROR;
     }
     
-    int ExecuteSetPosixPermissions(const CefV8ValueList& arguments,
-                       CefRefPtr<CefV8Value>& retval,
-                       CefString& exception)
+    int ExecuteCancelFindInFiles(int searchId,
+                                 CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 2 || !arguments[0]->IsString() || !arguments[1]->IsInt())
+        Brackets::FileSystem::CancelSearchAsync(searchId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteWatch(const std::string& path,
+                     const Function& callback,
+                     CefRefPtr<CefV8Value>& retval)
+    {
+        if (path.empty())
             return ERR_INVALID_PARAMS;
-        
-        std::string pathStr = arguments[0]->GetStringValue();
-        int mode = arguments[1]->GetIntValue();
-        NSError* error = nil;
-        
-        NSString* path = [NSString stringWithUTF8String:pathStr.c_str()];
-        NSDictionary* attrs = [NSDictionary dictionaryWithObject:[NSNumber numberWithInt:mode] forKey:NSFilePosixPermissions];
-        
-        if ([[NSFileManager defaultManager] setAttributes:attrs ofItemAtPath:path error:&error])
-            return NO_ERROR;
-        
-        return ConvertNSErrorCode(error, false);
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        int watchId = Brackets::FileSystem::WatchAsync(path, callbackId);
+
+        retval = CefV8Value::CreateInt(watchId);
+        return NO_ERROR;
     }
     
-    int ExecuteDeleteFileOrDirectory(const CefV8ValueList& arguments,
-                       CefRefPtr<CefV8Value>& retval,
-                       CefString& exception)
+    int ExecuteUnwatch(int watchId,
+                       CefRefPtr<CefV8Value>& retval)
     {
-        if (arguments.size() != 1 || !arguments[0]->IsString())
+        Brackets::FileSystem::UnwatchAsync(watchId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteCreateFileIndex(const std::string& root,
+                               const std::vector<std::string>& excludes,
+                               const Function& callback,
+                               CefRefPtr<CefV8Value>& retval)
+    {
+        if (root.empty())
             return ERR_INVALID_PARAMS;
-        
-        std::string pathStr = arguments[0]->GetStringValue();
-        NSError* error = nil;
-        
-        NSString* path = [NSString stringWithUTF8String:pathStr.c_str()];
-        
-        if ([[NSFileManager defaultManager] removeItemAtPath:path error:&error])
-            return NO_ERROR;
-        
-        return ConvertNSErrorCode(error, false);
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        int indexId = Brackets::FileSystem::CreateIndexAsync(root, excludes, callbackId);
+
+        retval = CefV8Value::CreateInt(indexId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteQueryFileIndex(int indexId,
+                              const std::string& query,
+                              int maxResults,
+                              CefRefPtr<CefV8Value>& retval)
+    {
+        if (maxResults < 0)
+            return ERR_INVALID_PARAMS;
+
+        std::vector<std::string> paths;
+        if (!Brackets::FileSystem::QueryIndex(indexId, query, maxResults, paths))
+            return ERR_INVALID_PARAMS;
+
+        retval = Brackets::V8Util::CreateStringArray(paths);
+        return NO_ERROR;
+    }
+    
+    int ExecuteFuzzyQueryFileIndex(int indexId,
+                                   const std::string& query,
+                                   int maxResults,
+                                   CefRefPtr<CefV8Value>& retval)
+    {
+        if (maxResults < 0)
+            return ERR_INVALID_PARAMS;
+
+        Brackets::FileSystem::FuzzyResultList results;
+        if (!Brackets::FileSystem::FuzzyQueryIndex(indexId, query, maxResults, results))
+            return ERR_INVALID_PARAMS;
+
+        retval = Brackets::V8Util::CreateFuzzyResultArray(results);
+        return NO_ERROR;
+    }
+    
+    int ExecuteUpdateFileIndex(const std::vector<std::string>& paths,
+                               const Function& callback,
+                               CefRefPtr<CefV8Value>& retval)
+    {
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::RefreshIndexedPathsAsync(paths, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteCloseFileIndex(int indexId,
+                              CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::CloseIndex(indexId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteGetFileIndexStats(int indexId,
+                                 CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::IndexStats stats;
+        if (!Brackets::FileSystem::GetIndexStats(indexId, stats))
+            return ERR_INVALID_PARAMS;
+
+        retval = CefV8Value::CreateObject(NULL);
+        retval->SetValue("files", CefV8Value::CreateInt((int)stats.files), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("poolBytes", CefV8Value::CreateDouble((double)stats.poolBytes), V8_PROPERTY_ATTRIBUTE_NONE);
+        return NO_ERROR;
+    }
+    
+    int ExecuteGetMetadataCacheStats(CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::MetadataCache::Stats stats;
+        Brackets::FileSystem::MetadataCache::GetStats(stats);
+
+        retval = CefV8Value::CreateObject(NULL);
+        retval->SetValue("hits", CefV8Value::CreateDouble((double)stats.hits), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("misses", CefV8Value::CreateDouble((double)stats.misses), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("evictions", CefV8Value::CreateDouble((double)stats.evictions), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("invalidations", CefV8Value::CreateDouble((double)stats.invalidations),
+                         V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("entries", CefV8Value::CreateInt((int)stats.entries), V8_PROPERTY_ATTRIBUTE_NONE);
+        return NO_ERROR;
+    }
+    
+    int ExecuteGetContentCacheStats(CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::ContentCache::Stats stats;
+        Brackets::FileSystem::ContentCache::GetStats(stats);
+
+        retval = CefV8Value::CreateObject(NULL);
+        retval->SetValue("hits", CefV8Value::CreateDouble((double)stats.hits), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("misses", CefV8Value::CreateDouble((double)stats.misses), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("evictions", CefV8Value::CreateDouble((double)stats.evictions), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("invalidations", CefV8Value::CreateDouble((double)stats.invalidations),
+                         V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("entries", CefV8Value::CreateInt((int)stats.entries), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("bytes", CefV8Value::CreateDouble((double)stats.bytes), V8_PROPERTY_ATTRIBUTE_NONE);
+        retval->SetValue("budget", CefV8Value::CreateDouble((double)stats.budget), V8_PROPERTY_ATTRIBUTE_NONE);
+        return NO_ERROR;
+    }
+    
+    int ExecuteSetContentCacheBudget(int budget,
+                                     CefRefPtr<CefV8Value>& retval)
+    {
+        if (budget < 0)
+            return ERR_INVALID_PARAMS;
+
+        Brackets::FileSystem::ContentCache::SetBudget((size_t)budget);
+        return NO_ERROR;
+    }
+    
+    int ExecuteSetPosixPermissions(const std::string& path,
+                                   int mode,
+                                   const Function& callback,
+                                   CefRefPtr<CefV8Value>& retval)
+    {
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::SetPosixPermissionsAsync(path, mode, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+    
+    int ExecuteDeleteFileOrDirectory(const std::string& path,
+                                     bool filesOnly,
+                                     const Function& callback,
+                                     CefRefPtr<CefV8Value>& retval)
+    {
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::DeleteFileOrDirectoryAsync(path, filesOnly, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+
+    int ExecuteMakeDir(const std::string& path,
+                       int mode,
+                       const Function& callback,
+                       CefRefPtr<CefV8Value>& retval)
+    {
+        if (path.empty())
+            return ERR_INVALID_PARAMS;
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::MakeDirAsync(path, mode, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+
+    int ExecuteRename(const std::string& oldPath,
+                      const std::string& newPath,
+                      const Function& callback,
+                      CefRefPtr<CefV8Value>& retval)
+    {
+        if (oldPath.empty() || newPath.empty())
+            return ERR_INVALID_PARAMS;
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        Brackets::FileSystem::RenameAsync(oldPath, newPath, callbackId);
+
+        retval = CefV8Value::CreateInt(callbackId);
+        return NO_ERROR;
+    }
+
+    int ExecuteCopy(const std::string& path,
+                    const std::string& newPath,
+                    const Function& callback,
+                    CefRefPtr<CefV8Value>& retval)
+    {
+        return CopyOrMove(path, newPath, false, callback, retval);
+    }
+
+    int ExecuteMove(const std::string& path,
+                    const std::string& newPath,
+                    const Function& callback,
+                    CefRefPtr<CefV8Value>& retval)
+    {
+        return CopyOrMove(path, newPath, true, callback, retval);
+    }
+
+    int CopyOrMove(const std::string& path,
+                   const std::string& newPath,
+                   bool move,
+                   const Function& callback,
+                   CefRefPtr<CefV8Value>& retval)
+    {
+        if (path.empty() || newPath.empty())
+            return ERR_INVALID_PARAMS;
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        retval = CefV8Value::CreateInt(Brackets::FileSystem::CopyAsync(path, newPath, move, callbackId));
+        return NO_ERROR;
+    }
+
+    int ExecuteCancelCopy(int copyId,
+                          CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::CancelCopyAsync(copyId);
+        return NO_ERROR;
+    }
+
+    int ExecuteDeleteRecursive(const std::string& path,
+                               const Function& callback,
+                               CefRefPtr<CefV8Value>& retval)
+    {
+        if (path.empty())
+            return ERR_INVALID_PARAMS;
+
+        int callbackId = Brackets::AsyncCallbacks::Register(callback);
+        retval = CefV8Value::CreateInt(Brackets::FileSystem::DeleteRecursiveAsync(path, callbackId));
+        return NO_ERROR;
+    }
+
+    int ExecuteCancelDeleteRecursive(int deleteId,
+                                     CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::FileSystem::CancelDeleteAsync(deleteId);
+        return NO_ERROR;
     }
   
-    int ExecuteQuitApplication(const CefV8ValueList& arguments,
-                               CefRefPtr<CefV8Value>& retval,
-                               CefString& exception)
+    int ExecuteQuitApplication(CefRefPtr<CefV8Value>& retval)
     {
       if (g_handler.get()) {
         if( !g_handler->DispatchQuitToAllBrowsers() ) {
@@ -713,18 +1391,14 @@ public:
       return NO_ERROR;
     }
 
-    int ExecuteShowDeveloperTools(const CefV8ValueList& arguments,
-                                  CefRefPtr<CefV8Value>& retval,
-                                  CefString& exception)
+    int ExecuteShowDeveloperTools(CefRefPtr<CefV8Value>& retval)
     {
         // Forward to the app delegate
         [[NSApp delegate] performSelector: @selector(showDevTools:) withObject: nil];
         return NO_ERROR;
     }
 
-    int ExecuteGetElapsedMilliseconds(const CefV8ValueList& arguments,
-                               CefRefPtr<CefV8Value>& retval,
-                               CefString& exception)
+    int ExecuteGetElapsedMilliseconds(CefRefPtr<CefV8Value>& retval)
     {
         CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - g_appStartupTime;
         
@@ -732,106 +1406,26 @@ public:
         return NO_ERROR;
     }
 
-    // Escapes characters that have special meaning in JSON
-    void EscapeJSONString(const std::string& str, std::string& result) {
-        result = "";
-        
-        for(size_t pos = 0; pos != str.size(); ++pos) {
-                switch(str[pos]) {
-                    case '\a':  result.append("\\a");   break;
-                    case '\b':  result.append("\\b");   break;
-                    case '\f':  result.append("\\f");   break;
-                    case '\n':  result.append("\\n");   break;
-                    case '\r':  result.append("\\r");   break;
-                    case '\t':  result.append("\\t");   break;
-                    case '\v':  result.append("\\v");   break;
-                    // Note: single quotes are OK for JSON
-                    case '\"':  result.append("\\\"");  break; // double quote
-                    case '\\':  result.append("\\\\");  break; // backslash
-                        
-                        
-                default:   result.append( 1, str[pos]); break;
-                        
-            }
-        }
-    }
+    int ExecuteGetNativeStats(CefRefPtr<CefV8Value>& retval)
+    {
+        Brackets::Metrics::MethodStatsList stats;
+        Brackets::Metrics::GetStats(stats);
 
-    
-    void NSArrayToJSONString(NSArray* array, std::string& result)
-    {        
-        int numItems = [array count];
-        std::string escapedStr = "";
-        
-        result = "[";
-        std::string item;
-        for (int i = 0; i < numItems; i++)
-        {
-            result += "\"";
-            
-            item = [[array objectAtIndex:i] UTF8String];
-            EscapeJSONString(item, escapedStr);
-            
-            result += escapedStr + "\"";
-            
-            if (i < numItems - 1)
-                result += ", ";
-        }
-        result += "]";
+        retval = Brackets::V8Util::CreateMethodStatsArray(stats);
+        return NO_ERROR;
     }
-    
-    int ConvertNSErrorCode(NSError* error, bool isReading)
+
+    int ExecuteGetTrace(CefRefPtr<CefV8Value>& retval)
     {
-        if (!error)
-            return NO_ERROR;
-        
-        if( [[error domain] isEqualToString: NSPOSIXErrorDomain] )
-        {
-            switch ([error code]) 
-            {
-                case ENOENT:
-                    return ERR_NOT_FOUND;
-                    break;
-                case EPERM:
-                case EACCES:
-                    return (isReading ? ERR_CANT_READ : ERR_CANT_WRITE);
-                    break;
-                case EROFS:
-                    return ERR_CANT_WRITE;
-                    break;
-                case ENOSPC:
-                    return ERR_OUT_OF_SPACE;
-                    break;
-            }
-            
-        }
-        
-            
-        switch ([error code]) 
-        {
-            case NSFileNoSuchFileError:
-            case NSFileReadNoSuchFileError:
-                return ERR_NOT_FOUND;
-                break;
-            case NSFileReadNoPermissionError:
-                return ERR_CANT_READ;
-                break;
-            case NSFileReadInapplicableStringEncodingError:
-                return ERR_UNSUPPORTED_ENCODING;
-                break;
-            case NSFileWriteNoPermissionError:
-                return ERR_CANT_WRITE;
-                break;
-            case NSFileWriteOutOfSpaceError:
-                return ERR_OUT_OF_SPACE;
-                break;
-        }
-        
-        // Unknown error
-        return ERR_UNKNOWN;
+        std::string json;
+        Brackets::Trace::AppendJSON(json);
+
+        retval = CefV8Value::CreateString(json);
+        return NO_ERROR;
     }
-    
+
 private:
-    int lastError;
+    Brackets::V8Binding::MethodTable<BracketsExtensionHandler> m_methods;
     ChromeWindowsTerminatedObserver* m_chromeTerminateObserver;
     NSTimer* m_closeLiveBrowserTimeoutTimer;
     CefRefPtr<CefV8Value> m_closeLiveBrowserCallback;
@@ -844,6 +1438,8 @@ BracketsExtensionHandler* BracketsExtensionHandler::s_instance = nil;
 
 void InitBracketsExtensions()
 {
+    Brackets::CallLog::StartRecordingIfRequested();
+
     // Register a V8 extension with JavaScript code that calls native
     // methods implemented in BracketsExtensionHandler.
     
@@ -872,6 +1468,16 @@ void InitBracketsExtensions()
 
 @end
 
+void ShutdownBracketsExtensions()
+{
+    Brackets::FileSystem::ShutdownWatcher();
+    Brackets::WorkerPool::Shutdown();
+    Brackets::AsyncCallbacks::Clear();
+    Brackets::Metrics::WriteStatsOnExit();
+    Brackets::Trace::WriteTraceOnExit();
+    Brackets::CallLog::WriteCallLogOnExit();
+}
+
 //Simple stack class to ensure calls to Enter and Exit are balanced
 class StContextScope {
 public:
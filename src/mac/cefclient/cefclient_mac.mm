@@ -9,6 +9,7 @@
 #include "brackets_extensions.h"
 #include "brackets_utils_mac.h"
 #include "client_handler.h"
+#include "common/brackets_trace.h"
 #include "resource_util.h"
 #include "string_util.h"
 #import <Cocoa/Cocoa.h>
@@ -324,8 +325,11 @@ NSButton* MakeButton(NSRect* rect, NSString* title, NSView* parent) {
     initialUrl = "file://" + filePath;
   }
   
-  CefBrowser::CreateBrowser(window_info, g_handler.get(),
-                            initialUrl, settings);
+  {
+    Brackets::Trace::Scope span("CreateBrowser", "startup");
+    CefBrowser::CreateBrowser(window_info, g_handler.get(),
+                              initialUrl, settings);
+  }
 
   // Show the window.
   [mainWnd makeKeyAndOrderFront: nil];
@@ -388,6 +392,9 @@ NSButton* MakeButton(NSRect* rect, NSString* title, NSView* parent) {
 - (void)applicationWillTerminate:(NSNotification *)aNotification {
   g_isTerminating = true;
   
+  // Stop Brackets background work
+  ShutdownBracketsExtensions();
+  
   // Shut down CEF.
   g_handler = NULL;
   CefShutdown();
@@ -411,6 +418,8 @@ int main(int argc, char* argv[])
    setBool:YES forKey:@"NSDisabledCharacterPaletteMenuItem"];
 	
   g_appStartupTime = CFAbsoluteTimeGetCurrent();
+  Brackets::Trace::SetThreadName("Main");
+  Brackets::Trace::AddInstant("AppStart", "startup");
   
   // Retrieve the current working directory.
   getcwd(szWorkingDir, sizeof(szWorkingDir));
@@ -435,10 +444,16 @@ int main(int argc, char* argv[])
   // Use the Chinese language locale.
   // CefString(&settings.locale).FromASCII("zh-cn");
 
-  CefInitialize(settings, nil);
+  {
+    Brackets::Trace::Scope span("CefInitialize", "startup");
+    CefInitialize(settings, nil);
+  }
 
   // Initialize Brackets extensions
-  InitBracketsExtensions();
+  {
+    Brackets::Trace::Scope span("InitBracketsExtensions", "startup");
+    InitBracketsExtensions();
+  }
     
   // Create the application delegate and window.
   NSObject* delegate = [[ClientAppDelegate alloc] init];
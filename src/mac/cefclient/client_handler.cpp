@@ -5,6 +5,8 @@
 #include "include/cef.h"
 #include "brackets_extensions.h"
 #include "client_handler.h"
+#include "common/brackets_threading.h"
+#include "common/brackets_trace.h"
 #include "cefclient.h"
 #include "download_handler.h"
 #include "string_util.h"
@@ -21,7 +23,8 @@ ClientHandler::ClientHandler()
     m_ForwardHwnd(NULL),
     m_StopHwnd(NULL),
     m_ReloadHwnd(NULL),
-    m_bFormElementHasFocus(false)
+    m_bFormElementHasFocus(false),
+    m_LoadStartTime(0)
 {
 }
 
@@ -116,6 +119,7 @@ void ClientHandler::OnLoadStart(CefRefPtr<CefBrowser> browser,
   if(m_BrowserHwnd == browser->GetWindowHandle() && frame->IsMain()) {
     // We've just started loading a page
     SetLoading(true);
+    m_LoadStartTime = Brackets::GetMonotonicTime();
   }
 }
 
@@ -128,6 +132,7 @@ void ClientHandler::OnLoadEnd(CefRefPtr<CefBrowser> browser,
   if(m_BrowserHwnd == browser->GetWindowHandle() && frame->IsMain()) {
     // We've just finished loading a page
     SetLoading(false);
+    Brackets::Trace::AddSpan("PageLoad", "shell", m_LoadStartTime, Brackets::GetMonotonicTime());
 
     CefRefPtr<CefDOMVisitor> visitor = GetDOMVisitor(frame->GetURL());
     if(visitor.get())
@@ -257,6 +257,9 @@ protected:
   // True if a form element currently has focus
   bool m_bFormElementHasFocus;
 
+  // When the main frame started loading, for the PageLoad span of the trace
+  unsigned long long m_LoadStartTime;
+
   // Include the default reference counting implementation.
   IMPLEMENT_REFCOUNTING(ClientHandler);
   // Include the default locking implementation.
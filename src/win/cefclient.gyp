@@ -120,6 +120,161 @@
         }],
       ],
     },
+    {
+      # Benchmarks of the native code, see bench/brackets_bench.h. Only the
+      # wrapper benchmarks need libcef, so it builds without it on Linux.
+      'target_name': 'brackets_bench',
+      'type': 'executable',
+      'include_dirs': [
+        '.',
+        '..',
+      ],
+      'sources': [
+        '../bench/brackets_bench.cpp',
+        '../bench/brackets_bench.h',
+        '../bench/brackets_bench_fs.cpp',
+        '../bench/brackets_bench_json.cpp',
+        '../common/brackets_encoding.cpp',
+        '../common/brackets_fs.cpp',
+        '../common/brackets_fs_content_cache.cpp',
+        '../common/brackets_fs_copy.cpp',
+        '../common/brackets_fs_delete.cpp',
+        '../common/brackets_fs_index.cpp',
+        '../common/brackets_fs_metadata_cache.cpp',
+        '../common/brackets_fs_search.cpp',
+        '../common/brackets_fs_walker.cpp',
+        '../common/brackets_fs_watcher.cpp',
+        '../common/brackets_fuzzy.cpp',
+        '../common/brackets_json.cpp',
+        '../common/brackets_metrics.cpp',
+        '../common/brackets_regex.cpp',
+        '../common/brackets_trace.cpp',
+        '../common/brackets_worker_pool.cpp',
+      ],
+      'xcode_settings': {
+        # Target build path.
+        'SYMROOT': 'xcodebuild',
+      },
+      'conditions': [
+        ['OS=="win" or OS=="mac"', {
+          'dependencies': [
+            'libcef_dll_wrapper',
+          ],
+          'defines': [
+            'USING_CEF_SHARED',
+            'BRACKETS_BENCH_CEF',
+          ],
+          'sources': [
+            '../bench/brackets_bench_cef.cpp',
+          ],
+        }],
+        ['OS=="win"', {
+          'msvs_settings': {
+            'VCLinkerTool': {
+              # Set /SUBSYSTEM:CONSOLE.
+              'SubSystem': '1',
+            },
+          },
+          'link_settings': {
+            'libraries': [
+              '-llib/$(ConfigurationName)/libcef.lib'
+            ],
+          },
+          'sources': [
+            '../common/brackets_fs_win.cpp',
+            '../common/brackets_threading_win.cpp',
+          ],
+        }],
+        [ 'OS=="mac"', {
+          'link_settings': {
+            'libraries': [
+              '$(CONFIGURATION)/libcef.dylib'
+            ],
+          },
+        }],
+        [ 'OS!="win"', {
+          'sources': [
+            '../common/brackets_fs_posix.cpp',
+            '../common/brackets_threading_posix.cpp',
+          ],
+        }],
+        [ 'OS=="linux"', {
+          'sources': [
+            '../common/brackets_fs_watcher_linux.cpp',
+          ],
+          'link_settings': {
+            'libraries': [
+              '-lpthread',
+            ],
+          },
+        }],
+      ],
+    },
+    {
+      # Replays the native calls recorded with CallLog against the file
+      # system core, see bench/brackets_replay.cpp.
+      'target_name': 'brackets_replay',
+      'type': 'executable',
+      'include_dirs': [
+        '.',
+        '..',
+      ],
+      'sources': [
+        '../bench/brackets_replay.cpp',
+        '../common/brackets_call_log.cpp',
+        '../common/brackets_call_log.h',
+        '../common/brackets_encoding.cpp',
+        '../common/brackets_fs.cpp',
+        '../common/brackets_fs_content_cache.cpp',
+        '../common/brackets_fs_copy.cpp',
+        '../common/brackets_fs_delete.cpp',
+        '../common/brackets_fs_index.cpp',
+        '../common/brackets_fs_metadata_cache.cpp',
+        '../common/brackets_fs_search.cpp',
+        '../common/brackets_fs_walker.cpp',
+        '../common/brackets_fs_watcher.cpp',
+        '../common/brackets_fuzzy.cpp',
+        '../common/brackets_json.cpp',
+        '../common/brackets_metrics.cpp',
+        '../common/brackets_regex.cpp',
+        '../common/brackets_trace.cpp',
+        '../common/brackets_worker_pool.cpp',
+      ],
+      'xcode_settings': {
+        # Target build path.
+        'SYMROOT': 'xcodebuild',
+      },
+      'conditions': [
+        ['OS=="win"', {
+          'msvs_settings': {
+            'VCLinkerTool': {
+              # Set /SUBSYSTEM:CONSOLE.
+              'SubSystem': '1',
+            },
+          },
+          'sources': [
+            '../common/brackets_fs_win.cpp',
+            '../common/brackets_threading_win.cpp',
+          ],
+        }],
+        [ 'OS!="win"', {
+          'sources': [
+            '../common/brackets_fs_posix.cpp',
+            '../common/brackets_threading_posix.cpp',
+          ],
+        }],
+        [ 'OS=="linux"', {
+          'sources': [
+            '../common/brackets_fs_watcher_linux.cpp',
+          ],
+          'link_settings': {
+            'libraries': [
+              '-lpthread',
+            ],
+          },
+        }],
+      ],
+    },
     {
       'target_name': 'libcef_dll_wrapper',
       'type': 'static_library',
@@ -15,6 +15,7 @@
 #include "string_util.h"
 #include "uiplugin_test.h"
 #include "brackets_extensions.h"
+#include "common/brackets_trace.h"
 #include <commdlg.h>
 #include <direct.h>
 #include <sstream>
@@ -63,6 +64,8 @@ int APIENTRY wWinMain(HINSTANCE hInstance,
   UNREFERENCED_PARAMETER(lpCmdLine);
 
   g_appStartupTime = timeGetTime();
+  Brackets::Trace::SetThreadName("Main");
+  Brackets::Trace::AddInstant("AppStart", "startup");
 
   // Retrieve the current working directory.
   if(_getcwd(szWorkingDir, MAX_PATH) == NULL)
@@ -87,10 +90,16 @@ int APIENTRY wWinMain(HINSTANCE hInstance,
   CefString(&settings.cache_path).FromWString(cachePath);
 
   // Initialize CEF.
-  CefInitialize(settings, app);
+  {
+    Brackets::Trace::Scope span("CefInitialize", "startup");
+    CefInitialize(settings, app);
+  }
 
   // Initialize Brackets extensions
-  InitBracketsExtensions();
+  {
+    Brackets::Trace::Scope span("InitBracketsExtensions", "startup");
+    InitBracketsExtensions();
+  }
 
   // Register the internal client plugin.
   //InitPluginTest();
@@ -149,6 +158,9 @@ int APIENTRY wWinMain(HINSTANCE hInstance,
     result = (int)msg.wParam;
   }
 
+  // Stop Brackets background work
+  ShutdownBracketsExtensions();
+
   // Shut down CEF.
   CefShutdown();
 
@@ -412,6 +424,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         }
 
         // Create the new child browser window
+        Brackets::Trace::Scope span("CreateBrowser", "startup");
         CefBrowser::CreateBrowser(info,
             static_cast<CefRefPtr<CefClient> >(g_handler),
             initialUrl, settings);
@@ -24,8 +24,9 @@
 // This is the JavaScript code for bridging to native functionality
 // See brackets_extentions.mm for implementation of native methods.
 //
-// Note: All file native file i/o functions are synchronous, but are exposed
-// here as asynchronous calls. 
+// Note: The native file i/o functions run on background threads, and call
+// their callback on the main thread when they are done. Calls for the same
+// path complete in the order they were made.
 
 /*jslint vars: true, plusplus: true, devel: true, browser: true, nomen: true, indent: 4, forin: true, maxerr: 50, regexp: true */
 /*global define, native */
@@ -41,11 +42,9 @@ if (!brackets.app) {
     brackets.app = {};
 }
 (function () {
-    // Internal function to get the last error code.
-    native function GetLastError();
-    function getLastError() {
-        return GetLastError();
-    }
+    // Every native function returns an array [err, value], so the error of a call
+    // comes back with its value, in the same call. value is undefined if there
+    // was an error, or if the function has nothing to return.
     
     // For debug purposes. When true, a 10 millisecond timeout is
     // run before the callback is called. See invokeCallback() below
@@ -53,7 +52,7 @@ if (!brackets.app) {
     brackets.forceAsyncCallbacks = false;
         
     // Error values. These MUST be in sync with the error values
-    // at the top of brackets_extensions.mm.
+    // at the top of common/brackets_fs.h.
     
     /**
      * @constant No error.
@@ -105,6 +104,31 @@ if (!brackets.app) {
      */
     brackets.fs.ERR_NOT_DIRECTORY           = 9;
     
+    /**
+     * @constant Specified path already exists.
+     */
+    brackets.fs.ERR_FILE_EXISTS             = 10;
+    
+    // Values for setSyncPolicy(). These MUST be in sync with SyncPolicy
+    // in common/brackets_fs.h.
+    
+    /**
+     * @constant Saved files are flushed to disk whenever the OS gets to it.
+     */
+    brackets.fs.SYNC_NONE                   = 0;
+    
+    /**
+     * @constant A saved file is flushed to disk before it replaces the old one,
+     * so a crash leaves either the old or the new contents. This is the default.
+     */
+    brackets.fs.SYNC_DATA                   = 1;
+    
+    /**
+     * @constant Like SYNC_DATA, but the directory is flushed as well, so the new
+     * file is sure to survive a crash.
+     */
+    brackets.fs.SYNC_FULL                   = 2;
+    
     /**
      * Invoke a callback function.
      *
@@ -126,6 +150,21 @@ if (!brackets.app) {
         }
     }
     
+    /**
+     * Checks the result of a native call that starts an asynchronous operation. The
+     * operation passes its errors to the callback itself, but if it could not be
+     * started (e.g. because of invalid parameters), the callback is invoked here
+     * with the error and the remaining arguments.
+     */
+    function invokeCallbackOnError(result, callback) {
+        var err = result[0];
+        if (err) {
+            var args = [].splice.call(arguments, 2);
+            args.unshift(callback, err);
+            invokeCallback.apply(this, args);
+        }
+    }
+    
     /**
      * Display the OS File Open dialog, allowing the user to select
      * files or directories.
@@ -150,11 +189,10 @@ if (!brackets.app) {
     native function ShowOpenDialog();
     brackets.fs.showOpenDialog = function (allowMultipleSelection, chooseDirectory, title, initialPath, fileTypes, callback) {
         setTimeout(function () {
-            var resultString = ShowOpenDialog(allowMultipleSelection, chooseDirectory,
-                                             title || 'Open', initialPath || '',
-                                             fileTypes ? fileTypes.join(' ') : '');
-           var result = JSON.parse(resultString || '[]');
-           invokeCallback(callback, getLastError(), result);
+            var result = ShowOpenDialog(allowMultipleSelection, chooseDirectory,
+                                       title || 'Open', initialPath || '',
+                                       fileTypes ? fileTypes.join(' ') : '');
+            invokeCallback(callback, result[0], result[1] || []);
         }, 0);
     };
     
@@ -162,6 +200,10 @@ if (!brackets.app) {
      * Reads the contents of a directory. 
      *
      * @param {string} path The path of the directory to read.
+     * @param {{stats: boolean}=} options Optional. If options.stats is true, each entry of
+     *        files is an object { name, isDir, size, mtime } instead of a name. This saves
+     *        a stat() call for every entry. Entries that can't be stat'ed (e.g. broken
+     *        symlinks) have isDir false, size 0 and mtime 0.
      * @param {function(err, files)} callback Asynchronous callback function. The callback gets two arguments 
      *        (err, files) where files is an array of the names of the files
      *        in the directory excluding '.' and '..'.
@@ -175,10 +217,13 @@ if (!brackets.app) {
      * @return None. This is an asynchronous call that sends all return information to the callback.
      */
     native function ReadDir();
-    brackets.fs.readdir = function (path, callback) {
-        var resultString = ReadDir(path);
-        var result = JSON.parse(resultString || '[]');
-        invokeCallback(callback, getLastError(), result);
+    brackets.fs.readdir = function (path, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
+        }
+        var result = ReadDir(path, !!(options && options.stats), callback);
+        invokeCallbackOnError(result, callback, []);
     };
     
     /**
@@ -195,20 +240,330 @@ if (!brackets.app) {
      *                 
      * @return None. This is an asynchronous call that sends all return information to the callback.
      */
-    native function IsDirectory();
-    native function GetFileModificationTime();
+    native function Stat();
     brackets.fs.stat = function (path, callback) {
-        var isDir = IsDirectory(path);
-        var modtime = GetFileModificationTime(path);
-        invokeCallback(callback, getLastError(), {
-            isFile: function () {
-                return !isDir;
-            },
-            isDirectory: function () {
-                return isDir;
-            },
-            mtime: modtime
+        function createStats(info) {
+            var isDir = !!(info && info.isDir);
+            return {
+                isFile: function () {
+                    return !isDir;
+                },
+                isDirectory: function () {
+                    return isDir;
+                },
+                mtime: info ? info.mtime : undefined
+            };
+        }
+        
+        var result = Stat(path, function (err, info) {
+            callback(err, createStats(info));
         });
+        invokeCallbackOnError(result, callback, createStats(null));
+    };
+
+    /**
+     * Get information for many files or directories at once. This is much faster than
+     * calling stat() for each path.
+     *
+     * @param {Array.<string>} paths The paths of the files or directories to read.
+     * @param {function(err, results)} callback Asynchronous callback function. The callback gets two
+     *        arguments (err, results) where results has one { err, isDir, size, mtime } object
+     *        for each path. results[i].err is the error value for paths[i]: NO_ERROR,
+     *        ERR_INVALID_PARAMS, ERR_NOT_FOUND, ERR_CANT_READ or ERR_UNKNOWN.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_INVALID_PARAMS
+     *
+     * @return None. This is an asynchronous call that sends all return information to the callback.
+     */
+    native function StatMany();
+    brackets.fs.statMany = function (paths, callback) {
+        var result = StatMany(paths, callback);
+        invokeCallbackOnError(result, callback, []);
+    };
+
+    /**
+     * Lists all the files and directories below a directory. The directories are read
+     * in parallel on background threads, and the callback is called each time a batch of
+     * paths is ready, while the walk goes on. Directories reachable through several
+     * symlinks are only listed once, so symlink cycles are safe.
+     *
+     * @param {string} path The path of the directory to walk.
+     * @param {{excludes: Array.<string>, batchSize: number}=} options Optional.
+     *        options.excludes is an array of file and directory names to skip, like
+     *        "node_modules" or ".git". Defaults to none. options.batchSize is the number
+     *        of paths collected before the callback is called. Defaults to 1000.
+     * @param {function(err, paths, done)} callback Asynchronous callback function. Called
+     *        once for each batch, and a last time with done set to true. paths is an array
+     *        of paths relative to path. Paths of directories end with '/'. err is the error
+     *        reading path itself; directories below it that can't be read are skipped.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN
+     *          ERR_INVALID_PARAMS
+     *          ERR_NOT_FOUND
+     *          ERR_CANT_READ
+     *
+     * @return {number} An id that can be passed to cancelReaddirRecursive().
+     */
+    native function ReadDirRecursive();
+    brackets.fs.readdirRecursive = function (path, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
+        }
+        var excludes = (options && options.excludes) || [];
+        var batchSize = (options && options.batchSize) || 1000;
+        var result = ReadDirRecursive(path, excludes, batchSize, callback);
+        invokeCallbackOnError(result, callback, [], true);
+        return result[1];
+    };
+
+    /**
+     * Stops a readdirRecursive() call. Its callback is called one more time, with done
+     * set to true.
+     *
+     * @param {number} walkId The id returned by readdirRecursive().
+     */
+    native function CancelReadDirRecursive();
+    brackets.fs.cancelReaddirRecursive = function (walkId) {
+        CancelReadDirRecursive(walkId);
+    };
+
+    /**
+     * Searches the files below a directory. The files are searched in parallel on
+     * background threads, and the callback is called with the matches found so far while
+     * the search goes on. Files that are not UTF-8 text, like images, are skipped.
+     *
+     * @param {string} path The path of the directory to search.
+     * @param {string} query The text to find, or a regular expression if options.isRegexp
+     *        is true. Regular expressions use the JavaScript syntax, without backreferences
+     *        and lookaround. Matches never span lines.
+     * @param {{isRegexp: boolean, ignoreCase: boolean, excludes: Array.<string>,
+     *        maxResults: number}=} options Optional. options.ignoreCase defaults to true and
+     *        only applies to ASCII letters. options.excludes is an array of file and
+     *        directory names to skip, like "node_modules". options.maxResults is the number
+     *        of matches after which the search stops. Defaults to 10000.
+     * @param {function(err, matches, done, truncated)} callback Asynchronous callback
+     *        function. Called for each batch of matches, and a last time with done set to
+     *        true. matches is an array of { path, line, column, length, preview,
+     *        previewColumn } objects. line and column are 0-based. preview is the line of
+     *        the match, shortened around it if the line is long, and previewColumn is
+     *        where the match starts in it. truncated is true if the search stopped at
+     *        options.maxResults. err is the error reading path itself.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN
+     *          ERR_INVALID_PARAMS
+     *          ERR_NOT_FOUND
+     *          ERR_CANT_READ
+     *
+     * @return {number} An id that can be passed to cancelFindInFiles().
+     */
+    native function FindInFiles();
+    brackets.fs.findInFiles = function (path, query, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
+        }
+        var isRegexp = !!(options && options.isRegexp);
+        var ignoreCase = !(options && options.ignoreCase === false);
+        var excludes = (options && options.excludes) || [];
+        var maxResults = (options && options.maxResults) || 10000;
+        var result = FindInFiles(path, query, isRegexp, ignoreCase, excludes, maxResults, callback);
+        invokeCallbackOnError(result, callback, [], true, false);
+        return result[1];
+    };
+
+    /**
+     * Stops a findInFiles() call. Its callback is called one more time, with done set
+     * to true.
+     *
+     * @param {number} searchId The id returned by findInFiles().
+     */
+    native function CancelFindInFiles();
+    brackets.fs.cancelFindInFiles = function (searchId) {
+        CancelFindInFiles(searchId);
+    };
+
+    /**
+     * Builds an index of the files below a directory, for Quick Open. The index is kept
+     * up to date by writeFile(), unlink() and the events of watch(); changes made by other
+     * programs in directories that aren't watched can be passed to updateFileIndex().
+     *
+     * @param {string} path The path of the directory to index.
+     * @param {{excludes: Array.<string>}=} options Optional. options.excludes is an array
+     *        of file and directory names to skip, like "node_modules" or ".git".
+     * @param {function(err, count)} callback Asynchronous callback function. Called once
+     *        the index is complete, with the number of files in it. queryFileIndex() can
+     *        be used before, but only finds the files indexed so far. err is the error
+     *        reading path itself. Not called if the index is closed first.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN
+     *          ERR_INVALID_PARAMS
+     *          ERR_NOT_FOUND
+     *          ERR_CANT_READ
+     *
+     * @return {number} An id that can be passed to queryFileIndex() and closeFileIndex().
+     */
+    native function CreateFileIndex();
+    brackets.fs.createFileIndex = function (path, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
+        }
+        var excludes = (options && options.excludes) || [];
+        var result = CreateFileIndex(path, excludes, callback);
+        invokeCallbackOnError(result, callback, 0);
+        return result[1];
+    };
+
+    /**
+     * Finds the indexed files whose path contains query, ignoring the case of ASCII
+     * letters. Files whose name starts with query come first, sorted by name.
+     *
+     * @param {number} indexId The id returned by createFileIndex().
+     * @param {string} query The text to find.
+     * @param {number=} maxResults Optional. The most paths to return. Defaults to 1000.
+     *
+     * @return {Array.<string>} Paths relative to the indexed directory, or null if the
+     *         index is not known.
+     */
+    native function QueryFileIndex();
+    brackets.fs.queryFileIndex = function (indexId, query, maxResults) {
+        var result = QueryFileIndex(indexId, query, maxResults || 1000);
+        return (result[0] === brackets.fs.NO_ERROR) ? result[1] : null;
+    };
+
+    /**
+     * Finds the indexed files that best match a Quick Open query. A path matches if it
+     * contains the characters of query in order, ignoring the case of ASCII letters.
+     * Matches at the start of words, in the file name and runs of consecutive characters
+     * score higher. The paths are scored on background threads and only the best ones
+     * are returned.
+     *
+     * @param {number} indexId The id returned by createFileIndex().
+     * @param {string} query The characters to find.
+     * @param {number=} maxResults Optional. The number of matches to return. Defaults to 100.
+     *
+     * @return {Array.<{path: string, score: number, ranges: Array.<{start: number, length: number}>}>}
+     *         The best matches, best first, or null if the index is not known. path is
+     *         relative to the indexed directory. ranges are the matched characters of
+     *         path, for highlighting.
+     */
+    native function FuzzyQueryFileIndex();
+    brackets.fs.fuzzyQueryFileIndex = function (indexId, query, maxResults) {
+        var result = FuzzyQueryFileIndex(indexId, query, maxResults || 100);
+        return (result[0] === brackets.fs.NO_ERROR) ? result[1] : null;
+    };
+
+    /**
+     * Brings the indexes that contain the given paths up to date with the disk: files
+     * are added, missing paths are removed and directories are indexed again.
+     *
+     * @param {Array.<string>} paths The full paths that changed.
+     * @param {function(err)} callback Asynchronous callback function, called once the
+     *        indexes are updated.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_INVALID_PARAMS
+     *
+     * @return None. This is an asynchronous call that sends all return information to the callback.
+     */
+    native function UpdateFileIndex();
+    brackets.fs.updateFileIndex = function (paths, callback) {
+        var result = UpdateFileIndex(paths, callback);
+        invokeCallbackOnError(result, callback);
+    };
+
+    /**
+     * Forgets an index built by createFileIndex().
+     *
+     * @param {number} indexId The id returned by createFileIndex().
+     */
+    native function CloseFileIndex();
+    brackets.fs.closeFileIndex = function (indexId) {
+        CloseFileIndex(indexId);
+    };
+
+    /**
+     * Returns the size of an index built by createFileIndex(), or null if the index is
+     * not known.
+     *
+     * @return {{files: number, poolBytes: number}}
+     */
+    native function GetFileIndexStats();
+    brackets.fs.getFileIndexStats = function (indexId) {
+        var result = GetFileIndexStats(indexId);
+        return (result[0] === brackets.fs.NO_ERROR) ? result[1] : null;
+    };
+
+    /**
+     * Watches a file or directory for changes made by other programs. For a directory,
+     * the files and directories directly in it are watched as well.
+     *
+     * @param {string} path The path of the file or directory to watch.
+     * @param {function(err, events)} callback Called with each batch of changes. events is an
+     *        array of { path, type } objects, where type is "created", "changed" or "deleted".
+     *        If the watch could not be started, callback is called once with the error.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN
+     *          ERR_INVALID_PARAMS
+     *          ERR_NOT_FOUND
+     *          ERR_CANT_READ
+     *
+     * @return {number} An id that can be passed to unwatch().
+     */
+    native function Watch();
+    brackets.fs.watch = function (path, callback) {
+        var result = Watch(path, callback);
+        invokeCallbackOnError(result, callback, []);
+        return result[1];
+    };
+
+    /**
+     * Stops a watch() call. Its callback is not called again.
+     *
+     * @param {number} watchId The id returned by watch().
+     */
+    native function Unwatch();
+    brackets.fs.unwatch = function (watchId) {
+        Unwatch(watchId);
+    };
+
+    /**
+     * Returns the counters of the native stat and directory listing cache, to check
+     * how well it works on a project.
+     *
+     * @return {{hits: number, misses: number, evictions: number, invalidations: number,
+     *          entries: number}}
+     */
+    native function GetMetadataCacheStats();
+    brackets.fs.getMetadataCacheStats = function () {
+        return GetMetadataCacheStats()[1];
+    };
+
+    /**
+     * Returns the counters of the native readFile() cache.
+     *
+     * @return {{hits: number, misses: number, evictions: number, invalidations: number,
+     *          entries: number, bytes: number, budget: number}}
+     */
+    native function GetContentCacheStats();
+    brackets.fs.getContentCacheStats = function () {
+        return GetContentCacheStats()[1];
+    };
+
+    /**
+     * Sets the most memory the native readFile() cache may use. The default is 32MB.
+     *
+     * @param {number} bytes Size of the cache in bytes. 0 turns it off.
+     */
+    native function SetContentCacheBudget();
+    brackets.fs.setContentCacheBudget = function (bytes) {
+        SetContentCacheBudget(bytes);
     };
 
     /**
@@ -231,9 +586,11 @@ if (!brackets.app) {
      * Reads the entire contents of a file. 
      *
      * @param {string} path The path of the file to read.
-     * @param {string} encoding The encoding for the file. The only supported encoding is 'utf8'.
-     * @param {function(err, data)} callback Asynchronous callback function. The callback gets two arguments 
-     *        (err, data) where data is the contents of the file.
+     * @param {string} encoding The encoding for the file: 'utf8', 'utf8bom', 'utf16le', 'utf16be', 'latin1',
+     *        'windows1252', or 'auto' to detect it from the byte order mark and the contents.
+     * @param {function(err, data, encoding)} callback Asynchronous callback function. The callback gets three
+     *        arguments (err, data, encoding) where data is the contents of the file and encoding is the
+     *        encoding it was decoded from. Pass that encoding to writeFile() to save the file the same way.
      *        Possible error values:
      *          NO_ERROR
      *          ERR_UNKNOWN
@@ -246,16 +603,83 @@ if (!brackets.app) {
      */
     native function ReadFile();
     brackets.fs.readFile = function (path, encoding, callback) {
-        var contents = ReadFile(path, encoding);
-        invokeCallback(callback, getLastError(), contents);
+        var result = ReadFile(path, encoding, callback);
+        invokeCallbackOnError(result, callback);
+    };
+    
+    /**
+     * Reads part of a file. Use this to load very large files a piece at a time.
+     *
+     * @param {string} path The path of the file to read.
+     * @param {string} encoding The encoding for the file, see readFile(). 'auto' is not supported.
+     * @param {number} offset The byte offset to start reading at.
+     * @param {number} length The maximum number of bytes to read, at least 4.
+     * @param {function(err, data, bytesRead, fileSize)} callback Asynchronous callback function.
+     *        data is shortened so it ends on a character boundary. The next range starts at
+     *        offset + bytesRead. fileSize is the current size of the file in bytes.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN
+     *          ERR_INVALID_PARAMS
+     *          ERR_NOT_FOUND
+     *          ERR_CANT_READ
+     *          ERR_UNSUPPORTED_ENCODING
+     *
+     * @return None. This is an asynchronous call that sends all return information to the callback.
+     */
+    native function ReadFileRange();
+    brackets.fs.readFileRange = function (path, encoding, offset, length, callback) {
+        var result = ReadFileRange(path, encoding, offset, length, callback);
+        invokeCallbackOnError(result, callback, "", 0, 0);
+    };
+    
+    /**
+     * Reads a whole file in chunks. Only a few chunks are read ahead of the callback,
+     * so the file is never in memory all at once.
+     *
+     * @param {string} path The path of the file to read.
+     * @param {string} encoding The encoding for the file, see readFile(). 'auto' is not supported.
+     * @param {?{chunkSize: number}} options chunkSize is the number of bytes per chunk
+     *        (default 1MB). Can be omitted.
+     * @param {function(err, data, done)} callback Called once per chunk, in order. done is true
+     *        on the last call. Possible error values are the same as for readFile().
+     *
+     * @return {number} An id that can be passed to cancelReadFileStream().
+     */
+    native function ReadFileStream();
+    brackets.fs.readFileStream = function (path, encoding, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
+        }
+        var chunkSize = (options && options.chunkSize) || 1024 * 1024;
+        var result = ReadFileStream(path, encoding, chunkSize, callback);
+        invokeCallbackOnError(result, callback, "", true);
+        return result[1];
+    };
+
+    /**
+     * Stops a readFileStream() call. Its callback is called one more time, with done
+     * set to true.
+     *
+     * @param {number} streamId The id returned by readFileStream().
+     */
+    native function CancelReadFileStream();
+    brackets.fs.cancelReadFileStream = function (streamId) {
+        CancelReadFileStream(streamId);
     };
     
     /**
      * Write data to a file, replacing the file if it already exists. 
      *
+     * The data is written to a temporary file that then replaces the file, so other
+     * programs never see a half written file. Saves of the same file that queue up
+     * while it is being written are merged, and a save that wouldn't change the
+     * file is skipped.
+     *
      * @param {string} path The path of the file to write.
      * @param {string} data The data to write to the file.
-     * @param {string} encoding The encoding for the file. The only supported encoding is 'utf8'.
+     * @param {string} encoding The encoding for the file, see readFile(). 'auto' is not supported.
      * @param {function(err)} callback Asynchronous callback function. The callback gets one argument (err).
      *        Possible error values:
      *          NO_ERROR
@@ -269,10 +693,19 @@ if (!brackets.app) {
      */
     native function WriteFile();
     brackets.fs.writeFile = function (path, data, encoding, callback) {
-        WriteFile(path, data, encoding);
-        if (callback) {
-            invokeCallback(callback, getLastError());
-        }
+        callback = callback || function () {};
+        var result = WriteFile(path, data, encoding, callback);
+        invokeCallbackOnError(result, callback);
+    };
+    
+    /**
+     * Sets how hard writeFile() tries to get the data to disk before it calls back.
+     *
+     * @param {number} policy SYNC_NONE, SYNC_DATA or SYNC_FULL.
+     */
+    native function SetSyncPolicy();
+    brackets.fs.setSyncPolicy = function (policy) {
+        SetSyncPolicy(policy);
     };
     
     /**
@@ -291,8 +724,8 @@ if (!brackets.app) {
      */
     native function SetPosixPermissions();
     brackets.fs.chmod = function (path, mode, callback) {
-        SetPosixPermissions(path, mode);
-        invokeCallback(callback, getLastError());
+        var result = SetPosixPermissions(path, mode, callback);
+        invokeCallbackOnError(result, callback);
     };
     
     /**
@@ -310,15 +743,194 @@ if (!brackets.app) {
      * @return None. This is an asynchronous call that sends all return information to the callback.
      */
     native function DeleteFileOrDirectory();
-    native function IsDirectory();
     brackets.fs.unlink = function (path, callback) {
         // Unlink can only delete files
-        if (IsDirectory(path)) {
-            invokeCallback(callback, brackets.fs.ERR_NOT_FILE);
-            return;
+        var result = DeleteFileOrDirectory(path, true, callback);
+        invokeCallbackOnError(result, callback);
+    };
+
+    /**
+     * Create a directory, and any missing parent directories.
+     *
+     * @param {string} path The path of the directory to create
+     * @param {number} mode The permissions for the new directories, in numeric format (ie 0777)
+     * @param {function(err)} callback Asynchronous callback function. The callback gets one argument (err).
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN
+     *          ERR_INVALID_PARAMS
+     *          ERR_FILE_EXISTS
+     *          ERR_CANT_WRITE
+     *
+     * @return None. This is an asynchronous call that sends all return information to the callback.
+     */
+    native function MakeDir();
+    brackets.fs.makedir = function (path, mode, callback) {
+        var result = MakeDir(path, mode, callback);
+        invokeCallbackOnError(result, callback);
+    };
+
+    /**
+     * Rename a file or directory. Both paths must be on the same volume; use move() to
+     * move files between volumes.
+     *
+     * @param {string} oldPath The path of the file or directory to rename
+     * @param {string} newPath Its new path, which must not exist yet unless only the
+     *        case of the name changes
+     * @param {function(err)} callback Asynchronous callback function. The callback gets one argument (err).
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN
+     *          ERR_INVALID_PARAMS
+     *          ERR_NOT_FOUND
+     *          ERR_FILE_EXISTS
+     *          ERR_CANT_WRITE
+     *
+     * @return None. This is an asynchronous call that sends all return information to the callback.
+     */
+    native function Rename();
+    brackets.fs.rename = function (oldPath, newPath, callback) {
+        var result = Rename(oldPath, newPath, callback);
+        invokeCallbackOnError(result, callback);
+    };
+
+    /**
+     * Copy a file or a directory with everything in it. Directories are copied by
+     * several background threads at once, and the file data is copied by the OS where
+     * it can, without going through Brackets.
+     *
+     * @param {string} path The path of the file or directory to copy
+     * @param {string} newPath The path of the copy, which must not exist yet
+     * @param {{onProgress: function(progress)}=} options Optional. options.onProgress is
+     *        called about ten times a second while files are copied, with a { files,
+     *        totalFiles, bytes, totalBytes } object. The totals grow as directories are read.
+     * @param {function(err)} callback Asynchronous callback function, called once the copy
+     *        is done. What was copied before an error is left in place.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN (also if the copy was cancelled)
+     *          ERR_INVALID_PARAMS (also if newPath is inside path)
+     *          ERR_NOT_FOUND
+     *          ERR_CANT_READ
+     *          ERR_FILE_EXISTS
+     *          ERR_CANT_WRITE
+     *
+     * @return {number} An id that can be passed to cancelCopy().
+     */
+    native function Copy();
+    brackets.fs.copy = function (path, newPath, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
+        }
+        var onProgress = options && options.onProgress;
+        var result = Copy(path, newPath, function (err, progress, done) {
+            if (!done) {
+                if (onProgress) {
+                    onProgress(progress);
+                }
+            } else {
+                callback(err);
+            }
+        });
+        invokeCallbackOnError(result, callback);
+        return result[1];
+    };
+
+    /**
+     * Move a file or directory. It is renamed if newPath is on the same volume, or else
+     * copied like copy() does and deleted once the copy succeeded.
+     *
+     * @param {string} path The path of the file or directory to move
+     * @param {string} newPath Its new path, which must not exist yet
+     * @param {{onProgress: function(progress)}=} options Optional, see copy()
+     * @param {function(err)} callback Asynchronous callback function, see copy()
+     *
+     * @return {number} An id that can be passed to cancelCopy().
+     */
+    native function Move();
+    brackets.fs.move = function (path, newPath, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
+        }
+        var onProgress = options && options.onProgress;
+        var result = Move(path, newPath, function (err, progress, done) {
+            if (!done) {
+                if (onProgress) {
+                    onProgress(progress);
+                }
+            } else {
+                callback(err);
+            }
+        });
+        invokeCallbackOnError(result, callback);
+        return result[1];
+    };
+
+    /**
+     * Stops a copy() or move() call. Its callback is still called, with ERR_UNKNOWN.
+     *
+     * @param {number} copyId The id returned by copy() or move().
+     */
+    native function CancelCopy();
+    brackets.fs.cancelCopy = function (copyId) {
+        CancelCopy(copyId);
+    };
+
+    /**
+     * Delete a file or a directory with everything in it. Directories are deleted by
+     * several background threads at once. Symlinks are deleted, not followed. Entries
+     * that can't be deleted don't stop the others; the directories that contain them
+     * are left in place.
+     *
+     * @param {string} path The path of the file or directory to delete
+     * @param {{onProgress: function(progress)}=} options Optional. options.onProgress is
+     *        called about ten times a second while entries are deleted, with a
+     *        { deleted, failed } object.
+     * @param {function(err, failures)} callback Asynchronous callback function, called
+     *        once the delete is done. failures is an array of { path, err } objects for
+     *        the entries that could not be deleted, at most 1000. err is NO_ERROR if path
+     *        is gone, or else the error of the first failure.
+     *        Possible error values:
+     *          NO_ERROR
+     *          ERR_UNKNOWN (also if the delete was cancelled)
+     *          ERR_INVALID_PARAMS
+     *          ERR_NOT_FOUND
+     *          ERR_CANT_READ
+     *          ERR_CANT_WRITE
+     *
+     * @return {number} An id that can be passed to cancelDeleteRecursive().
+     */
+    native function DeleteRecursive();
+    brackets.fs.deleteRecursive = function (path, options, callback) {
+        if (typeof options === "function") {
+            callback = options;
+            options = null;
         }
-        DeleteFileOrDirectory(path);
-        invokeCallback(callback, getLastError());
+        var onProgress = options && options.onProgress;
+        var result = DeleteRecursive(path, function (err, progress, failures, done) {
+            if (!done) {
+                if (onProgress) {
+                    onProgress(progress);
+                }
+            } else {
+                callback(err, failures);
+            }
+        });
+        invokeCallbackOnError(result, callback, []);
+        return result[1];
+    };
+
+    /**
+     * Stops a deleteRecursive() call. Its callback is still called, with ERR_UNKNOWN
+     * unless some entries failed.
+     *
+     * @param {number} deleteId The id returned by deleteRecursive().
+     */
+    native function CancelDeleteRecursive();
+    brackets.fs.cancelDeleteRecursive = function (deleteId) {
+        CancelDeleteRecursive(deleteId);
     };
 
     /**
@@ -327,9 +939,37 @@ if (!brackets.app) {
      */
     native function GetElapsedMilliseconds();
     brackets.app.getElapsedMilliseconds = function () {
-        return GetElapsedMilliseconds();
+        return GetElapsedMilliseconds()[1];
     }
 
+    /**
+     * Return the counters recorded for every native function since the
+     * application was launched, as an array of { name, calls, errors,
+     * bytesIn, bytesOut, latency, callbackLatency } objects. latency is the
+     * time spent in the native function, callbackLatency the time from the
+     * call to its last callback, both as { count, min, mean, max, p50, p90,
+     * p99, p999, buckets } objects in milliseconds. buckets is an array of
+     * [max, count] pairs. Set the BRACKETS_NATIVE_STATS_FILE environment
+     * variable to have the same counters written there as JSON on exit.
+     */
+    native function GetNativeStats();
+    brackets.app.getNativeStats = function () {
+        return GetNativeStats()[1];
+    };
+
+    /**
+     * Return the timeline recorded by the native code: startup (CefInitialize,
+     * InitBracketsExtensions, browser creation, page loads), every native
+     * function call and the file system work done in the background. The
+     * result is a string of JSON in the Trace Event Format; save it to a file
+     * and load it in chrome://tracing. Set the BRACKETS_TRACE_FILE environment
+     * variable to have it written there on exit.
+     */
+    native function GetTrace();
+    brackets.app.getTrace = function () {
+        return GetTrace()[1];
+    };
+
     /**
      * Open the live browser
      *
@@ -347,8 +987,8 @@ if (!brackets.app) {
     native function OpenLiveBrowser();
     brackets.app.openLiveBrowser = function (url, enableRemoteDebugging, callback) {
         setTimeout(function() {
-            OpenLiveBrowser(url, enableRemoteDebugging);
-            callback(getLastError());
+            var result = OpenLiveBrowser(url, enableRemoteDebugging);
+            callback(result[0]);
         }, 0);
     };
     